@@ -26,6 +26,7 @@
 
 #include <Urho3D/Core/StringUtils.h>
 #include <Urho3D/Core/Profiler.h>
+#include <Urho3D/Core/Timer.h>
 
 // Disable unreferenced formal parameter coming from Bullet
 #ifdef _MSC_VER
@@ -43,7 +44,8 @@ namespace Tundra
 BulletPhysics::BulletPhysics(Framework* owner)
 :IModule("BulletPhysics", owner),
 defaultPhysicsUpdatePeriod_(1.0f / 60.0f),
-defaultMaxSubSteps_(6) // If fps is below 10, we start to slow down physics
+defaultMaxSubSteps_(6), // If fps is below 10, we start to slow down physics
+runBenchmark_(false)
 {
 }
 
@@ -76,6 +78,13 @@ void BulletPhysics::Initialize()
     framework->Console()->RegisterCommand("autoCollisionMesh",
         "Auto-assigns static rigid bodies with collision mesh to all visible meshes.",
         this, &BulletPhysics::AutoCollisionMesh);
+    framework->Console()->RegisterCommand("physicsBenchmark",
+        "Measures writing simulated rigid body transforms back to the scene, with and without batching. "
+        "Usage: physicsBenchmark(numBodies = 10000, numFrames = 60)")->ExecutedWith.Connect(this, &BulletPhysics::OnBenchmarkCommand);
+    
+    // The benchmark is run once all plugins, including the one providing Placeable, are initialized.
+    runBenchmark_ = framework->HasCommandLineParameter("--physicsBenchmark");
+    benchmarkParams_ = framework->CommandLineParameters("--physicsBenchmark");
     
     // Check physics execution rate related command line parameters
     StringList params = framework->CommandLineParameters("--physicsRate");
@@ -159,9 +168,85 @@ void BulletPhysics::AutoCollisionMesh()
     }
 }
 
+void BulletPhysics::OnBenchmarkCommand(const StringVector &params)
+{
+    RunWriteBackBenchmark(params.Size() > 0 ? Urho3D::ToUInt(params[0]) : 0, params.Size() > 1 ? Urho3D::ToUInt(params[1]) : 0);
+}
+
+void BulletPhysics::RunWriteBackBenchmark(uint numBodies, uint numFrames)
+{
+    if (!numBodies)
+        numBodies = 10000;
+    if (!numFrames)
+        numFrames = 60;
+
+    const String sceneName = "PhysicsWriteBackBenchmark";
+    float frameMsecs[2] = { 0.f, 0.f };
+    for(int batched = 0; batched < 2; ++batched)
+    {
+        ScenePtr scene = framework->Scene()->CreateScene(sceneName, false, true, AttributeChange::LocalOnly);
+        PhysicsWorldPtr world = (scene ? scene->Subsystem<PhysicsWorld>() : PhysicsWorldPtr());
+        if (!world)
+        {
+            LogError("BulletPhysics::RunWriteBackBenchmark: Failed to create a scene with a physics world.");
+            framework->Scene()->RemoveScene(sceneName);
+            return;
+        }
+        world->SetBatchedWriteBack(batched != 0);
+
+        // Bodies in a grid, far enough apart to not collide. They fall freely, so every body moves on every step.
+        uint side = 1;
+        while(side * side < numBodies)
+            ++side;
+        for(uint i = 0; i < numBodies; ++i)
+        {
+            EntityPtr entity = scene->CreateEntity(0, StringVector(), AttributeChange::Default);
+            SharedPtr<Placeable> placeable = entity->GetOrCreateComponent<Placeable>();
+            SharedPtr<RigidBody> body = entity->GetOrCreateComponent<RigidBody>();
+            if (!placeable || !body)
+            {
+                LogError("BulletPhysics::RunWriteBackBenchmark: Failed to create Placeable and RigidBody components.");
+                framework->Scene()->RemoveScene(sceneName);
+                return;
+            }
+            Transform t = placeable->transform.Get();
+            t.SetPos(float3((float)(i % side) * 3.f, 100.f, (float)(i / side) * 3.f));
+            placeable->transform.Set(t, AttributeChange::Default);
+            body->shapeType.Set(RigidBody::Sphere, AttributeChange::Default);
+            body->mass.Set(1.0f, AttributeChange::Default);
+        }
+
+        SimulateFrames(scene, 1); // Warm up
+        frameMsecs[batched] = SimulateFrames(scene, numFrames);
+        framework->Scene()->RemoveScene(sceneName);
+    }
+
+    LogInfo(Urho3D::ToString("physicsBenchmark: %u bodies, %u frames: immediate write-back %.2f ms/frame, batched %.2f ms/frame (%.2fx)",
+        numBodies, numFrames, frameMsecs[0], frameMsecs[1], (frameMsecs[1] > 0.f ? frameMsecs[0] / frameMsecs[1] : 0.f)));
+}
+
+float BulletPhysics::SimulateFrames(Scene *scene, uint numFrames)
+{
+    PhysicsWorldPtr world = scene->Subsystem<PhysicsWorld>();
+    Urho3D::HiresTimer timer;
+    for(uint i = 0; i < numFrames; ++i)
+        world->Simulate(world->PhysicsUpdatePeriod());
+    return (numFrames > 0 ? timer.GetUSec(false) / 1000.f / (float)numFrames : 0.f);
+}
+
 void BulletPhysics::Update(float frametime)
 {
     URHO3D_PROFILE(BulletPhysics_Update);
+
+    if (runBenchmark_)
+    {
+        runBenchmark_ = false;
+        RunWriteBackBenchmark(benchmarkParams_.Size() > 0 ? Urho3D::ToUInt(benchmarkParams_[0]) : 0,
+            benchmarkParams_.Size() > 1 ? Urho3D::ToUInt(benchmarkParams_[1]) : 0);
+        framework->Exit();
+        return;
+    }
+
     // Loop all the physics worlds and update them.
     Vector<PhysicsWorldPtr>::Iterator i = physicsWorlds_.Begin();
     while(i != physicsWorlds_.End())
@@ -204,6 +289,20 @@ int BulletPhysics::ForgetUnusedCacheShapes()
        this keeping the ptr alive. These will be forgotten. */
     int forgotten = 0;
 
+    // The BVH shapes reference the triangle meshes, so forget them first.
+    for (BvhTriangleMeshShapeMap::Iterator iter = bvhTriangleMeshShapes_.Begin(), end = bvhTriangleMeshShapes_.End();
+        iter != end;)
+    {
+        shared_ptr<btBvhTriangleMeshShape> &ptr = iter->second_.second_;
+        if (ptr.use_count() == 1)
+        {
+            iter = bvhTriangleMeshShapes_.Erase(iter);
+            forgotten++;
+        }
+        else
+            iter++;
+    }
+
     for (TriangleMeshMap::Iterator iter = triangleMeshes_.Begin(), end = triangleMeshes_.End();
         iter != end;)
     {
@@ -253,6 +352,27 @@ shared_ptr<btTriangleMesh> BulletPhysics::GetTriangleMeshFromMeshAsset(IMeshAsse
     return ptr;
 }
 
+shared_ptr<btBvhTriangleMeshShape> BulletPhysics::GetBvhTriangleMeshShapeFromMeshAsset(IMeshAsset* mesh)
+{
+    shared_ptr<btBvhTriangleMeshShape> ptr;
+    if (!mesh)
+        return ptr;
+    
+    shared_ptr<btTriangleMesh> triangleMesh = GetTriangleMeshFromMeshAsset(mesh);
+    
+    // Check if the BVH has already been built from the current triangle mesh
+    BvhTriangleMeshShapeMap::ConstIterator iter = bvhTriangleMeshShapes_.Find(mesh->Name());
+    if (iter != bvhTriangleMeshShapes_.End() && iter->second_.first_ == triangleMesh)
+        return iter->second_.second_;
+    
+    ptr = shared_ptr<btBvhTriangleMeshShape>(new btBvhTriangleMeshShape(triangleMesh.get(), true, true));
+    
+    // Keep the triangle mesh referenced by the shape alive with it.
+    bvhTriangleMeshShapes_[mesh->Name()] = Urho3D::MakePair(triangleMesh, ptr);
+    
+    return ptr;
+}
+
 shared_ptr<ConvexHullSet> BulletPhysics::GetConvexHullSetFromMeshAsset(IMeshAsset* mesh)
 {
     shared_ptr<ConvexHullSet> ptr;
@@ -33,7 +33,7 @@ public:
     void Uninitialize();
 
     /// Forget cache bullet shapes.
-    /** Code that loads into the cache with calling GetTriangleMeshFromMesh and GetConvexHullSetFromMesh is
+    /** Code that loads into the cache with calling GetTriangleMeshFromMesh, GetBvhTriangleMeshShapeFromMeshAsset and GetConvexHullSetFromMesh is
         responsible to call this function when it has reseted its own shared ptr, to ensure if your code was the last
         use of this particular Mesh, the shapes memory will get released. */
     int ForgetUnusedCacheShapes();
@@ -42,6 +42,13 @@ public:
     /** If already has been generated, returns the previously created one */
     shared_ptr<btTriangleMesh> GetTriangleMeshFromMeshAsset(IMeshAsset* mesh);
 
+    /// Get a Bullet BVH triangle mesh shape of the triangle mesh corresponding to a graphics mesh.
+    /** If already has been generated, returns the previously created one. The shape is shared by all rigid bodies using the mesh,
+        so it must not be scaled: wrap it into a btScaledBvhTriangleMeshShape instead. The shape references the triangle mesh
+        returned by GetTriangleMeshFromMeshAsset, which the cache keeps alive for as long as it keeps the shape. If the shape
+        is replaced in the cache, the callers still using it must keep the triangle mesh alive themselves. */
+    shared_ptr<btBvhTriangleMeshShape> GetBvhTriangleMeshShapeFromMeshAsset(IMeshAsset* mesh);
+
     /// Get a Bullet convex hull set (using minimum recursion, not very accurate but fast) corresponding to an Ogre mesh.
     /** If already has been generated, returns the previously created one */
     shared_ptr<ConvexHullSet> GetConvexHullSetFromMeshAsset(IMeshAsset* mesh);
@@ -72,6 +79,13 @@ public:
 
     /// Enable/disable physics simulation from all physics worlds
     void SetRunPhysics(bool enable);
+
+    /// Measures the cost of writing simulated rigid body transforms back to the scene, with and without batching.
+    /** Simulates freely falling bodies in a temporary scene and logs the average frame time of both write-back modes.
+        Run headless with the --physicsBenchmark [numBodies] [numFrames] command line parameter, which exits when done.
+        @param numBodies Number of active bodies. 10000 if 0.
+        @param numFrames Number of simulated frames per mode. 60 if 0. */
+    void RunWriteBackBenchmark(uint numBodies = 0, uint numFrames = 0);
     
 private:
     /// Creates PhysicsWorld for a Scene.
@@ -79,6 +93,12 @@ private:
     /// Removes PhysicsWorld of a Scene.
     void RemovePhysicsWorld(Scene *scene, AttributeChange::Type change);
 
+    /// Handles the physicsBenchmark console command.
+    void OnBenchmarkCommand(const StringVector &params);
+
+    /// Simulates numFrames frames of scene, returns the average frame time in milliseconds.
+    float SimulateFrames(Scene *scene, uint numFrames);
+
     /// All PhysicsWorlds created.
     Vector<PhysicsWorldPtr> physicsWorlds_;
 
@@ -86,12 +106,20 @@ private:
     /// Bullet triangle meshes generated from graphics meshes
     TriangleMeshMap triangleMeshes_;
 
+    typedef Pair<shared_ptr<btTriangleMesh>, shared_ptr<btBvhTriangleMeshShape> > BvhTriangleMeshShapeEntry;
+    typedef HashMap<String, BvhTriangleMeshShapeEntry> BvhTriangleMeshShapeMap;
+    /// Bullet BVH triangle mesh shapes built from the triangle meshes, stored with the triangle mesh the shape references
+    BvhTriangleMeshShapeMap bvhTriangleMeshShapes_;
+
     typedef HashMap<String, shared_ptr<ConvexHullSet> > ConvexHullSetMap;
     /// Bullet convex hull sets generated from graphics meshes
     ConvexHullSetMap convexHullSets_;
     
     float defaultPhysicsUpdatePeriod_;
     int defaultMaxSubSteps_;
+    /// Parameters of the --physicsBenchmark run on the first update, empty if not requested.
+    StringVector benchmarkParams_;
+    bool runBenchmark_;
 };
 
 }
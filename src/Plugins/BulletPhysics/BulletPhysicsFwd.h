@@ -17,6 +17,7 @@ namespace Tundra
     class PhysicsWorld;
     struct PhysicsRaycastResult;
     class RigidBody;
+    struct RigidBodyWriteBack;
     class VolumeTrigger;
 
     typedef SharedPtr<PhysicsWorld> PhysicsWorldPtr;
@@ -25,6 +26,7 @@ namespace Tundra
 
 // From Bullet:
 class btTriangleMesh;
+class btBvhTriangleMeshShape;
 class btCollisionConfiguration;
 class btBroadphaseInterface;
 class btConstraintSolver;
@@ -377,6 +377,7 @@ PhysicsWorld::PhysicsWorld(Scene* scene, bool isClient) :
     runPhysics_(true),
     drawDebugManuallySet_(false),
     useVariableTimestep_(false),
+    batchedWriteBack_(true),
     impl(new Impl(this))
 {
     if (scene->GetFramework()->HasCommandLineParameter("--variablephysicsstep"))
@@ -402,6 +403,47 @@ void PhysicsWorld::SetMaxSubSteps(int steps)
         maxSubSteps_ = steps;
 }
 
+void PhysicsWorld::SetBatchedWriteBack(bool enable)
+{
+    ApplyWriteBacks();
+    batchedWriteBack_ = enable;
+}
+
+void PhysicsWorld::QueueWriteBack(const RigidBodyWriteBack &writeBack, int &index)
+{
+    if (index >= 0 && index < (int)writeBacks_.Size() && writeBacks_[index].body == writeBack.body)
+        writeBacks_[index] = writeBack;
+    else
+    {
+        index = (int)writeBacks_.Size();
+        writeBacks_.Push(writeBack);
+    }
+}
+
+void PhysicsWorld::CancelWriteBack(int index)
+{
+    if (index >= 0 && index < (int)writeBacks_.Size())
+        writeBacks_[index].body = 0;
+}
+
+void PhysicsWorld::ApplyWriteBacks()
+{
+    if (writeBacks_.Empty())
+        return;
+
+    URHO3D_PROFILE(PhysicsWorld_ApplyWriteBacks);
+
+    // Write all values before signalling any of them, so that the listeners see every body at its new state.
+    for(uint i = 0; i < writeBacks_.Size(); ++i)
+        if (writeBacks_[i].body)
+            writeBacks_[i].body->WriteBackValues(writeBacks_[i]);
+    for(uint i = 0; i < writeBacks_.Size(); ++i)
+        if (writeBacks_[i].body)
+            writeBacks_[i].body->NotifyWriteBack(writeBacks_[i]);
+
+    writeBacks_.Clear();
+}
+
 void PhysicsWorld::SetGravity(const float3& gravity)
 {
     impl->world->setGravity(gravity);
@@ -442,6 +484,8 @@ void PhysicsWorld::Simulate(float frametime)
         else
             impl->world->stepSimulation(fFrametime, maxSubSteps_, physicsUpdatePeriod_);
     }
+
+    ApplyWriteBacks();
     
     if (!scene_.Expired() && !scene_.Lock()->GetFramework()->IsHeadless())
     {
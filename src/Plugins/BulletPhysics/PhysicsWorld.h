@@ -7,6 +7,8 @@
 #include "BulletPhysicsApi.h"
 #include "BulletPhysicsFwd.h"
 #include "Math/float3.h"
+#include "Math/Quat.h"
+#include "AttributeChangeType.h"
 #include "Signals.h"
 
 #include <Urho3D/Core/Object.h>
@@ -28,6 +30,19 @@ struct PhysicsRaycastResult
     float distance; ///< Distance from ray origin to the hit point.
 };
 
+/// Simulated state of a rigid body waiting to be written back to its attributes.
+/** @sa PhysicsWorld::SetBatchedWriteBack */
+struct RigidBodyWriteBack
+{
+    RigidBody* body; ///< Null if the body was destroyed after the state was queued.
+    float3 position; ///< World position.
+    Quat orientation; ///< World orientation.
+    float3 linearVelocity;
+    float3 angularVelocity; ///< In degrees per second.
+    AttributeChange::Type change;
+    u8 changed; ///< Attributes whose values were written, RigidBody::WriteBackFlags.
+};
+
 /// A physics world that encapsulates a Bullet physics world
 class BULLETPHYSICS_API PhysicsWorld : public Object
 {
@@ -86,6 +101,16 @@ public:
     /// Return whether simulation is on
     bool IsRunning() const { return runPhysics_; }
 
+    /// Enable/disable batched write-back of the simulated rigid body transforms. Enabled by default.
+    /** Bullet reports the new pose of each moving body during the simulation step. With batching, the poses are collected
+        to a buffer, one per body even if there were several substeps, and applied in one pass after the step: all the new values
+        are written first, and the attribute changes are signalled after that. Without batching, each pose is applied and its
+        changes signalled immediately as Bullet reports it. */
+    void SetBatchedWriteBack(bool enable);
+
+    /// Return whether batched write-back is enabled
+    bool IsBatchedWriteBack() const { return batchedWriteBack_; }
+
     /// Return the Bullet world object
     btDiscreteDynamicsWorld* BulletWorld() const;
 
@@ -139,6 +164,16 @@ private:
     /// Draw physics debug geometry, if debug drawing enabled
     void DrawDebugGeometry();
 
+    /// Queue the simulated state of a body for write-back. Replaces the state queued earlier during the same step.
+    /** @param index Index of the body's queued state, -1 if none. Updated by this function. */
+    void QueueWriteBack(const RigidBodyWriteBack &writeBack, int &index);
+
+    /// Forget the queued state of a destroyed body
+    void CancelWriteBack(int index);
+
+    /// Write back all queued states
+    void ApplyWriteBacks();
+
     struct Impl;
     Impl *impl;
     /// Length of one physics simulation step
@@ -157,6 +192,10 @@ private:
     bool runPhysics_;
     /// Variable timestep flag
     bool useVariableTimestep_;
+    /// Batched write-back flag
+    bool batchedWriteBack_;
+    /// States waiting for write-back after the current simulation step
+    Vector<RigidBodyWriteBack> writeBacks_;
     
     /// Debug draw-enabled rigidbodies. Note: these pointers are never dereferenced, it is just used for counting
     HashSet<RigidBody*> debugRigidBodies_;
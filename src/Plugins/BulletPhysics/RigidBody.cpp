@@ -23,6 +23,7 @@
 #include <btBulletDynamicsCommon.h>
 #include <LinearMath/btMotionState.h>
 #include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+#include <BulletCollision/CollisionShapes/btUniformScalingShape.h>
 #include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
 #include <Urho3D/Core/Profiler.h>
 
@@ -33,6 +34,18 @@ static const float cForceThresholdSq = 0.0005f * 0.0005f;
 static const float cImpulseThresholdSq = 0.0005f * 0.0005f;
 static const float cTorqueThresholdSq = 0.0005f * 0.0005f;
 
+/// Creates a scaled instance of a shared convex hull.
+static btCollisionShape* CreateConvexHullInstance(btConvexHullShape* hull, const float3 &scale)
+{
+    // Uniform scale only needs a wrapper referencing the hull. Non-uniform scale can not be expressed by a wrapper,
+    // so then the points are copied.
+    if (scale.Equals(float3(scale.x, scale.x, scale.x)))
+        return new btUniformScalingShape(hull, scale.x);
+    btConvexHullShape* convex = new btConvexHullShape(reinterpret_cast<const btScalar*>(hull->getUnscaledPoints()), hull->getNumVertices());
+    convex->setLocalScaling(scale);
+    return convex;
+}
+
 struct RigidBody::Impl : public btMotionState
 {
     Impl(RigidBody *rb) :
@@ -40,12 +53,13 @@ struct RigidBody::Impl : public btMotionState
         world(0),
         owner(0),
         shape(0),
-        childShape(0),
         heightField(0),
         disconnected(false),
         cachedShapeType(-1),
         cachedSize(float3::zero),
+        hullScale(float3::zero),
         clientExtrapolating(false),
+        writeBackIndex(-1),
         rigidBody(rb)
     {
     }
@@ -66,9 +80,6 @@ struct RigidBody::Impl : public btMotionState
     /// btMotionState override. Called when Bullet wants to tell us the body's current transform
     void setWorldTransform(const btTransform &worldTrans)
     {
-        /// \todo For a large scene, applying the changed transforms of rigid bodies is slow (slower than the physics simulation itself,
-        /// or handling collisions) due to the large number of Qt signals being fired.
-    
         // Cannot modify server-authoritative physics object, rather get the transform changes through placeable attributes
         const bool hasAuthority = rigidBody->HasAuthority();
         if (!hasAuthority && !clientExtrapolating)
@@ -76,53 +87,25 @@ struct RigidBody::Impl : public btMotionState
     
         if (placeable.Expired())
             return;
-        Placeable* p = placeable;
-        // Important: disconnect our own response to attribute changes to not create an endless loop!
-        disconnected = true;
-    
-        AttributeChange::Type changeType = hasAuthority ? AttributeChange::Default : AttributeChange::LocalOnly;
 
-        // Set transform
-        float3 position = worldTrans.getOrigin();
-        Quat orientation = worldTrans.getRotation();
-    
-        // Non-parented case
-        if (p->parentRef.Get().IsEmpty())
-        {
-            Transform newTrans = p->transform.Get();
-            newTrans.SetPos(position.x, position.y, position.z);
-            newTrans.SetOrientation(orientation);
-            p->transform.Set(newTrans, changeType);
-        }
+        RigidBodyWriteBack writeBack;
+        writeBack.body = rigidBody;
+        writeBack.position = worldTrans.getOrigin();
+        writeBack.orientation = worldTrans.getRotation();
+        writeBack.linearVelocity = (body ? float3(body->getLinearVelocity()) : rigidBody->linearVelocity.Get());
+        writeBack.angularVelocity = (body ? RadToDeg(float3(body->getAngularVelocity())) : rigidBody->angularVelocity.Get());
+        writeBack.change = hasAuthority ? AttributeChange::Default : AttributeChange::LocalOnly;
+        writeBack.changed = 0;
+
+        // Applying the changed transforms one by one as Bullet reports them is slow in a large scene (slower than the simulation itself),
+        // due to the large number of signals being fired. Rather let the physics world apply them in one batch after the step.
+        if (world && world->IsBatchedWriteBack())
+            world->QueueWriteBack(writeBack, writeBackIndex);
         else
-        // The placeable has a parent itself
-        {
-            Urho3D::Node* parent = p->UrhoSceneNode()->GetParent();
-            if (parent)
-            {
-                position = parent->WorldToLocal(position);
-                orientation = parent->GetWorldRotation().Inverse() * orientation;
-                Transform newTrans = p->transform.Get();
-                newTrans.SetPos(position);
-                newTrans.SetOrientation(orientation);
-                p->transform.Set(newTrans, changeType);
-            }
-        }
-        // Set linear & angular velocity
-        if (body)
         {
-            // Performance optimization: because applying each attribute causes signals to be fired, which is slow in a large scene
-            // (and furthermore, on a server, causes each connection's sync state to be accessed), do not set the linear/angular
-            // velocities if they haven't changed
-            float3 linearVel = body->getLinearVelocity();
-            float3 angularVel = RadToDeg(body->getAngularVelocity());
-            if (!linearVel.Equals(rigidBody->linearVelocity.Get()))
-                rigidBody->linearVelocity.Set(linearVel, changeType);
-            if (!angularVel.Equals(rigidBody->angularVelocity.Get()))
-                rigidBody->angularVelocity.Set(angularVel, changeType);
+            rigidBody->WriteBackValues(writeBack);
+            rigidBody->NotifyWriteBack(writeBack);
         }
-    
-        disconnected = false;
     }
 
     /// Calculate mass, shape & static/dynamic-classification dependant properties
@@ -171,8 +154,6 @@ struct RigidBody::Impl : public btMotionState
     btRigidBody* body;
     /// Bullet collision shape
     btCollisionShape* shape;
-    /// Bullet collision child shape. This is needed to use btScaledBvhTriangleMeshShape
-    btCollisionShape* childShape;
     /// Physics world. May be 0 if the scene does not have a physics world. In that case most of RigidBody's functionality is a no-op
     PhysicsWorld* world;
     /// BulletPhysics pointer
@@ -183,12 +164,20 @@ struct RigidBody::Impl : public btMotionState
     float3 cachedSize;
     /// Bullet triangle mesh
     shared_ptr<btTriangleMesh> triangleMesh;
+    /// Bullet BVH triangle mesh shape, shared between bodies using the same mesh. Wrapped by a btScaledBvhTriangleMeshShape (impl->shape) for individual scaling
+    shared_ptr<btBvhTriangleMeshShape> bvhShape;
     /// Convex hull set
     shared_ptr<ConvexHullSet> convexHullSet;
+    /// Scaled instances of the convex hulls when there are several of them in the compound shape (impl->shape)
+    Vector<btCollisionShape*> hullInstances;
+    /// Scale the convex hull instances were created with
+    float3 hullScale;
     /// Bullet heightfield shape. Note: this is always put inside a compound shape (impl->shape)
     btHeightfieldTerrainShape* heightField;
     /// Heightfield values, for the case the shape is a heightfield.
     PODVector<float> heightValues;
+    /// Index of the simulated state queued for write-back in the physics world, -1 if none.
+    int writeBackIndex;
 };
 
 RigidBody::RigidBody(Urho3D::Context* context, Scene* scene) :
@@ -237,12 +226,16 @@ RigidBody::~RigidBody()
 {
     // Explicitly reset here, RemoveCollisionShape() wont do it if shape type matches.
     impl->triangleMesh.reset();
+    impl->bvhShape.reset();
     impl->convexHullSet.reset();
 
     RemoveBody();
     RemoveCollisionShape();
     if (impl->world)
+    {
         impl->world->debugRigidBodies_.Erase(this);
+        impl->world->CancelWriteBack(impl->writeBackIndex);
+    }
     delete impl;
 }
 
@@ -474,11 +467,10 @@ void RigidBody::CreateCollisionShape()
         impl->shape = new btCapsuleShape(sizeVec.x * 0.5f, sizeVec.y * 0.5f);
         break;
     case TriMesh:
-        if (impl->triangleMesh)
+        if (impl->bvhShape)
         {
-            // Need to first create a bvhTriangleMeshShape, then a scaled version of it to allow for individual scaling.
-            impl->childShape = new btBvhTriangleMeshShape(impl->triangleMesh.get(), true, true);
-            impl->shape = new btScaledBvhTriangleMeshShape(static_cast<btBvhTriangleMeshShape*>(impl->childShape), btVector3(1.0f, 1.0f, 1.0f));
+            // The bvhTriangleMeshShape is shared, create a scaled version of it to allow for individual scaling.
+            impl->shape = new btScaledBvhTriangleMeshShape(impl->bvhShape.get(), btVector3(1.0f, 1.0f, 1.0f));
         }
         break;
     case HeightField:
@@ -506,11 +498,16 @@ void RigidBody::RemoveCollisionShape()
             impl->body->setCollisionShape(0);
         SAFE_DELETE(impl->shape);
     }
-    SAFE_DELETE(impl->childShape);
+    foreach(btCollisionShape* instance, impl->hullInstances)
+        delete instance;
+    impl->hullInstances.Clear();
     SAFE_DELETE(impl->heightField);
 
     if (shapeType.Get() != TriMesh)
+    {
         impl->triangleMesh.reset();
+        impl->bvhShape.reset();
+    }
     if (shapeType.Get() != ConvexHull)
         impl->convexHullSet.reset();
 
@@ -580,6 +577,80 @@ void RigidBody::RemoveBody()
     }
 }
 
+void RigidBody::WriteBackValues(RigidBodyWriteBack &writeBack)
+{
+    writeBack.changed = 0;
+    Placeable* p = impl->placeable;
+    if (!p)
+        return;
+
+    // Parented transforms are relative to the parent's node, which may itself be waiting for its write-back to be signalled.
+    // Write them only when signalling, in the same order as Bullet reported the bodies.
+    if (!p->parentRef.Get().IsEmpty())
+        writeBack.changed |= WriteBackParented;
+    else
+    {
+        Transform newTrans = p->transform.Get();
+        newTrans.SetPos(writeBack.position.x, writeBack.position.y, writeBack.position.z);
+        newTrans.SetOrientation(writeBack.orientation);
+        if (!(newTrans == p->transform.Get()))
+        {
+            p->transform.Set(newTrans, AttributeChange::Disconnected);
+            writeBack.changed |= WriteBackTransform;
+        }
+    }
+
+    // Performance optimization: because applying each attribute causes signals to be fired, which is slow in a large scene
+    // (and furthermore, on a server, causes each connection's sync state to be accessed), do not set the linear/angular
+    // velocities if they haven't changed
+    if (impl->body)
+    {
+        if (!writeBack.linearVelocity.Equals(linearVelocity.Get()))
+        {
+            linearVelocity.Set(writeBack.linearVelocity, AttributeChange::Disconnected);
+            writeBack.changed |= WriteBackLinearVelocity;
+        }
+        if (!writeBack.angularVelocity.Equals(angularVelocity.Get()))
+        {
+            angularVelocity.Set(writeBack.angularVelocity, AttributeChange::Disconnected);
+            writeBack.changed |= WriteBackAngularVelocity;
+        }
+    }
+}
+
+void RigidBody::NotifyWriteBack(const RigidBodyWriteBack &writeBack)
+{
+    impl->writeBackIndex = -1;
+    Placeable* p = impl->placeable;
+    if (!p || !writeBack.changed)
+        return;
+
+    // Important: disconnect our own response to attribute changes to not create an endless loop!
+    impl->disconnected = true;
+
+    if (writeBack.changed & WriteBackParented)
+    {
+        Urho3D::Node* parent = p->UrhoSceneNode()->GetParent();
+        if (parent)
+        {
+            float3 position = parent->WorldToLocal(writeBack.position);
+            Quat orientation = parent->GetWorldRotation().Inverse() * writeBack.orientation;
+            Transform newTrans = p->transform.Get();
+            newTrans.SetPos(position);
+            newTrans.SetOrientation(orientation);
+            p->transform.Set(newTrans, writeBack.change);
+        }
+    }
+    else if (writeBack.changed & WriteBackTransform)
+        p->transform.Changed(writeBack.change);
+    if (writeBack.changed & WriteBackLinearVelocity)
+        linearVelocity.Changed(writeBack.change);
+    if (writeBack.changed & WriteBackAngularVelocity)
+        angularVelocity.Changed(writeBack.change);
+
+    impl->disconnected = false;
+}
+
 void RigidBody::SetClientExtrapolating(bool isClientExtrapolating)
 {
     impl->clientExtrapolating = isClientExtrapolating;
@@ -606,6 +677,7 @@ void RigidBody::OnCollisionMeshAssetLoaded(AssetPtr asset)
     if (shapeType.Get() == TriMesh)
     {
         impl->triangleMesh = impl->owner->GetTriangleMeshFromMeshAsset(meshAsset);
+        impl->bvhShape = impl->owner->GetBvhTriangleMeshShapeFromMeshAsset(meshAsset);
         CreateCollisionShape();
     }
     else if (shapeType.Get() == ConvexHull)
@@ -927,29 +999,44 @@ void RigidBody::UpdateScale()
     Placeable* placeable = impl->placeable;
     if (placeable && impl->shape)
     {
-        const ShapeType shape = static_cast<ShapeType>(shapeType.Get());
-        const float3 &sizeVec = size.Get();
-        const float3 scale = placeable->WorldScale();
-
-        // Trianglemesh or convexhull does not have scaling of its own in the shape, so multiply with the size
-        btVector3 finalScale = (shape != TriMesh && shape != ConvexHull ?
-            btVector3(scale.x, scale.y, scale.z) : btVector3(sizeVec.x * scale.x, sizeVec.y * scale.y, sizeVec.z * scale.z));
-
-        /* Bullet has asserts for zero scale in debug mode. These wont trigger in Release
-           builds but they sure do indicate we should not be passing zero scale into it.
-           @note This is the same logic Placeable enforces before passing scale to ogre,
-           but Transform attributes scale can still be zero or negative. */
-        if (finalScale.x() < 0)
-            finalScale.setX(0);
-        if (finalScale.y() < 0)
-            finalScale.setY(0);
-        if (finalScale.z() < 0)
-            finalScale.setZ(0);
-
-        impl->shape->setLocalScaling(finalScale);
+        // The convex hulls are shared between bodies, so they are never scaled. Recreate the instances referencing them instead.
+        if (shapeType.Get() == ConvexHull)
+        {
+            if (!CollisionShapeScale().Equals(impl->hullScale))
+                RescaleConvexHullSetShape();
+        }
+        else
+            impl->shape->setLocalScaling(CollisionShapeScale());
     }
 }
 
+float3 RigidBody::CollisionShapeScale() const
+{
+    Placeable* placeable = impl->placeable;
+    if (!placeable)
+        return float3(1,1,1);
+
+    const ShapeType shape = static_cast<ShapeType>(shapeType.Get());
+    const float3 &sizeVec = size.Get();
+    const float3 scale = placeable->WorldScale();
+
+    // Trianglemesh or convexhull does not have scaling of its own in the shape, so multiply with the size
+    float3 finalScale = (shape != TriMesh && shape != ConvexHull ? scale : sizeVec.Mul(scale));
+
+    /* Bullet has asserts for zero scale in debug mode. These wont trigger in Release
+       builds but they sure do indicate we should not be passing zero scale into it.
+       @note This is the same logic Placeable enforces before passing scale to ogre,
+       but Transform attributes scale can still be zero or negative. */
+    if (finalScale.x < 0)
+        finalScale.x = 0;
+    if (finalScale.y < 0)
+        finalScale.y = 0;
+    if (finalScale.z < 0)
+        finalScale.z = 0;
+
+    return finalScale;
+}
+
 void RigidBody::UpdateGravity()
 {
     if (!impl->body || !impl->world)
@@ -1027,20 +1114,48 @@ void RigidBody::CreateConvexHullSetShape()
     if (!impl->convexHullSet)
         return;
     
+    // The scale is applied to the hull instances and their positions, so the compound shape itself is never scaled.
+    impl->hullScale = CollisionShapeScale();
+    
     // Avoid creating a compound shape if only 1 hull in the set
     if (impl->convexHullSet->hulls_.Size() > 1)
     {
         btCompoundShape* compound = new btCompoundShape();
         impl->shape = compound;
         for (uint i = 0; i < impl->convexHullSet->hulls_.Size(); ++i)
-            compound->addChildShape(btTransform(btQuaternion(0,0,0,1), impl->convexHullSet->hulls_[i].position_), impl->convexHullSet->hulls_[i].hull_.get());
+        {
+            const ConvexHull &hull = impl->convexHullSet->hulls_[i];
+            btCollisionShape* instance = CreateConvexHullInstance(hull.hull_.get(), impl->hullScale);
+            impl->hullInstances.Push(instance);
+            compound->addChildShape(btTransform(btQuaternion(0,0,0,1), hull.position_.Mul(impl->hullScale)), instance);
+        }
     }
     else if (impl->convexHullSet->hulls_.Size() == 1)
+        impl->shape = CreateConvexHullInstance(impl->convexHullSet->hulls_[0].hull_.get(), impl->hullScale);
+}
+
+void RigidBody::RescaleConvexHullSetShape()
+{
+    btCollisionShape* oldShape = impl->shape;
+    Vector<btCollisionShape*> oldInstances;
+    oldInstances.Swap(impl->hullInstances);
+    
+    impl->shape = 0;
+    CreateConvexHullSetShape();
+    
+    // Unlike ReaddBody(), do not stop the body, only make Bullet forget the contacts of the old shape.
+    if (impl->body)
     {
-        btConvexHullShape* original = impl->convexHullSet->hulls_[0].hull_.get();
-        btConvexHullShape* convex = new btConvexHullShape(reinterpret_cast<const btScalar*>(original->getUnscaledPoints()), original->getNumVertices());
-        impl->shape = convex;
+        if (impl->world)
+            impl->world->BulletWorld()->removeRigidBody(impl->body);
+        impl->body->setCollisionShape(impl->shape);
+        if (impl->world)
+            impl->world->BulletWorld()->addRigidBody(impl->body, (short)collisionLayer.Get(), (short)collisionMask.Get());
     }
+    
+    delete oldShape;
+    foreach(btCollisionShape* instance, oldInstances)
+        delete instance;
 }
 
 void RigidBody::UpdatePosRotFromPlaceable()
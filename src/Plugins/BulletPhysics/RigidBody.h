@@ -306,8 +306,12 @@ private:
     void CreateHeightFieldFromTerrain();
     
     /// Create a convex hull set collisionshape
+    /** The shared hulls of the set are never scaled, each body gets its own scaled instances of them. */
     void CreateConvexHullSetShape();
     
+    /// Recreate the convex hull set collisionshape after its scale has changed, keeping the body's motion.
+    void RescaleConvexHullSetShape();
+    
     /// Create the body. No-op if the scene is not associated with a physics world.
     void CreateBody();
     
@@ -321,6 +325,9 @@ private:
     /// Update scale from placeable & own size setting
     void UpdateScale();
     
+    /// Returns the scale of the collisionshape from placeable & own size setting
+    float3 CollisionShapeScale() const;
+    
     /// Update position & rotation from placeable
     void UpdatePosRotFromPlaceable();
     
@@ -330,6 +337,21 @@ private:
     /// Request mesh resource (for trimesh & convexhull shapes)
     void RequestMesh();
 
+    /// Attributes written back from the simulation, RigidBodyWriteBack::changed
+    enum WriteBackFlags
+    {
+        WriteBackTransform = 1,
+        WriteBackLinearVelocity = 2,
+        WriteBackAngularVelocity = 4,
+        WriteBackParented = 8 ///< The placeable is parented, its transform is written when signalling.
+    };
+
+    /// Write the simulated state to the attributes without signalling the changes. Called from PhysicsWorld
+    void WriteBackValues(RigidBodyWriteBack &writeBack);
+
+    /// Signal the attribute changes written by WriteBackValues. Called from PhysicsWorld
+    void NotifyWriteBack(const RigidBodyWriteBack &writeBack);
+
     /// Emit a physics collision. Called from PhysicsWorld
     void EmitPhysicsCollision(Entity* otherEntity, const float3& position, const float3& normal, float distance, float impulse, bool newCollision);
 
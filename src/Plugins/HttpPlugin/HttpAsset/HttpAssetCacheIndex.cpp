@@ -0,0 +1,181 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "StableHeaders.h"
+#include "HttpAssetCacheIndex.h"
+#include "HttpRequest.h"
+
+#include "AssetAPI.h"
+#include "JSON/JSON.h"
+#include "LoggingFunctions.h"
+
+#include <Urho3D/Core/StringUtils.h>
+
+namespace Tundra
+{
+
+/// Version of the persisted index format. Index files of other versions are ignored.
+static const int cCacheIndexVersion = 1;
+
+HttpAssetCacheIndex::HttpAssetCacheIndex() :
+    dirty_(false)
+{
+}
+
+bool HttpAssetCacheIndex::Load(const String &filepath)
+{
+    entries_.Clear();
+    dirty_ = false;
+
+    Vector<u8> data;
+    if (!LoadFileToVector(filepath, data) || data.Empty())
+        return false;
+
+    JSONValue root;
+    if (!root.FromString(String(reinterpret_cast<const char*>(&data[0]), data.Size())) || !root.IsObject())
+    {
+        LogWarning("HttpAssetCacheIndex::Load: Failed to parse " + filepath);
+        return false;
+    }
+    if ((int)root["version"].GetNumber() != cCacheIndexVersion)
+        return false;
+
+    const JSONObject &entries = root["entries"].GetObject();
+    for(JSONObject::ConstIterator iter = entries.Begin(); iter != entries.End(); ++iter)
+    {
+        Entry &entry = entries_[iter->first_];
+        entry.etag = iter->second_["etag"].GetString();
+        entry.expires = static_cast<time_t>(iter->second_["expires"].GetNumber());
+        entry.hash = iter->second_["hash"].GetString();
+    }
+    return true;
+}
+
+bool HttpAssetCacheIndex::Save(const String &filepath)
+{
+    JSONValue entries;
+    entries.SetEmptyObject();
+    for(HashMap<String, Entry>::ConstIterator iter = entries_.Begin(); iter != entries_.End(); ++iter)
+    {
+        JSONValue &entry = entries[iter->first_];
+        if (!iter->second_.etag.Empty())
+            entry["etag"] = iter->second_.etag;
+        if (iter->second_.expires > 0)
+            entry["expires"] = static_cast<double>(iter->second_.expires);
+        if (!iter->second_.hash.Empty())
+            entry["hash"] = iter->second_.hash;
+    }
+
+    JSONValue root;
+    root["version"] = cCacheIndexVersion;
+    root["entries"] = entries;
+
+    String json = root.ToString(0);
+    if (!SaveAssetFromMemoryToFile(reinterpret_cast<const u8*>(json.CString()), json.Length(), filepath))
+    {
+        LogWarning("HttpAssetCacheIndex::Save: Failed to write " + filepath);
+        return false;
+    }
+    dirty_ = false;
+    return true;
+}
+
+const HttpAssetCacheIndex::Entry *HttpAssetCacheIndex::Find(const String &assetRef) const
+{
+    HashMap<String, Entry>::ConstIterator iter = entries_.Find(assetRef);
+    return (iter != entries_.End() ? &iter->second_ : 0);
+}
+
+bool HttpAssetCacheIndex::IsFresh(const String &assetRef, time_t now) const
+{
+    const Entry *entry = Find(assetRef);
+    return (entry && entry->expires > now);
+}
+
+void HttpAssetCacheIndex::Update(const String &assetRef, HttpRequest *request, const Vector<u8> &body)
+{
+    const time_t now = time(0);
+
+    Entry &entry = entries_[assetRef];
+    // A 304 response may omit the ETag, in which case the earlier one is still valid.
+    if (request->HasResponseHeader(Http::Header::ETag))
+        entry.etag = request->ResponseHeader(Http::Header::ETag).Trimmed();
+    entry.expires = ExpiryTime(request, now);
+    if (request->StatusCode() != 304 || entry.hash.Empty())
+        entry.hash = (!body.Empty() ? ContentHash(&body[0], body.Size()) : String::EMPTY);
+    dirty_ = true;
+}
+
+void HttpAssetCacheIndex::Remove(const String &assetRef)
+{
+    if (entries_.Erase(assetRef))
+        dirty_ = true;
+}
+
+void HttpAssetCacheIndex::Clear()
+{
+    if (!entries_.Empty())
+        dirty_ = true;
+    entries_.Clear();
+}
+
+String HttpAssetCacheIndex::ContentHash(const u8 *data, uint numBytes)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for(uint i = 0; i < numBytes; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return Urho3D::ToString("%08x%08x", (uint)(hash >> 32), (uint)(hash & 0xffffffff));
+}
+
+time_t HttpAssetCacheIndex::ExpiryTime(HttpRequest *request, time_t now)
+{
+    const String names[] = { Http::Header::CacheControl, Http::Header::Age, Http::Header::Expires, Http::Header::Date };
+    HttpHeaderMap headers;
+    for(uint i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if (request->HasResponseHeader(names[i]))
+            headers[names[i]] = request->ResponseHeader(names[i]);
+    return ExpiryTime(headers, now);
+}
+
+time_t HttpAssetCacheIndex::ExpiryTime(const HttpHeaderMap &responseHeaders, time_t now)
+{
+    HttpHeaderMap::const_iterator cacheControl = responseHeaders.find(Http::Header::CacheControl);
+    if (cacheControl != responseHeaders.end())
+    {
+        StringVector directives = cacheControl->second.Split(',');
+        foreach(const String &d, directives)
+        {
+            String directive = d.Trimmed().ToLower();
+            if (directive == "no-cache" || directive == "no-store")
+                return 0;
+            if (directive.StartsWith("max-age="))
+            {
+                int maxAge = Urho3D::ToInt(directive.Substring(8).Replaced("\"", ""));
+                // Age is the time the response has already spent in intermediate caches.
+                HttpHeaderMap::const_iterator age = responseHeaders.find(Http::Header::Age);
+                if (age != responseHeaders.end())
+                    maxAge -= Urho3D::ToInt(age->second);
+                return (maxAge > 0 ? now + maxAge : 0);
+            }
+        }
+    }
+    HttpHeaderMap::const_iterator expiresHeader = responseHeaders.find(Http::Header::Expires);
+    if (expiresHeader != responseHeaders.end())
+    {
+        // Invalid dates, commonly "0" or "-1", mean already expired.
+        String expiresDate = expiresHeader->second.Trimmed();
+        time_t expires = (expiresDate.Length() > 2 ? Http::HttpDateToUtcEpoch(expiresDate) : 0);
+        if (expires <= 0)
+            return 0;
+        // Use the server clock for the lifetime to be immune to client clock skew.
+        HttpHeaderMap::const_iterator dateHeader = responseHeaders.find(Http::Header::Date);
+        time_t date = (dateHeader != responseHeaders.end() ? Http::HttpDateToUtcEpoch(dateHeader->second) : 0);
+        time_t lifetime = expires - (date > 0 ? date : now);
+        return (lifetime > 0 ? now + lifetime : 0);
+    }
+    return 0;
+}
+
+}
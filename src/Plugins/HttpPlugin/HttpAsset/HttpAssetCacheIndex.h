@@ -0,0 +1,79 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#include "HttpPluginApi.h"
+#include "HttpPluginFwd.h"
+
+#include <Urho3D/Container/HashMap.h>
+
+#include <time.h>
+
+namespace Tundra
+{
+
+/// Persistent HTTP cache metadata for the assets in the asset cache.
+/** Stores the ETag, the expiry time and the content hash of each cached HTTP asset. Used by HttpAssetProvider to load
+    assets that are still fresh according to Cache-Control max-age/Expires, or that match a storage manifest,
+    directly from disk without a request, and to revalidate the rest with If-None-Match. */
+class TUNDRA_HTTP_API HttpAssetCacheIndex
+{
+public:
+    /// Cache metadata of a single asset ref.
+    struct Entry
+    {
+        Entry() : expires(0) {}
+
+        String etag; ///< ETag of the cached response, empty if the server did not send one.
+        time_t expires; ///< UTC epoch seconds until the cached file can be used without revalidation, 0 if it always needs to be revalidated.
+        String hash; ///< ContentHash of the cached file.
+    };
+
+    HttpAssetCacheIndex();
+
+    /// Loads the index from @c filepath, replacing the current entries.
+    bool Load(const String &filepath);
+
+    /// Saves the index to @c filepath.
+    bool Save(const String &filepath);
+
+    /// Returns if the index has changed since it was loaded or saved.
+    bool IsDirty() const { return dirty_; }
+
+    /// Returns the entry for @c assetRef, or null if the asset has no metadata.
+    const Entry *Find(const String &assetRef) const;
+
+    /// Returns if the cached copy of @c assetRef can be used without revalidation at UTC epoch @c now.
+    bool IsFresh(const String &assetRef, time_t now) const;
+
+    /// Updates the entry of @c assetRef from a completed '200 OK' or '304 Not Modified' response.
+    /** @param body Response body, or the cached file contents for a 304 response. Used to compute the content hash. */
+    void Update(const String &assetRef, HttpRequest *request, const Vector<u8> &body);
+
+    /// Removes the entry of @c assetRef.
+    void Remove(const String &assetRef);
+
+    /// Removes all entries.
+    void Clear();
+
+    /// Returns the number of entries.
+    uint Size() const { return entries_.Size(); }
+
+    /// Returns the content hash of @c data as a hex string. This is the hash used in storage manifests.
+    /** 64-bit FNV-1a, which is fast enough to be computed for every downloaded asset on the main thread. */
+    static String ContentHash(const u8 *data, uint numBytes);
+
+    /// Returns the UTC epoch seconds until the response of @c request is fresh, computed at UTC epoch @c now.
+    /** Cache-Control no-cache, no-store and max-age take precedence over Expires. Returns 0 if the response is stale
+        immediately or has no freshness information. */
+    static time_t ExpiryTime(HttpRequest *request, time_t now);
+    /// @overload
+    /** @param responseHeaders Response headers: Cache-Control, Age, Expires and Date are used. */
+    static time_t ExpiryTime(const HttpHeaderMap &responseHeaders, time_t now);
+
+private:
+    HashMap<String, Entry> entries_;
+    bool dirty_;
+};
+
+}
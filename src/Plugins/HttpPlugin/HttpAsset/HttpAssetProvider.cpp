@@ -7,28 +7,153 @@
 #include "HttpAssetProvider.h"
 #include "HttpAssetStorage.h"
 #include "HttpAssetTransfer.h"
+#include "HttpAssetUploadTransfer.h"
 
 #include "AssetAPI.h"
 #include "AssetCache.h"
 #include "IAssetTransfer.h" /// @todo HttpAssetTransfer
 
 #include "Framework.h"
+#include "LoggingFunctions.h"
+
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/IO/File.h>
 
 namespace Tundra
 {
 
+/// File name of the cache index in the asset cache directory.
+static const char * const cCacheIndexFileName = "httpcache.json";
+/// Minimum interval in milliseconds between saving a changed cache index.
+static const unsigned cCacheIndexSaveInterval = 5000;
+
 HttpAssetProvider::HttpAssetProvider(Framework *framework, const HttpClientPtr &client) :
     IAssetProvider(framework->GetContext()),
     framework_(framework),
-    client_(client)
+    client_(client),
+    cacheIndexLoaded_(false),
+    numCacheHits_(0)
 {
 }
 
 HttpAssetProvider::~HttpAssetProvider()
 {
+    SaveCacheIndex();
+    pendingCacheHits_.Clear();
     httpStorages_.Clear();
 }
 
+HttpAssetCacheIndex *HttpAssetProvider::CacheIndex()
+{
+    if (!cacheIndexLoaded_)
+    {
+        AssetCache *cache = framework_->Asset()->Cache();
+        if (!cache)
+            return 0;
+        cacheIndexFile_ = cache->CacheDirectory() + cCacheIndexFileName;
+        cacheIndex_.Load(cacheIndexFile_);
+        cacheIndexLoaded_ = true;
+        cacheIndexSaveTimer_.Reset();
+    }
+    return &cacheIndex_;
+}
+
+bool HttpAssetProvider::IsCacheUsable(const String &assetRef)
+{
+    HttpAssetCacheIndex *index = CacheIndex();
+    const HttpAssetCacheIndex::Entry *entry = (index ? index->Find(assetRef) : 0);
+    if (!entry)
+        return false;
+
+    // The manifest is authoritative: a listed asset is up to date exactly when its hash matches, regardless of max-age.
+    HttpAssetStorage *storage = dynamic_cast<HttpAssetStorage*>(StorageForAssetRef(assetRef).Get());
+    String manifestHash = (storage ? storage->ManifestHash(assetRef) : String::EMPTY);
+    if (!manifestHash.Empty())
+        return manifestHash.Compare(entry->hash, false) == 0;
+
+    return index->IsFresh(assetRef, time(0));
+}
+
+void HttpAssetProvider::Update(float /*frametime*/)
+{
+    URHO3D_PROFILE(HttpAssetProvider_Update);
+
+    CompletePendingCacheHits();
+    StartPendingUploads();
+
+    if (cacheIndex_.IsDirty() && cacheIndexSaveTimer_.GetMSec(false) >= cCacheIndexSaveInterval)
+        SaveCacheIndex();
+}
+
+void HttpAssetProvider::StartPendingUploads()
+{
+    if (pendingUploads_.Empty())
+        return;
+
+    Vector<AssetUploadTransferPtr> uploads;
+    uploads.Swap(pendingUploads_);
+    foreach(const AssetUploadTransferPtr &transfer, uploads)
+        static_cast<HttpAssetUploadTransfer*>(transfer.Get())->Start();
+}
+
+void HttpAssetProvider::CompletePendingCacheHits()
+{
+    if (pendingCacheHits_.Empty())
+        return;
+
+    // Completing may start new transfers that end up in pendingCacheHits_, handle those on the next frame.
+    Vector<AssetTransferPtr> cacheHits;
+    cacheHits.Swap(pendingCacheHits_);
+
+    foreach(const AssetTransferPtr &transfer, cacheHits)
+    {
+        HttpAssetTransfer *httpTransfer = static_cast<HttpAssetTransfer*>(transfer.Get());
+        if (httpTransfer->LoadFromCache())
+            ++numCacheHits_;
+        else
+        {
+            // Cache file was removed behind our back, fall back to the network.
+            cacheIndex_.Remove(transfer->source.ref);
+            client_->Schedule(httpTransfer->Request());
+        }
+    }
+}
+
+void HttpAssetProvider::SaveCacheIndex()
+{
+    if (cacheIndexLoaded_ && cacheIndex_.IsDirty())
+        cacheIndex_.Save(cacheIndexFile_);
+    cacheIndexSaveTimer_.Reset();
+}
+
+void HttpAssetProvider::RequestManifest(HttpAssetStorage *storage)
+{
+    HttpRequestPtr request = client_->Create(Http::Method::Get, storage->ManifestUrl());
+    if (!request)
+        return;
+    request->Finished.Connect(this, &HttpAssetProvider::OnManifestFinished);
+    client_->Schedule(request);
+}
+
+void HttpAssetProvider::OnManifestFinished(HttpRequestPtr &request, int status, const String &error)
+{
+    if (status != 200 || !error.Empty())
+    {
+        LogWarning(Urho3D::ToString("HttpAssetProvider: Failed to fetch asset manifest %s: %s", request->Url().CString(),
+            (!error.Empty() ? error : Urho3D::ToString("%d %s", status, request->Status().CString())).CString()));
+        return;
+    }
+
+    const Vector<u8> &body = request->ResponseBody();
+    String data = (!body.Empty() ? String(reinterpret_cast<const char*>(&body[0]), body.Size()) : String::EMPTY);
+    foreach(const AssetStoragePtr &storage, httpStorages_)
+    {
+        HttpAssetStorage *httpStorage = static_cast<HttpAssetStorage*>(storage.Get());
+        if (httpStorage->ManifestUrl() == request->Url())
+            httpStorage->LoadManifest(data);
+    }
+}
+
 AssetStoragePtr HttpAssetProvider::StorageForBaseURL(const String &url) const
 {
     foreach(const AssetStoragePtr &httpStorage, httpStorages_)
@@ -93,7 +218,13 @@ AssetTransferPtr HttpAssetProvider::CreateTransfer(String assetRef, String asset
 void HttpAssetProvider::ExecuteTransfer(AssetTransferPtr transfer)
 {
     HttpAssetTransfer *httpTransfer = dynamic_cast<HttpAssetTransfer*>(transfer.Get());
-    if (httpTransfer)
+    if (!httpTransfer)
+        return;
+
+    // Fresh assets are loaded from disk on the next Update, the rest are (conditionally) requested.
+    if (IsCacheUsable(httpTransfer->source.ref))
+        pendingCacheHits_.Push(transfer);
+    else
         client_->Schedule(httpTransfer->Request());
 }
 
@@ -152,12 +283,50 @@ AssetStoragePtr HttpAssetProvider::StorageForAssetRef(const String &assetRef) co
 AssetUploadTransferPtr HttpAssetProvider::UploadAssetFromFileInMemory(const u8 *data, uint numBytes,
     AssetStoragePtr destination, const String &assetName)
 {
-    UNREFERENCED_PARAM(data);
-    UNREFERENCED_PARAM(numBytes);
-    UNREFERENCED_PARAM(destination);
-    UNREFERENCED_PARAM(assetName);
+    if (!data || numBytes == 0 || !destination)
+        return AssetUploadTransferPtr();
+
+    SharedPtr<HttpAssetUploadTransfer> transfer(new HttpAssetUploadTransfer(this, client_));
+    transfer->destinationStorage = destination;
+    transfer->destinationName = assetName;
+    transfer->assetData.Insert(transfer->assetData.End(), data, data + numBytes);
+    transfer->totalBytes = numBytes;
+    if (transfer->AssetRef().Empty())
+        return AssetUploadTransferPtr();
+    pendingUploads_.Push(transfer);
+    return transfer;
+}
+
+AssetUploadTransferPtr HttpAssetProvider::UploadAssetFromFile(const String &filename, AssetStoragePtr destination, const String &assetName)
+{
+    if (!destination)
+        return AssetUploadTransferPtr();
 
-    return AssetUploadTransferPtr(); /// @todo
+    uint size = 0;
+    {
+        Urho3D::File file(GetContext(), filename, Urho3D::FILE_READ);
+        if (!file.IsOpen())
+        {
+            LogError("HttpAssetProvider::UploadAssetFromFile: Failed to open " + filename);
+            return AssetUploadTransferPtr();
+        }
+        size = file.GetSize();
+    }
+    if (size == 0)
+    {
+        LogError("HttpAssetProvider::UploadAssetFromFile: Refusing to upload empty file " + filename);
+        return AssetUploadTransferPtr();
+    }
+
+    SharedPtr<HttpAssetUploadTransfer> transfer(new HttpAssetUploadTransfer(this, client_));
+    transfer->destinationStorage = destination;
+    transfer->destinationName = assetName;
+    transfer->sourceFilename = filename;
+    transfer->totalBytes = size;
+    if (transfer->AssetRef().Empty())
+        return AssetUploadTransferPtr();
+    pendingUploads_.Push(transfer);
+    return transfer;
 }
 
 AssetStoragePtr HttpAssetProvider::TryCreateStorage(HashMap<String, String> &storageParams, bool /*fromNetwork*/)
@@ -184,6 +353,22 @@ AssetStoragePtr HttpAssetProvider::TryCreateStorage(HashMap<String, String> &sto
     }
 
     storage->SetReplicated(Urho3D::ToBool(storageParams["replicated"]));
+    if (storageParams.Contains("readonly"))
+        static_cast<HttpAssetStorage*>(storage.Get())->SetWritable(!Urho3D::ToBool(storageParams["readonly"]));
+
+    // Manifest URL can be absolute or relative to the base URL.
+    String manifest = storageParams["manifest"].Trimmed();
+    if (!manifest.Empty())
+    {
+        if (!IsValidRef(manifest, ""))
+            manifest = baseUrl + manifest;
+        HttpAssetStorage *httpStorage = static_cast<HttpAssetStorage*>(storage.Get());
+        if (httpStorage->ManifestUrl() != manifest)
+        {
+            httpStorage->SetManifestUrl(manifest);
+            RequestManifest(httpStorage);
+        }
+    }
     return storage;
 }
 
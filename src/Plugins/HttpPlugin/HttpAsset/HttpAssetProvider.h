@@ -4,9 +4,12 @@
 
 #include "HttpPluginApi.h"
 #include "HttpPluginFwd.h"
+#include "HttpAssetCacheIndex.h"
 
 #include "IAssetProvider.h"
 
+#include <Urho3D/Core/Timer.h>
+
 namespace Tundra
 {
 
@@ -21,6 +24,21 @@ public:
 
     Framework *Fw() { return framework_; }
 
+    /// Returns the HTTP cache metadata of the asset cache, loading it on first use.
+    /** @return Null if the asset cache is disabled. */
+    HttpAssetCacheIndex *CacheIndex();
+
+    /// Returns if @c assetRef can be loaded from the asset cache without a request.
+    /** True if the cached copy matches the content hash in the storage manifest, or if the storage has no manifest entry
+        for the asset and the cached response is still fresh according to its Cache-Control max-age or Expires header. */
+    bool IsCacheUsable(const String &assetRef);
+
+    /// Returns the number of transfers that were completed from the asset cache without a request.
+    uint NumCacheHits() const { return numCacheHits_; }
+
+    /// IAssetProvider override.
+    void Update(float frametime) override;
+
     /// IAssetProvider override.
     String Name() const override;
     /// IAssetProvider override.
@@ -44,6 +62,10 @@ public:
     /// IAssetProvider override.
     AssetUploadTransferPtr UploadAssetFromFileInMemory(const u8 *data, uint numBytes,
         AssetStoragePtr destination, const String &assetName) override;
+    /// IAssetProvider override.
+    bool SupportsStreamingUploads() const override { return true; }
+    /// IAssetProvider override.
+    AssetUploadTransferPtr UploadAssetFromFile(const String &filename, AssetStoragePtr destination, const String &assetName) override;
 
 private:
     /// IAssetProvider override.
@@ -55,10 +77,35 @@ private:
     /// Returns a uniqeu HTTP storage name.
     String UniqueName(String prefix = "Web") const;
 
+    /// Fetches the content manifest of @c storage.
+    void RequestManifest(HttpAssetStorage *storage);
+    /// Handles a finished manifest request.
+    void OnManifestFinished(HttpRequestPtr &request, int status, const String &error);
+
+    /// Completes the pending transfers whose assets are loaded from the asset cache.
+    void CompletePendingCacheHits();
+
+    /// Starts the uploads created since the last Update.
+    void StartPendingUploads();
+
+    /// Saves the cache index if it has changed.
+    void SaveCacheIndex();
+
     Framework *framework_;
     HttpClientPtr client_;
 
     Vector<AssetStoragePtr> httpStorages_;
+
+    HttpAssetCacheIndex cacheIndex_;
+    String cacheIndexFile_;
+    bool cacheIndexLoaded_;
+    /// Time since the cache index was last saved.
+    Urho3D::Timer cacheIndexSaveTimer_;
+    /// Transfers that are completed from the asset cache on the next Update.
+    Vector<AssetTransferPtr> pendingCacheHits_;
+    /// Uploads that are started on the next Update, so that the caller can connect to their signals first.
+    Vector<AssetUploadTransferPtr> pendingUploads_;
+    uint numCacheHits_;
 };
 
 }
@@ -4,6 +4,8 @@
 #include "HttpAssetStorage.h"
 
 #include "AssetAPI.h"
+#include "JSON/JSON.h"
+#include "LoggingFunctions.h"
 
 #include <Urho3D/Core/StringUtils.h>
 
@@ -15,7 +17,8 @@ HttpAssetStorage::HttpAssetStorage(Urho3D::Context* context, const String &name,
     // HttpAssetStorage
     name_(name),
     baseUrl_(baseUrl),
-    localDir_(localDir.Empty() ? localDir : GuaranteeTrailingSlash(localDir))
+    localDir_(localDir.Empty() ? localDir : GuaranteeTrailingSlash(localDir)),
+    hasManifest_(false)
 {
     // IAssetStorage
     writable = false;
@@ -58,8 +61,46 @@ String HttpAssetStorage::SerializeToString(bool networkTransfer) const
         ";trusted=" + TrustStateToString(trustState);
     if (!networkTransfer && !localDir_.Empty())
         serialized += ";localdir=" + localDir_;
+    if (!manifestUrl_.Empty())
+        serialized += ";manifest=" + manifestUrl_;
     serialized += ";";
     return serialized;
 }
 
+void HttpAssetStorage::SetManifestUrl(const String &url)
+{
+    manifestUrl_ = url;
+    manifestHashes_.Clear();
+    hasManifest_ = false;
+}
+
+bool HttpAssetStorage::LoadManifest(const String &data)
+{
+    JSONValue root;
+    if (!root.FromString(data) || !root["assets"].IsObject())
+    {
+        LogError("HttpAssetStorage::LoadManifest: Failed to parse manifest " + manifestUrl_);
+        return false;
+    }
+
+    manifestHashes_.Clear();
+    const JSONObject &assets = root["assets"].GetObject();
+    for(JSONObject::ConstIterator iter = assets.Begin(); iter != assets.End(); ++iter)
+    {
+        const String &hash = iter->second_["hash"].GetString();
+        if (!hash.Empty())
+            manifestHashes_[iter->first_] = hash;
+    }
+    hasManifest_ = true;
+    return true;
+}
+
+String HttpAssetStorage::ManifestHash(const String &assetRef) const
+{
+    if (!hasManifest_ || !assetRef.StartsWith(baseUrl_, false))
+        return "";
+    HashMap<String, String>::ConstIterator iter = manifestHashes_.Find(assetRef.Substring(baseUrl_.Length()));
+    return (iter != manifestHashes_.End() ? iter->second_ : String::EMPTY);
+}
+
 }
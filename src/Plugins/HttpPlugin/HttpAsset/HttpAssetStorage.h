@@ -27,10 +27,33 @@ public:
     /// IAssetStorage override.
     String SerializeToString(bool networkTransfer = false) const override;
 
+    /// Sets if assets can be uploaded to this storage with HTTP PUT.
+    void SetWritable(bool isWritable) { writable = isWritable; }
+
+    /// Returns the URL of the content manifest, empty if the storage has no manifest.
+    String ManifestUrl() const { return manifestUrl_; }
+
+    /// Sets the URL of the content manifest. Clears the currently loaded manifest.
+    void SetManifestUrl(const String &url);
+
+    /// Returns if the content manifest has been loaded.
+    bool HasManifest() const { return hasManifest_; }
+
+    /// Sets the content manifest from the JSON @c data fetched from ManifestUrl.
+    /** The manifest is an object { "assets": { "<local name>": { "hash": "<HttpAssetCacheIndex::ContentHash>" }, ... } },
+        where the local names are relative to BaseURL. */
+    bool LoadManifest(const String &data);
+
+    /// Returns the manifest content hash of the asset @c assetRef, or an empty string if the manifest does not list it.
+    String ManifestHash(const String &assetRef) const;
+
 private:
     String name_;
     String baseUrl_;
     String localDir_;
+    String manifestUrl_;
+    HashMap<String, String> manifestHashes_; ///< Content hash by local name
+    bool hasManifest_;
 };
 
 }
@@ -11,6 +11,8 @@
 #include "Framework.h"
 #include "LoggingFunctions.h"
 
+#include <Urho3D/IO/FileSystem.h>
+
 namespace Tundra
 {
 
@@ -31,6 +33,13 @@ HttpAssetTransfer::HttpAssetTransfer(HttpAssetProvider *provider, HttpRequestPtr
     {
         String cacheFile = provider_->Fw()->Asset()->Cache()->DiskSourceByRef(source.ref);
         request->SetCacheFile(cacheFile, true);
+
+        // Prefer the ETag validator when we have one. Only send it with an existing cache file, as 304 is served from that file.
+        HttpAssetCacheIndex *index = provider_->CacheIndex();
+        const HttpAssetCacheIndex::Entry *entry = (index ? index->Find(source.ref) : 0);
+        if (entry && !entry->etag.Empty() && provider_->Fw()->GetSubsystem<Urho3D::FileSystem>()->FileExists(cacheFile))
+            request->SetHeader(Http::Header::IfNoneMatch, entry->etag);
+
         /* Indicated so AssetAPI that we will take care of writing the cache, but it can find
            the source file from this path. */
         SetCachingBehavior(false, cacheFile);
@@ -44,6 +53,19 @@ HttpAssetTransfer::~HttpAssetTransfer()
 {
 }
 
+bool HttpAssetTransfer::LoadFromCache()
+{
+    if (diskSource.Empty() || !LoadFileToVector(diskSource, rawAssetData))
+        return false;
+
+    // The request was never scheduled.
+    request_.Reset();
+
+    diskSourceType = IAsset::Cached;
+    provider_->Fw()->Asset()->AssetTransferCompleted(this);
+    return true;
+}
+
 void HttpAssetTransfer::OnFinished(HttpRequestPtr &request, int status, const String &error)
 {
     // Clear out reference.
@@ -67,6 +89,11 @@ void HttpAssetTransfer::OnFinished(HttpRequestPtr &request, int status, const St
 
         request->CopyResponseBodyTo(rawAssetData);
 
+        // Remember the validators and freshness of the response for the next load.
+        HttpAssetCacheIndex *index = provider_->CacheIndex();
+        if (index && !diskSource.Empty())
+            index->Update(source.ref, request.Get(), rawAssetData);
+
         provider_->Fw()->Asset()->AssetTransferCompleted(this);
     }
     else
@@ -19,6 +19,10 @@ public:
 
     HttpRequestPtr Request() const { return request_; }
 
+    /// Completes the transfer from the asset cache file without a request.
+    /** @return False if the cache file could not be read, in which case the transfer is left untouched. */
+    bool LoadFromCache();
+
 private:
     void OnFinished(HttpRequestPtr &request, int status, const String &error);
 
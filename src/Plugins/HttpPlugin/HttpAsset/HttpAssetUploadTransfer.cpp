@@ -0,0 +1,150 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "StableHeaders.h"
+#include "HttpAssetUploadTransfer.h"
+#include "HttpAssetProvider.h"
+#include "HttpClient.h"
+#include "HttpRequest.h"
+
+#include "AssetAPI.h"
+
+#include "Framework.h"
+#include "LoggingFunctions.h"
+
+#include <Urho3D/Core/StringUtils.h>
+
+namespace Tundra
+{
+
+/// Number of '308 Resume Incomplete' replies in a row that may acknowledge no new data before the upload fails.
+static const uint cMaxStalledReplies = 3;
+
+HttpAssetUploadTransfer::HttpAssetUploadTransfer(HttpAssetProvider *provider, const HttpClientPtr &client) :
+    IAssetUploadTransfer(provider->GetContext()),
+    provider_(provider),
+    client_(client),
+    numStalledReplies_(0)
+{
+}
+
+HttpAssetUploadTransfer::~HttpAssetUploadTransfer()
+{
+}
+
+bool HttpAssetUploadTransfer::Start()
+{
+    url_ = AssetRef();
+    if (url_.Empty() || totalBytes == 0)
+    {
+        Fail("No destination or data");
+        return false;
+    }
+    return SendNextChunk();
+}
+
+bool HttpAssetUploadTransfer::SendNextChunk()
+{
+    Vector<u8> chunk;
+    if (!ReadChunk(bytesUploaded, chunkSize, chunk))
+    {
+        Fail("Failed to read upload data");
+        return false;
+    }
+
+    request_ = client_->Create(Http::Method::Put, url_);
+    if (!request_)
+    {
+        Fail("Failed to create request");
+        return false;
+    }
+    request_->SetBody(chunk);
+    if (totalBytes > chunkSize)
+        request_->SetHeader(Http::Header::ContentRange, Urho3D::ToString("bytes %u-%u/%u", bytesUploaded, bytesUploaded + chunk.Size() - 1, totalBytes));
+    request_->Finished.Connect(this, &HttpAssetUploadTransfer::OnChunkFinished);
+    client_->Schedule(request_);
+    return true;
+}
+
+void HttpAssetUploadTransfer::SendStatusQuery()
+{
+    request_ = client_->Create(Http::Method::Put, url_);
+    if (!request_)
+    {
+        Fail("Failed to create request");
+        return;
+    }
+    request_->SetBody(Vector<u8>());
+    request_->SetHeader(Http::Header::ContentRange, Urho3D::ToString("bytes */%u", totalBytes));
+    request_->Finished.Connect(this, &HttpAssetUploadTransfer::OnChunkFinished);
+    client_->Schedule(request_);
+}
+
+void HttpAssetUploadTransfer::OnChunkFinished(HttpRequestPtr &request, int status, const String &error)
+{
+    request_.Reset();
+
+    if (error.Empty() && (status == 200 || status == 201 || status == 204))
+        Complete(request);
+    else if (error.Empty() && status == 308)
+    {
+        // The server tells how much it has, which may be less than what we sent.
+        const uint previousBytes = bytesUploaded;
+        SetBytesUploaded(AcknowledgedBytes(request));
+        // A server that keeps storing nothing would otherwise have the same chunk resent forever.
+        numStalledReplies_ = (bytesUploaded > previousBytes ? 0 : numStalledReplies_ + 1);
+        if (bytesUploaded >= totalBytes)
+            Fail("Server acknowledged all data but did not complete the upload");
+        else if (numStalledReplies_ > cMaxStalledReplies)
+            Fail(Urho3D::ToString("Server stored no data in %u replies, stuck at %u of %u bytes", numStalledReplies_, bytesUploaded, totalBytes));
+        else
+            SendNextChunk();
+    }
+    else if (!error.Empty() || status >= 500 || status == 408)
+        Retry(!error.Empty() ? error : Urho3D::ToString("%d %s", status, request->Status().CString()));
+    else
+        Fail(Urho3D::ToString("%d %s", status, request->Status().CString()));
+}
+
+void HttpAssetUploadTransfer::Retry(const String &reason)
+{
+    if (++numRetries > maxRetries)
+    {
+        Fail(reason);
+        return;
+    }
+    LogWarning("HttpAssetUploadTransfer: Upload to " + url_ + " interrupted (" + reason + "), resuming");
+    // Single chunk uploads are simply resent. Chunked ones ask the server where to continue from.
+    if (totalBytes > chunkSize)
+        SendStatusQuery();
+    else
+        SendNextChunk();
+}
+
+uint HttpAssetUploadTransfer::AcknowledgedBytes(HttpRequestPtr &request) const
+{
+    // 'Range: bytes=0-last', no Range header means nothing has been stored.
+    String range = request->ResponseHeader(Http::Header::Range).Trimmed();
+    uint dash = range.FindLast('-');
+    if (!range.StartsWith("bytes=0-", false) || dash == String::NPOS)
+        return 0;
+    return Urho3D::ToUInt(range.Substring(dash + 1)) + 1;
+}
+
+void HttpAssetUploadTransfer::Complete(HttpRequestPtr &request)
+{
+    SetBytesUploaded(totalBytes);
+    request->CopyResponseBodyTo(replyData);
+    if (request->HasResponseHeader(Http::Header::Location))
+        replyHeaders[Http::Header::Location] = request->ResponseHeader(Http::Header::Location);
+    if (request->HasResponseHeader(Http::Header::ETag))
+        replyHeaders[Http::Header::ETag] = request->ResponseHeader(Http::Header::ETag);
+    provider_->Fw()->Asset()->AssetUploadTransferCompleted(this);
+}
+
+void HttpAssetUploadTransfer::Fail(const String &reason)
+{
+    LogError("HttpAssetUploadTransfer: Upload to " + url_ + " failed: " + reason);
+    EmitTransferFailed();
+}
+
+}
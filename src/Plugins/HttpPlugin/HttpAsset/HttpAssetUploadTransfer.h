@@ -0,0 +1,58 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#include "HttpPluginApi.h"
+#include "HttpPluginFwd.h"
+
+#include "IAssetUploadTransfer.h"
+
+namespace Tundra
+{
+
+/// HTTP asset upload transfer.
+/** Uploads the data with PUT requests of at most chunkSize bytes, each with a 'Content-Range: bytes first-last/total' header.
+    The server acknowledges intermediate chunks with '308 Resume Incomplete' and a 'Range: bytes=0-last' header telling how
+    much it has stored, and the final chunk with 200, 201 or 204. The upload fails if several 308 replies in a row
+    acknowledge no new data. After a failed chunk the upload status is queried with an
+    empty PUT and 'Content-Range: bytes *\/total', and the upload resumes from the acknowledged offset.
+    Uploads that fit into a single chunk are sent as a plain PUT. */
+class TUNDRA_HTTP_API HttpAssetUploadTransfer : public IAssetUploadTransfer
+{
+    URHO3D_OBJECT(HttpAssetUploadTransfer, IAssetUploadTransfer);
+
+public:
+    HttpAssetUploadTransfer(HttpAssetProvider *provider, const HttpClientPtr &client);
+    ~HttpAssetUploadTransfer();
+
+    /// Starts the upload to AssetRef(). totalBytes and the source must be set before calling this.
+    /** Called by HttpAssetProvider on the Update after the upload was created, so that reading the first chunk
+        does not block the caller and its failure is signaled after the caller has connected to the signals. */
+    bool Start();
+
+private:
+    /// Sends the chunk starting at bytesUploaded.
+    bool SendNextChunk();
+    /// Queries how much of the upload the server has stored.
+    void SendStatusQuery();
+    /// Retries after a failed request, or fails the upload if out of retries.
+    void Retry(const String &reason);
+    /// Completes the upload successfully.
+    void Complete(HttpRequestPtr &request);
+    /// Fails the upload.
+    void Fail(const String &reason);
+
+    void OnChunkFinished(HttpRequestPtr &request, int status, const String &error);
+
+    /// Returns the offset acknowledged by a '308 Resume Incomplete' response.
+    uint AcknowledgedBytes(HttpRequestPtr &request) const;
+
+    HttpAssetProvider *provider_;
+    HttpClientPtr client_;
+    HttpRequestPtr request_;
+    String url_;
+    /// Number of '308 Resume Incomplete' replies in a row that acknowledged no new data.
+    uint numStalledReplies_;
+};
+
+}
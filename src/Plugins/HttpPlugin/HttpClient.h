@@ -60,6 +60,7 @@ public:
 private:
     friend class HttpPlugin;
     friend class HttpAssetProvider;
+    friend class HttpAssetUploadTransfer;
 
     /// Create a request without scheduling it.
     HttpRequestPtr Create(int method, const String &url);
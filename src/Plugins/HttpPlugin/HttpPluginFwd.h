@@ -14,6 +14,8 @@ namespace Tundra
 {
     class HttpAssetProvider;
     class HttpAssetTransfer;
+    class HttpAssetStorage;
+    class HttpAssetCacheIndex;
 
     typedef SharedPtr<HttpAssetProvider> HttpAssetProviderPtr;
     typedef SharedPtr<HttpAssetTransfer> HttpAssetTransferPtr;
@@ -6,12 +6,15 @@
 #include "GraphicsWorld.h"
 #include "Framework.h"
 #include "Placeable.h"
+#include "Mesh.h"
+#include "Terrain.h"
 #include "Entity.h"
 #include "Scene/Scene.h"
 #include "LoggingFunctions.h"
 #include "UrhoRenderer.h"
 #include "InputAPI.h"
 #include "InputContext.h"
+#include "ConfigAPI.h"
 
 #include <Math/float3.h>
 #include <Math/MathFunc.h>
@@ -28,7 +31,17 @@ SceneInteract::SceneInteract(Framework* owner) :
     lastX(-1),
     lastY(-1),
     frameRaycasted(false),
-    itemUnderMouse(false)
+    itemUnderMouse(false),
+    sceneDirty(true),
+    raycastInterval(0.0f),
+    timeSinceRaycast(0.0f),
+    raycastLayerMask(0xffffffff),
+    pickX(-1),
+    pickY(-1),
+    pickViewWidth(0),
+    pickViewHeight(0),
+    pickItemUnderMouse(false),
+    pickCameraTransform(float3x4::identity)
 {
 }
 
@@ -40,20 +53,28 @@ void SceneInteract::Initialize()
 {
     inputContext = framework->Input()->RegisterInputContext("SceneInteract", 100);
     inputContext->MouseEventReceived.Connect(this, &SceneInteract::HandleMouseEvent);
+
+    ConfigData config(ConfigAPI::FILE_FRAMEWORK, "scene interact");
+    SetRaycastInterval(framework->Config()->Read(config, "raycast interval", 0.0f).GetFloat());
+    SetRaycastLayerMask(framework->Config()->Read(config, "raycast layer mask", 0xffffffff).GetUInt());
 }
 
 void SceneInteract::Uninitialize()
 {
+    TrackScene(nullptr);
     inputContext.Reset();
 }
 
-void SceneInteract::Update(float /*frameTime*/)
+void SceneInteract::Update(float frameTime)
 {
     if (!framework->IsHeadless())
     {
         URHO3D_PROFILE(SceneInteract_Update);
 
-        ExecuteRaycast();
+        // Coarser pick rate, if configured, applies only to the per-frame raycast. Mouse events always raycast.
+        timeSinceRaycast += frameTime;
+        if (timeSinceRaycast >= raycastInterval)
+            ExecuteRaycast();
         if (lastHitEntity)
             lastHitEntity->Exec(EntityAction::Local, "MouseHover");
         
@@ -66,6 +87,24 @@ RayQueryResult* SceneInteract::CurrentMouseRaycastResult() const
     return &lastRaycast;
 }
 
+void SceneInteract::SetRaycastInterval(float seconds)
+{
+    raycastInterval = Max(seconds, 0.0f);
+}
+
+void SceneInteract::SetRaycastLayerMask(unsigned layerMask)
+{
+    if (raycastLayerMask == layerMask)
+        return;
+    raycastLayerMask = layerMask;
+    InvalidateRaycast();
+}
+
+void SceneInteract::InvalidateRaycast()
+{
+    sceneDirty = true;
+}
+
 float3 SceneInteract::RaycastClosestIntersect(const float3 &from, const float3 &to, unsigned layerMask, float maxDistance) const
 {
     Vector<float3> toVec;
@@ -126,21 +165,58 @@ float3 SceneInteract::RaycastFurthestIntersect(const float3 &from, const Vector<
         // We use raycast all as there might be multiple entities in between 'from' and 'to'
         // and this function should return the closest hit to the 'to' target.
         float maxDistance = from.Distance(to[i]);
-        RayQueryResultVector results = world->RaycastAll(ray, layerMask, maxDistance);
-        if (!results.Empty())
+        RayQueryResult result = world->RaycastFurthest(ray, layerMask, maxDistance);
+        if (result.entity && result.t > furthest)
         {
-            // Last result is picked as the results are already ordered by distance.
-            RayQueryResult& result = results.Back();
-            if (result.t > furthest)
-            {
-                furthest = result.t;
-                intersection = result.pos;
-            }
+            furthest = result.t;
+            intersection = result.pos;
         }
     }
     return intersection;
 }
 
+Vector<float3> SceneInteract::RaycastClosestIntersects(const float3 &from, const Vector<float3> &to, unsigned layerMask, float maxDistance) const
+{
+    Vector<float3> intersections(to.Size(), float3::nan);
+    Scene* scene = framework->Module<UrhoRenderer>()->MainCameraScene();
+    GraphicsWorld* world = scene ? scene->Subsystem<GraphicsWorld>().Get() : nullptr;
+    if (!world)
+        return intersections;
+
+    Ray ray;
+    ray.pos = from;
+
+    for (int i=0, len=to.Size(); i<len; ++i)
+    {
+        ray.dir = to[i].Sub(from).Normalized();
+        RayQueryResult result = world->Raycast(ray, layerMask, maxDistance);
+        if (result.entity)
+            intersections[i] = result.pos;
+    }
+    return intersections;
+}
+
+Vector<float3> SceneInteract::RaycastFurthestIntersects(const float3 &from, const Vector<float3> &to, unsigned layerMask) const
+{
+    Vector<float3> intersections(to.Size(), float3::nan);
+    Scene* scene = framework->Module<UrhoRenderer>()->MainCameraScene();
+    GraphicsWorld* world = scene ? scene->Subsystem<GraphicsWorld>().Get() : nullptr;
+    if (!world)
+        return intersections;
+
+    Ray ray;
+    ray.pos = from;
+
+    for (int i=0, len=to.Size(); i<len; ++i)
+    {
+        ray.dir = to[i].Sub(from).Normalized();
+        RayQueryResult result = world->RaycastFurthest(ray, layerMask, from.Distance(to[i]));
+        if (result.entity)
+            intersections[i] = result.pos;
+    }
+    return intersections;
+}
+
 RayQueryResult* SceneInteract::ExecuteRaycast()
 {
     // Return the cached result if already executed this frame.
@@ -153,7 +229,16 @@ RayQueryResult* SceneInteract::ExecuteRaycast()
     if (!world)
         return 0;
 
-    lastRaycast = world->Raycast(lastX, lastY);
+    TrackScene(scene);
+
+    // Skip the raycast if nothing that affects its result has changed since the last pick.
+    bool pickChanged = UpdatePickState(framework->Module<UrhoRenderer>()->MainCamera());
+    if (!pickChanged && !sceneDirty)
+        return &lastRaycast;
+    sceneDirty = false;
+    timeSinceRaycast = 0.0f;
+
+    lastRaycast = world->Raycast(lastX, lastY, raycastLayerMask);
     if (!lastRaycast.entity || itemUnderMouse)
     {
         if (lastHitEntity)
@@ -178,6 +263,81 @@ RayQueryResult* SceneInteract::ExecuteRaycast()
     return &lastRaycast;
 }
 
+bool SceneInteract::UpdatePickState(Entity *cameraEntity)
+{
+    UrhoRenderer *renderer = framework->Module<UrhoRenderer>();
+    Placeable *placeable = cameraEntity ? cameraEntity->Component<Placeable>().Get() : nullptr;
+    float3x4 cameraTransform = placeable ? placeable->LocalToWorld() : float3x4::identity;
+    int viewWidth = renderer->WindowWidth();
+    int viewHeight = renderer->WindowHeight();
+
+    bool changed = (pickCamera.Get() != cameraEntity || pickX != lastX || pickY != lastY ||
+        pickViewWidth != viewWidth || pickViewHeight != viewHeight || pickItemUnderMouse != itemUnderMouse ||
+        !pickCameraTransform.Equals(cameraTransform, 1e-5f));
+
+    pickCamera = cameraEntity;
+    pickX = lastX;
+    pickY = lastY;
+    pickViewWidth = viewWidth;
+    pickViewHeight = viewHeight;
+    pickItemUnderMouse = itemUnderMouse;
+    pickCameraTransform = cameraTransform;
+    return changed;
+}
+
+void SceneInteract::TrackScene(Scene *scene)
+{
+    if (trackedScene.Get() == scene)
+        return;
+
+    if (trackedScene)
+    {
+        trackedScene->AttributeChanged.Disconnect(this, &SceneInteract::OnSceneAttributeChanged);
+        trackedScene->ComponentAdded.Disconnect(this, &SceneInteract::OnSceneComponentChanged);
+        trackedScene->ComponentRemoved.Disconnect(this, &SceneInteract::OnSceneComponentChanged);
+        trackedScene->EntityRemoved.Disconnect(this, &SceneInteract::OnSceneEntityRemoved);
+    }
+
+    trackedScene = scene;
+    sceneDirty = true;
+
+    if (scene)
+    {
+        scene->AttributeChanged.Connect(this, &SceneInteract::OnSceneAttributeChanged);
+        scene->ComponentAdded.Connect(this, &SceneInteract::OnSceneComponentChanged);
+        scene->ComponentRemoved.Connect(this, &SceneInteract::OnSceneComponentChanged);
+        scene->EntityRemoved.Connect(this, &SceneInteract::OnSceneEntityRemoved);
+    }
+}
+
+void SceneInteract::OnSceneAttributeChanged(IComponent *component, IAttribute *attribute, AttributeChange::Type /*change*/)
+{
+    // Only the placement, visibility and geometry of the pickable objects affect the raycast result.
+    // Other changes, such as the continuous network and physics updates of unrelated attributes, keep the cached pick.
+    if (sceneDirty || !component)
+        return;
+    const u32 typeId = component->TypeId();
+    if (typeId == Placeable::ComponentTypeId)
+    {
+        Placeable *placeable = static_cast<Placeable*>(component);
+        if (attribute == &placeable->transform || attribute == &placeable->visible || attribute == &placeable->selectionLayer ||
+            attribute == &placeable->parentRef || attribute == &placeable->parentBone)
+            sceneDirty = true;
+    }
+    else if (typeId == Mesh::ComponentTypeId || typeId == Terrain::ComponentTypeId)
+        sceneDirty = true;
+}
+
+void SceneInteract::OnSceneComponentChanged(Entity * /*entity*/, IComponent * /*component*/, AttributeChange::Type /*change*/)
+{
+    sceneDirty = true;
+}
+
+void SceneInteract::OnSceneEntityRemoved(Entity * /*entity*/, AttributeChange::Type /*change*/)
+{
+    sceneDirty = true;
+}
+
 void SceneInteract::HandleMouseEvent(MouseEvent* e)
 {
     // Invalidate cached raycast if mouse coordinates have changed
@@ -10,6 +10,8 @@
 #include "IRenderer.h"
 #include "Signals.h"
 
+#include <Math/float3x4.h>
+
 namespace Tundra
 {
 
@@ -62,6 +64,33 @@ public:
     /// @overload
     float3 RaycastFurthestIntersect(const float3 &from, const Vector<float3> &to, unsigned layerMask = 0xffffffff) const;
 
+    /// Returns the closest intersect point for each target when raycasting from @c from to each point in @c to.
+    /** Batch variant of RaycastClosestIntersect that looks up the graphics world only once for all targets.
+        @return Intersect world positions in the same order as @c to. float3::nan for targets that had no hits. */
+    Vector<float3> RaycastClosestIntersects(const float3 &from, const Vector<float3> &to, unsigned layerMask = 0xffffffff, float maxDistance = 1000.0f) const;
+
+    /// Returns the furthest intersect point for each target when raycasting from @c from to each point in @c to.
+    /** Batch variant of RaycastFurthestIntersect that looks up the graphics world only once for all targets.
+        @return Intersect world positions in the same order as @c to. float3::nan for targets that had no hits. */
+    Vector<float3> RaycastFurthestIntersects(const float3 &from, const Vector<float3> &to, unsigned layerMask = 0xffffffff) const;
+
+    /// Sets the minimum interval in seconds between the per-frame mouse raycasts.
+    /** Zero (default) raycasts every frame when the pick state has changed. Mouse input events
+        always get an up-to-date raycast. Can be configured with the "raycast interval" key in the
+        "scene interact" section of the framework config. */
+    void SetRaycastInterval(float seconds);
+    /// Returns the minimum interval in seconds between the per-frame mouse raycasts.
+    float RaycastInterval() const { return raycastInterval; }
+
+    /// Sets the selection layer mask used for the mouse raycasts.
+    /** Can be configured with the "raycast layer mask" key in the "scene interact" section of the framework config. */
+    void SetRaycastLayerMask(unsigned layerMask);
+    /// Returns the selection layer mask used for the mouse raycasts.
+    unsigned RaycastLayerMask() const { return raycastLayerMask; }
+
+    /// Forces the next mouse raycast to be executed even if the pick state has not changed.
+    void InvalidateRaycast();
+
     /// Emitted when mouse cursor moves on top of an entity.
     /** @param entity Hit entity.
         @param Possible mouse button held down during the move.
@@ -88,7 +117,8 @@ public:
 
 private:
     /// Performs raycast to last known mouse cursor position in the currently active scene.
-    /** This function will only perform the raycast once per Tundra mainloop frame. */
+    /** This function will only perform the raycast once per Tundra mainloop frame. The raycast is skipped
+        and the previous result returned if the camera, mouse position and scene have not changed since the last pick. */
     RayQueryResult* ExecuteRaycast();
     
     void Initialize() override;
@@ -97,11 +127,37 @@ private:
     /// Handle mouse input events.
     void HandleMouseEvent(MouseEvent* e);
 
+    /// Returns if the camera, view or mouse state has changed since the last raycast. Stores the new state.
+    bool UpdatePickState(Entity *cameraEntity);
+
+    /// Connects to the scene change signals of @c scene, disconnecting from the previously tracked scene.
+    void TrackScene(Scene *scene);
+
+    /// Marks the last raycast result stale when the scene contents change.
+    /** Attribute changes invalidate it only for the placement and visibility of Placeable, and for Mesh and Terrain. */
+    void OnSceneAttributeChanged(IComponent *component, IAttribute *attribute, AttributeChange::Type change);
+    void OnSceneComponentChanged(Entity *entity, IComponent *component, AttributeChange::Type change);
+    void OnSceneEntityRemoved(Entity *entity, AttributeChange::Type change);
+
     int lastX; ///< Last known mouse cursor's x position.
     int lastY; ///< Last known mouse cursor's y position.
     
     bool itemUnderMouse; ///< Was there widget under mouse in last known position.
     bool frameRaycasted; ///< Has raycast been already done for this frame.
+    bool sceneDirty; ///< Has the tracked scene changed since the last raycast.
+
+    float raycastInterval; ///< Minimum interval in seconds between the per-frame raycasts.
+    float timeSinceRaycast; ///< Time in seconds since the last per-frame raycast.
+    unsigned raycastLayerMask; ///< Selection layer mask used for the mouse raycasts.
+
+    int pickX; ///< Mouse cursor's x position at the last raycast.
+    int pickY; ///< Mouse cursor's y position at the last raycast.
+    int pickViewWidth; ///< Window width at the last raycast.
+    int pickViewHeight; ///< Window height at the last raycast.
+    bool pickItemUnderMouse; ///< Was there widget under mouse at the last raycast.
+    float3x4 pickCameraTransform; ///< Camera world transform at the last raycast.
+    EntityWeakPtr pickCamera; ///< Camera entity used for the last raycast.
+    SceneWeakPtr trackedScene; ///< Scene whose changes invalidate the last raycast.
 
     EntityWeakPtr lastHitEntity; ///< Last entity raycast has hit.
     mutable RayQueryResult lastRaycast; ///< Last raycast result.
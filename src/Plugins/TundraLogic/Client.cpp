@@ -35,7 +35,9 @@ Client::Client(TundraLogic* owner) :
     framework_(owner->GetFramework()),
     loginstate_(NotConnected),
     reconnect_(false),
-    client_id_(0)
+    binaryLoginSent_(false),
+    client_id_(0),
+    receivedMessageCount_(0)
 {
     // Create "virtual" client->server connection & syncstate. Used by SyncManager
     serverUserConnection_ = KNetUserConnectionPtr(new KNetUserConnection());
@@ -47,11 +49,13 @@ Client::~Client()
 {
 }
 
-void Client::Update(float)
+void Client::Update(float frametime)
 {
     // If we aren't a server, check pending login
     if (!owner_->IsServer())
         CheckLogin();
+    if (serverUserConnection_->connection)
+        serverUserConnection_->UpdateLinkSimulation(frametime);
 }
 
 void Client::Login(const String& address, unsigned short port, const String& username, const String& password, const String &protocol)
@@ -82,6 +86,7 @@ void Client::Login(const String& address, unsigned short port, kNet::SocketTrans
     }
 
     reconnect_ = false;
+    resumeToken_.Clear();
     
     KristalliProtocol *kristalli = owner_->KristalliProtocol();
 
@@ -218,11 +223,26 @@ void Client::CheckLogin()
             AboutToConnect.Emit(); // This signal is used as a 'function call'. Any interested party can fill in
 
             // new content to the login properties of the client object, which will then be sent out on the line below.
-            msg.loginData = StringToBuffer(LoginPropertiesAsXml());
-            DataSerializer ds(msg.Size() + 4);
+            // The binary login format is used only when reconnecting to a server that has already accepted it,
+            // as older servers can only parse XML. The server may have been replaced by an older one meanwhile,
+            // in which case HandleLoginReply logs in again with XML.
+            binaryLoginSent_ = reconnect_ && serverUserConnection_->protocolVersion >= ProtocolBinaryLogin;
+            if (binaryLoginSent_)
+                msg.loginData = SerializeLoginProperties(properties_);
+            else
+                msg.loginData = StringToBuffer(LoginPropertiesAsXml());
+            const bool resume = reconnect_ && !resumeToken_.Empty();
+            DataSerializer ds(msg.Size() + 4 + (resume ? 2 + resumeToken_.Length() + 4 : 0));
             msg.SerializeTo(ds);
             // Add requested protocol version
             ds.AddVLE<kNet::VLE8_16_32>(cHighestSupportedProtocolVersion);
+            // Ask the server to resume our previous session, telling how many messages we received during it
+            if (resume)
+            {
+                ds.AddString(resumeToken_.CString());
+                ds.Add<u32>(receivedMessageCount_);
+            }
+            receivedMessageCount_ = 0;
             connection->SendMessage(msg.messageID, msg.reliable, msg.inOrder, msg.priority, 0, ds.GetData(), ds.BytesFilled());
         }
         break;
@@ -274,6 +294,10 @@ void Client::HandleKristalliMessage(kNet::MessageConnection* source, kNet::packe
         return;
     }
     
+    // Count the same messages as the server, see KNetUserConnection::Send
+    if (IsSceneStateMessage(messageId))
+        ++receivedMessageCount_;
+
     switch(messageId)
     {
     case MsgLoginReply::messageID:
@@ -300,6 +324,28 @@ void Client::HandleLoginReply(kNet::MessageConnection* /*source*/, const char *d
     if (dd.BytesLeft())
         serverUserConnection_->protocolVersion = (NetworkProtocolVersion)dd.ReadVLE<kNet::VLE8_16_32>();
 
+    // If the server did not agree on the binary login format in this handshake, it could not read the login properties.
+    // Drop the connection without handling the reply; the reconnect logs in with XML, as the protocol version read above now selects.
+    // Note that a failure reply carries no protocol version, so a denied binary login is always retried once with XML.
+    if (binaryLoginSent_ && serverUserConnection_->protocolVersion < ProtocolBinaryLogin)
+    {
+        LogWarning("Server did not accept the binary login format, logging in again with XML");
+        binaryLoginSent_ = false;
+        loginstate_ = ConnectionPending;
+        if (MessageConnection())
+            MessageConnection()->Disconnect(0);
+        return;
+    }
+
+    // Read the session resume token, and whether the server resumed our previous session
+    bool resumed = false;
+    resumeToken_.Clear();
+    if (serverUserConnection_->protocolVersion >= ProtocolSessionResume && dd.BytesLeft())
+    {
+        resumeToken_ = dd.ReadString().c_str();
+        resumed = dd.Read<u8>() != 0;
+    }
+
     if (msg.success)
     {
         loginstate_ = LoggedIn;
@@ -311,6 +357,7 @@ void Client::HandleLoginReply(kNet::MessageConnection* /*source*/, const char *d
         {
             // The connection is now live for use by eg. SyncManager
             serverUserConnection_->connection = MessageConnection();
+            serverUserConnection_->SetLinkSimulation(owner_->KristalliProtocol()->linkSimulation);
 
             // Create a non-authoritative scene for the client
             ScenePtr scene = framework_->Scene()->CreateScene("TundraClient", true, false);
@@ -327,6 +374,11 @@ void Client::HandleLoginReply(kNet::MessageConnection* /*source*/, const char *d
 
             Connected.Emit(&responseData);
         }
+        else if (resumed)
+        {
+            // The server resumed our previous session and will only send what changed while we were disconnected
+            LogInfo("Resumed previous scene sync session");
+        }
         else
         {
             // If we are reconnecting, empty the scene, as the server will send everything again anyway
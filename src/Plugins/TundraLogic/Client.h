@@ -135,7 +135,10 @@ private:
     ClientLoginState loginstate_;
     LoginPropertyMap properties_;
     bool reconnect_; ///< Whether the connect attempt is a reconnect because of dropped connection
+    bool binaryLoginSent_; ///< Whether the login data of the current connection attempt was sent in the binary format
     u32 client_id_; ///< User ID, once known
+    String resumeToken_; ///< Token for resuming the scene sync session on reconnect, if the server supports it
+    u32 receivedMessageCount_; ///< Number of scene state messages (IsSceneStateMessage) received on the current connection
 
     TundraLogic* owner_;
     Framework* framework_;
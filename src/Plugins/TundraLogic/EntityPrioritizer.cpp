@@ -13,117 +13,234 @@
 #include "IMeshAsset.h"
 #include "Framework.h"
 #include "LoggingFunctions.h"
+#include "Math/Quat.h"
 //#include "Sound.h"
 
 #include <Urho3D/Graphics/Model.h>
 
+#include <cmath>
+#include <utility>
+
 namespace Tundra
 {
 
-void DefaultEntityPrioritizer::ComputeSyncPriorities(EntitySyncStateMap &entities, const float3 &observerPos,const float3 &observerRot)
+// Observer rotations are Euler angles in degrees, as returned by RadToDeg(Quat::ToEulerZYX()).
+static Quat ObserverOrientation(const float3 &rot)
 {
-    // IDEA: could cache observerPos and observerRot and recompute priorities only of those are changed.
-    // But of constantly moving objects it's probably good to recompute priorities every once in a while even if 
-    // the observer doesn't move.
-    if (!observerPos.IsFinite() || !observerRot.IsFinite())
-        return; // camera information not received yet.
-    ScenePtr scn = scene.Lock();
-    if (!scn)
-        return;
+    return Quat::FromEulerZYX(DegToRad(rot.x), DegToRad(rot.y), DegToRad(rot.z));
+}
+
+EntityPrioritizer::EntityPrioritizer() :
+    observerMoveThreshold(1.f),
+    observerTurnThreshold(10.f),
+    maxEntitiesPerUpdate(256)
+{
+}
+
+void EntityPrioritizer::ComputeSyncPriorities(EntitySyncStateMap::iterator begin, EntitySyncStateMap::iterator end, const float3 &observerPos, const float3 &observerRot)
+{
+    for(EntitySyncStateMap::iterator it = begin; it != end; ++it)
+        ComputeSyncPriorities(it->second, observerPos, observerRot);
+}
+
+void EntityPrioritizer::ComputeSyncPriorities(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot)
+{
+    // Swap the state in and out instead of copying, the component states are referred to by pointers.
+    const entity_id_t id = entityState.id;
+    EntitySyncStateMap entities;
+    std::swap(entities[id], entityState);
+    ComputeSyncPriorities(entities, observerPos, observerRot);
+    std::swap(entities[id], entityState);
+}
+
+void EntityPrioritizer::UpdateDirtySyncPriority(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot)
+{
+    if (entityState.priority < 0.f)
+        ComputeSyncPriorities(entityState, observerPos, observerRot);
+}
 
-    for(EntitySyncStateMap::iterator it = entities.begin(); it != entities.end(); ++it)
+void EntityPrioritizer::ObserverUpdated(SceneSyncState &state)
+{
+    if (state.priorityRecomputePending || !state.observerPos.IsFinite() || !state.observerRot.IsFinite())
+        return;
+    if (!state.prioritizedObserverPos.IsFinite() || !state.prioritizedObserverRot.IsFinite() ||
+        state.observerPos.DistanceSq(state.prioritizedObserverPos) >= observerMoveThreshold * observerMoveThreshold ||
+        RadToDeg(ObserverOrientation(state.observerRot).AngleBetween(ObserverOrientation(state.prioritizedObserverRot))) >= observerTurnThreshold)
     {
-        EntitySyncState &entityState = it->second;
-        Entity *entity = scn->EntityById(entityState.id).Get(); /**< @todo Use EntityWeakPtr in EntitySyncState when available */
-        if (!entity)
-            continue; // we (might) end up here e.g. when entity was just deleted
+        state.priorityRecomputePending = true;
+        state.priorityCursor = 0;
+    }
+}
 
-        /// @todo Check do we end up computing sync prio for local entities
+void EntityPrioritizer::UpdateSyncPriorities(SceneSyncState &state, bool periodic)
+{
+    if (!state.observerPos.IsFinite() || !state.observerRot.IsFinite())
+        return; // camera information not received yet.
 
-        SharedPtr<Placeable> placeable = entity->Component<Placeable>();
-        SharedPtr<Mesh> mesh = entity->Component<Mesh>();
-        SharedPtr<RigidBody> rigidBody = entity->Component<RigidBody>();
+    if (periodic && !state.priorityRecomputePending)
+    {
+        state.priorityRecomputePending = true;
+        state.priorityCursor = 0;
+    }
 
-        /// @todo sound sources
-        /*
-        SharedPtr<Sound> sound = entity->Component<Sound>();
-        if (sound)
+    if (state.priorityRecomputePending)
+    {
+        // Continue the full recompute from where the previous update left off. Entities may have been added or removed
+        // in between, so the position is stored as an entity ID instead of an iterator.
+        if (state.priorityCursor == 0)
         {
-            if (sound->spatial.Get() && placeable)
-            {
-                float r = sound->soundOuterRadius.Get();
-                r *= r;
-                entityState.priority = 4.f * pi * r / observerPos.DistanceSq(placeable->WorldPosition());
-            }
-            else
-                entityState.priority = inf;
+            state.prioritizedObserverPos = state.observerPos;
+            state.prioritizedObserverRot = state.observerRot;
         }
-        */
-        /// @todo Handle terrains
-        //shared_ptr<Terrain> terrain = entity->Component<Terrain>();
-        //if (terrain) { ... }
+        EntitySyncStateMap::iterator begin = state.entities.lower_bound(state.priorityCursor);
+        EntitySyncStateMap::iterator end = begin;
+        for(uint i = 0; i < maxEntitiesPerUpdate && end != state.entities.end(); ++i)
+            ++end;
+        ComputeSyncPriorities(begin, end, state.observerPos, state.observerRot);
+        if (end == state.entities.end())
+            state.priorityRecomputePending = false;
+        else
+            state.priorityCursor = end->first;
+    }
+
+    // Entities with pending changes that the full recompute has not reached yet
+    for(std::list<EntitySyncState*>::iterator it = state.dirtyQueue.begin(); it != state.dirtyQueue.end(); ++it)
+        UpdateDirtySyncPriority(**it, state.observerPos, state.observerRot);
+}
+
+void DefaultEntityPrioritizer::ComputeSyncPriorities(EntitySyncStateMap::iterator begin, EntitySyncStateMap::iterator end, const float3 &observerPos, const float3 &observerRot)
+{
+    if (!observerPos.IsFinite() || !observerRot.IsFinite())
+        return; // camera information not received yet.
+    ScenePtr scn = scene.Lock();
+    for(EntitySyncStateMap::iterator it = begin; it != end; ++it)
+        ComputeSyncPriority(scn.Get(), it->second, observerPos);
+}
+
+void DefaultEntityPrioritizer::ComputeSyncPriorities(EntitySyncStateMap &entities, const float3 &observerPos, const float3 &observerRot)
+{
+    ComputeSyncPriorities(entities.begin(), entities.end(), observerPos, observerRot);
+}
+
+void DefaultEntityPrioritizer::ComputeSyncPriorities(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot)
+{
+    if (!observerPos.IsFinite() || !observerRot.IsFinite())
+        return; // camera information not received yet.
+    ScenePtr scn = scene.Lock();
+    ComputeSyncPriority(scn.Get(), entityState, observerPos);
+}
 
-        if (!placeable)
+void DefaultEntityPrioritizer::UpdateDirtySyncPriority(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot)
+{
+    bool recompute = entityState.priority < 0.f;
+    if (!recompute && entityState.prioritizedPos.IsFinite() && cellSize > 0.f)
+    {
+        EntityPtr entity = entityState.weak.Lock();
+        Placeable *placeable = entity ? entity->Component<Placeable>().Get() : 0;
+        if (placeable)
         {
-            /// @todo Should handle special case entities with rigid body but no placeable?
-            //if (rigidBody)
-            // Non-spatial (probably), use max priority
-            /// @todo Can have f.ex. Terrain component that has its own transform, but it can use Placeable too.
-            entityState.priority = inf;
+            // Recompute only if the entity has crossed to another cell, not on every small movement.
+            const float3 newPos = placeable->WorldPosition();
+            const float3 &oldPos = entityState.prioritizedPos;
+            recompute = floor(oldPos.x / cellSize) != floor(newPos.x / cellSize) ||
+                floor(oldPos.y / cellSize) != floor(newPos.y / cellSize) ||
+                floor(oldPos.z / cellSize) != floor(newPos.z / cellSize);
         }
-        else if (placeable && !mesh)
+    }
+    if (recompute)
+        ComputeSyncPriorities(entityState, observerPos, observerRot);
+}
+
+void DefaultEntityPrioritizer::ComputeSyncPriority(Scene *scn, EntitySyncState &entityState, const float3 &observerPos)
+{
+    // The sync state may belong to another scene than the default one, see SyncManager::RegisterAdditionalScene
+    Entity *entity = entityState.weak.Get();
+    if (!entity && scn)
+        entity = scn->EntityById(entityState.id).Get();
+    if (!entity)
+        return; // we (might) end up here e.g. when entity was just deleted
+
+    /// @todo Check do we end up computing sync prio for local entities
+
+    SharedPtr<Placeable> placeable = entity->Component<Placeable>();
+    SharedPtr<Mesh> mesh = entity->Component<Mesh>();
+    SharedPtr<RigidBody> rigidBody = entity->Component<RigidBody>();
+
+    /// @todo sound sources
+    /*
+    SharedPtr<Sound> sound = entity->Component<Sound>();
+    if (sound)
+    {
+        if (sound->spatial.Get() && placeable)
         {
-            // Spatial, but no mesh, for now use a harcoded priority of 20 (updateInterval = 1 / (priority * relevance),
-            // so will probably yield the default SyncManager's update period 1/20th of a second
-            entityState.priority = 20.f;
-            /// @todo retrieve/calculate bounding volumes of possible billboards, particle systems, lights, etc.
-            /// Not going to be easy with Ogre though, especially when running in headless mode.
+            float r = sound->soundOuterRadius.Get();
+            r *= r;
+            entityState.priority = 4.f * pi * r / observerPos.DistanceSq(placeable->WorldPosition());
         }
-        else if (placeable && mesh)
+        else
+            entityState.priority = inf;
+    }
+    */
+    /// @todo Handle terrains
+    //shared_ptr<Terrain> terrain = entity->Component<Terrain>();
+    //if (terrain) { ... }
+
+    entityState.prioritizedPos = placeable ? placeable->WorldPosition() : float3::nan;
+
+    if (!placeable)
+    {
+        /// @todo Should handle special case entities with rigid body but no placeable?
+        //if (rigidBody)
+        // Non-spatial (probably), use max priority
+        /// @todo Can have f.ex. Terrain component that has its own transform, but it can use Placeable too.
+        entityState.priority = inf;
+    }
+    else if (placeable && !mesh)
+    {
+        // Spatial, but no mesh, for now use a harcoded priority of 20 (updateInterval = 1 / (priority * relevance),
+        // so will probably yield the default SyncManager's update period 1/20th of a second
+        entityState.priority = 20.f;
+        /// @todo retrieve/calculate bounding volumes of possible billboards, particle systems, lights, etc.
+        /// Not going to be easy with Ogre though, especially when running in headless mode.
+    }
+    else if (placeable && mesh)
+    {
+        OBB worldObb;
+        // The scene may be null when the sync state holds the entity weakly, so use the entity's framework
+        if (entity->GetFramework()->IsHeadless())
         {
-            OBB worldObb;
-            if (scn->GetFramework()->IsHeadless())
+            // On headless mode, force mesh asset load in order to be able to inspect its AABB.
+            if (!mesh->MeshAsset() && !mesh->meshRef.Get().ref.Trimmed().Empty())
             {
-                // On headless mode, force mesh asset load in order to be able to inspect its AABB.
-                if (!mesh->MeshAsset() && !mesh->meshRef.Get().ref.Trimmed().Empty())
-                {
-                    mesh->ForceMeshLoad();
-                    continue; // compute the priority next time when mesh asset is available
-                }
-                // Mesh::WorldOBB not usable in headless mode
-                // so we must dig the bounding volume information from the model asset instead.
-                /// @todo For some meshes (f.ex. floor of the Avatar scene) there seems to be significant discrepancy
-                // between the OBB values when running as headless or not. Investigate.
-                Urho3D::Model* model = mesh->MeshAsset() ? mesh->MeshAsset()->UrhoModel() : (Urho3D::Model*)0;
-                if (!model)
-                    LogWarning("SyncManager::ComputeSyncPriorities: " + entity->ToString() + " has null Ogre mesh " + mesh->MeshName());
-                worldObb = model ? AABB(model->GetBoundingBox()) : OBB();
-                worldObb.Transform(placeable->LocalToWorld());
+                mesh->ForceMeshLoad();
+                return; // compute the priority next time when mesh asset is available
             }
-            else
-                worldObb = mesh->WorldOBB();
-            float sizeSq = worldObb.SurfaceArea();
-            sizeSq *= sizeSq;
-            float distanceSq = observerPos.DistanceSq(placeable->WorldPosition());
-            entityState.priority = sizeSq/distanceSq;
-            //LogDebug(QString("%1 sizeSq %2 distanceSq %3").arg(entity->ToString()).arg(sizeSq).arg(distanceSq));
+            // Mesh::WorldOBB not usable in headless mode
+            // so we must dig the bounding volume information from the model asset instead.
+            /// @todo For some meshes (f.ex. floor of the Avatar scene) there seems to be significant discrepancy
+            // between the OBB values when running as headless or not. Investigate.
+            Urho3D::Model* model = mesh->MeshAsset() ? mesh->MeshAsset()->UrhoModel() : (Urho3D::Model*)0;
+            if (!model)
+                LogWarning("SyncManager::ComputeSyncPriorities: " + entity->ToString() + " has null Ogre mesh " + mesh->MeshName());
+            worldObb = model ? AABB(model->GetBoundingBox()) : OBB();
+            worldObb.Transform(placeable->LocalToWorld());
         }
-
-        /// @todo Take direction and velocity of rigid bodies into account
-            //if (rigidBody)
-        /// @todo Hardcoded relevancy of 10 for entities with RigidBody component and 1 for others for now.
-        /// @todo Movement of non-physical entities is too jerky.
-        entityState.relevancy = rigidBody /*entity->Component("Avatar")*/ ? 10.f : 1.f;
-        //LogDebug(QString("%1 P %2 R %3 P*R %4 syncRate %5").arg(entity->ToString()).arg(
-            //entityState.priority).arg(entityState.relevancy).arg(entityState.FinalPriority()).arg(entityState.ComputePrioritizedUpdateInterval(updatePeriod_)));
+        else
+            worldObb = mesh->WorldOBB();
+        float sizeSq = worldObb.SurfaceArea();
+        sizeSq *= sizeSq;
+        float distanceSq = observerPos.DistanceSq(placeable->WorldPosition());
+        entityState.priority = sizeSq/distanceSq;
+        //LogDebug(QString("%1 sizeSq %2 distanceSq %3").arg(entity->ToString()).arg(sizeSq).arg(distanceSq));
     }
-}
 
-void DefaultEntityPrioritizer::ComputeSyncPriorities(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot)
-{
-    EntitySyncStateMap m;
-    m[entityState.id] = entityState;
-    ComputeSyncPriorities(m, observerPos, observerRot);
+    /// @todo Take direction and velocity of rigid bodies into account
+        //if (rigidBody)
+    /// @todo Hardcoded relevancy of 10 for entities with RigidBody component and 1 for others for now.
+    /// @todo Movement of non-physical entities is too jerky.
+    entityState.relevancy = rigidBody /*entity->Component("Avatar")*/ ? 10.f : 1.f;
+    //LogDebug(QString("%1 P %2 R %3 P*R %4 syncRate %5").arg(entity->ToString()).arg(
+        //entityState.priority).arg(entityState.relevancy).arg(entityState.FinalPriority()).arg(entityState.ComputePrioritizedUpdateInterval(updatePeriod_)));
 }
 
 }
@@ -13,22 +13,54 @@ namespace Tundra
 {
 
 /// Subclass and provide the implementation to SyncManager to perform application-specific entity prioritizing.
-/** The base class implementations of functions are no-ops.
+/** The base class drives the computation incrementally: a full recompute of a user's entities is started when the observer
+    has moved or turned beyond a threshold, or periodically, and is spread over several sync updates, at most maxEntitiesPerUpdate
+    entities at a time. In between, only the entities that are in the dirty queue are given a chance to update their priority
+    (see UpdateDirtySyncPriority).
+
+    SyncManager calls the iterator range and single entity overloads of ComputeSyncPriorities. Their base implementations fall back
+    to the overloads older prioritizers implement: the range overload computes each entity with the single entity overload, and the
+    single entity overload passes the entity to the map overload. New prioritizers should override the range and single entity overloads.
     @remark Interest management */
 class TUNDRALOGIC_API EntityPrioritizer
 {
 public:
+    EntityPrioritizer();
+    virtual ~EntityPrioritizer() {}
+
+    /// Computes priorities for the entity sync states in range [begin, end).
+    /** The default implementation calls the single entity overload for each entity. */
+    virtual void ComputeSyncPriorities(EntitySyncStateMap::iterator begin, EntitySyncStateMap::iterator end, const float3& observerPos, const float3& observerRot);
+
     /// Computes priorities provided entity sync states.
-    /// @todo In addition, or instead, could provide a function with begin and end iterators as input. This could useful
-    /// when dealing when very large container and only a fixed number of priority calculation would be wanted per frame.
+    /** The default implementation is a no-op. Not called by SyncManager, see the class description. */
     virtual void ComputeSyncPriorities(EntitySyncStateMap& UNUSED_PARAM(entities), const float3& UNUSED_PARAM(observerPos), const float3& UNUSED_PARAM(observerRot))
     {
     }
 
-     /// @overload
-    virtual void ComputeSyncPriorities(EntitySyncState& UNUSED_PARAM(entityState), const float3& UNUSED_PARAM(observerPos), const float3& UNUSED_PARAM(observerRot))
-    {
-    }
+    /// @overload
+    /** The default implementation calls the map overload with a map holding only @c entityState. */
+    virtual void ComputeSyncPriorities(EntitySyncState& entityState, const float3& observerPos, const float3& observerRot);
+
+    /// Called for each entity in the dirty queue between full recomputes.
+    /** The default implementation computes the priority only if it has not been computed yet. Override to recompute
+        e.g. when the entity has moved significantly. */
+    virtual void UpdateDirtySyncPriority(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot);
+
+    /// Notifies the prioritizer that a new observer position has been received for @c state.
+    /** Schedules a full recompute if the observer has moved or turned beyond the thresholds since the previous one. */
+    void ObserverUpdated(SceneSyncState &state);
+
+    /// Advances the priority computation of @c state. Called by SyncManager on each sync update before the dirty queue is sorted.
+    /** @param periodic Start a full recompute even if the observer has not moved, in order to catch up with moving entities. */
+    void UpdateSyncPriorities(SceneSyncState &state, bool periodic);
+
+    /// Observer movement (world units) that triggers a full recompute, default 1.
+    float observerMoveThreshold;
+    /// Observer rotation (degrees) that triggers a full recompute, default 10.
+    float observerTurnThreshold;
+    /// Max. number of entities processed by a full recompute per sync update, default 256.
+    uint maxEntitiesPerUpdate;
 
     /// @todo Provide virtual Sort() function? Prioritizer could sort then dirty queue using custom predicates.
 };
@@ -37,13 +69,24 @@ public:
 class TUNDRALOGIC_API DefaultEntityPrioritizer : public EntityPrioritizer
 {
 public:
-    explicit DefaultEntityPrioritizer(const SceneWeakPtr &syncedScene) : scene(syncedScene) {}
+    explicit DefaultEntityPrioritizer(const SceneWeakPtr &syncedScene) : scene(syncedScene), cellSize(4.f) {}
+    using EntityPrioritizer::ComputeSyncPriorities;
     /// EntityPrioritizer override
-    void ComputeSyncPriorities(EntitySyncStateMap &entities, const float3 &observerPos,const float3 &observerRot);
+    void ComputeSyncPriorities(EntitySyncStateMap::iterator begin, EntitySyncStateMap::iterator end, const float3 &observerPos, const float3 &observerRot);
+    /// EntityPrioritizer override
+    void ComputeSyncPriorities(EntitySyncStateMap &entities, const float3 &observerPos, const float3 &observerRot);
     /// EntityPrioritizer override
     void ComputeSyncPriorities(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot);
+    /// EntityPrioritizer override
+    /** Recomputes the priority also if the entity has moved to another spatial cell since the last computation. */
+    void UpdateDirtySyncPriority(EntitySyncState &entityState, const float3 &observerPos, const float3 &observerRot);
 
     SceneWeakPtr scene;
+    /// Size of the spatial grid cells (world units) used to detect entity movement, default 4.
+    float cellSize;
+
+private:
+    void ComputeSyncPriority(Scene *scn, EntitySyncState &entityState, const float3 &observerPos);
 };
 
 }
@@ -81,6 +81,10 @@ void KristalliProtocol::Initialize()
         if (transportLayer != kNet::InvalidTransportLayer)
             defaultTransport = transportLayer;
     }
+
+    StringVector netSimParams = framework->CommandLineParameters("--netsim");
+    if (netSimParams.Size() > 0)
+        linkSimulation = LinkSimulationParams::FromString(netSimParams.Front());
 }
 
 void KristalliProtocol::Uninitialize()
@@ -93,7 +97,7 @@ void KristalliProtocol::OpenKNetLogWindow()
     LogError("Cannot open kNet logging window - kNet was not built with Qt enabled!");
 }
 
-void KristalliProtocol::Update(float /*frametime*/)
+void KristalliProtocol::Update(float frametime)
 {
     // Pulls all new inbound network messages and calls the message handler we've registered
     // for each of them.
@@ -156,6 +160,10 @@ void KristalliProtocol::Update(float /*frametime*/)
     // If connection was made, enable a larger number of reconnection attempts in case it gets lost
     if (serverConnection && serverConnection->GetConnectionState() == kNet::ConnectionOK)
         reconnectAttempts = cReconnectAttempts;
+
+    // Release the simulated outgoing messages that are due, also of the connections registered by other server modules
+    for(auto iter = connections.Begin(); iter != connections.End(); ++iter)
+        (*iter)->UpdateLinkSimulation(frametime);
 }
 
 void KristalliProtocol::Connect(const char *ip, unsigned short port, kNet::SocketTransportLayer transport)
@@ -232,6 +240,7 @@ void KristalliProtocol::StopServer()
     if (server)
     {
         network.StopServer();
+        connectionsBySource.Clear();
         // We may have connections registered by other server modules. Only clear native connections
         for(auto iter = connections.Begin(); iter != connections.End();)
         {
@@ -259,7 +268,9 @@ void KristalliProtocol::NewConnectionEstablished(kNet::MessageConnection *source
     UserConnectionPtr connection = UserConnectionPtr(new KNetUserConnection());
     connection->userID = AllocateNewConnectionID();
     Urho3D::StaticCast<KNetUserConnection>(connection)->connection = source;
+    connection->SetLinkSimulation(linkSimulation);
     connections.Push(connection);
+    connectionsBySource[source] = connection;
 
     // For TCP mode sockets, set the TCP_NODELAY option to improve latency for the messages we send.
     if (source->GetSocket() && source->GetSocket()->TransportLayer() == kNet::SocketOverTCP)
@@ -280,6 +291,7 @@ void KristalliProtocol::ClientDisconnected(kNet::MessageConnection *source)
             ClientDisconnectedEvent.Emit(iter->Get());
             
             LogInfo("User disconnected, connection ID " + String((*iter)->userID));
+            connectionsBySource.Erase(source);
             connections.Erase(iter);
             return;
         }
@@ -326,11 +338,8 @@ u32 KristalliProtocol::AllocateNewConnectionID() const
 
 UserConnectionPtr KristalliProtocol::UserConnectionBySource(kNet::MessageConnection* source) const
 {
-    for(auto iter = connections.Begin(); iter != connections.End(); ++iter)
-        if ((*iter)->ConnectionType() == "knet" && Urho3D::StaticCast<KNetUserConnection>(*iter)->connection == source)
-            return *iter;
-
-    return UserConnectionPtr();
+    auto iter = connectionsBySource.Find(source);
+    return (iter != connectionsBySource.End() ? iter->second_ : UserConnectionPtr());
 }
 
 UserConnectionPtr KristalliProtocol::UserConnectionById(u32 id) const
@@ -76,6 +76,10 @@ public:
     /// What trasport layer to use. Read on startup from "--protocol <udp|tcp>". Defaults to UDP if no start param was given.
     kNet::SocketTransportLayer defaultTransport;
 
+    /// Network conditions simulated for new connections, on both the server and the client.
+    /** Read on startup from "--netsim <params>", see LinkSimulationParams::FromString. Disabled by default. */
+    LinkSimulationParams linkSimulation;
+
     /// Allocate a connection ID for new connection
     u32 AllocateNewConnectionID() const;
 
@@ -124,6 +128,8 @@ private:
     
     /// Users that are connected to server
     UserConnectionList connections;
+    /// Native users by message connection, for per-message lookups.
+    HashMap<kNet::MessageConnection*, UserConnectionPtr> connectionsBySource;
 };
 
 }
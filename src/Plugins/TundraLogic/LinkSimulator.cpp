@@ -0,0 +1,194 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "StableHeaders.h"
+#include "LinkSimulator.h"
+#include "LoggingFunctions.h"
+
+#include "Math/MathFunc.h"
+
+#include <Urho3D/Core/StringUtils.h>
+
+#include <cstring>
+
+namespace Tundra
+{
+
+/// Minimum time in seconds before a lost reliable message is retransmitted, in addition to the round trip.
+static const double cMinRetransmitDelay = 0.1;
+/// Maximum number of times a reliable message is simulated to be lost in a row.
+static const int cMaxRetransmits = 8;
+
+LinkSimulationParams::LinkSimulationParams() :
+    latency(0.f),
+    jitter(0.f),
+    lossRate(0.f),
+    burstLossRate(0.f),
+    burstLength(0),
+    reorderRate(0.f),
+    bandwidth(0),
+    seed(0)
+{
+}
+
+bool LinkSimulationParams::IsEnabled() const
+{
+    return latency > 0.f || jitter > 0.f || lossRate > 0.f || (burstLossRate > 0.f && burstLength > 0) || reorderRate > 0.f || bandwidth > 0;
+}
+
+LinkSimulationParams LinkSimulationParams::FromString(const String &str)
+{
+    LinkSimulationParams params;
+    StringVector pairs = str.Split(',');
+    for(uint i = 0; i < pairs.Size(); ++i)
+    {
+        StringVector keyValue = pairs[i].Split('=');
+        if (keyValue.Size() != 2)
+        {
+            LogWarning("LinkSimulationParams::FromString: Malformed parameter \"" + pairs[i] + "\", expected key=value");
+            continue;
+        }
+        String key = keyValue[0].Trimmed().ToLower();
+        String value = keyValue[1].Trimmed();
+        if (key == "latency")
+            params.latency = Max(0.f, Urho3D::ToFloat(value));
+        else if (key == "jitter")
+            params.jitter = Max(0.f, Urho3D::ToFloat(value));
+        else if (key == "loss")
+            params.lossRate = Clamp(Urho3D::ToFloat(value), 0.f, 1.f);
+        else if (key == "burstloss")
+            params.burstLossRate = Clamp(Urho3D::ToFloat(value), 0.f, 1.f);
+        else if (key == "burstlength")
+            params.burstLength = Urho3D::ToUInt(value);
+        else if (key == "reorder")
+            params.reorderRate = Clamp(Urho3D::ToFloat(value), 0.f, 1.f);
+        else if (key == "bandwidth")
+            params.bandwidth = Urho3D::ToUInt(value);
+        else if (key == "seed")
+            params.seed = Urho3D::ToUInt(value);
+        else
+            LogWarning("LinkSimulationParams::FromString: Unknown parameter \"" + key + "\"");
+    }
+    return params;
+}
+
+String LinkSimulationParams::ToString() const
+{
+    return "latency=" + String(latency) + ",jitter=" + String(jitter) + ",loss=" + String(lossRate) +
+        ",burstloss=" + String(burstLossRate) + ",burstlength=" + String(burstLength) + ",reorder=" + String(reorderRate) +
+        ",bandwidth=" + String(bandwidth) + ",seed=" + String(seed);
+}
+
+LinkSimulator::LinkSimulator(const LinkSimulationParams &params) :
+    params_(params),
+    random_(params.seed ? params.seed : std::random_device{}()),
+    time_(0.0),
+    linkFreeTime_(0.0),
+    lastInOrderTime_(0.0),
+    burstRemaining_(0),
+    numLost_(0),
+    numRetransmitted_(0),
+    numReordered_(0)
+{
+}
+
+void LinkSimulator::Advance(double seconds)
+{
+    if (seconds > 0.0)
+        time_ += seconds;
+}
+
+float LinkSimulator::Random()
+{
+    return std::uniform_real_distribution<float>(0.f, 1.f)(random_);
+}
+
+bool LinkSimulator::NextLost()
+{
+    if (burstRemaining_ > 0)
+    {
+        --burstRemaining_;
+        return true;
+    }
+    if (params_.burstLength > 0 && params_.burstLossRate > 0.f && Random() < params_.burstLossRate)
+    {
+        burstRemaining_ = params_.burstLength - 1;
+        return true;
+    }
+    return params_.lossRate > 0.f && Random() < params_.lossRate;
+}
+
+bool LinkSimulator::Queue(kNet::message_id_t id, const char *data, size_t numBytes, bool reliable, bool inOrder, unsigned long priority, unsigned long contentID)
+{
+    const double now = time_;
+    const double latency = params_.latency / 1000.0;
+    const double jitter = params_.jitter / 1000.0;
+
+    // The message occupies the link for its transmission time, whether it gets lost or not
+    double sendTime = now;
+    if (params_.bandwidth > 0)
+    {
+        linkFreeTime_ = Max(linkFreeTime_, now) + (double)numBytes / params_.bandwidth;
+        sendTime = linkFreeTime_;
+    }
+
+    double deliveryTime = sendTime + latency;
+    if (jitter > 0.0)
+        deliveryTime = Max(sendTime, deliveryTime + (Random() * 2.0 - 1.0) * jitter);
+
+    if (!reliable)
+    {
+        if (NextLost())
+        {
+            ++numLost_;
+            return false;
+        }
+    }
+    else
+    {
+        // Each lost transmission costs a round trip and the retransmission timeout
+        for(int i = 0; i < cMaxRetransmits && NextLost(); ++i)
+        {
+            deliveryTime += 2.0 * latency + cMinRetransmitDelay;
+            ++numRetransmitted_;
+        }
+    }
+
+    if (reliable && inOrder)
+    {
+        // Head-of-line blocking: can not be delivered before the previous in-order message
+        deliveryTime = Max(deliveryTime, lastInOrderTime_);
+        lastInOrderTime_ = deliveryTime;
+    }
+    else if (params_.reorderRate > 0.f && Random() < params_.reorderRate)
+    {
+        deliveryTime += latency + jitter + 0.001;
+        ++numReordered_;
+    }
+
+    Message msg;
+    msg.id = id;
+    msg.data.Resize((uint)numBytes);
+    if (numBytes)
+        memcpy(&msg.data[0], data, numBytes);
+    msg.reliable = reliable;
+    msg.inOrder = inOrder;
+    msg.priority = priority;
+    msg.contentID = contentID;
+    queue_.insert(std::make_pair(deliveryTime, msg));
+    return true;
+}
+
+void LinkSimulator::PopDue(Vector<Message> &dest)
+{
+    if (queue_.empty())
+        return;
+    const double now = time_;
+    std::multimap<double, Message>::iterator i = queue_.begin();
+    while(i != queue_.end() && i->first <= now)
+    {
+        dest.Push(i->second);
+        i = queue_.erase(i);
+    }
+}
+
+}
@@ -0,0 +1,117 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#include "TundraLogicApi.h"
+#include "CoreTypes.h"
+
+#include <kNet/Types.h>
+
+#include <Urho3D/Container/RefCounted.h>
+
+#include <map>
+#include <random>
+
+namespace Tundra
+{
+
+/// Simulated network link conditions, see LinkSimulator.
+struct TUNDRALOGIC_API LinkSimulationParams
+{
+    LinkSimulationParams();
+
+    float latency; ///< One-way latency in milliseconds.
+    float jitter; ///< Maximum random deviation from the latency in milliseconds.
+    float lossRate; ///< Probability [0, 1] of a single message being lost.
+    float burstLossRate; ///< Probability [0, 1] per message of a loss burst starting.
+    uint burstLength; ///< Number of consecutive messages lost in a burst.
+    float reorderRate; ///< Probability [0, 1] of an unordered message being held back so that later messages overtake it.
+    uint bandwidth; ///< Bandwidth cap in bytes per second, 0 for unlimited.
+    u32 seed; ///< Random seed. With 0 the generator is seeded from system entropy, otherwise the simulated conditions are repeatable.
+
+    /// Returns whether any conditions are simulated.
+    bool IsEnabled() const;
+
+    /// Parses the parameters from a comma-separated list of key=value pairs, f.ex. "latency=100,jitter=20,loss=0.01,seed=1".
+    /** Recognized keys are latency, jitter, loss, burstloss, burstlength, reorder, bandwidth and seed. */
+    static LinkSimulationParams FromString(const String &str);
+
+    /// Returns the parameters in the format accepted by FromString.
+    String ToString() const;
+};
+
+/// Simulates latency, jitter, packet loss, reordering and bandwidth limits for the messages sent to a connection.
+/** Used by UserConnection on the sending side, so both peers need to simulate to affect both directions.
+    Lost unreliable messages are dropped. Lost reliable messages are delivered late, after a simulated retransmission.
+    Reliable in-order messages are never reordered and suffer head-of-line blocking from the ones before them.
+    The simulator does not read the wall clock. Its time is advanced by the owner, normally by the frame time,
+    so that a given seed and sequence of frames and messages reproduces the same conditions. */
+class TUNDRALOGIC_API LinkSimulator : public RefCounted
+{
+public:
+    /// A message held back by the simulator.
+    struct Message
+    {
+        kNet::message_id_t id;
+        PODVector<u8> data;
+        bool reliable;
+        bool inOrder;
+        unsigned long priority;
+        unsigned long contentID;
+    };
+
+    explicit LinkSimulator(const LinkSimulationParams &params);
+
+    /// Returns the simulated conditions.
+    const LinkSimulationParams &Params() const { return params_; }
+
+    /// Takes a message to be sent over the simulated link.
+    /** @return False if the message was lost and will not be delivered. */
+    bool Queue(kNet::message_id_t id, const char *data, size_t numBytes, bool reliable, bool inOrder, unsigned long priority, unsigned long contentID);
+
+    /// Advances the simulated time by @c seconds.
+    void Advance(double seconds);
+
+    /// Returns the simulated time in seconds since the simulator was created.
+    double Time() const { return time_; }
+
+    /// Moves the messages that are due for delivery at the current simulated time to @c dest, in delivery order.
+    void PopDue(Vector<Message> &dest);
+
+    /// Returns the number of messages waiting for delivery.
+    uint NumQueued() const { return (uint)queue_.size(); }
+
+    /// Returns the number of dropped unreliable messages.
+    uint NumLost() const { return numLost_; }
+
+    /// Returns the number of lost reliable messages that were delivered late.
+    uint NumRetransmitted() const { return numRetransmitted_; }
+
+    /// Returns the number of messages held back for reordering.
+    uint NumReordered() const { return numReordered_; }
+
+private:
+    /// Returns a random number in [0, 1).
+    float Random();
+    /// Decides whether the next message is lost, taking loss bursts into account.
+    bool NextLost();
+
+    LinkSimulationParams params_;
+    std::mt19937 random_;
+    /// Simulated time in seconds.
+    double time_;
+    /// Messages by delivery time. Messages with the same time are delivered in the order they were queued.
+    std::multimap<double, Message> queue_;
+    /// Time when the simulated link has transmitted all the queued bytes.
+    double linkFreeTime_;
+    /// Delivery time of the latest reliable in-order message.
+    double lastInOrderTime_;
+    uint burstRemaining_;
+    uint numLost_;
+    uint numRetransmitted_;
+    uint numReordered_;
+};
+
+typedef SharedPtr<LinkSimulator> LinkSimulatorPtr;
+
+}
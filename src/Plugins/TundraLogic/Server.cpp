@@ -107,6 +107,8 @@ void Server::Stop()
 
         owner_->KristalliProtocol()->StopServer();
         framework_->Scene()->RemoveScene("TundraServer");
+        authenticatedUsers_.Clear();
+        authenticatedUsersById_.Clear();
         
         ServerStopped.Emit();
 
@@ -136,23 +138,37 @@ String Server::Protocol() const
     return IsRunning() ? current_protocol_ : "";
 }
 
-UserConnectionList Server::AuthenticatedUsers() const
+UserConnectionPtr Server::UserConnectionById(u32 connectionID) const
 {
-    UserConnectionList ret;
-    UserConnectionList& allUsers = UserConnections();
-    foreach(const UserConnectionPtr &user, allUsers)
-        if (user->properties["authenticated"].GetBool() == true)
-            ret.Push(user);
-    return ret;
+    UserConnectionMap::ConstIterator iter = authenticatedUsersById_.Find(connectionID);
+    return (iter != authenticatedUsersById_.End() ? iter->second_ : UserConnectionPtr());
 }
 
-UserConnectionPtr Server::UserConnectionById(u32 connectionID) const
+void Server::AddAuthenticatedUser(const UserConnectionPtr &user)
+{
+    if (authenticatedUsersById_.Contains(user->userID))
+        return;
+    authenticatedUsersById_[user->userID] = user;
+    authenticatedUsers_.Push(user);
+}
+
+void Server::RemoveAuthenticatedUser(UserConnection *user)
+{
+    UserConnectionMap::Iterator iter = authenticatedUsersById_.Find(user->userID);
+    if (iter == authenticatedUsersById_.End() || iter->second_ != user)
+        return;
+    authenticatedUsersById_.Erase(iter);
+    authenticatedUsers_.Remove(UserConnectionPtr(user));
+}
+
+template <typename T>
+void Server::BroadcastToAuthenticatedUsers(const T &msg)
 {
-    UserConnectionList connections = AuthenticatedUsers();
-    foreach(const UserConnectionPtr &user, connections)
-        if (user->userID == connectionID)
-            return user;
-    return UserConnectionPtr();
+    // Serialize once for all recipients
+    DataSerializer ds(msg.Size());
+    msg.SerializeTo(ds);
+    for(UserConnectionList::ConstIterator iter = authenticatedUsers_.Begin(); iter != authenticatedUsers_.End(); ++iter)
+        (*iter)->Send(T::messageID, ds.GetData(), ds.BytesFilled(), msg.reliable, msg.inOrder);
 }
 
 UserConnectionList& Server::UserConnections() const
@@ -191,6 +207,7 @@ bool Server::AddExternalUser(UserConnectionPtr user)
     // Allocate user connection if not yet allocated
     if (user->userID == 0)
         user->userID = owner_->KristalliProtocol()->AllocateNewConnectionID();
+    user->SetLinkSimulation(owner_->KristalliProtocol()->linkSimulation);
 
     UserConnectionList& users = owner_->KristalliProtocol()->UserConnections();
     users.Push(user);
@@ -215,15 +232,15 @@ void Server::RemoveExternalUser(UserConnectionPtr user)
     // If user had zero ID, was not logged in yet and does not need to be reported
     if (user->userID)
     {
+        RemoveAuthenticatedUser(user.Get());
+
         // Tell everyone of the client leaving
         MsgClientLeft left;
         left.userID = user->userID;
-        UserConnectionList connections = AuthenticatedUsers();
-        foreach(const UserConnectionPtr &u, connections)
-            if (u->userID != user->userID)
-                u->Send(left);
+        BroadcastToAuthenticatedUsers(left);
     
        UserDisconnected.Emit(user->userID, user.Get());
+       owner_->SyncManager()->UserDisconnected(user.Get());
     }
 
     users.Remove(user);
@@ -286,26 +303,27 @@ void Server::HandleLogin(kNet::MessageConnection* source, const char* data, size
     MsgLogin msg;
     // Read login data (all clients)
     msg.DeserializeFrom(dd);
-    String loginData = BufferToString(msg.loginData);
 
     // Read optional protocol version
     if (dd.BytesLeft())
         user->protocolVersion = (NetworkProtocolVersion)dd.ReadVLE<kNet::VLE8_16_32>();
-    
-    Urho3D::XMLFile xml(context_);
-    bool success = xml.FromString(loginData);
-    if (!success)
-        LogWarning("[SERVER] ID " + String(user->userID) + " client login data xml has malformed data");
-    
-    // Fill the user's logindata, both in raw format and as keyvalue pairs
-    user->loginData = loginData;
-    Urho3D::XMLElement rootElem = xml.GetRoot();
-    Urho3D::XMLElement keyvalueElem = rootElem.GetChild();
-    while(keyvalueElem)
+
+    // Read optional session resume request
+    if (user->protocolVersion >= ProtocolSessionResume && dd.BytesLeft())
     {
-        user->SetProperty(keyvalueElem.GetName(), keyvalueElem.GetAttribute("value"));
-        keyvalueElem = keyvalueElem.GetNext();
+        user->resumeToken = dd.ReadString().c_str();
+        user->resumeMessageCount = dd.Read<u32>();
     }
+
+    // The login data is in binary or in XML, depending on the client version and whether it is reconnecting.
+    // Fill the user's logindata, both in raw format and as keyvalue pairs.
+    // Note: the login is decoded here on the main thread, like all kNet message handling. The binary format avoids
+    // building an XML document per login, but decoding is not deferred to a worker thread.
+    LoginPropertyMap properties;
+    if (!DeserializeLoginData(context_, msg.loginData, properties, user->loginData))
+        LogWarning("[SERVER] ID " + String(user->userID) + " client login data has malformed data");
+    for(LoginPropertyMap::ConstIterator iter = properties.Begin(); iter != properties.End(); ++iter)
+        user->SetProperty(iter->first_, iter->second_.GetString());
     
     FinalizeLogin(user);
 }
@@ -333,6 +351,7 @@ bool Server::FinalizeLogin(UserConnectionPtr user)
         std::vector<s8> responseByteData = StringToBuffer(user->properties["reason"].GetString());
         reply.loginReplyData.insert(reply.loginReplyData.end(), responseByteData.data(), responseByteData.data() + responseByteData.size());
         user->Send(reply);
+        RemoveAuthenticatedUser(user.Get());
         return false;
     }
     
@@ -341,6 +360,8 @@ bool Server::FinalizeLogin(UserConnectionPtr user)
     else
         LogInfo("[SERVER] ID " + String(user->userID) + " client '" + connectedUsername + "' connected");
     
+    AddAuthenticatedUser(user);
+
     // Allow entityactions & EC sync from now on
     MsgLoginReply reply;
     reply.success = 1;
@@ -352,12 +373,10 @@ bool Server::FinalizeLogin(UserConnectionPtr user)
     if (user->HasProperty("username"))
         joined.username = user->Property("username").GetString();
     
-    UserConnectionList users = AuthenticatedUsers();
-    foreach(const UserConnectionPtr &u, users)
-        u->Send(joined);
+    BroadcastToAuthenticatedUsers(joined);
     
     // Advertise the users who already are in the world, to the new user
-    foreach(const UserConnectionPtr &u, users)
+    foreach(const UserConnectionPtr &u, authenticatedUsers_)
     {
         if (u->userID != user->userID)
         {
@@ -370,7 +389,7 @@ bool Server::FinalizeLogin(UserConnectionPtr user)
     }
     
     // Tell syncmanager of the new user
-    owner_->SyncManager()->NewUserConnected(user);
+    const bool resumed = owner_->SyncManager()->NewUserConnected(user);
     
     // Tell all server-side application code that a new user has successfully connected.
     // Ask them to fill the contents of a UserConnectedResponseData structure. This will
@@ -390,9 +409,15 @@ bool Server::FinalizeLogin(UserConnectionPtr user)
     reply.loginReplyData.insert(reply.loginReplyData.end(), responseByteData.data(), responseByteData.data() + responseByteData.size());
 
     // Send login reply, with protocol version accepted by the server appended
-    DataSerializer ds(reply.Size() + 4 + 4);
+    DataSerializer ds(reply.Size() + 4 + 4 + 2 + user->resumeToken.Length());
     reply.SerializeTo(ds);
     ds.AddVLE<kNet::VLE8_16_32>(user->protocolVersion); 
+    // Append the token for resuming this session, and whether the previous session was resumed
+    if (user->protocolVersion >= ProtocolSessionResume)
+    {
+        ds.AddString(user->resumeToken.CString());
+        ds.Add<u8>(resumed ? 1 : 0);
+    }
     user->Send(reply.messageID, reply.reliable, reply.inOrder, ds, reply.priority);
 
     // Successful login
@@ -401,15 +426,15 @@ bool Server::FinalizeLogin(UserConnectionPtr user)
 
 void Server::HandleUserDisconnected(UserConnection* user)
 {
+    RemoveAuthenticatedUser(user);
+
     // Tell everyone of the client leaving
     MsgClientLeft left;
     left.userID = user->userID;
-    UserConnectionList connections = AuthenticatedUsers();
-    foreach(const UserConnectionPtr &u, connections)
-        if (u->userID != user->userID)
-            u->Send(left);
+    BroadcastToAuthenticatedUsers(left);
 
     UserDisconnected.Emit(user->userID, user);
+    owner_->SyncManager()->UserDisconnected(user);
 
     String username = user->Property("username").GetString();
     if (username.Empty())
@@ -73,9 +73,11 @@ public:
     bool IsAboutToStart() const;
 
     /// Returns all authenticated users.
-    UserConnectionList AuthenticatedUsers() const;
+    /** The list is maintained as users log in and disconnect, so iterating it does not allocate.
+        @note Do not hold on to the reference over a frame, the list changes as users come and go. */
+    const UserConnectionList &AuthenticatedUsers() const { return authenticatedUsers_; }
 
-    /// Returns connection corresponding to a connection ID.
+    /// Returns authenticated connection corresponding to a connection ID, or null if not found.
     UserConnectionPtr UserConnectionById(u32 connectionID) const;
 
     /// Returns current sender of an action.
@@ -120,6 +122,14 @@ private:
     /// Finalize the login of a user. Allow security plugins to inspect login credentials. Return true if allowed to log in
     bool FinalizeLogin(UserConnectionPtr user);
 
+    /// Adds a user to the authenticated user registry. Does nothing if already added.
+    void AddAuthenticatedUser(const UserConnectionPtr &user);
+    /// Removes a user from the authenticated user registry.
+    void RemoveAuthenticatedUser(UserConnection *user);
+    /// Sends a message to all authenticated users. The message is serialized only once.
+    template <typename T>
+    void BroadcastToAuthenticatedUsers(const T &msg);
+
     UserConnectionWeakPtr actionSender;
     TundraLogic* owner_;
     Framework* framework_;
@@ -127,6 +137,10 @@ private:
     String current_protocol_;
 
     UserConnectionList userConnectionList_;
+
+    typedef HashMap<u32, UserConnectionPtr> UserConnectionMap; ///< Maps users by connection ID.
+    UserConnectionList authenticatedUsers_; ///< Authenticated users in login order.
+    UserConnectionMap authenticatedUsersById_; ///< Authenticated users by connection ID.
 };
 
 }
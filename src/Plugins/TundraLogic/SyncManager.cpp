@@ -29,11 +29,21 @@
 
 #include <cstring>
 
+#ifdef WIN32
+#include "Win.h"
+#include <wincrypt.h>
+#else
+#include <cstdio>
+#endif
+
 // Used to print EC mismatch warnings only once per EC.
 static std::set<u32> mismatchingComponentTypes;
 
 static size_t oldAttrDataBufferSize = 16 * 1024;
 
+// Maximum factor by which interest management scales up the tolerated rigid body error of distant entities.
+static const float cMaxRigidBodyErrorScale = 10.f;
+
 namespace Tundra
 {
 
@@ -160,6 +170,163 @@ int DetectRotSendType(bool rotChanged, const float3x3 &rot)
         return 0;
 }
 
+// Helper function for sorting the dirty queue so that the entities with the highest priority are processed first.
+bool HigherSyncPriority(const EntitySyncState *lhs, const EntitySyncState *rhs)
+{
+    return rhs->FinalPriority() < lhs->FinalPriority();
+}
+
+// Helper function for checking whether a sync state replicates the scene of an entity.
+bool ReplicatesEntity(const SceneSyncState *state, const Entity *entity)
+{
+    return state && state->ParentScene().Get() == entity->ParentScene();
+}
+
+// Helper function for checking that a received scene sync message concerns the scene the connection is currently in.
+// Messages sent before the user was moved to another scene are disregarded.
+bool IsCurrentScene(const SceneSyncState *state, u32 sceneId)
+{
+    if (sceneId == state->sceneId)
+        return true;
+    LogDebug("SyncManager: Disregarding message for scene " + String(sceneId) + ", the connection is in scene " + String(state->sceneId));
+    return false;
+}
+
+// Helper function for generating a random session resume token from the system's cryptographic random source.
+// Returns an empty token, which disables resuming the session, if the random source is unavailable.
+String GenerateResumeToken()
+{
+    u32 values[4];
+    bool success = false;
+#ifdef WIN32
+    HCRYPTPROV provider = 0;
+    if (CryptAcquireContext(&provider, 0, 0, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT | CRYPT_SILENT))
+    {
+        success = CryptGenRandom(provider, sizeof(values), (BYTE*)values) != FALSE;
+        CryptReleaseContext(provider, 0);
+    }
+#else
+    FILE *file = fopen("/dev/urandom", "rb");
+    if (file)
+    {
+        success = fread(values, sizeof(values), 1, file) == 1;
+        fclose(file);
+    }
+#endif
+    if (!success)
+    {
+        LogError("SyncManager: Failed to read the system random source, session resume is not available.");
+        return String();
+    }
+
+    String token;
+    for(int i = 0; i < 4; ++i)
+        token.AppendWithFormat("%08x", (unsigned)values[i]);
+    return token;
+}
+
+// Helper function for reading past an attribute value that is not applied.
+void SkipAttributeValue(IAttribute *attr, kNet::DataDeserializer &dd)
+{
+    IAttribute *discarded = attr->Clone();
+    discarded->FromBinary(dd, AttributeChange::Disconnected);
+    delete discarded;
+}
+
+// Helper function for reading the static and dynamic attribute values of a component full update, see SyncManager::WriteComponentFullUpdate.
+void ReadComponentFullUpdate(IComponent *comp, kNet::DataDeserializer &attrDs, AttributeChange::Type change)
+{
+    // Fill static attributes
+    unsigned numStaticAttrs = comp->NumStaticAttributes();
+    const AttributeVector& attrs = comp->Attributes();
+    for (uint i = 0; i < numStaticAttrs; ++i)
+    {
+        // Allow component version mismatches (adding more attributes to the end of static attributes list), break if no more data present.
+        // All attributes (including bool) are at least 8 bits.
+        if (attrDs.BitsLeft() >= 8)
+            attrs[i]->FromBinary(attrDs, AttributeChange::Disconnected);
+        else
+        {
+            if (mismatchingComponentTypes.find(comp->TypeId()) == mismatchingComponentTypes.end())
+            {
+                mismatchingComponentTypes.insert(comp->TypeId());
+                LogWarning("Not enough static attribute data in component " + comp->TypeName() + " (version mismatch).");
+            }
+            break;
+        }
+    }
+
+    if (comp->SupportsDynamicAttributes())
+    {
+        // Create any dynamic attributes
+        while (attrDs.BitsLeft() > 2 * 8)
+        {
+            u8 index = attrDs.Read<u8>();
+            u8 typeId = attrDs.Read<u8>();
+            String attrName = String(attrDs.ReadString().c_str());
+            IAttribute* newAttr = comp->CreateAttribute(index, typeId, attrName, change);
+            if (!newAttr)
+            {
+                LogWarning("Failed to create dynamic attribute. Skipping rest of the attributes for this component.");
+                break;
+            }
+            newAttr->FromBinary(attrDs, AttributeChange::Disconnected);
+        }
+    }
+    else if (attrDs.BitsLeft())
+    {
+        if (mismatchingComponentTypes.find(comp->TypeId()) == mismatchingComponentTypes.end())
+        {
+            mismatchingComponentTypes.insert(comp->TypeId());
+            LogWarning("Extra static attribute data in component " + comp->TypeName() + " (version mismatch).");
+        }
+    }
+}
+
+// Helper function for reading a prefab instance component update, see SyncManager::WritePrefabComponentUpdate.
+// The attributes that are not sent share the values of the prefab prototype.
+void ReadPrefabComponentUpdate(IComponent *comp, IComponent *prototype, kNet::DataDeserializer &attrDs)
+{
+    if (prototype)
+        comp->SharePrototypeValues(ComponentPtr(prototype));
+    else
+        LogWarning("Prefab prototype of component " + comp->TypeName() + " is missing, its attributes that are not sent keep their default values.");
+
+    unsigned numStaticAttrs = comp->NumStaticAttributes();
+    const AttributeVector& attrs = comp->Attributes();
+    unsigned numSentAttrs = attrDs.ReadVLE<kNet::VLE8_16_32>();
+    std::vector<u8> bits((numSentAttrs + 7) / 8);
+    for (size_t i = 0; i < bits.size(); ++i)
+        bits[i] = attrDs.Read<u8>();
+    for (uint i = 0; i < numSentAttrs; ++i)
+    {
+        if (!(bits[i / 8] & (1 << (i % 8))))
+            continue;
+        if (i >= numStaticAttrs)
+        {
+            // The values of the unknown attributes can not be skipped, but they are the last ones
+            if (mismatchingComponentTypes.find(comp->TypeId()) == mismatchingComponentTypes.end())
+            {
+                mismatchingComponentTypes.insert(comp->TypeId());
+                LogWarning("Extra static attribute data in component " + comp->TypeName() + " (version mismatch).");
+            }
+            break;
+        }
+        attrs[i]->FromBinary(attrDs, AttributeChange::Disconnected);
+    }
+}
+
+// Helper function for checking whether an attribute of a prefab instance component still has the value of the prefab prototype.
+bool HasPrototypeValue(IComponent *comp, IComponent *prototype, IAttribute *attr, IAttribute *prototypeAttr)
+{
+    if (!attr || !prototypeAttr || attr->TypeId() != prototypeAttr->TypeId())
+        return false;
+    // Values that have not been set since instantiating the prefab are shared with the prototype, no need to compare them.
+    if (attr->IsValueShared() && comp->Prototype().Get() == prototype)
+        return true;
+    return attr->ToString() == prototypeAttr->ToString();
+}
+
 bool SyncManager::WriteComponentFullUpdate(kNet::DataSerializer& ds, ComponentPtr comp)
 {
     // Component identification
@@ -197,6 +364,80 @@ bool SyncManager::WriteComponentFullUpdate(kNet::DataSerializer& ds, ComponentPt
     return true;
 }
 
+bool SyncManager::WritePrefabComponentUpdate(kNet::DataSerializer& ds, ComponentPtr comp, IComponent* prototype)
+{
+    // Component identification
+    ds.AddVLE<kNet::VLE8_16_32>(comp->Id() & UniqueIdGenerator::LAST_REPLICATED_ID);
+    ds.AddVLE<kNet::VLE8_16_32>(comp->TypeId());
+    ds.AddString(comp->Name().CString());
+
+    kNet::DataSerializer attrDs(attrDataBuffer_, NUMELEMS(attrDataBuffer_));
+
+    // Bitmask of the static attributes that differ from the prototype, followed by the values of those attributes only
+    unsigned numStaticAttrs = comp->NumStaticAttributes();
+    const AttributeVector& attrs = comp->Attributes();
+    const AttributeVector& prototypeAttrs = prototype->Attributes();
+    std::vector<bool> differs(numStaticAttrs, false);
+    for (uint i = 0; i < numStaticAttrs; ++i)
+        differs[i] = !HasPrototypeValue(comp.Get(), prototype, attrs[i], i < prototypeAttrs.Size() ? prototypeAttrs[i] : 0);
+
+    attrDs.AddVLE<kNet::VLE8_16_32>(numStaticAttrs);
+    for (uint i = 0; i < numStaticAttrs; i += 8)
+    {
+        u8 bits = 0;
+        for (uint j = i; j < i + 8 && j < numStaticAttrs; ++j)
+            if (differs[j])
+                bits |= (u8)(1 << (j - i));
+        attrDs.Add<u8>(bits);
+    }
+    for (uint i = 0; i < numStaticAttrs; ++i)
+        if (differs[i])
+            attrs[i]->ToBinary(attrDs);
+
+    if (!ValidateAttributeBuffer(false, attrDs, comp))
+        return false;
+
+    ds.AddVLE<kNet::VLE8_16_32>((u32)attrDs.BytesFilled());
+    ds.AddArray<u8>((unsigned char*)attrDataBuffer_, (u32)attrDs.BytesFilled());
+    return true;
+}
+
+bool SyncManager::SendPrefab(UserConnection* user, Scene* scene, SceneSyncState* sceneState, const String& name)
+{
+    uint revision = scene->PrefabRevision(name);
+    if (!revision)
+        return false;
+    // Each registration of the prefab is sent only once per client
+    Urho3D::HashMap<String, uint>::Iterator sent = sceneState->sentPrefabs.Find(name);
+    if (sent != sceneState->sentPrefabs.End() && sent->second_ == revision)
+        return true;
+
+    kNet::DataSerializer ds(createEntityBuffer_, NUMELEMS(createEntityBuffer_));
+    ds.AddVLE<kNet::VLE8_16_32>(sceneState->sceneId);
+    ds.AddString(name.CString());
+
+    const Entity::ComponentVector prototypes = scene->PrefabComponents(name);
+    uint numReplicatedPrototypes = 0;
+    for (uint i = 0; i < prototypes.Size(); ++i)
+    {
+        if (prototypes[i]->IsReplicated())
+            ++numReplicatedPrototypes;
+    }
+    ds.AddVLE<kNet::VLE8_16_32>(numReplicatedPrototypes);
+    for (uint i = 0; i < prototypes.Size(); ++i)
+    {
+        if (prototypes[i]->IsReplicated() && !WriteComponentFullUpdate(ds, prototypes[i]))
+        {
+            LogWarning("SyncManager::SendPrefab: failed to serialize prefab \"" + name + "\", sending its instances without it.");
+            return false;
+        }
+    }
+
+    user->Send(cRegisterPrefabMessage, true, true, ds);
+    sceneState->sentPrefabs[name] = revision;
+    return true;
+}
+
 bool SyncManager::ValidateAttributeBuffer(bool fatal, kNet::DataSerializer& ds, ComponentPtr &comp, size_t maxBytes)
 {
     if (maxBytes == 0)
@@ -233,6 +474,7 @@ SyncManager::SyncManager(TundraLogic* owner) :
     Object(owner->GetContext()),
     owner_(owner),
     framework_(owner->GetFramework()),
+    nextSceneId_(1),
     updatePeriod_(1.0f / 20.0f),
     updateAcc_(0.0),
     maxLinExtrapTime_(3.0f),
@@ -240,7 +482,14 @@ SyncManager::SyncManager(TundraLogic* owner) :
     componentTypeSender_(0),
     prioUpdateAcc_(0.0),
     priorityUpdatePeriod_(1.f),
-    prioritizer_(0)
+    prioritizer_(0),
+    resumeTimeout_(30.f),
+    syncTick_(0),
+    syncStartTime_(kNet::Clock::Tick()),
+    serverSyncTime_(-1.0),
+    snapshotInterpolation_(true),
+    rigidBodyPosErrorThreshold_(0.03f),
+    rigidBodyRotErrorThreshold_(2.f)
 {
     if (framework_->HasCommandLineParameter("--interestManagement"))
     {
@@ -251,6 +500,9 @@ SyncManager::SyncManager(TundraLogic* owner) :
 
     if (framework_->HasCommandLineParameter("--noclientphysics"))
         noClientPhysicsHandoff_ = true;
+
+    if (framework_->HasCommandLineParameter("--nosnapshotinterpolation"))
+        snapshotInterpolation_ = false;
     
     GetClientExtrapolationTime();
 
@@ -284,6 +536,19 @@ void SyncManager::SetPriorityUpdatePeriod(float period)
         priorityUpdatePeriod_ = updatePeriod_;
 }
 
+void SyncManager::SetRigidBodyErrorThresholds(float position, float rotation)
+{
+    rigidBodyPosErrorThreshold_ = Max(0.f, position);
+    rigidBodyRotErrorThreshold_ = Max(0.f, rotation);
+}
+
+void SyncManager::SetResumeTimeout(float seconds)
+{
+    resumeTimeout_ = seconds > 0.f ? seconds : 0.f;
+    if (resumeTimeout_ == 0.f)
+        parkedSessions_.Clear();
+}
+
 void SyncManager::SetInterestManagementEnabled(bool enabled)
 {
     SetPrioritizer(enabled ? new DefaultEntityPrioritizer(scene_) : 0);
@@ -295,6 +560,78 @@ void SyncManager::SetPrioritizer(EntityPrioritizer *prioritizer)
     prioritizer_ =  prioritizer;
 }
 
+void SyncManager::SetEntityPredictor(EntityPredictor *predictor)
+{
+    EntityPredictorPtr ptr(predictor); // Take ownership, also when bailing out
+    if (!predictor || !predictor->ParentEntity())
+    {
+        LogError("SyncManager::SetEntityPredictor: Null predictor or predictor without entity.");
+        return;
+    }
+    if (predictor->ParentEntity()->IsLocal())
+    {
+        LogError("SyncManager::SetEntityPredictor: Can not predict local entity " + predictor->ParentEntity()->ToString() + ".");
+        return;
+    }
+    predictors_[predictor->ParentEntity()->Id()] = ptr;
+}
+
+void SyncManager::RemoveEntityPredictor(entity_id_t id)
+{
+    predictors_.Erase(id);
+    entityControllers_.Erase(id);
+}
+
+EntityPredictor *SyncManager::Predictor(entity_id_t id) const
+{
+    HashMap<entity_id_t, EntityPredictorPtr>::ConstIterator i = predictors_.Find(id);
+    return i != predictors_.End() ? i->second_.Get() : 0;
+}
+
+void SyncManager::SetEntityController(entity_id_t id, u32 connectionId)
+{
+    if (connectionId)
+        entityControllers_[id] = connectionId;
+    else
+        entityControllers_.Erase(id);
+}
+
+u32 SyncManager::EntityController(entity_id_t id) const
+{
+    HashMap<entity_id_t, u32>::ConstIterator i = entityControllers_.Find(id);
+    return i != entityControllers_.End() ? i->second_ : 0;
+}
+
+bool SyncManager::PredictEntityInput(entity_id_t id, const PODVector<u8> &data, float timeStep)
+{
+    if (owner_->IsServer())
+    {
+        LogError("SyncManager::PredictEntityInput: Can not be called on the server.");
+        return false;
+    }
+    EntityPredictor *predictor = Predictor(id);
+    if (!predictor || !predictor->ParentEntity())
+        return false;
+    if (serverConnection_->ProtocolVersion() < ProtocolEntityPrediction)
+    {
+        LogWarning("SyncManager::PredictEntityInput: Server does not support entity prediction.");
+        return false;
+    }
+
+    const PredictionInput &input = predictor->Predict(data, timeStep);
+
+    // Entity ID, sequence, time step and the VLE-encoded data size precede the data
+    kNet::DataSerializer ds(4 + 4 + 4 + 4 + input.data.Size());
+    ds.Add<u32>(id);
+    ds.Add<u32>(input.sequence);
+    ds.Add<float>(input.timeStep);
+    ds.AddVLE<kNet::VLE8_16_32>(input.data.Size());
+    if (input.data.Size())
+        ds.AddArray<u8>(&input.data[0], input.data.Size());
+    Urho3D::StaticCast<UserConnection>(serverConnection_)->Send(cEntityInputMessage, true, true, ds);
+    return true;
+}
+
 void SyncManager::GetClientExtrapolationTime()
 {
     StringVector extrapTimeParam = framework_->CommandLineParameters("--clientextrapolationtime");
@@ -327,26 +664,35 @@ SceneSyncState* SyncManager::SceneState(const UserConnectionPtr &connection) con
 
 void SyncManager::RegisterToScene(ScenePtr scene)
 {
-    // Disconnect from previous scene if not expired
-    ScenePtr previous = scene_.Lock();
-    if (previous)
+    // Users replicated an additional scene are moved to the new default scene below
+    UserConnectionList movedUsers;
+    if (owner_->IsServer())
     {
-        previous->AttributeChanged.Disconnect(this, &SyncManager::OnAttributeChanged);
-        previous->AttributeAdded.Disconnect(this, &SyncManager::OnAttributeAdded);
-        previous->AttributeRemoved.Disconnect(this, &SyncManager::OnAttributeRemoved);
-        previous->ComponentAdded.Disconnect(this, &SyncManager::OnComponentAdded);
-        previous->ComponentRemoved.Disconnect(this, &SyncManager::OnComponentRemoved);
-        previous->EntityCreated.Disconnect(this, &SyncManager::OnEntityCreated);
-        previous->EntityRemoved.Disconnect(this, &SyncManager::OnEntityRemoved);
-        previous->ActionTriggered.Disconnect(this, &SyncManager::OnActionTriggered);
-        previous->EntityTemporaryStateToggled.Disconnect(this, &SyncManager::OnEntityPropertiesChanged);
-        previous->EntityParentChanged.Disconnect(this, &SyncManager::OnEntityParentChanged);
+        UserConnectionList& users = owner_->Server()->UserConnections();
+        for(auto i = users.Begin(); i != users.End(); ++i)
+            if ((*i)->syncState && (*i)->syncState->sceneId != 0)
+                movedUsers.Push(*i);
     }
+
+    // Disconnect from previous scenes if not expired
+    ScenePtr previous = scene_.Lock();
+    if (previous)
+        DisconnectFromScene(previous.Get());
+    for(auto i = additionalScenes_.Begin(); i != additionalScenes_.End(); ++i)
+        if (i->second_.Get())
+            DisconnectFromScene(i->second_.Get());
+    additionalScenes_.Clear();
     
     serverConnection_->syncState->Clear();
     serverConnection_->syncState->SetParentScene(SceneWeakPtr(scene));
+    serverConnection_->syncState->sceneId = 0;
     scene_.Reset();
     componentTypesFromServer_.clear();
+    serverSyncTime_ = -1.0;
+    predictors_.Clear();
+    entityControllers_.Clear();
+    // Parked sessions refer to the previous scene and can not be resumed anymore
+    parkedSessions_.Clear();
     
     if (!scene)
     {
@@ -355,17 +701,143 @@ void SyncManager::RegisterToScene(ScenePtr scene)
     }
     
     scene_ = scene;
-    Scene* sceneptr = scene.Get();
-    sceneptr->AttributeChanged.Connect(this, &SyncManager::OnAttributeChanged);
-    sceneptr->AttributeAdded.Connect(this, &SyncManager::OnAttributeAdded);
-    sceneptr->AttributeRemoved.Connect(this, &SyncManager::OnAttributeRemoved);
-    sceneptr->ComponentAdded.Connect(this, &SyncManager::OnComponentAdded);
-    sceneptr->ComponentRemoved.Connect(this, &SyncManager::OnComponentRemoved);
-    sceneptr->EntityCreated.Connect(this, &SyncManager::OnEntityCreated);
-    sceneptr->EntityRemoved.Connect(this, &SyncManager::OnEntityRemoved);
-    sceneptr->ActionTriggered.Connect(this, &SyncManager::OnActionTriggered);
-    sceneptr->EntityTemporaryStateToggled.Connect(this, &SyncManager::OnEntityPropertiesChanged);
-    sceneptr->EntityParentChanged.Connect(this, &SyncManager::OnEntityParentChanged);
+    ConnectToScene(scene.Get());
+
+    for(auto i = movedUsers.Begin(); i != movedUsers.End(); ++i)
+        AssignUserToScene(i->Get(), 0);
+}
+
+u32 SyncManager::RegisterAdditionalScene(ScenePtr scene)
+{
+    if (!owner_->IsServer())
+    {
+        LogError("SyncManager::RegisterAdditionalScene: Additional scenes can only be replicated by the server");
+        return 0;
+    }
+    if (!scene || !scene_.Get())
+    {
+        LogError("SyncManager::RegisterAdditionalScene: Null scene, or the default scene has not been registered");
+        return 0;
+    }
+    if (scene == scene_.Lock())
+        return 0;
+    for(auto i = additionalScenes_.Begin(); i != additionalScenes_.End(); ++i)
+        if (i->second_.Get() == scene.Get())
+            return i->first_;
+
+    u32 sceneId = nextSceneId_++;
+    additionalScenes_[sceneId] = scene;
+    ConnectToScene(scene.Get());
+    return sceneId;
+}
+
+void SyncManager::UnregisterAdditionalScene(u32 sceneId)
+{
+    auto iter = additionalScenes_.Find(sceneId);
+    if (iter == additionalScenes_.End())
+        return;
+
+    Scene *scene = iter->second_.Get();
+    if (scene)
+    {
+        DisconnectFromScene(scene);
+        UserConnectionList& users = owner_->Server()->UserConnections();
+        for(auto i = users.Begin(); i != users.End(); ++i)
+            if ((*i)->syncState && (*i)->syncState->sceneId == sceneId)
+                AssignUserToScene(i->Get(), 0);
+    }
+    for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End();)
+    {
+        if (i->second_.state->sceneId == sceneId)
+            i = parkedSessions_.Erase(i);
+        else
+            ++i;
+    }
+    additionalScenes_.Erase(sceneId);
+}
+
+ScenePtr SyncManager::RegisteredScene(u32 sceneId) const
+{
+    if (sceneId == 0)
+        return scene_.Lock();
+    auto iter = additionalScenes_.Find(sceneId);
+    return iter != additionalScenes_.End() ? iter->second_.Lock() : ScenePtr();
+}
+
+Vector<u32> SyncManager::RegisteredSceneIds() const
+{
+    Vector<u32> ids;
+    if (scene_.Get())
+        ids.Push(0);
+    for(auto i = additionalScenes_.Begin(); i != additionalScenes_.End(); ++i)
+        if (i->second_.Get())
+            ids.Push(i->first_);
+    return ids;
+}
+
+bool SyncManager::AssignUserToScene(UserConnection *user, u32 sceneId)
+{
+    if (!owner_->IsServer() || !user || !user->syncState)
+    {
+        LogError("SyncManager::AssignUserToScene: Server operation only, for users that have logged in");
+        return false;
+    }
+    ScenePtr scene = RegisteredScene(sceneId);
+    if (!scene)
+    {
+        LogError("SyncManager::AssignUserToScene: No scene with ID " + String(sceneId));
+        return false;
+    }
+    if (user->syncState->sceneId == sceneId && user->syncState->ParentScene().Get() == scene.Get())
+        return true;
+    if (user->ProtocolVersion() < ProtocolMultiScene)
+    {
+        LogError("SyncManager::AssignUserToScene: Client " + String(user->ConnectionId()) + " does not support changing scenes");
+        return false;
+    }
+
+    // Tell the client to clear its scene. Any sync messages already queued for the old scene are delivered before this.
+    kNet::DataSerializer ds(removeEntityBuffer_, NUMELEMS(removeEntityBuffer_));
+    ds.AddVLE<kNet::VLE8_16_32>(sceneId);
+    user->Send(cSceneChangedMessage, true, true, ds);
+
+    ResetUserSyncState(user, scene, sceneId);
+    return true;
+}
+
+ScenePtr SyncManager::SourceScene(UserConnection* source) const
+{
+    if (source && source->syncState)
+        return source->syncState->ParentScene().Lock();
+    return scene_.Lock();
+}
+
+void SyncManager::ConnectToScene(Scene* scene)
+{
+    scene->AttributeChanged.Connect(this, &SyncManager::OnAttributeChanged);
+    scene->AttributeAdded.Connect(this, &SyncManager::OnAttributeAdded);
+    scene->AttributeRemoved.Connect(this, &SyncManager::OnAttributeRemoved);
+    scene->ComponentAdded.Connect(this, &SyncManager::OnComponentAdded);
+    scene->ComponentRemoved.Connect(this, &SyncManager::OnComponentRemoved);
+    scene->EntityCreated.Connect(this, &SyncManager::OnEntityCreated);
+    scene->EntityRemoved.Connect(this, &SyncManager::OnEntityRemoved);
+    scene->ActionTriggered.Connect(this, &SyncManager::OnActionTriggered);
+    scene->EntityTemporaryStateToggled.Connect(this, &SyncManager::OnEntityPropertiesChanged);
+    scene->EntityParentChanged.Connect(this, &SyncManager::OnEntityParentChanged);
+}
+
+void SyncManager::DisconnectFromScene(Scene* scene)
+{
+    scene->AttributeChanged.Disconnect(this, &SyncManager::OnAttributeChanged);
+    scene->AttributeAdded.Disconnect(this, &SyncManager::OnAttributeAdded);
+    scene->AttributeRemoved.Disconnect(this, &SyncManager::OnAttributeRemoved);
+    scene->ComponentAdded.Disconnect(this, &SyncManager::OnComponentAdded);
+    scene->ComponentRemoved.Disconnect(this, &SyncManager::OnComponentRemoved);
+    scene->EntityCreated.Disconnect(this, &SyncManager::OnEntityCreated);
+    scene->EntityRemoved.Disconnect(this, &SyncManager::OnEntityRemoved);
+    scene->ActionTriggered.Disconnect(this, &SyncManager::OnActionTriggered);
+    scene->EntityTemporaryStateToggled.Disconnect(this, &SyncManager::OnEntityPropertiesChanged);
+    scene->EntityParentChanged.Disconnect(this, &SyncManager::OnEntityParentChanged);
 }
 
 void SyncManager::HandleNetworkMessage(UserConnection* user, kNet::packet_id_t packetId, kNet::message_id_t messageId, const char* data, size_t numBytes)
@@ -417,14 +889,26 @@ void SyncManager::HandleNetworkMessage(UserConnection* user, kNet::packet_id_t p
             HandleSetEntityParent(user, data, numBytes);
             break;
         case cEntityActionMessage:
-            {
-                MsgEntityAction msg(data, numBytes);
-                HandleEntityAction(user, msg);
-            }
+            HandleEntityAction(user, data, numBytes);
             break;
         case cRegisterComponentTypeMessage:
             HandleRegisterComponentType(user, data, numBytes);
             break;
+        case cRegisterPrefabMessage:
+            HandleRegisterPrefab(user, data, numBytes);
+            break;
+        case cSyncTickMessage:
+            HandleSyncTick(user, data, numBytes);
+            break;
+        case cSceneChangedMessage:
+            HandleSceneChanged(user, data, numBytes);
+            break;
+        case cEntityInputMessage:
+            HandleEntityInput(user, data, numBytes);
+            break;
+        case cEntityInputAckMessage:
+            HandleEntityInputAck(user, data, numBytes);
+            break;
         }
     }
     catch (kNet::NetException& e)
@@ -434,7 +918,7 @@ void SyncManager::HandleNetworkMessage(UserConnection* user, kNet::packet_id_t p
     }
 }
 
-void SyncManager::NewUserConnected(const UserConnectionPtr &user)
+bool SyncManager::NewUserConnected(const UserConnectionPtr &user)
 {
     URHO3D_PROFILE(SyncManager_NewUserConnected);
 
@@ -442,7 +926,7 @@ void SyncManager::NewUserConnected(const UserConnectionPtr &user)
     if (!scene)
     {
         LogWarning("SyncManager: Cannot handle new user connection message - No scene set!");
-        return;
+        return false;
     }
 
     // Connect to actions sent to specifically to this user
@@ -451,12 +935,46 @@ void SyncManager::NewUserConnected(const UserConnectionPtr &user)
     // Connect to network messages from this user
     user->NetworkMessageReceived.Connect(this, &SyncManager::HandleNetworkMessage);
 
+    // Resume a parked session if the client has received everything we reliably sent during it.
+    // The parked sync state has been kept dirty with all scene changes since the disconnect, so the client
+    // is brought up to date by the normal sync update. On any mismatch fall back to a full resync below.
+    if (!user->resumeToken.Empty())
+    {
+        ResumableSessionMap::Iterator session = parkedSessions_.Find(user->resumeToken);
+        if (session != parkedSessions_.End())
+        {
+            SharedPtr<SceneSyncState> state = session->second_.state;
+            const bool intact = session->second_.messagesSent == user->resumeMessageCount &&
+                kNet::Clock::SecondsSinceF(session->second_.disconnectTime) <= resumeTimeout_;
+            parkedSessions_.Erase(session);
+            if (intact)
+            {
+                user->syncState = state;
+                user->syncState->SetUserConnectionId(user->ConnectionId());
+                user->resumeToken = GenerateResumeToken();
+                // Let the application hook the resumed state like a new one
+                SceneStateCreated.Emit(user.Get(), user->syncState.Get());
+                return true;
+            }
+            LogDebug("SyncManager: Session of user " + String(user->ConnectionId()) + " can not be resumed, performing full scene sync.");
+        }
+    }
+
+    // New users start in the default scene
+    user->resumeToken = GenerateResumeToken();
+    ResetUserSyncState(user.Get(), scene, 0);
+    return false;
+}
+
+void SyncManager::ResetUserSyncState(UserConnection* user, const ScenePtr &scene, u32 sceneId)
+{
     // Mark all entities in the sync state as new so we will send them
     user->syncState = SharedPtr<SceneSyncState>(new SceneSyncState(user->ConnectionId(), owner_->IsServer()));
-    user->syncState->SetParentScene(scene_);
+    user->syncState->SetParentScene(scene);
+    user->syncState->sceneId = sceneId;
 
     if (owner_->IsServer())
-        SceneStateCreated.Emit(user.Get(), user->syncState.Get());
+        SceneStateCreated.Emit(user, user->syncState.Get());
 
     for(auto iter = scene->Begin(); iter != scene->End(); ++iter)
     {
@@ -473,6 +991,33 @@ void SyncManager::NewUserConnected(const UserConnectionPtr &user)
     }
 }
 
+void SyncManager::UserDisconnected(UserConnection *user)
+{
+    if (!user || !user->syncState || !owner_->IsServer())
+        return;
+
+    // Release the entities the user was controlling. A resumed session gets a new connection ID.
+    for(HashMap<entity_id_t, u32>::Iterator i = entityControllers_.Begin(); i != entityControllers_.End();)
+    {
+        if (i->second_ == user->ConnectionId())
+            i = entityControllers_.Erase(i);
+        else
+            ++i;
+    }
+
+    // Only native clients present resume tokens when logging in
+    if (resumeTimeout_ <= 0.f || user->protocolVersion < ProtocolSessionResume || user->ConnectionType() != "knet" || user->resumeToken.Empty())
+        return;
+
+    ResumableSession session;
+    session.state = user->syncState;
+    session.messagesSent = user->sceneStateMessagesSent;
+    session.disconnectTime = kNet::Clock::Tick();
+    // Entity actions are transient, do not replay them after resume
+    session.state->queuedActions.clear();
+    parkedSessions_[user->resumeToken] = session;
+}
+
 void SyncManager::OnAttributeChanged(IComponent* comp, IAttribute* attr, AttributeChange::Type change)
 {
     assert(comp && attr);
@@ -507,8 +1052,10 @@ void SyncManager::OnAttributeChanged(IComponent* comp, IAttribute* attr, Attribu
         // clients on the next network sync iteration.
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
-            if ((*i)->syncState)
+            if (ReplicatesEntity((*i)->syncState, entity))
                 (*i)->syncState->MarkAttributeDirty(entity->Id(), comp->Id(), attr->Index());
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkAttributeDirty(entity->Id(), comp->Id(), attr->Index());
     }
     else
     {
@@ -539,7 +1086,9 @@ void SyncManager::OnAttributeAdded(IComponent* comp, IAttribute* attr, Attribute
     {
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
-            if ((*i)->syncState) (*i)->syncState->MarkAttributeCreated(entity->Id(), comp->Id(), attr->Index());
+            if (ReplicatesEntity((*i)->syncState, entity)) (*i)->syncState->MarkAttributeCreated(entity->Id(), comp->Id(), attr->Index());
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkAttributeCreated(entity->Id(), comp->Id(), attr->Index());
     }
     else
     {
@@ -568,7 +1117,9 @@ void SyncManager::OnAttributeRemoved(IComponent* comp, IAttribute* attr, Attribu
     {
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
-            if ((*i)->syncState) (*i)->syncState->MarkAttributeRemoved(entity->Id(), comp->Id(), attr->Index());
+            if (ReplicatesEntity((*i)->syncState, entity)) (*i)->syncState->MarkAttributeRemoved(entity->Id(), comp->Id(), attr->Index());
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkAttributeRemoved(entity->Id(), comp->Id(), attr->Index());
     }
     else
     {
@@ -591,7 +1142,9 @@ void SyncManager::OnComponentAdded(Entity* entity, IComponent* comp, AttributeCh
     {
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
-            if ((*i)->syncState) (*i)->syncState->MarkComponentDirty(entity->Id(), comp->Id());
+            if (ReplicatesEntity((*i)->syncState, entity)) (*i)->syncState->MarkComponentDirty(entity->Id(), comp->Id());
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkComponentDirty(entity->Id(), comp->Id());
     }
     else
     {
@@ -613,7 +1166,9 @@ void SyncManager::OnComponentRemoved(Entity* entity, IComponent* comp, Attribute
     {
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
-            if ((*i)->syncState) (*i)->syncState->MarkComponentRemoved(entity->Id(), comp->Id());
+            if (ReplicatesEntity((*i)->syncState, entity)) (*i)->syncState->MarkComponentRemoved(entity->Id(), comp->Id());
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkComponentRemoved(entity->Id(), comp->Id());
     }
     else
     {
@@ -634,7 +1189,7 @@ void SyncManager::OnEntityCreated(Entity* entity, AttributeChange::Type change)
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
         {
-            if ((*i)->syncState)
+            if (ReplicatesEntity((*i)->syncState, entity))
             {
                 (*i)->syncState->MarkEntityDirty(entity->Id());
                 if ((*i)->syncState->entities[entity->Id()].removed)
@@ -644,6 +1199,8 @@ void SyncManager::OnEntityCreated(Entity* entity, AttributeChange::Type change)
                 }
             }
         }
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkEntityDirty(entity->Id());
     }
     else
     {
@@ -656,6 +1213,11 @@ void SyncManager::OnEntityRemoved(Entity* entity, AttributeChange::Type change)
     assert(entity);
     if (!entity)
         return;
+    if (!predictors_.Empty())
+    {
+        predictors_.Erase(entity->Id());
+        entityControllers_.Erase(entity->Id());
+    }
     if (change != AttributeChange::Replicate)
         return;
     if (entity->IsLocal())
@@ -665,7 +1227,9 @@ void SyncManager::OnEntityRemoved(Entity* entity, AttributeChange::Type change)
     {
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
-            if ((*i)->syncState) (*i)->syncState->MarkEntityRemoved(entity->Id());
+            if (ReplicatesEntity((*i)->syncState, entity)) (*i)->syncState->MarkEntityRemoved(entity->Id());
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkEntityRemoved(entity->Id());
     }
     else
     {
@@ -703,15 +1267,23 @@ void SyncManager::OnActionTriggered(Entity *entity, const String &action, const
     {
         msg.executionType = (u8)EntityAction::Local; // Propagate as local actions.
         // On server, queue the actions and send after entity sync
-        /// \todo Making copy is inefficient, consider storing pointers
-        foreach(UserConnectionPtr c, owner_->Server()->UserConnections())
-        {
-            if (c->properties["authenticated"].GetBool() == true)
-                c->syncState->queuedActions.push_back(msg);
-        }
+        QueuedMessagePtr action(new QueuedMessage(msg.messageID, msg.reliable, msg.inOrder));
+        action->data.Resize((uint)msg.Size());
+        kNet::DataSerializer ds(&action->data[0], action->data.Size());
+        msg.SerializeTo(ds);
+        action->data.Resize((uint)ds.BytesFilled());
+        QueueEntityAction(action, entity, 0);
     }
 }
 
+void SyncManager::QueueEntityAction(const QueuedMessagePtr &action, Entity *entity, UserConnection *exclude)
+{
+    const UserConnectionList &users = owner_->Server()->AuthenticatedUsers();
+    for(auto i = users.Begin(); i != users.End(); ++i)
+        if (i->Get() != exclude && ReplicatesEntity((*i)->syncState, entity))
+            (*i)->syncState->queuedActions.push_back(action);
+}
+
 void SyncManager::OnUserActionTriggered(UserConnection* user, Entity *entity, const String &action, const StringVector &params)
 {
     assert(user && entity);
@@ -749,9 +1321,11 @@ void SyncManager::OnEntityPropertiesChanged(Entity* entity, AttributeChange::Typ
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
         {
-            if ((*i)->syncState)
+            if (ReplicatesEntity((*i)->syncState, entity))
                 (*i)->syncState->MarkEntityDirty(entity->Id(), true);
         }
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkEntityDirty(entity->Id(), true);
     }
     else
     {
@@ -777,9 +1351,11 @@ void SyncManager::OnEntityParentChanged(Entity* entity, Entity* newParent, Attri
         UserConnectionList& users = owner_->Server()->UserConnections();
         for(auto i = users.Begin(); i != users.End(); ++i)
         {
-            if ((*i)->syncState)
+            if (ReplicatesEntity((*i)->syncState, entity))
                 (*i)->syncState->MarkEntityDirty(entity->Id(), false, true);
         }
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End(); ++i)
+            if (ReplicatesEntity(i->second_.state, entity)) i->second_.state->MarkEntityDirty(entity->Id(), false, true);
     }
     else
     {
@@ -827,7 +1403,7 @@ void SyncManager::ReplicateComponentType(u32 typeId, UserConnection* connection)
     {
         if (owner_->IsServer())
         {
-            UserConnectionList users = owner_->Server()->AuthenticatedUsers();
+            const UserConnectionList &users = owner_->Server()->AuthenticatedUsers();
             for(auto i = users.Begin(); i != users.End(); ++i)
             {
                 if ((*i)->ProtocolVersion() >= ProtocolCustomComponents && (*i).Get() != componentTypeSender_)
@@ -872,7 +1448,7 @@ float3 HermiteDerivative(const float3 &pos0, const float3 &vel0, const float3 &p
 
 void SyncManager::InterpolateRigidBodies(float frametime, SceneSyncState* state)
 {
-    ScenePtr scene = scene_.Lock();
+    ScenePtr scene = state->ParentScene().Lock();
     if (!scene)
         return;
 
@@ -1005,6 +1581,22 @@ void SyncManager::Update(float frametime)
     
     if (owner_->IsServer())
     {
+        // Drop parked sessions that were not resumed in time
+        for(auto i = parkedSessions_.Begin(); i != parkedSessions_.End();)
+        {
+            if (kNet::Clock::SecondsSinceF(i->second_.disconnectTime) > resumeTimeout_)
+                i = parkedSessions_.Erase(i);
+            else
+                ++i;
+        }
+
+        ++syncTick_;
+
+        // Start a periodic priority recompute for all users, to catch up with entities that moved on their own
+        const bool periodicPriorityUpdate = prioUpdateAcc_ >= priorityUpdatePeriod_;
+        if (periodicPriorityUpdate)
+            prioUpdateAcc_ = fmod(prioUpdateAcc_, priorityUpdatePeriod_);
+
         // If we are server, process all authenticated users
         // SyncState is not added to the user before it's authenticated, so using UserConnections() instead of
         // AuthenticatedUsers() and checking for SyncState's existence does the same thing in a little more efficient fashion.
@@ -1015,17 +1607,11 @@ void SyncManager::Update(float frametime)
             if (syncState)
             {
                 // First sort the dirty queue according to priority if IM enabled
-                if (prioritizer_) /**< @todo Move all code in this block behind EntityPrioritizer? */
+                if (prioritizer_)
                 {
-                    /// @todo Do priority update independently from regular sync update.
-                    if (prioUpdateAcc_ >= priorityUpdatePeriod_)
-                    {
-                        prioUpdateAcc_ = fmod(prioUpdateAcc_, priorityUpdatePeriod_);
-                        if (prioritizer_)
-                            prioritizer_->ComputeSyncPriorities(syncState->entities, syncState->observerPos, syncState->observerRot);
-                    }
+                    prioritizer_->UpdateSyncPriorities(*syncState, periodicPriorityUpdate);
                     URHO3D_PROFILE(SyncManager_Update_SortDirtyQueue);
-                    syncState->dirtyQueue.sort();
+                    syncState->dirtyQueue.sort(HigherSyncPriority);
                 }
 
                 // Then send out all changes to rigid bodies.
@@ -1037,6 +1623,8 @@ void SyncManager::Update(float frametime)
                     ReplicateRigidBodyChanges((*i).Get());
                 // Finally send out changes to other attributes via the generic sync mechanism.
                 ProcessSyncState((*i).Get());
+                // Rigid body changes that were not sent yet stay queued for the next update
+                RestoreDeferredRigidBodyChanges((*i).Get());
             }
         }
     }
@@ -1059,16 +1647,21 @@ void SyncManager::ReplicateRigidBodyChanges(UserConnection* user)
 {
     URHO3D_PROFILE(SyncManager_ReplicateRigidBodyChanges);
     
-    ScenePtr scene = scene_.Lock();
+    deferredRigidBodyChanges_.Clear();
+    SceneSyncState* state = user->syncState.Get();
+    ScenePtr scene = state->ParentScene().Lock();
     if (!scene)
         return;
 
     const int maxMessageSizeBytes = 1400;
     kNet::DataSerializer ds(maxMessageSizeBytes);
     bool msgReliable = false;
-    SceneSyncState* state = user->syncState.Get();
+    // Unreliable updates are not ordered with the SceneChanged message, so tag them with the scene for clients that can change scenes
+    const bool sendSceneId = user->ProtocolVersion() >= ProtocolMultiScene;
+    if (sendSceneId)
+        ds.AddVLE<kNet::VLE8_16_32>(state->sceneId);
+    const size_t headerBits = ds.BitsFilled();
 
-    /// \todo In interest management mode, this doesn't skip entities that shouldn't be updated according to their priority-based interval
     for (std::list<EntitySyncState*>::iterator it = state->dirtyQueue.begin(); it != state->dirtyQueue.end(); ++it)
     {
         const int maxRigidBodyMessageSizeBits = 350; // An update for a single rigid body can take at most this many bits. (conservative bound)
@@ -1077,6 +1670,8 @@ void SyncManager::ReplicateRigidBodyChanges(UserConnection* user)
         {
             user->Send(cRigidBodyUpdateMessage, msgReliable, true, ds);
             ds = kNet::DataSerializer(maxMessageSizeBytes);
+            if (sendSceneId)
+                ds.AddVLE<kNet::VLE8_16_32>(state->sceneId);
             msgReliable = false;
         }
 
@@ -1092,18 +1687,26 @@ void SyncManager::ReplicateRigidBodyChanges(UserConnection* user)
 
         std::map<component_id_t, ComponentSyncState>::iterator placeableComp = ess.components.find(placeable->Id());
 
-        bool transformDirty = false;
+        // The dirty bits are cleared below, so that the generic sync will not replicate the changes.
+        // Changes that are not sent now are restored after the generic sync, see RestoreDeferredRigidBodyChanges.
+        DeferredRigidBodyChange change;
+        change.entityId = ess.id;
+        change.placeableId = placeable->Id();
+        change.rigidBodyId = 0;
+        change.dirtyBits[0] = change.dirtyBits[1] = 0;
         if (placeableComp != ess.components.end())
         {
             ComponentSyncState &pss = placeableComp->second;
             if (!pss.isNew && !pss.removed) // Newly created and deleted components are handled through the traditional sync mechanism.
             {
-                transformDirty = (pss.dirtyAttributes[0] & 1) != 0; // The Transform of an EC_Placeable is the first attibute in the component.
+                change.dirtyBits[0] = pss.dirtyAttributes[0] & 1; // The Transform of an EC_Placeable is the first attibute in the component.
                 pss.dirtyAttributes[0] &= ~1;
             }
         }
+        bool transformDirty = change.dirtyBits[0] != 0;
         bool velocityDirty = false;
         bool angularVelocityDirty = false;
+        bool enteredRest = false;
         
         SharedPtr<RigidBody> rigidBody = e->Component<RigidBody>();
         if (rigidBody)
@@ -1117,24 +1720,17 @@ void SyncManager::ReplicateRigidBodyChanges(UserConnection* user)
                     velocityDirty = (rss.dirtyAttributes[1] & (1 << 5)) != 0;
                     angularVelocityDirty = (rss.dirtyAttributes[1] & (1 << 6)) != 0;
 
+                    change.rigidBodyId = rigidBody->Id();
+                    change.dirtyBits[1] = rss.dirtyAttributes[1] & ((1 << 5) | (1 << 6));
                     rss.dirtyAttributes[1] &= ~(1 << 5);
                     rss.dirtyAttributes[1] &= ~(1 << 6);
 
-                    velocityDirty = velocityDirty && (rigidBody->linearVelocity.Get().DistanceSq(ess.linearVelocity) >= 1e-2f);
-                    angularVelocityDirty = angularVelocityDirty && (rigidBody->angularVelocity.Get().DistanceSq(ess.angularVelocity) >= 1e-1f);
-
                     // If the object enters rest, force an update, and force the update to be sent as reliable, so that the client
                     // is guaranteed to receive the message, and will put the object to rest, instead of extrapolating it away indefinitely.
                     if (rigidBody->linearVelocity.Get().IsZero(1e-4f) && !ess.linearVelocity.IsZero(1e-4f))
-                    {
-                        velocityDirty = true;
-                        msgReliable = true;
-                    }
+                        enteredRest = true;
                     if (rigidBody->angularVelocity.Get().IsZero(1e-4f) && !ess.angularVelocity.IsZero(1e-4f))
-                    {
-                        angularVelocityDirty = true;
-                        msgReliable = true;
-                    }
+                        enteredRest = true;
                 }
             }
         }
@@ -1143,16 +1739,49 @@ void SyncManager::ReplicateRigidBodyChanges(UserConnection* user)
             continue;
 
         const Transform &t = placeable->transform.Get();
+        const float3 &linearVel = rigidBody ? rigidBody->linearVelocity.Get() : float3::zero;
+        const float3 angVel = rigidBody ? DegToRad(rigidBody->angularVelocity.Get()) : float3::zero;
+        const float timeSinceLastSend = kNet::Clock::SecondsSinceF(ess.lastNetworkSendTime);
+
+        // Distant and low priority bodies are updated at their prioritized interval and tolerate proportionally more error.
+        float errorScale = 1.f;
+        if (prioritizer_ && ess.priority >= 0.f && ess.relevancy >= 0.f)
+        {
+            const float interval = ess.ComputePrioritizedUpdateInterval(updatePeriod_);
+            if (!enteredRest && timeSinceLastSend < interval)
+            {
+                deferredRigidBodyChanges_.Push(change);
+                continue;
+            }
+            errorScale = Min(interval / updatePeriod_, cMaxRigidBodyErrorScale);
+        }
+
+        // Model what the client shows: it extrapolates the last sent position with the last sent linear velocity
+        // (Newtonian bodies only) and keeps the last sent orientation. The velocity difference is projected over
+        // the next sync update, so that collisions and other sudden changes are sent without waiting for the error to grow.
+        const bool isNewtonian = rigidBody && rigidBody->mass.Get() > 0;
+        const float3 predictedClientSidePosition = isNewtonian ? ess.transform.pos + timeSinceLastSend * ess.linearVelocity : ess.transform.pos;
+        const float posError = t.pos.Distance(predictedClientSidePosition) + linearVel.Distance(ess.linearVelocity) * updatePeriod_;
+        const float rotError = RadToDeg(t.Orientation().AngleBetween(ess.transform.Orientation()) + angVel.Distance(ess.angularVelocity) * updatePeriod_);
+
+        const bool scaleChanged = transformDirty && (t.scale.DistanceSq(ess.transform.scale) > 1e-3f);
+        const bool errorExceeded = posError > rigidBodyPosErrorThreshold_ * errorScale || rotError > rigidBodyRotErrorThreshold_ * errorScale;
+        // Correct residual error below the threshold once in a while, so that the client does not stay off indefinitely.
+        const bool refresh = timeSinceLastSend >= EntitySyncState::MinUpdateRate && (posError > 1e-3f || rotError > 1e-1f);
+        if (!enteredRest && !errorExceeded && !refresh && !scaleChanged)
+        {
+            // Keep the change queued, so that it is sent once the error grows or at the next refresh
+            deferredRigidBodyChanges_.Push(change);
+            continue;
+        }
+        if (enteredRest)
+            msgReliable = true;
 
-        float timeSinceLastSend = kNet::Clock::SecondsSinceF(ess.lastNetworkSendTime);
-        const float3 predictedClientSidePosition = ess.transform.pos + timeSinceLastSend * ess.linearVelocity;
-        float error = t.pos.DistanceSq(predictedClientSidePosition);
-        UNREFERENCED_PARAM(error)
-        // TEST: To have the server estimate how far the client has simulated, use this.
-//        bool posChanged = transformDirty && (timeSinceLastSend > 0.2f || t.pos.DistanceSq(/*ess.transform.pos*/ predictedClientSidePosition) > 5e-5f);
-        bool posChanged = transformDirty && t.pos.DistanceSq(ess.transform.pos) > 1e-3f;
-        bool rotChanged = transformDirty && (t.rot.DistanceSq(ess.transform.rot) > 1e-1f);
-        bool scaleChanged = transformDirty && (t.scale.DistanceSq(ess.transform.scale) > 1e-3f);
+        // Rebase the client's model on the current state: send everything that differs from what was last sent.
+        bool posChanged = t.pos.DistanceSq(ess.transform.pos) > 1e-6f;
+        bool rotChanged = t.rot.DistanceSq(ess.transform.rot) > 1e-3f;
+        velocityDirty = linearVel.DistanceSq(ess.linearVelocity) > 1e-4f;
+        angularVelocityDirty = angVel.DistanceSq(ess.angularVelocity) > 1e-4f;
 
         // Detect whether to send compact or full states for each variable.
         int posSendType = DetectPosSendType(posChanged, t.pos);
@@ -1172,9 +1801,6 @@ void SyncManager::ReplicateRigidBodyChanges(UserConnection* user)
         else
             scaleSendType = 0;
 
-        const float3 &linearVel = rigidBody ? rigidBody->linearVelocity.Get() : float3::zero;
-        const float3 angVel = rigidBody ? DegToRad(rigidBody->angularVelocity.Get()) : float3::zero;
-
         velSendType = velocityDirty ? (linearVel.LengthSq() >= 64.f ? 2 : 1) : 0;
         angVelSendType = angularVelocityDirty ? 1 : 0;
 
@@ -1243,13 +1869,31 @@ void SyncManager::ReplicateRigidBodyChanges(UserConnection* user)
         UNREFERENCED_PARAM(bitsEnd)
         ess.lastNetworkSendTime = kNet::Clock::Tick();
     }
-    if (ds.BytesFilled() > 0)
+    if (ds.BitsFilled() > headerBits)
         user->Send(cRigidBodyUpdateMessage, msgReliable, true, ds);
 }
 
+void SyncManager::RestoreDeferredRigidBodyChanges(UserConnection* user)
+{
+    SceneSyncState* state = user->syncState.Get();
+    for(uint i = 0; i < deferredRigidBodyChanges_.Size(); ++i)
+    {
+        const DeferredRigidBodyChange &change = deferredRigidBodyChanges_[i];
+        std::map<entity_id_t, EntitySyncState>::const_iterator ess = state->entities.find(change.entityId);
+        if (ess == state->entities.end() || ess->second.removed)
+            continue;
+        if (change.dirtyBits[0])
+            state->MarkAttributeDirty(change.entityId, change.placeableId, 0);
+        for(u8 j = 0; j < 8; ++j)
+            if (change.dirtyBits[1] & (1 << j))
+                state->MarkAttributeDirty(change.entityId, change.rigidBodyId, 8 + j);
+    }
+    deferredRigidBodyChanges_.Clear();
+}
+
 void SyncManager::HandleRigidBodyChanges(UserConnection* source, kNet::packet_id_t packetId, const char* data, size_t numBytes)
 {
-    ScenePtr scene = scene_.Lock();
+    ScenePtr scene = SourceScene(source);
     if (!scene)
         return;
 
@@ -1259,6 +1903,12 @@ void SyncManager::HandleRigidBodyChanges(UserConnection* source, kNet::packet_id
         return;
 
     kNet::DataDeserializer dd(data, numBytes);
+    if (source->ProtocolVersion() >= ProtocolMultiScene)
+    {
+        u32 sceneID = dd.ReadVLE<kNet::VLE8_16_32>();
+        if (!IsCurrentScene(state, sceneID))
+            return;
+    }
     while(dd.BitsLeft() >= 9)
     {
         u32 entityID = dd.ReadVLE<kNet::VLE8_16_32>();
@@ -1439,7 +2089,7 @@ void SyncManager::HandleEditEntityProperties(UserConnection* source, const char*
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding EditEntityProperties message");
@@ -1451,8 +2101,9 @@ void SyncManager::HandleEditEntityProperties(UserConnection* source, const char*
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     
     if (!ValidateAction(source, cEditEntityPropertiesMessage, entityID))
@@ -1481,7 +2132,7 @@ void SyncManager::HandleSetEntityParent(UserConnection* source, const char* data
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding SetEntityParent message");
@@ -1493,8 +2144,9 @@ void SyncManager::HandleSetEntityParent(UserConnection* source, const char* data
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.Read<u32>();
     entity_id_t parentEntityID = ds.Read<u32>();
     
@@ -1592,14 +2244,72 @@ void SyncManager::HandleRegisterComponentType(UserConnection* source, const char
     componentTypeSender_ = 0;
 }
 
+void SyncManager::HandleRegisterPrefab(UserConnection* source, const char* data, size_t numBytes)
+{
+    assert(source);
+
+    // Only the server sends prefabs
+    if (owner_->IsServer())
+    {
+        LogWarning("SyncManager::HandleRegisterPrefab: received a prefab from a client, disregarding.");
+        return;
+    }
+
+    SceneSyncState* state = source->syncState.Get();
+    ScenePtr scene = SourceScene(source);
+    if (!scene || !state)
+    {
+        LogWarning("Null scene or sync state, disregarding RegisterPrefab message");
+        return;
+    }
+
+    kNet::DataDeserializer ds(data, numBytes);
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
+    String name = String(ds.ReadString().c_str());
+
+    Entity::ComponentVector prototypes;
+    unsigned numComponents = ds.ReadVLE<kNet::VLE8_16_32>();
+    for(uint i = 0; i < numComponents; ++i)
+    {
+        ds.ReadVLE<kNet::VLE8_16_32>(); // Prototypes are not in the scene, the component ID is not used
+        u32 typeID = ds.ReadVLE<kNet::VLE8_16_32>();
+        String compName = String(ds.ReadString().c_str());
+        unsigned attrDataSize = ds.ReadVLE<kNet::VLE8_16_32>();
+        if (attrDataSize > NUMELEMS(attrDataBuffer_))
+        {
+            LogError("SyncManager::HandleRegisterPrefab: Attribute data size " + String(attrDataSize) + " bytes is bigger than the destination buffer of " +
+                String(NUMELEMS(attrDataBuffer_)) + " bytes in prefab \"" + name + "\". Prefab will be ignored!");
+            return;
+        }
+        ds.ReadArray<u8>((u8*)&attrDataBuffer_[0], attrDataSize);
+        kNet::DataDeserializer attrDs(attrDataBuffer_, attrDataSize);
+
+        ComponentPtr prototype = framework_->Scene()->CreateComponentById(scene.Get(), typeID, compName);
+        if (!prototype)
+        {
+            LogWarning("Failed to create component type " + String(typeID) + " for prefab \"" + name + "\", skipping component");
+            continue;
+        }
+        prototype->SetReplicated(true);
+        ReadComponentFullUpdate(prototype.Get(), attrDs, AttributeChange::Disconnected);
+        prototypes.Push(prototype);
+    }
+
+    scene->RegisterPrefab(name, prototypes, false, false);
+}
+
 void SyncManager::ProcessSyncState(UserConnection* user)
 {
     URHO3D_PROFILE(SyncManager_ProcessSyncState);
     
-    ScenePtr scene = scene_.Lock();
     bool isServer = owner_->IsServer();
 
     SceneSyncState* state = user->syncState.Get();
+    ScenePtr scene = state->ParentScene().Lock();
+    if (!scene)
+        return;
     
     // Send knowledge of registered placeholder components to the remote peer
     if (user->ProtocolVersion() >= ProtocolCustomComponents && state->NeedSendPlaceholderComponents())
@@ -1614,6 +2324,25 @@ void SyncManager::ProcessSyncState(UserConnection* user)
         state->MarkPlaceholderComponentsSent();
     }
 
+    // Timestamp the update for client snapshot interpolation. Sent while there are changes, and once after them,
+    // so that the client knows that the values it last received are final and not just late.
+    if (isServer && user->ProtocolVersion() >= ProtocolSyncTick)
+    {
+        const bool hasChanges = !state->dirtyQueue.empty();
+        if (hasChanges || state->syncTickSent)
+        {
+            kNet::DataSerializer ds(removeEntityBuffer_, NUMELEMS(removeEntityBuffer_));
+            ds.AddVLE<kNet::VLE8_16_32>(syncTick_);
+            ds.Add<u32>((u32)(kNet::Clock::SecondsSinceD(syncStartTime_) * 1000.0));
+            user->Send(cSyncTickMessage, true, true, ds);
+        }
+        state->syncTickSent = hasChanges;
+    }
+
+    // Acknowledge the entity inputs processed since the last update
+    if (isServer && !state->pendingInputAcks.empty())
+        SendEntityInputAcks(user, state);
+
     // Process the state's dirty entity queue.
     /// \todo Limit and prioritize the data sent. For now the whole queue is processed, regardless of whether the connection is being saturated.
    // Interest management sync priorization performed only on the server
@@ -1643,15 +2372,49 @@ void SyncManager::ProcessSyncState(UserConnection* user)
     if (state->queuedActions.size())
     {
         for (size_t i = 0; i < state->queuedActions.size(); ++i)
-            user->Send(state->queuedActions[i]);
+        {
+            const QueuedMessage *action = state->queuedActions[i].Get();
+            user->Send(action->id, action->data.Size() ? &action->data[0] : 0, action->data.Size(), action->reliable, action->inOrder);
+        }
 
         state->queuedActions.clear();
     }
 }
 
+void SyncManager::SendEntityInputAcks(UserConnection* user, SceneSyncState* state)
+{
+    for(std::map<entity_id_t, u32>::const_iterator i = state->pendingInputAcks.begin(); i != state->pendingInputAcks.end(); ++i)
+    {
+        EntityPredictor *predictor = Predictor(i->first);
+        if (!predictor || !predictor->ParentEntity())
+            continue;
+
+        const Vector<AttributeWeakPtr> &attributes = predictor->PredictedAttributes();
+        kNet::DataSerializer ds(attrDataBuffer_, NUMELEMS(attrDataBuffer_));
+        ds.Add<u32>(i->first);
+        ds.Add<u32>(i->second);
+        uint numAttrs = 0;
+        for(uint j = 0; j < attributes.Size(); ++j)
+            if (attributes[j].Get())
+                ++numAttrs;
+        ds.AddVLE<kNet::VLE8_16_32>(numAttrs);
+        for(uint j = 0; j < attributes.Size(); ++j)
+        {
+            IAttribute *attr = attributes[j].Get();
+            if (!attr)
+                continue;
+            ds.AddVLE<kNet::VLE8_16_32>(attr->Owner()->Id());
+            ds.Add<u8>(attr->Index());
+            attr->ToBinary(ds);
+        }
+        user->Send(cEntityInputAckMessage, true, true, ds);
+    }
+    state->pendingInputAcks.clear();
+}
+
 void SyncManager::ProcessEntitySyncState(bool isServer, UserConnection* user, Scene *scene, SceneSyncState *sceneState, EntitySyncState* entityState)
 {
-    unsigned sceneId = 0;       /// @todo Replace with proper scene ID once multiscene support is in place.
+    const unsigned sceneId = sceneState->sceneId;
     bool removeState = false;
 
     EntityPtr entity = entityState->weak.Lock();
@@ -1722,6 +2485,13 @@ void SyncManager::ProcessEntitySyncState(bool isServer, UserConnection* user, Sc
             }
         }
         
+        // Send the prefab of a prefab instance first, so that only the attributes that differ from it need to be sent.
+        // Must be done prior to below code using the createEntityBuffer_.
+        String prefabName;
+        if (isServer && user->ProtocolVersion() >= ProtocolPrefabs && !entity->PrefabName().Empty() &&
+            !scene->IsPrefabLocal(entity->PrefabName()) && SendPrefab(user, scene, sceneState, entity->PrefabName()))
+            prefabName = entity->PrefabName();
+
         kNet::DataSerializer ds(createEntityBuffer_, NUMELEMS(createEntityBuffer_));
         
         // Entity identification and temporary flag
@@ -1737,6 +2507,9 @@ void SyncManager::ProcessEntitySyncState(bool isServer, UserConnection* user, Sc
 
             ds.Add<u32>(entity->Parent() ? entity->Parent()->Id() : 0);
         }
+        // If prefabs are supported, send the prefab name or an empty string if the components are sent in full
+        if (user->ProtocolVersion() >= ProtocolPrefabs)
+            ds.AddString(prefabName.CString());
         
         const Entity::ComponentMap& components = entity->Components();
         // Count the amount of replicated components
@@ -1755,10 +2528,24 @@ void SyncManager::ProcessEntitySyncState(bool isServer, UserConnection* user, Sc
             ComponentPtr comp = i->second_;
             if (!comp->IsReplicated())
                 continue;
-            if (bufferValid && !WriteComponentFullUpdate(ds, comp))
+            if (bufferValid)
             {
-                bufferValid = false;
-                ds.ResetFill();
+                // Components of a prefab instance are preceded by a flag telling whether only the attributes that differ from the prefab follow
+                IComponent *prototype = 0;
+                if (!prefabName.Empty())
+                {
+                    if (!comp->SupportsDynamicAttributes())
+                        prototype = scene->PrefabComponent(prefabName, comp->TypeId(), comp->Name());
+                    // Only replicated prototypes were sent with the prefab
+                    if (prototype && !prototype->IsReplicated())
+                        prototype = 0;
+                    ds.Add<u8>(prototype ? 1 : 0);
+                }
+                if (!(prototype ? WritePrefabComponentUpdate(ds, comp, prototype) : WriteComponentFullUpdate(ds, comp)))
+                {
+                    bufferValid = false;
+                    ds.ResetFill();
+                }
             }
             // Mark the component undirty in the receiver's syncstate
             sceneState->MarkComponentProcessed(entity->Id(), comp->Id());
@@ -2097,7 +2884,7 @@ void SyncManager::SendObserverPosition(UserConnection *connection, SceneSyncStat
             const size_t maxDataSize = sizeof(uint) + 1 + 6 * sizeof(float); /** <@todo use scene_id_t instead of uint when available */
             char dataBuffer[maxDataSize];
             kNet::DataSerializer ds(dataBuffer, maxDataSize);
-            ds.AddVLE<kNet::VLE8_16_32>((uint)0/*scene->Id()*/);/** <@todo Use proper scene ID when available */
+            ds.AddVLE<kNet::VLE8_16_32>(senderState->sceneId);
 
             // Detect whether to send compact or full states for each variable.
             int posSendType = DetectPosSendType(posChanged, pos);
@@ -2122,7 +2909,8 @@ void SyncManager::HandleObserverPosition(UserConnection* source, const char* dat
 
     kNet::DataDeserializer dd(data, numBytes);
     uint sceneId = dd.ReadVLE<kNet::VLE8_16_32>(); /**< @todo scene_id_t */
-    UNREFERENCED_PARAM(sceneId) /**< @todo Scene lookup, when multi-scene support is in place. */
+    if (!IsCurrentScene(syncState, sceneId))
+        return;
 
     int posSendType;
     int rotSendType;
@@ -2132,12 +2920,150 @@ void SyncManager::HandleObserverPosition(UserConnection* source, const char* dat
     Quat rot = Quat::identity;
     ReadOptimizedPosAndRot(dd, posSendType, pos, rotSendType, rot);
 
-    // Save observer information always, but compute priorities only on fixed interval.
+    // Save observer information always. The prioritizer schedules a recompute if the observer moved significantly,
+    // and carries it out in bounded steps on the following sync updates.
     if (posSendType)
         syncState->observerPos = pos;
     if (rotSendType)
         syncState->observerRot = RadToDeg(rot.ToEulerZYX());
-    /// @todo if (posSendType || rotSendType) -> notify current prioritizer that new observer position is available
+    if (prioritizer_ && (posSendType || rotSendType))
+        prioritizer_->ObserverUpdated(*syncState);
+}
+
+void SyncManager::HandleSyncTick(UserConnection* source, const char* data, size_t numBytes)
+{
+    if (owner_->IsServer())
+    {
+        LogWarning("Client " + String(source->ConnectionId()) + " sent a SyncTick message, disregarding");
+        return;
+    }
+    ScenePtr scene = SourceScene(source);
+    if (!scene)
+        return;
+
+    kNet::DataDeserializer dd(data, numBytes);
+    syncTick_ = dd.ReadVLE<kNet::VLE8_16_32>();
+    serverSyncTime_ = dd.Read<u32>() / 1000.0;
+    // The scene sync messages of this update follow, stamped with this time
+    if (snapshotInterpolation_)
+        scene->UpdateSnapshotClock(serverSyncTime_);
+}
+
+void SyncManager::HandleSceneChanged(UserConnection* source, const char* data, size_t numBytes)
+{
+    if (owner_->IsServer())
+    {
+        LogWarning("Client " + String(source->ConnectionId()) + " sent a SceneChanged message, disregarding");
+        return;
+    }
+    SceneSyncState* state = source->syncState.Get();
+    ScenePtr scene = SourceScene(source);
+    if (!scene || !state)
+        return;
+
+    kNet::DataDeserializer dd(data, numBytes);
+    u32 sceneId = dd.ReadVLE<kNet::VLE8_16_32>();
+
+    // The server syncs the new scene from scratch, like on a reconnect
+    scene->RemoveAllEntities(true, AttributeChange::LocalOnly);
+    state->Clear();
+    state->sceneId = sceneId;
+    predictors_.Clear();
+}
+
+void SyncManager::HandleEntityInput(UserConnection* source, const char* data, size_t numBytes)
+{
+    if (!owner_->IsServer())
+    {
+        LogWarning("Server sent an EntityInput message, disregarding");
+        return;
+    }
+    SceneSyncState* state = source->syncState.Get();
+    ScenePtr scene = SourceScene(source);
+    if (!scene || !state)
+        return;
+
+    kNet::DataDeserializer dd(data, numBytes);
+    entity_id_t entityID = dd.Read<u32>();
+    PredictionInput input;
+    input.sequence = dd.Read<u32>();
+    input.timeStep = dd.Read<float>();
+    uint dataSize = dd.ReadVLE<kNet::VLE8_16_32>();
+    if (dataSize > dd.BytesLeft())
+        throw kNet::NetException("Malformed EntityInput message");
+    input.data.Resize(dataSize);
+    if (dataSize)
+        dd.ReadArray<u8>(&input.data[0], dataSize);
+
+    if (!ValidateAction(source, cEntityInputMessage, entityID))
+        return;
+    EntityPredictor *predictor = Predictor(entityID);
+    Entity *entity = predictor ? predictor->ParentEntity() : 0;
+    if (!entity || entity->ParentScene() != scene.Get())
+    {
+        LogWarning("Entity " + String(entityID) + " is not predicted, disregarding EntityInput message");
+        return;
+    }
+    if (!scene->AllowModifyEntity(source, entity))
+        return;
+
+    // Only the controlling connection drives the entity. The first connection to send input claims it if no controller is set.
+    u32 &controller = entityControllers_[entityID];
+    if (!controller)
+        controller = source->ConnectionId();
+    else if (controller != source->ConnectionId())
+    {
+        LogWarning("Client " + String(source->ConnectionId()) + " is not the controller of entity " + String(entityID) + ", disregarding EntityInput message");
+        return;
+    }
+
+    // Sequence numbers are per client, so track them in the connection's sync state instead of the shared predictor.
+    // Inputs older than the last processed one are ignored.
+    u32 &lastProcessed = state->processedInputs[entityID];
+    if (input.sequence <= lastProcessed)
+        return;
+    lastProcessed = input.sequence;
+
+    // Do not let the client dictate arbitrarily long simulation steps
+    input.timeStep = Clamp(input.timeStep, 0.f, 1.f);
+    predictor->ApplyInput(input, AttributeChange::Default);
+    state->pendingInputAcks[entityID] = input.sequence;
+}
+
+void SyncManager::HandleEntityInputAck(UserConnection* source, const char* data, size_t numBytes)
+{
+    if (owner_->IsServer())
+    {
+        LogWarning("Client " + String(source->ConnectionId()) + " sent an EntityInputAck message, disregarding");
+        return;
+    }
+
+    kNet::DataDeserializer dd(data, numBytes);
+    entity_id_t entityID = dd.Read<u32>();
+    u32 sequence = dd.Read<u32>();
+    EntityPredictor *predictor = Predictor(entityID);
+    Entity *entity = predictor ? predictor->ParentEntity() : 0;
+    if (!entity)
+        return; // Predictor removed while the input was in flight
+
+    uint numAttrs = dd.ReadVLE<kNet::VLE8_16_32>();
+    for(uint i = 0; i < numAttrs; ++i)
+    {
+        component_id_t compID = dd.ReadVLE<kNet::VLE8_16_32>();
+        u8 attrIndex = dd.Read<u8>();
+        ComponentPtr comp = entity->ComponentById(compID);
+        IAttribute *attr = (comp && attrIndex < comp->Attributes().Size()) ? comp->Attributes()[attrIndex] : 0;
+        if (!attr)
+        {
+            // The rest of the values can not be parsed without knowing the attribute type
+            LogWarning("Nonexistent attribute in EntityInputAck message for entity " + String(entityID) + ", disregarding");
+            return;
+        }
+        IAttribute *value = attr->Clone();
+        value->FromBinary(dd, AttributeChange::Disconnected);
+        predictor->SetAuthoritativeValue(attr, value);
+    }
+    predictor->Acknowledge(sequence);
 }
 
 void SyncManager::HandleCreateEntity(UserConnection* source, const char* data, size_t numBytes)
@@ -2146,7 +3072,7 @@ void SyncManager::HandleCreateEntity(UserConnection* source, const char* data, s
     
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding CreateEntity message");
@@ -2161,7 +3087,9 @@ void SyncManager::HandleCreateEntity(UserConnection* source, const char* data, s
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     entity_id_t senderEntityID = entityID;
     
@@ -2204,6 +3132,7 @@ void SyncManager::HandleCreateEntity(UserConnection* source, const char* data, s
     std::vector<std::pair<component_id_t, component_id_t> > componentIdRewrites;
 
     entity_id_t parentEntityID = 0;
+    String prefabName;
 
     try
     {    
@@ -2234,10 +3163,17 @@ void SyncManager::HandleCreateEntity(UserConnection* source, const char* data, s
             }
         }
 
+        // In prefab protocol, read the prefab name. The prefab has been received before its first instance
+        if (source->ProtocolVersion() >= ProtocolPrefabs)
+            prefabName = String(ds.ReadString().c_str());
+        if (!prefabName.Empty() && !scene->HasPrefab(prefabName))
+            LogWarning("SyncManager::HandleCreateEntity: unknown prefab \"" + prefabName + "\" for entity " + String(entityID) + ".");
+
         // Read the components
         unsigned numComponents = ds.ReadVLE<kNet::VLE8_16_32>();
         for(uint i = 0; i < numComponents; ++i)
         {
+            bool prefabDelta = (!prefabName.Empty() && ds.Read<u8>() != 0);
             component_id_t compID = ds.ReadVLE<kNet::VLE8_16_32>();
             component_id_t senderCompID = compID;
             // If we are server, rewrite the ID
@@ -2283,51 +3219,10 @@ void SyncManager::HandleCreateEntity(UserConnection* source, const char* data, s
             // Create the component to the sender's syncstate, then mark it processed (undirty)
             state->MarkComponentProcessed(entityID, compID);
             
-            // Fill static attributes
-            unsigned numStaticAttrs = comp->NumStaticAttributes();
-            const AttributeVector& attrs = comp->Attributes();
-            for (uint j = 0; j < numStaticAttrs; ++j)
-            {
-                // Allow component version mismatches (adding more attributes to the end of static attributes list), break if no more data present.
-                // All attributes (including bool) are at least 8 bits.
-                if (attrDs.BitsLeft() >= 8)
-                    attrs[j]->FromBinary(attrDs, AttributeChange::Disconnected);
-                else
-                {
-                    if (mismatchingComponentTypes.find(comp->TypeId()) == mismatchingComponentTypes.end())
-                    {
-                        mismatchingComponentTypes.insert(comp->TypeId());
-                        LogWarning("Not enough static attribute data in component " + comp->TypeName() + " (version mismatch).");
-                    }
-                    break;
-                }
-            }
-
-            if (comp->SupportsDynamicAttributes())
-            {
-                // Create any dynamic attributes
-                while (attrDs.BitsLeft() > 2 * 8)
-                {
-                    u8 index = attrDs.Read<u8>();
-                    u8 typeId = attrDs.Read<u8>();
-                    String attrName = String(attrDs.ReadString().c_str());
-                    IAttribute* newAttr = comp->CreateAttribute(index, typeId, attrName, change);
-                    if (!newAttr)
-                    {
-                        LogWarning("Failed to create dynamic attribute. Skipping rest of the attributes for this component.");
-                        break;
-                    }
-                    newAttr->FromBinary(attrDs, AttributeChange::Disconnected);
-                }
-            }
-            else if (attrDs.BitsLeft())
-            {
-                if (mismatchingComponentTypes.find(comp->TypeId()) == mismatchingComponentTypes.end())
-                {
-                    mismatchingComponentTypes.insert(comp->TypeId());
-                    LogWarning("Extra static attribute data in component " + comp->TypeName() + " (version mismatch).");
-                }
-            }
+            if (prefabDelta)
+                ReadPrefabComponentUpdate(comp.Get(), scene->PrefabComponent(prefabName, typeID, compName), attrDs);
+            else
+                ReadComponentFullUpdate(comp.Get(), attrDs, change);
         }
     }
     catch(kNet::NetException &/*e*/)
@@ -2338,6 +3233,9 @@ void SyncManager::HandleCreateEntity(UserConnection* source, const char* data, s
         throw; // Propagate the exception up, to handle a peer which is sending us bad protocol bits.
     }
     
+    if (scene->HasPrefab(prefabName))
+        entity->SetPrefabName(prefabName);
+
     // Emit the component changes last, to signal only a coherent state of the whole entity
     scene->EmitEntityCreated(entity.Get(), change);
     const Entity::ComponentMap &components = entity->Components();
@@ -2369,7 +3267,7 @@ void SyncManager::HandleCreateComponents(UserConnection* source, const char* dat
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding CreateComponents message");
@@ -2390,7 +3288,9 @@ void SyncManager::HandleCreateComponents(UserConnection* source, const char* dat
     try
     {
         kNet::DataDeserializer ds(data, numBytes);
-        sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
+        sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+        if (!IsCurrentScene(state, sceneID))
+            return;
         entityID = ds.ReadVLE<kNet::VLE8_16_32>();
         
         if (!ValidateAction(source, cCreateComponentsMessage, entityID))
@@ -2455,51 +3355,7 @@ void SyncManager::HandleCreateComponents(UserConnection* source, const char* dat
             
             addedComponents.push_back(comp);
             
-            // Fill static attributes
-            unsigned numStaticAttrs = comp->NumStaticAttributes();
-            const AttributeVector& attrs = comp->Attributes();
-            for (uint i = 0; i < numStaticAttrs; ++i)
-            {
-                // Allow component version mismatches (adding more attributes to the end of static attributes list), break if no more data present.
-                // All attributes (including bool) are at least 8 bits.
-                if (attrDs.BitsLeft() >= 8)
-                    attrs[i]->FromBinary(attrDs, AttributeChange::Disconnected);
-                else
-                {
-                    if (mismatchingComponentTypes.find(comp->TypeId()) == mismatchingComponentTypes.end())
-                    {
-                        mismatchingComponentTypes.insert(comp->TypeId());
-                        LogWarning("Not enough static attribute data in component " + comp->TypeName() + " (version mismatch).");
-                    }
-                    break;
-                }
-            }
-            
-            if (comp->SupportsDynamicAttributes())
-            {
-                // Create any dynamic attributes
-                while (attrDs.BitsLeft() > 2 * 8)
-                {
-                    u8 index = attrDs.Read<u8>();
-                    u8 typeId = attrDs.Read<u8>();
-                    String attrName = String(attrDs.ReadString().c_str());
-                    IAttribute* newAttr = comp->CreateAttribute(index, typeId, attrName, change);
-                    if (!newAttr)
-                    {
-                        LogWarning("Failed to create dynamic attribute. Skipping rest of the attributes for this component.");
-                        break;
-                    }
-                    newAttr->FromBinary(attrDs, AttributeChange::Disconnected);
-                }
-            }
-            else if (attrDs.BitsLeft())
-            {
-                if (mismatchingComponentTypes.find(comp->TypeId()) == mismatchingComponentTypes.end())
-                {
-                    mismatchingComponentTypes.insert(comp->TypeId());
-                    LogWarning("Extra static attribute data in component " + comp->TypeName() + " (version mismatch).");
-                }
-            }
+            ReadComponentFullUpdate(comp.Get(), attrDs, change);
         }
     } catch(kNet::NetException &/*e*/)
     {
@@ -2535,7 +3391,7 @@ void SyncManager::HandleRemoveEntity(UserConnection* source, const char* data, s
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding RemoveEntity message");
@@ -2547,8 +3403,9 @@ void SyncManager::HandleRemoveEntity(UserConnection* source, const char* data, s
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     
     if (!ValidateAction(source, cRemoveEntityMessage, entityID))
@@ -2576,7 +3433,7 @@ void SyncManager::HandleRemoveComponents(UserConnection* source, const char* dat
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding RemoveComponents message");
@@ -2588,8 +3445,9 @@ void SyncManager::HandleRemoveComponents(UserConnection* source, const char* dat
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     
     if (!ValidateAction(source, cRemoveComponentsMessage, entityID))
@@ -2626,7 +3484,7 @@ void SyncManager::HandleCreateAttributes(UserConnection* source, const char* dat
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding CreateAttributes message");
@@ -2638,8 +3496,9 @@ void SyncManager::HandleCreateAttributes(UserConnection* source, const char* dat
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     
     if (!ValidateAction(source, cCreateAttributesMessage, entityID))
@@ -2721,7 +3580,7 @@ void SyncManager::HandleRemoveAttributes(UserConnection* source, const char* dat
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding RemoveAttributes message");
@@ -2733,8 +3592,9 @@ void SyncManager::HandleRemoveAttributes(UserConnection* source, const char* dat
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     
     if (!ValidateAction(source, cRemoveAttributesMessage, entityID))
@@ -2774,7 +3634,7 @@ void SyncManager::HandleEditAttributes(UserConnection* source, const char* data,
     assert(source);
     // Get matching syncstate for reflecting the changes
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding EditAttributes message");
@@ -2786,8 +3646,9 @@ void SyncManager::HandleEditAttributes(UserConnection* source, const char* data,
     AttributeChange::Type change = isServer ? AttributeChange::Replicate : AttributeChange::LocalOnly;
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     
     if (!ValidateAction(source, cRemoveAttributesMessage, entityID))
@@ -2814,6 +3675,10 @@ void SyncManager::HandleEditAttributes(UserConnection* source, const char* data,
     }
     // Add a fudge factor in case there is jitter in packet receipt or the server is too taxed
     updateInterval *= 1.25f;
+    // Buffer the values by server time if the server timestamps its updates
+    const bool useSnapshots = !isServer && snapshotInterpolation_ && serverSyncTime_ >= 0.0;
+    // Predicted attributes are reconciled from the input acknowledgements instead
+    EntityPredictor *predictor = isServer ? 0 : Predictor(entityID);
 
     std::vector<IAttribute*> changedAttrs;
     while (ds.BitsLeft() >= 8)
@@ -2860,6 +3725,11 @@ void SyncManager::HandleEditAttributes(UserConnection* source, const char* data,
                     LogWarning("Nonexistent attribute in EditAttributes message, skipping to next component");
                     break;
                 }
+                if (predictor && predictor->IsPredicted(attr))
+                {
+                    SkipAttributeValue(attr, attrDs);
+                    continue;
+                }
                 
                 bool interpolate = (!isServer && attr->Metadata() && attr->Metadata()->interpolation == AttributeMetadata::Interpolate);
                 if (!interpolate)
@@ -2871,7 +3741,10 @@ void SyncManager::HandleEditAttributes(UserConnection* source, const char* data,
                 {
                     IAttribute* endValue = attr->Clone();
                     endValue->FromBinary(attrDs, AttributeChange::Disconnected);
-                    scene->StartAttributeInterpolation(attr, endValue, updateInterval);
+                    if (useSnapshots)
+                        scene->PushAttributeSnapshot(attr, endValue, serverSyncTime_);
+                    else
+                        scene->StartAttributeInterpolation(attr, endValue, updateInterval);
                 }
             }
         }
@@ -2893,6 +3766,11 @@ void SyncManager::HandleEditAttributes(UserConnection* source, const char* data,
                         LogWarning("Nonexistent attribute in EditAttributes message, skipping to next component");
                         break;
                     }
+                    if (predictor && predictor->IsPredicted(attr))
+                    {
+                        SkipAttributeValue(attr, attrDs);
+                        continue;
+                    }
                     bool interpolate = (!isServer && attr->Metadata() && attr->Metadata()->interpolation == AttributeMetadata::Interpolate);
                     if (!interpolate)
                     {
@@ -2903,7 +3781,10 @@ void SyncManager::HandleEditAttributes(UserConnection* source, const char* data,
                     {
                         IAttribute* endValue = attr->Clone();
                         endValue->FromBinary(attrDs, AttributeChange::Disconnected);
-                        scene->StartAttributeInterpolation(attr, endValue, updateInterval);
+                        if (useSnapshots)
+                            scene->PushAttributeSnapshot(attr, endValue, serverSyncTime_);
+                        else
+                            scene->StartAttributeInterpolation(attr, endValue, updateInterval);
                     }
                 }
             }
@@ -2926,7 +3807,7 @@ void SyncManager::HandleCreateEntityReply(UserConnection* source, const char* da
 {
     assert(source);
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding CreateEntityReply message");
@@ -2941,8 +3822,9 @@ void SyncManager::HandleCreateEntityReply(UserConnection* source, const char* da
     }
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
 
     entity_id_t senderEntityID = ds.ReadVLE<kNet::VLE8_16_32>() | UniqueIdGenerator::FIRST_UNACKED_ID;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
@@ -2994,7 +3876,7 @@ void SyncManager::HandleCreateComponentsReply(UserConnection* source, const char
 {
     assert(source);
     SceneSyncState* state = source->syncState.Get();
-    ScenePtr scene = GetRegisteredScene();
+    ScenePtr scene = SourceScene(source);
     if (!scene || !state)
     {
         LogWarning("Null scene or sync state, disregarding CreateComponentsReply message");
@@ -3009,8 +3891,9 @@ void SyncManager::HandleCreateComponentsReply(UserConnection* source, const char
     }
     
     kNet::DataDeserializer ds(data, numBytes);
-    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>(); ///\todo Dummy ID. Lookup scene once multiscene is properly supported
-    UNREFERENCED_PARAM(sceneID)
+    unsigned sceneID = ds.ReadVLE<kNet::VLE8_16_32>();
+    if (!IsCurrentScene(state, sceneID))
+        return;
     entity_id_t entityID = ds.ReadVLE<kNet::VLE8_16_32>();
     state->RemoveFromQueue(entityID); // Make sure we don't have stale pointers in the dirty queue
     
@@ -3047,22 +3930,44 @@ void SyncManager::HandleCreateComponentsReply(UserConnection* source, const char
     }
 }
 
-void SyncManager::HandleEntityAction(UserConnection* source, MsgEntityAction& msg)
+void SyncManager::HandleEntityAction(UserConnection* source, const char* data, size_t numBytes)
 {
     bool isServer = owner_->IsServer();
-    
-    ScenePtr scene = GetRegisteredScene();
+
+    // Read the action name and parameters directly from the message data.
+    // Layout matches MsgEntityAction: u32 entityId, u8 name length, name, u8 executionType, u8 parameter count,
+    // and for each parameter VLE length followed by the parameter.
+    kNet::DataDeserializer dd(data, numBytes);
+    const entity_id_t entityId = dd.Read<u32>();
+    const uint nameLength = dd.Read<u8>();
+    if (nameLength > dd.BytesLeft())
+        throw kNet::NetException("Malformed EntityAction message");
+    String action(data + dd.BytePos(), nameLength);
+    dd.SkipBytes(nameLength);
+    const uint executionTypePos = dd.BytePos();
+    const EntityAction::ExecTypeField type = (EntityAction::ExecTypeField)dd.Read<u8>();
+    const uint numParams = dd.Read<u8>();
+    StringVector params(numParams);
+    for(uint i = 0; i < numParams; ++i)
+    {
+        const uint paramLength = dd.ReadVLE<kNet::VLE8_16_32>();
+        if (paramLength > dd.BytesLeft())
+            throw kNet::NetException("Malformed EntityAction message");
+        params[i] = String(data + dd.BytePos(), paramLength);
+        dd.SkipBytes(paramLength);
+    }
+
+    ScenePtr scene = SourceScene(source);
     if (!scene)
     {
-        LogWarning("SyncManager: Ignoring received MsgEntityAction \"" + String(msg.name.size() == 0 ? "(null)" : std::string((const char *)&msg.name[0], msg.name.size()).c_str()) + "\" (" + String(msg.parameters.size()) + " parameters) for entity ID " + String(msg.entityId) + " as no scene exists!");
+        LogWarning("SyncManager: Ignoring received MsgEntityAction \"" + (action.Empty() ? String("(null)") : action) + "\" (" + String(numParams) + " parameters) for entity ID " + String(entityId) + " as no scene exists!");
         return;
     }
     
-    entity_id_t entityId = msg.entityId;
     EntityPtr entity = scene->EntityById(entityId);
     if (!entity)
     {
-        LogWarning("Entity with ID " + String(entityId) + " not found for EntityAction message \"" + String(msg.name.size() == 0 ? "(null)" : std::string((const char *)&msg.name[0], msg.name.size()).c_str()) + "\" (" + String(msg.parameters.size()) + " parameters).");
+        LogWarning("Entity with ID " + String(entityId) + " not found for EntityAction message \"" + (action.Empty() ? String("(null)") : action) + "\" (" + String(numParams) + " parameters).");
         return;
     }
 
@@ -3075,13 +3980,6 @@ void SyncManager::HandleEntityAction(UserConnection* source, MsgEntityAction& ms
             server->SetActionSender(source);
         }
     }
-    
-    String action = String(BufferToString(msg.name));
-    StringVector params;
-    for(uint i = 0; i < msg.parameters.size(); ++i)
-        params.Push(String(BufferToString(msg.parameters[i].parameter)));
-
-    EntityAction::ExecTypeField type = (EntityAction::ExecTypeField)(msg.executionType);
 
     bool handled = false;
 
@@ -3094,10 +3992,13 @@ void SyncManager::HandleEntityAction(UserConnection* source, MsgEntityAction& ms
     // If execution type is Peers, replicate to all peers but the sender.
     if (isServer && (type & EntityAction::Peers) != 0)
     {
-        msg.executionType = (u8)EntityAction::Local;
-        foreach(UserConnectionPtr userConn, owner_->Server()->UserConnections())
-            if (userConn.Get() != source) // The EC action will not be sent to the machine that originated the request to send an action to all peers.
-                userConn->syncState->queuedActions.push_back(msg);
+        // Share the received payload between all peers, only the execution type needs to change.
+        QueuedMessagePtr peerAction(new QueuedMessage(MsgEntityAction::messageID, MsgEntityAction::defaultReliable, MsgEntityAction::defaultInOrder));
+        peerAction->data.Resize((uint)numBytes);
+        memcpy(&peerAction->data[0], data, numBytes);
+        peerAction->data[executionTypePos] = (char)EntityAction::Local;
+        // The EC action will not be sent to the machine that originated the request to send an action to all peers.
+        QueueEntityAction(peerAction, entity.Get(), source);
         handled = true;
     }
     
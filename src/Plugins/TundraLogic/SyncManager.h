@@ -15,6 +15,7 @@
 #include "AttributeChangeType.h"
 #include "EntityAction.h"
 #include "EntityPrioritizer.h"
+#include "EntityPredictor.h"
 
 #include <Urho3D/Core/Object.h>
 
@@ -33,13 +34,97 @@ public:
     ~SyncManager();
     
     /// Register to entity/component change signals from a specific scene and start syncing them
+    /** This is the default scene, with ID 0, that new users are replicated. Additional scenes registered with
+        RegisterAdditionalScene are unregistered, and the users that were replicated them are moved to this scene. */
     void RegisterToScene(ScenePtr scene);
+
+    /// Register an additional scene to be replicated independently of the default scene (server operation only)
+    /** Each user is replicated one scene at a time, see AssignUserToScene.
+        @return ID of the scene, or 0 if the scene could not be registered. */
+    u32 RegisterAdditionalScene(ScenePtr scene);
+
+    /// Stop replicating an additional scene. Its users are moved to the default scene (server operation only)
+    void UnregisterAdditionalScene(u32 sceneId);
+
+    /// Returns a registered scene by ID, or null if not found. ID 0 is the default scene.
+    ScenePtr RegisteredScene(u32 sceneId) const;
+
+    /// Returns the IDs of the registered scenes, including the default scene.
+    Vector<u32> RegisteredSceneIds() const;
+
+    /// Move a user to be replicated another registered scene (server operation only)
+    /** The client is told to clear its scene, after which the new scene is synced to it from scratch.
+        Requires a client of ProtocolMultiScene or newer, unless moving to the scene the user already is in.
+        @return True if the user is now in the scene. */
+    bool AssignUserToScene(UserConnection *user, u32 sceneId);
     
     /// Accumulate time & send pending sync messages if enough time passed from last update
     void Update(float frametime);
     
     /// Create new replication state for user and dirty it (server operation only)
-    void NewUserConnected(const UserConnectionPtr &user);
+    /** If the user presented a valid resume token (UserConnection::resumeToken) of a recently disconnected session
+        and has received all of its reliable sync messages, the parked sync state is reattached instead.
+        In both cases a fresh resume token is assigned to the user.
+        @return True if a previous session was resumed, false if a full scene sync will be performed. */
+    bool NewUserConnected(const UserConnectionPtr &user);
+
+    /// Park the replication state of a disconnecting user so that the session can be resumed on reconnect (server operation only)
+    void UserDisconnected(UserConnection *user);
+
+    /// Set how long (seconds) the sync state of a disconnected user is kept for session resume. 0 disables session resume.
+    void SetResumeTimeout(float seconds);
+
+    /// Returns session resume timeout (seconds).
+    float ResumeTimeout() const { return resumeTimeout_; }
+
+    /// Enable or disable buffered snapshot interpolation of attributes on the client, enabled by default.
+    /** When enabled and the server timestamps its updates (ProtocolSyncTick), interpolated attributes are buffered
+        with Scene::PushAttributeSnapshot and rendered with an adaptive delay. Otherwise Scene::StartAttributeInterpolation is used. */
+    void SetSnapshotInterpolationEnabled(bool enabled) { snapshotInterpolation_ = enabled; }
+
+    /// Is buffered snapshot interpolation enabled.
+    bool IsSnapshotInterpolationEnabled() const { return snapshotInterpolation_; }
+
+    /// Sets the error tolerated in the client's extrapolation of a rigid body before the server sends an update.
+    /** The server models the position and orientation the client extrapolates from the last sent state, and sends
+        rigid body updates only when the error exceeds these thresholds. With interest management the thresholds
+        are scaled up for distant and low priority bodies.
+        @param position Position error in world units, default 0.03.
+        @param rotation Orientation error in degrees, default 2. */
+    void SetRigidBodyErrorThresholds(float position, float rotation);
+
+    /// Returns the tolerated rigid body position error in world units.
+    float RigidBodyPositionErrorThreshold() const { return rigidBodyPosErrorThreshold_; }
+
+    /// Returns the tolerated rigid body orientation error in degrees.
+    float RigidBodyRotationErrorThreshold() const { return rigidBodyRotErrorThreshold_; }
+
+    /// Returns the number of the latest sync update: sent by the server (server), or received from the server (client).
+    u32 SyncTick() const { return syncTick_; }
+
+    /// Sets the predictor of an entity. Takes ownership, a possible existing predictor of the entity is replaced.
+    /** On the client, inputs given to PredictEntityInput are applied locally and sent to the server, and the predicted attributes
+        are reconciled when the server acknowledges the inputs. On the server, the inputs received for the entity are applied
+        with the predictor and acknowledged to the sender. Use the same predictor implementation on both ends. */
+    void SetEntityPredictor(EntityPredictor *predictor);
+
+    /// Removes the predictor of an entity.
+    void RemoveEntityPredictor(entity_id_t id);
+
+    /// Returns the predictor of an entity, or null if the entity is not predicted.
+    EntityPredictor *Predictor(entity_id_t id) const;
+
+    /// Sets the connection whose inputs drive a predicted entity (server operation only).
+    /** Inputs from other connections are disregarded. If no controller is set, the first connection that sends an input
+        for the entity becomes its controller until it disconnects. 0 clears the controller. */
+    void SetEntityController(entity_id_t id, u32 connectionId);
+
+    /// Returns the connection ID whose inputs drive a predicted entity, or 0 if none (server operation only).
+    u32 EntityController(entity_id_t id) const;
+
+    /// Applies an input to a predicted entity and sends it to the server (client operation only).
+    /** @return True if the input was applied and sent, false if the entity has no predictor or the server does not support prediction. */
+    bool PredictEntityInput(entity_id_t id, const PODVector<u8> &data, float timeStep);
 
     /// Set update period (seconds)
     void SetUpdatePeriod(float period);
@@ -82,7 +167,8 @@ public:
     EntityPrioritizer *Prioritizer() const { return prioritizer_; }
 
     // signals
-    /// This signal is emitted when a new user connects and a new SceneSyncState is created for the connection.
+    /// This signal is emitted when a new user connects and a new SceneSyncState is created for the connection,
+    /// or the SceneSyncState of a resumed session is handed to the reconnected user.
     /// @note See signals of the SceneSyncState object to build prioritization logic how the sync state is filled.
     Signal2<UserConnection* ARG(user), SceneSyncState* ARG(state)> SceneStateCreated;
     
@@ -129,8 +215,15 @@ private:
 private:
     /// Craft a component full update, with all static and dynamic attributes.
     bool WriteComponentFullUpdate(kNet::DataSerializer& ds, ComponentPtr comp);
+    /// Craft a component update of a prefab instance, with only the static attributes that differ from the prefab @c prototype.
+    bool WritePrefabComponentUpdate(kNet::DataSerializer& ds, ComponentPtr comp, IComponent* prototype);
+    /// Send the prefab @c name to the user, unless its current registration has already been sent. Called on the server.
+    /** @return False if the prefab is not registered or could not be serialized, in which case its instances must be sent in full. */
+    bool SendPrefab(UserConnection* user, Scene* scene, SceneSyncState* sceneState, const String& name);
     /// Handle entity action message.
-    void HandleEntityAction(UserConnection* source, MsgEntityAction& msg);
+    void HandleEntityAction(UserConnection* source, const char* data, size_t numBytes);
+    /// Queue a serialized entity action of @c entity to all authenticated users in its scene except @c exclude. Called on the server.
+    void QueueEntityAction(const QueuedMessagePtr &action, Entity *entity, UserConnection *exclude);
     /// Handle create entity message.
     void HandleCreateEntity(UserConnection* source, const char* data, size_t numBytes);
     /// Handle create components message.
@@ -155,12 +248,26 @@ private:
     void HandleEditEntityProperties(UserConnection* source, const char* data, size_t numBytes);
     /// Handle component type registration message.
     void HandleRegisterComponentType(UserConnection* source, const char* data, size_t numBytes);
+    /// Handle prefab registration message.
+    void HandleRegisterPrefab(UserConnection* source, const char* data, size_t numBytes);
     /// Handle entity parent change message.
     void HandleSetEntityParent(UserConnection* source, const char* data, size_t numBytes);
+    /// Handle sync tick message.
+    void HandleSyncTick(UserConnection* source, const char* data, size_t numBytes);
+    /// Handle scene changed message.
+    void HandleSceneChanged(UserConnection* source, const char* data, size_t numBytes);
+    /// Handle entity input message.
+    void HandleEntityInput(UserConnection* source, const char* data, size_t numBytes);
+    /// Handle entity input acknowledgement message.
+    void HandleEntityInputAck(UserConnection* source, const char* data, size_t numBytes);
+    /// Send acknowledgements of the processed entity inputs together with the resulting predicted attribute values. Called on the server.
+    void SendEntityInputAcks(UserConnection* user, SceneSyncState* state);
 
     void HandleRigidBodyChanges(UserConnection* source, kNet::packet_id_t packetId, const char* data, size_t numBytes);
     
     void ReplicateRigidBodyChanges(UserConnection* user);
+    /// Re-dirty the rigid body changes that ReplicateRigidBodyChanges skipped, after the generic sync has been processed. Called on the server.
+    void RestoreDeferredRigidBodyChanges(UserConnection* user);
 
     void InterpolateRigidBodies(float frametime, SceneSyncState* state);
 
@@ -187,6 +294,17 @@ private:
     
     ScenePtr GetRegisteredScene() const { return scene_.Lock(); }
 
+    /// Returns the scene that the messages of @c source concern: the scene of its sync state, or the default scene if it has none yet.
+    ScenePtr SourceScene(UserConnection* source) const;
+
+    /// Connect to the change signals of a scene.
+    void ConnectToScene(Scene* scene);
+    /// Disconnect from the change signals of a scene.
+    void DisconnectFromScene(Scene* scene);
+
+    /// Create a fresh replication state of @c scene for the user and dirty all its entities (server operation only)
+    void ResetUserSyncState(UserConnection* user, const ScenePtr &scene, u32 sceneId);
+
     /// @remark Interest management.
     void HandleObserverPosition(UserConnection* source, const char* data, size_t numBytes);
     /// Sends client's observer information. @remark Interest management
@@ -200,6 +318,10 @@ private:
     
     /// Scene pointer
     SceneWeakPtr scene_;
+    /// Additional scenes by ID. Server only.
+    HashMap<u32, SceneWeakPtr> additionalScenes_;
+    /// ID for the next additional scene.
+    u32 nextSceneId_;
     
     /// Time period for update, default 1/30th of a second
     float updatePeriod_;
@@ -241,6 +363,50 @@ private:
     EntityWeakPtr observer_;
     /// @remark Interest management
     EntityPrioritizer *prioritizer_;
+
+    /// Sync state of a disconnected user, kept for session resume.
+    struct ResumableSession
+    {
+        SharedPtr<SceneSyncState> state;
+        /// Number of scene state messages sent to the user during the session.
+        u32 messagesSent;
+        kNet::tick_t disconnectTime;
+    };
+    typedef HashMap<String, ResumableSession> ResumableSessionMap;
+    /// Parked sessions by resume token. Kept up to date with scene changes like the sync states of connected users.
+    ResumableSessionMap parkedSessions_;
+    /// Time in seconds a parked session is kept, default 30.
+    float resumeTimeout_;
+
+    /// Sync update number, see SyncTick().
+    u32 syncTick_;
+    /// Server: start time of the sync update timestamps.
+    kNet::tick_t syncStartTime_;
+    /// Client: server time in seconds of the latest received sync update, negative if not received.
+    double serverSyncTime_;
+    /// Client: snapshot interpolation -flag.
+    bool snapshotInterpolation_;
+    /// Server: tolerated rigid body position error, see SetRigidBodyErrorThresholds.
+    float rigidBodyPosErrorThreshold_;
+    /// Server: tolerated rigid body orientation error in degrees, see SetRigidBodyErrorThresholds.
+    float rigidBodyRotErrorThreshold_;
+
+    /// Rigid body change that was not sent yet and is kept dirty for the next update.
+    struct DeferredRigidBodyChange
+    {
+        entity_id_t entityId;
+        component_id_t placeableId;
+        component_id_t rigidBodyId;
+        /// Dirty bits of the Placeable transform (first byte) and the RigidBody velocities (second byte).
+        u8 dirtyBits[2];
+    };
+    /// Server: rigid body changes of the user being processed that were skipped by ReplicateRigidBodyChanges.
+    PODVector<DeferredRigidBodyChange> deferredRigidBodyChanges_;
+
+    /// Entity predictors by entity ID.
+    HashMap<entity_id_t, EntityPredictorPtr> predictors_;
+    /// Server: connection IDs whose inputs drive the predicted entities, by entity ID.
+    HashMap<entity_id_t, u32> entityControllers_;
 };
 
 }
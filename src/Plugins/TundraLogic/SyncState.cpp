@@ -29,12 +29,18 @@ StateChangeRequest::StateChangeRequest(u32 connectionID) :
 
 
 SceneSyncState::SceneSyncState(u32 userConnectionID, bool isServer) :
+    sceneId(0),
     userConnectionID_(userConnectionID),
     changeRequest_(userConnectionID),
     isServer_(isServer),
     placeholderComponentsSent_(false),
     observerPos(float3::nan),
-    observerRot(float3::nan)
+    observerRot(float3::nan),
+    prioritizedObserverPos(float3::nan),
+    prioritizedObserverRot(float3::nan),
+    priorityCursor(0),
+    priorityRecomputePending(false),
+    syncTickSent(false)
 {
     Clear();
 }
@@ -167,6 +173,12 @@ void SceneSyncState::Clear()
     changeRequest_.Reset();
     scene_.Reset();
     placeholderComponentsSent_ = false;
+    priorityCursor = 0;
+    priorityRecomputePending = false;
+    syncTickSent = false;
+    pendingInputAcks.clear();
+    processedInputs.clear();
+    sentPrefabs.Clear();
 }
 
 void SceneSyncState::RemoveFromQueue(entity_id_t id)
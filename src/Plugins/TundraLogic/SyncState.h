@@ -31,6 +31,23 @@ namespace Tundra
 
 class SceneSyncState;
 
+/// Serialized network message that can be queued to several users without copying the payload.
+struct QueuedMessage : public RefCounted
+{
+    QueuedMessage(kNet::message_id_t messageId, bool reliableMessage, bool inOrderMessage) :
+        id(messageId),
+        reliable(reliableMessage),
+        inOrder(inOrderMessage)
+    {
+    }
+
+    kNet::message_id_t id; ///< Message ID.
+    bool reliable; ///< Reliable-flag.
+    bool inOrder; ///< In order-flag.
+    PODVector<char> data; ///< Serialized message content.
+};
+typedef SharedPtr<QueuedMessage> QueuedMessagePtr;
+
 /// Component's per-user network sync state
 struct ComponentSyncState
 {
@@ -87,7 +104,8 @@ struct EntitySyncState
         id(0),
         avgUpdateInterval(0.0f),
         priority(-1.f),
-        relevancy(-1.f)
+        relevancy(-1.f),
+        prioritizedPos(float3::nan)
     {
     }
     
@@ -221,6 +239,9 @@ struct EntitySyncState
         Used to determinate the prioritized update interval of the entity together with priority.
         @remark Interest management */
     float relevancy;
+
+    /// World position of the entity when its priority was last computed, if spatial. @remark Interest management
+    float3 prioritizedPos;
 };
 
 struct RigidBodyInterpolationState
@@ -284,6 +305,7 @@ public:
     bool Rejected()                         { return !accepted_; }
 
     u32 ConnectionID()                      { return connectionID_; }
+    void SetConnectionID(u32 connectionID)  { connectionID_ = connectionID; }
 
     entity_id_t EntityId()                  { return entityId_; }
     Entity* GetEntity()                     { return entity_; }
@@ -306,6 +328,9 @@ public:
     explicit SceneSyncState(u32 userConnectionID = 0, bool isServer = false);
     virtual ~SceneSyncState();
 
+    /// ID of the replicated scene, written to and expected in the scene sync messages. 0 for the default scene.
+    u32 sceneId;
+
     /// Entity sync states
     EntitySyncStateMap entities; 
 
@@ -318,7 +343,8 @@ public:
     std::map<entity_id_t, RigidBodyInterpolationState> entityInterpolations;
 
     /// Queued EntityAction messages. These will be sent to the user on the next network update tick.
-    std::vector<MsgEntityAction> queuedActions;
+    /** Broadcast actions are serialized once and the payload is shared between the queues of all recipients. */
+    std::vector<QueuedMessagePtr> queuedActions;
 
     /// Last sent (client) or received (server) observer position in world coordinates.
     /** If !IsFinite() ObserverPosition message has not been been received from the client. */
@@ -327,6 +353,25 @@ public:
     /** If !IsFinite() ObserverPosition message has not been been received from the client. */
     float3 observerRot;
 
+    /// Observer position used by the latest full priority recompute. @remark Interest management
+    float3 prioritizedObserverPos;
+    /// Observer orientation used by the latest full priority recompute. @remark Interest management
+    float3 prioritizedObserverRot;
+    /// Entity ID from which the ongoing full priority recompute continues. @remark Interest management
+    entity_id_t priorityCursor;
+    /// Whether a full priority recompute is scheduled or in progress. @remark Interest management
+    bool priorityRecomputePending;
+    /// Whether a SyncTick message was sent on the previous sync update. Server only.
+    bool syncTickSent;
+
+    /// Sequence numbers of the latest processed inputs by predicted entity ID, to be acknowledged on the next sync update. Server only.
+    std::map<entity_id_t, u32> pendingInputAcks;
+    /// Sequence numbers of the latest inputs applied from this connection by predicted entity ID. Server only.
+    std::map<entity_id_t, u32> processedInputs;
+
+    /// Revisions of the prefabs sent to the client by prefab name, see Scene::PrefabRevision. Server only.
+    Urho3D::HashMap<String, uint> sentPrefabs;
+
     // signals
 
     /// This signal is emitted when a entity is being added to the client sync state.
@@ -367,8 +412,17 @@ public:
 
 public:
     void SetParentScene(SceneWeakPtr scene);
+    /// Returns the replicated scene.
+    SceneWeakPtr ParentScene() const { return scene_; }
     void Clear();
 
+    /// Sets the ID of the user connection this state belongs to. Used when a session is resumed on a new connection.
+    void SetUserConnectionId(u32 userConnectionID)
+    {
+        userConnectionID_ = userConnectionID;
+        changeRequest_.SetConnectionID(userConnectionID);
+    }
+
     /// Gets or creates a new entity sync state.
     /** If a new state is created it will get initialized with id and EntityWeakPtr. */
     EntitySyncState &GetOrCreateEntitySyncState(entity_id_t id);
@@ -17,7 +17,9 @@
 #include "LoggingFunctions.h"
 
 #include "AssetAPI.h"
+#include "AssetPrefetchManifest.h"
 #include "IAsset.h"
+#include "IAssetTransfer.h"
 
 #include "LocalAssetProvider.h"
 #include "LocalAssetStorage.h"
@@ -61,6 +63,10 @@ void TundraLogic::Initialize()
 
     framework->Console()->RegisterCommand("disconnect", "Disconnects from a server.", client_.Get(), &Client::Logout);
 
+    framework->Console()->RegisterCommand("savePrefetchManifest", "Writes the assets of the current scene and their dependencies to a prefetch manifest file, "
+        "to be advertised to clients with --prefetchmanifest. Usage: savePrefetchManifest(filename)")->ExecutedWith.Connect(
+        this, &TundraLogic::HandleSavePrefetchManifest);
+
     kristalliProtocol_->Initialize();
 
     // Load startup parameters once we are running.
@@ -211,6 +217,44 @@ void TundraLogic::StartupSceneLoaded(AssetPtr sceneAsset)
     sceneAsset->Unload();
 }
 
+void TundraLogic::HandleSavePrefetchManifest(const StringVector &params)
+{
+    if (params.Empty() || params[0].Trimmed().Empty())
+    {
+        LogError("savePrefetchManifest: No filename given. Usage: savePrefetchManifest(filename)");
+        return;
+    }
+    Scene *scene = framework->Scene()->MainCameraScene();
+    if (!scene)
+    {
+        LogError("savePrefetchManifest: No scene to generate the manifest from.");
+        return;
+    }
+
+    AssetPrefetchManifest manifest = AssetPrefetchManifest::FromScene(scene);
+    String json = manifest.ToJSON();
+    String filename = params[0].Trimmed();
+    if (SaveAssetFromMemoryToFile(reinterpret_cast<const u8*>(json.CString()), json.Length(), filename))
+        LogInfo(Urho3D::ToString("savePrefetchManifest: Wrote %d assets, %llu bytes total, to %s", manifest.entries.Size(), manifest.TotalSize(), filename.CString()));
+    else
+        LogError("savePrefetchManifest: Failed to write " + filename);
+}
+
+void TundraLogic::PrefetchManifestLoaded(AssetPtr manifestAsset)
+{
+    Vector<u8> data = manifestAsset->RawData();
+    manifestAsset->Unload();
+
+    AssetPrefetchManifest manifest;
+    if (data.Empty() || !manifest.FromJSON(String(reinterpret_cast<const char*>(&data[0]), data.Size())))
+    {
+        LogError("TundraLogic: Failed to read prefetch manifest " + manifestAsset->Name());
+        return;
+    }
+    uint numRequested = framework->Asset()->PrefetchAssets(manifest);
+    LogInfo(Urho3D::ToString("Prefetching %d assets from manifest %s", numRequested, manifestAsset->Name().CString()));
+}
+
 bool TundraLogic::LoadScene(String filename, bool clearScene, bool useEntityIDsFromFile)
 {
     filename = filename.Trimmed();
@@ -297,6 +341,16 @@ void TundraLogic::ClientConnectedToServer(UserConnectedResponseData *responseDat
                 if (defaultStoragePtr)
                     framework->Asset()->SetDefaultAssetStorage(defaultStoragePtr);
             }
+
+            // Request everything the scene needs up front, if the server advertises a prefetch manifest.
+            // Requested after the storages are set up as the manifest ref may be relative to the default storage.
+            Urho3D::XMLElement prefetch = root.GetChild("prefetch");
+            if (prefetch && !prefetch.GetAttribute("ref").Trimmed().Empty())
+            {
+                AssetTransferPtr transfer = framework->Asset()->RequestAsset(prefetch.GetAttribute("ref").Trimmed(), "Binary", true);
+                if (transfer)
+                    transfer->Succeeded.Connect(this, &TundraLogic::PrefetchManifestLoaded);
+            }
         }
     }
 }
@@ -356,6 +410,15 @@ void TundraLogic::ServerNewUserConnected(u32 /*connectionID*/, UserConnection *c
     storageData["type"] = defaultStorage->Type();
     storageData["src"] = defaultStorage->BaseURL();
     responseData->responseDataJson["storage"] = storageData;
+
+    // Advertise the prefetch manifest of the scene, if one is given.
+    StringVector prefetchManifest = framework->CommandLineParameters("--prefetchmanifest");
+    if (!prefetchManifest.Empty() && !prefetchManifest.Front().Trimmed().Empty())
+    {
+        Urho3D::XMLElement prefetch = assetRoot.CreateChild("prefetch");
+        prefetch.SetAttribute("ref", prefetchManifest.Front().Trimmed());
+        responseData->responseDataJson["prefetch"] = prefetchManifest.Front().Trimmed();
+    }
 }
 
 void TundraLogic::DetermineStorageTrustStatus(AssetStoragePtr storage)
@@ -41,6 +41,10 @@ public:
     /// For console command
     void HandleLogin(const StringVector &params) const;
 
+    /// For console command. Writes the prefetch manifest of the main camera scene to the file given in @c params.
+    /** @see AssetPrefetchManifest::FromScene. */
+    void HandleSavePrefetchManifest(const StringVector &params);
+
 private:
     void Load() override;
     void Initialize() override;
@@ -61,6 +65,9 @@ private:
     /// Handle startup scene asset being loaded
     void StartupSceneLoaded(AssetPtr sceneAsset);
 
+    /// Handle the prefetch manifest advertised by the server being loaded. Requests all the assets in it.
+    void PrefetchManifestLoaded(AssetPtr manifestAsset);
+
     /// Handle client connection to server. Add asset storages advertised by the server.
     void ClientConnectedToServer(UserConnectedResponseData *responseData);
 
@@ -3,6 +3,12 @@
 #include "StableHeaders.h"
 #include "TundraLogicUtils.h"
 
+#include <kNet/DataDeserializer.h>
+#include <kNet/DataSerializer.h>
+#include <kNet/NetException.h>
+
+#include <Urho3D/Resource/XMLFile.h>
+
 namespace Tundra
 {
 
@@ -23,4 +29,94 @@ String BufferToString(const std::vector<s8>& buffer)
         return String();
 }
 
+std::vector<s8> SerializeLoginProperties(const LoginPropertyMap& properties)
+{
+    // Compute the exact size first so that the serializer never runs out of space
+    size_t size = 1 + kNet::VLE8_16_32::GetEncodedBitLength(properties.Size()) / 8;
+    Vector<String> values;
+    values.Reserve(properties.Size());
+    for(LoginPropertyMap::ConstIterator iter = properties.Begin(); iter != properties.End(); ++iter)
+    {
+        values.Push(iter->second_.ToString());
+        size += kNet::VLE8_16_32::GetEncodedBitLength(iter->first_.Length()) / 8 + iter->first_.Length();
+        size += kNet::VLE8_16_32::GetEncodedBitLength(values.Back().Length()) / 8 + values.Back().Length();
+    }
+
+    std::vector<s8> ret(size);
+    kNet::DataSerializer ds((char*)&ret[0], ret.size());
+    ds.Add<s8>(cBinaryLoginMarker);
+    ds.AddVLE<kNet::VLE8_16_32>(properties.Size());
+    uint i = 0;
+    for(LoginPropertyMap::ConstIterator iter = properties.Begin(); iter != properties.End(); ++iter, ++i)
+    {
+        ds.AddVLE<kNet::VLE8_16_32>(iter->first_.Length());
+        if (iter->first_.Length())
+            ds.AddArray<s8>((const s8*)iter->first_.CString(), iter->first_.Length());
+        ds.AddVLE<kNet::VLE8_16_32>(values[i].Length());
+        if (values[i].Length())
+            ds.AddArray<s8>((const s8*)values[i].CString(), values[i].Length());
+    }
+    return ret;
+}
+
+bool IsBinaryLoginData(const char* data, size_t numBytes)
+{
+    return numBytes > 0 && data[0] == cBinaryLoginMarker;
+}
+
+bool DeserializeLoginProperties(const char* data, size_t numBytes, LoginPropertyMap& properties)
+{
+    if (!IsBinaryLoginData(data, numBytes))
+        return false;
+
+    try
+    {
+        kNet::DataDeserializer dd(data, numBytes);
+        dd.SkipBytes(1);
+        const u32 count = dd.ReadVLE<kNet::VLE8_16_32>();
+        for(u32 i = 0; i < count; ++i)
+        {
+            const u32 keyLength = dd.ReadVLE<kNet::VLE8_16_32>();
+            if (keyLength > dd.BytesLeft())
+                return false;
+            String key(data + dd.BytePos(), keyLength);
+            dd.SkipBytes(keyLength);
+
+            const u32 valueLength = dd.ReadVLE<kNet::VLE8_16_32>();
+            if (valueLength > dd.BytesLeft())
+                return false;
+            properties[key] = String(data + dd.BytePos(), valueLength);
+            dd.SkipBytes(valueLength);
+        }
+    }
+    catch(kNet::NetException &/*e*/)
+    {
+        return false;
+    }
+    return true;
+}
+
+bool DeserializeLoginData(Urho3D::Context* context, const std::vector<s8>& loginData, LoginPropertyMap& properties, String& loginXml)
+{
+    const char *data = loginData.size() ? (const char*)&loginData[0] : 0;
+    if (IsBinaryLoginData(data, loginData.size()))
+    {
+        loginXml.Clear();
+        return DeserializeLoginProperties(data, loginData.size(), properties);
+    }
+
+    loginXml = BufferToString(loginData);
+    Urho3D::XMLFile xml(context);
+    if (!xml.FromString(loginXml))
+        return false;
+
+    Urho3D::XMLElement keyvalueElem = xml.GetRoot().GetChild();
+    while(keyvalueElem)
+    {
+        properties[keyvalueElem.GetName()] = keyvalueElem.GetAttribute("value");
+        keyvalueElem = keyvalueElem.GetNext();
+    }
+    return true;
+}
+
 }
@@ -3,13 +3,41 @@
 #pragma once
 
 #include "CoreTypes.h"
+#include "TundraLogicFwd.h"
+#include "TundraLogicApi.h"
 #include <vector>
 
+namespace Urho3D
+{
+    class Context;
+}
+
 namespace Tundra
 {
 
-std::vector<s8> StringToBuffer(const String& str);
+/// First byte of login data in the binary login format. XML login data never starts with it.
+const s8 cBinaryLoginMarker = 0;
+
+TUNDRALOGIC_API std::vector<s8> StringToBuffer(const String& str);
+
+TUNDRALOGIC_API String BufferToString(const std::vector<s8>& buffer);
+
+/// Encodes login properties in the compact binary login format used from ProtocolBinaryLogin onwards.
+/** Layout: cBinaryLoginMarker, VLE property count, and for each property VLE key length, key, VLE value length, value.
+    Values are sent as strings, like in the XML login format. */
+TUNDRALOGIC_API std::vector<s8> SerializeLoginProperties(const LoginPropertyMap& properties);
+
+/// Returns whether login data is in the binary login format, ie. starts with cBinaryLoginMarker.
+TUNDRALOGIC_API bool IsBinaryLoginData(const char* data, size_t numBytes);
+
+/// Decodes login properties in the binary login format. Returns false if the data is malformed.
+/** Does not touch the Urho3D context, so it is safe to call from worker threads. */
+TUNDRALOGIC_API bool DeserializeLoginProperties(const char* data, size_t numBytes, LoginPropertyMap& properties);
 
-String BufferToString(const std::vector<s8>& buffer);
+/// Decodes the login data of a login message, in either the binary or the XML format. Returns false if the data is malformed.
+/** The format is detected from the data itself, as a client that supports the binary format still sends XML
+    until a server has accepted its protocol version.
+    @param loginXml Receives the raw XML login data, or an empty string for the binary format. */
+TUNDRALOGIC_API bool DeserializeLoginData(Urho3D::Context* context, const std::vector<s8>& loginData, LoginPropertyMap& properties, String& loginXml);
 
 }
\ No newline at end of file
@@ -45,6 +45,27 @@ const unsigned long cRegisterComponentTypeMessage = 123;
 // Entity parenting
 const unsigned long cSetEntityParentMessage = 124;
 
+// Server sync update timestamp, precedes the scene sync messages of the update. Server->client only
+const unsigned long cSyncTickMessage = 125;
+
+// Client prediction
+const unsigned long cEntityInputMessage = 126; // Client->server only
+const unsigned long cEntityInputAckMessage = 127; // Server->client only
+
+// The user has been moved to another scene on the server and should clear its scene. Server->client only
+const unsigned long cSceneChangedMessage = 128;
+
+// Prefab definition, sent once per client before the first instance of the prefab is created. Server->client only
+const unsigned long cRegisterPrefabMessage = 129;
+
+/// Returns whether a message changes the receiver's copy of the scene. These are always sent reliably and in order,
+/// and both ends of a connection count them for verifying that a resumed session has not missed any.
+inline bool IsSceneStateMessage(unsigned long id)
+{
+    return (id >= cEditEntityPropertiesMessage && id <= cCreateComponentsReplyMessage) ||
+        id == cRegisterComponentTypeMessage || id == cSetEntityParentMessage || id == cSceneChangedMessage || id == cRegisterPrefabMessage;
+}
+
 // In case of network message structs are regenerated and descriptions get deleted., saving their descriptions here.
 // MsgAssetDeleted: Network message informing that asset has been deleted from storage.
 // MsgAssetDiscovery: Network message informing that new asset has been discovered in storage.
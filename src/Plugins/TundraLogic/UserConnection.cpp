@@ -5,6 +5,7 @@
 #include "Entity.h"
 #include "LoggingFunctions.h"
 #include "Client.h"
+#include "TundraMessages.h"
 
 #include <kNet.h>
 
@@ -13,7 +14,10 @@ namespace Tundra
 
 UserConnection::UserConnection() : 
     userID(0),
-    protocolVersion(ProtocolOriginal)
+    protocolVersion(ProtocolOriginal),
+    resumeMessageCount(0),
+    sceneStateMessagesSent(0),
+    sendingSimulated_(false)
 {}
 
 void UserConnection::Send(kNet::message_id_t id, bool reliable, bool inOrder, kNet::DataSerializer& ds, unsigned long priority, unsigned long contentID)
@@ -21,6 +25,42 @@ void UserConnection::Send(kNet::message_id_t id, bool reliable, bool inOrder, kN
     Send(id, ds.GetData(), ds.BytesFilled(), reliable, inOrder, priority, contentID);
 }
 
+void UserConnection::SetLinkSimulation(const LinkSimulationParams &params)
+{
+    if (params.IsEnabled())
+    {
+        linkSimulator_ = new LinkSimulator(params);
+        LogInfo("Simulating network conditions for connection " + String(userID) + ": " + params.ToString());
+    }
+    else
+        linkSimulator_.Reset();
+}
+
+void UserConnection::UpdateLinkSimulation(float frametime)
+{
+    if (!linkSimulator_)
+        return;
+
+    linkSimulator_->Advance(frametime);
+    Vector<LinkSimulator::Message> due;
+    linkSimulator_->PopDue(due);
+    sendingSimulated_ = true;
+    for(uint i = 0; i < due.Size(); ++i)
+    {
+        const LinkSimulator::Message &msg = due[i];
+        Send(msg.id, msg.data.Size() ? (const char*)&msg.data[0] : 0, msg.data.Size(), msg.reliable, msg.inOrder, msg.priority, msg.contentID);
+    }
+    sendingSimulated_ = false;
+}
+
+bool UserConnection::SimulateSend(kNet::message_id_t id, const char* data, size_t numBytes, bool reliable, bool inOrder, unsigned long priority, unsigned long contentID)
+{
+    if (!linkSimulator_ || sendingSimulated_)
+        return false;
+    linkSimulator_->Queue(id, data, numBytes, reliable, inOrder, priority, contentID);
+    return true;
+}
+
 void UserConnection::EmitNetworkMessageReceived(kNet::packet_id_t packetId, kNet::message_id_t messageId, const char* data, size_t numBytes)
 {
     NetworkMessageReceived.Emit(this, packetId, messageId, data, numBytes);
@@ -87,6 +127,8 @@ void KNetUserConnection::Send(kNet::message_id_t id, const char* data, size_t nu
         LogError("KNetUserConnection::Send: can not queue message as MessageConnection is null");
         return;
     }
+    if (SimulateSend(id, data, numBytes, reliable, inOrder, priority, contentID))
+        return;
 
     kNet::NetworkMessage* msg = connection->StartNewMessage(id, numBytes);
     if (numBytes)
@@ -96,6 +138,10 @@ void KNetUserConnection::Send(kNet::message_id_t id, const char* data, size_t nu
     msg->priority = priority;
     msg->contentID = contentID;
     connection->EndAndQueueMessage(msg);
+
+    // Counted when handed to kNet, after any link simulation delay. The client counts the same messages on receive.
+    if (reliable && inOrder && IsSceneStateMessage(id))
+        ++sceneStateMessagesSent;
 }
 
 void KNetUserConnection::Disconnect()
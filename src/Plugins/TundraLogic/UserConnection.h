@@ -10,6 +10,7 @@
 #include "TundraLogicFwd.h"
 #include "Signals.h"
 #include "SyncState.h"
+#include "LinkSimulator.h"
 
 #include <Urho3D/Core/Object.h>
 
@@ -24,11 +25,17 @@ enum NetworkProtocolVersion
     ProtocolOriginal = 0x1,         // Original
     ProtocolCustomComponents = 0x2, // Adds support for transmitting new static-structured component types without actual C++ implementation, using EC_PlaceholderComponent
     ProtocolHierarchicScene = 0x3,  // Adds support for hierarchic scene, ie. entities having child entities
-    ProtocolWebClientRigidBodyMessage = 0x4 // WebSocket client that supports the rigid body optimization message
+    ProtocolWebClientRigidBodyMessage = 0x4, // WebSocket client that supports the rigid body optimization message
+    ProtocolBinaryLogin = 0x5, // Login properties are sent in a compact binary format instead of XML
+    ProtocolSessionResume = 0x6, // A reconnecting client can resume its previous scene sync session
+    ProtocolSyncTick = 0x7, // Server timestamps its sync updates with SyncTick messages, used for client snapshot interpolation
+    ProtocolEntityPrediction = 0x8, // Client prediction of entities with EntityInput and EntityInputAck messages
+    ProtocolMultiScene = 0x9, // Server can move the client between scenes with SceneChanged messages, scene IDs in the sync messages, rigid body updates included, are meaningful
+    ProtocolPrefabs = 0xA // Server sends each prefab once with RegisterPrefab messages, and the components of prefab instances in CreateEntity as differences to the prefab
 };
 
 /// Highest supported protocol version in the build. Update this when a new protocol version is added
-const NetworkProtocolVersion cHighestSupportedProtocolVersion = ProtocolWebClientRigidBodyMessage;
+const NetworkProtocolVersion cHighestSupportedProtocolVersion = ProtocolPrefabs;
 
 /// Represents a client connection on the server side. Subclassed by networking implementations.
 class TUNDRALOGIC_API UserConnection : public RefCounted
@@ -55,6 +62,14 @@ public:
     NetworkProtocolVersion protocolVersion;
     /// Map of the unacked entity IDs a user has sent, and the real entity IDs they have been assigned
     std::map<u32, u32> unackedIdsToRealIds;
+    /// Session resume token.
+    /** On the server this is the token presented by a reconnecting client until the login has been finalized,
+        after which it is the token assigned to the new session. */
+    String resumeToken;
+    /// Number of messages the reconnecting client reports having received on its previous connection.
+    u32 resumeMessageCount;
+    /// Number of scene state messages (IsSceneStateMessage) sent on this connection. Server only.
+    u32 sceneStateMessagesSent;
 
     /// Queue a network message to be sent to the client. All implementations may not use the reliable, inOrder, priority and contentID parameters.
     virtual void Send(kNet::message_id_t id, const char* data, size_t numBytes, bool reliable, bool inOrder, unsigned long priority = 100, unsigned long contentID = 0) = 0;
@@ -70,6 +85,16 @@ public:
         Send(SerializableMessage::messageID, data.reliable, data.inOrder, ds);
     }
 
+    /// Sets simulated network conditions for the messages sent to this connection. Disabled parameters remove the simulation.
+    /** Messages still held back by a previous simulation are discarded. */
+    void SetLinkSimulation(const LinkSimulationParams &params);
+
+    /// Returns the link simulator, or null if network conditions are not simulated.
+    LinkSimulator *LinkSimulation() const { return linkSimulator_.Get(); }
+
+    /// Advances the simulated link by @c frametime seconds and sends the simulated messages that are due. Called each frame by the owner of the connection.
+    void UpdateLinkSimulation(float frametime);
+
     /// Trigger a network message signal. Called by the networking implementation.
     void EmitNetworkMessageReceived(kNet::packet_id_t packetId, kNet::message_id_t messageId, const char* data, size_t numBytes);
 
@@ -78,6 +103,7 @@ public:
     void Exec(Entity *entity, const String &action, const String &p1 = "", const String &p2 = "", const String &p3 = "");  /**< @overload */
 
     /// Returns raw login data
+    /** Empty for clients that sent their login properties in the binary format (ProtocolBinaryLogin). */
     String LoginData() const { return loginData; }
 
     /// Sets a property
@@ -107,6 +133,16 @@ public:
     Signal4<UserConnection* ARG(connection), Entity* ARG(entity), const String& ARG(action), const StringVector& ARG(params)> ActionTriggered;
     /// Emitted when the client has sent a network message. PacketId will be 0 if not supported by the networking implementation.
     Signal5<UserConnection* ARG(connection), kNet::packet_id_t ARG(packetId), kNet::message_id_t ARG(messageId), const char* ARG(data), size_t ARG(numBytes)> NetworkMessageReceived;
+
+protected:
+    /// Hands an outgoing message to the link simulator. Called by the networking implementation at the start of Send.
+    /** @return True if the simulator took the message, in which case it must not be sent now. */
+    bool SimulateSend(kNet::message_id_t id, const char* data, size_t numBytes, bool reliable, bool inOrder, unsigned long priority, unsigned long contentID);
+
+private:
+    LinkSimulatorPtr linkSimulator_;
+    /// Whether the simulated messages are being sent, and Send should pass them through.
+    bool sendingSimulated_;
 };
 
 /// A kNet user connection.
@@ -229,6 +229,14 @@ Vector<RayQueryResult> GraphicsWorld::RaycastAll(const Ray& ray, unsigned layerM
     return rayHits_;
 }
 
+RayQueryResult GraphicsWorld::RaycastFurthest(const Ray& ray, unsigned layerMask, float maxDistance)
+{
+    RaycastInternal(ray, layerMask, maxDistance, true);
+
+    // Results are ordered by distance, return the last hit, or a cleared raycastresult if no hits
+    return rayHits_.Size() ? rayHits_.Back() : RayQueryResult();
+}
+
 void GraphicsWorld::RaycastInternal(const Ray& ray, unsigned layerMask, float maxDistance, bool getAllResults)
 {
     URHO3D_PROFILE(GraphicsWorld_Raycast);
@@ -257,6 +265,7 @@ void GraphicsWorld::RaycastInternal(const Ray& ray, unsigned layerMask, float ma
         res.entity = entity;
         res.pos = i->position_;
         res.normal = i->normal_;
+        res.t = i->distance_;
         /// \todo Fill the rest, like submesh information
 
         rayHits_.Push(res);
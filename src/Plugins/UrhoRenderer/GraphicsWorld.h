@@ -99,6 +99,11 @@ public:
     /// @overload
     /** Does raycast into the world using a ray in world space coordinates and a maximum distance, and returns all results */
     RayQueryResultVector RaycastAll(const Ray& ray, unsigned layerMask, float maxDistance);
+
+    /// Does raycast into the world using a ray in world space coordinates and returns the furthest hit within @c maxDistance.
+    /** Equals to picking the last result of RaycastAll, but without copying the whole result list.
+        @return Furthest raycast result, or a cleared raycast result if nothing was hit. */
+    RayQueryResult RaycastFurthest(const Ray& ray, unsigned layerMask, float maxDistance);
     
     /// Does a frustum query to the world from viewport coordinates.
     /** @param viewRect The query rectangle in 2d window coords.
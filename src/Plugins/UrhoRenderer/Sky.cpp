@@ -103,6 +103,7 @@ void Sky::UpdateSignals()
         textureRefListListener_->Changed.Connect(this, &Sky::OnTextureAssetRefsChanged);
         textureRefListListener_->Failed.Connect(this, &Sky::OnTextureAssetFailed);
         textureRefListListener_->Loaded.Connect(this, &Sky::OnTextureAssetLoaded);
+        textureRefListListener_->ContentReloaded.Connect(this, &Sky::OnTextureAssetContentReloaded);
 
         CreateSkyboxNode();
     }
@@ -273,6 +274,13 @@ void Sky::OnTextureAssetLoaded(uint /*index*/, AssetPtr asset)
         Update();
 }
 
+void Sky::OnTextureAssetContentReloaded(uint /*index*/, AssetPtr /*asset*/)
+{
+    // The cube texture is built from copies of the image data, so rebuild it with the new content.
+    if (texturesLoaded >= 6)
+        Update();
+}
+
 void Sky::HandleDeviceReset(StringHash /*eventType*/, VariantMap& /*eventData*/)
 {
     if (cubeTexture_ && cubeTexture_->IsDataLost())
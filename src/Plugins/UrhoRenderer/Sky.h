@@ -93,6 +93,8 @@ private:
 
     void OnTextureAssetLoaded(uint index, AssetPtr asset);
 
+    void OnTextureAssetContentReloaded(uint index, AssetPtr asset);
+
     void HandleDeviceReset(StringHash eventType, VariantMap& eventData);
 
     AssetRefListenerPtr materialAsset_;
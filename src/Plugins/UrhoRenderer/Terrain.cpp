@@ -98,6 +98,8 @@ void Terrain::UpdateSignals()
         materialAsset_->Loaded.Connect(this, &Terrain::OnMaterialAssetLoaded);
         materialAsset_->TransferFailed.Connect(this, &Terrain::OnMaterialAssetFailed);
         heightMapAsset_->Loaded.Connect(this, &Terrain::OnTerrainAssetLoaded);
+        // The height data is copied out of the asset, so regenerate also when it is reloaded in place.
+        heightMapAsset_->ContentReloaded.Connect(this, &Terrain::OnTerrainAssetLoaded);
     }
 }
 
@@ -41,32 +41,11 @@ bool TextureAsset::DeserializeFromData(const u8 *data_, uint numBytes, bool /*al
     Unload();
     texture = new Urho3D::Texture2D(context_);
 
-    if (!Name().EndsWith(".crn", false))
+    SharedPtr<Urho3D::Image> image = DecodeImage(data_, numBytes);
+    if (image)
     {
-        Urho3D::MemoryBuffer imageBuffer(data_, numBytes);
-        SharedPtr<Urho3D::Image> image(new Urho3D::Image(context_));
-        success = image->Load(imageBuffer);
-        if (success)
-        {
-            DetermineMipsToSkip(image, texture);
-            success = texture->SetData(image);
-        }
-    }
-    else
-    {
-        Vector<u8> ddsData;
-        success = DecompressCRNtoDDS(data_, numBytes, ddsData);
-        if (success)
-        {
-            Urho3D::MemoryBuffer imageBuffer(&ddsData[0], ddsData.Size());
-            SharedPtr<Urho3D::Image> image(new Urho3D::Image(context_));
-            success = image->Load(imageBuffer);
-            if (success)
-            {
-                DetermineMipsToSkip(image, texture);
-                success = texture->SetData(image);
-            }
-        }
+        DetermineMipsToSkip(image, texture);
+        success = texture->SetData(image);
     }
 
     if (success)
@@ -84,6 +63,49 @@ bool TextureAsset::DeserializeFromData(const u8 *data_, uint numBytes, bool /*al
     return success;
 }
 
+bool TextureAsset::DoReloadInPlace(const u8 *data_, uint numBytes)
+{
+    URHO3D_PROFILE(TextureAsset_DoReloadInPlace);
+
+    // Decode first, so that a broken file leaves the old content intact. SetData recreates the GPU resource
+    // if the size or format changed, but the texture object the materials refer to stays the same.
+    SharedPtr<Urho3D::Image> image = DecodeImage(data_, numBytes);
+    if (!texture || !image)
+    {
+        LogError("TextureAsset::DoReloadInPlace: Failed to decode new data for texture asset " + Name());
+        return false;
+    }
+    DetermineMipsToSkip(image, texture);
+    if (!texture->SetData(image))
+    {
+        LogError("TextureAsset::DoReloadInPlace: Failed to update texture asset " + Name());
+        return false;
+    }
+    return true;
+}
+
+SharedPtr<Urho3D::Image> TextureAsset::DecodeImage(const u8 *data_, uint numBytes) const
+{
+    SharedPtr<Urho3D::Image> image(new Urho3D::Image(context_));
+    if (!Name().EndsWith(".crn", false))
+    {
+        Urho3D::MemoryBuffer imageBuffer(data_, numBytes);
+        if (image->Load(imageBuffer))
+            return image;
+    }
+    else
+    {
+        Vector<u8> ddsData;
+        if (DecompressCRNtoDDS(data_, numBytes, ddsData))
+        {
+            Urho3D::MemoryBuffer imageBuffer(&ddsData[0], ddsData.Size());
+            if (image->Load(imageBuffer))
+                return image;
+        }
+    }
+    return SharedPtr<Urho3D::Image>();
+}
+
 bool TextureAsset::DecompressCRNtoDDS(const u8 *crnData, uint crnNumBytes, Vector<u8> &ddsData) const
 {
     URHO3D_PROFILE(TextureAsset_DecompressCRNtoDDS);
@@ -219,7 +241,8 @@ void TextureAsset::HandleDeviceReset(StringHash /*eventType*/, VariantMap& /*eve
     if (texture && texture->IsDataLost() && DiskSource().Trimmed().Length())
     {
         LogDebug("TextureAsset::HandleDeviceReset: Restoring texture data for " + Name() + " from disk source");
-        LoadFromFile(DiskSource().Trimmed());
+        if (!ReloadInPlaceFromDiskSource())
+            LoadFromFile(DiskSource().Trimmed());
     }
 }
 
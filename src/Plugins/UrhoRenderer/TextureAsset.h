@@ -25,6 +25,9 @@ public:
     /// IAsset override.
     bool IsLoaded() const override;
 
+    /// Texture data can be replaced in the existing Urho texture. IAsset override.
+    bool SupportsInPlaceReload() const override { return true; }
+
     /// Returns Urho3D texture
     Urho3D::Texture2D* UrhoTexture() const;
 
@@ -38,6 +41,9 @@ protected:
     /// Unload asset. IAsset override.
     void DoUnload() override;
 
+    /// Uploads the new image data into the existing Urho texture, so materials using it do not need to be rebuilt. IAsset override.
+    bool DoReloadInPlace(const u8 *data_, uint numBytes) override;
+
     /// Urho asset resource.
     SharedPtr<Urho3D::Texture2D> texture;
 
@@ -46,6 +52,9 @@ private:
 
     bool DecompressCRNtoDDS(const u8 *crnData, uint crnNumBytes, Vector<u8> &ddsData) const;
 
+    /// Decodes the image file data, decompressing CRN if necessary. Returns null on failure.
+    SharedPtr<Urho3D::Image> DecodeImage(const u8 *data_, uint numBytes) const;
+
     int MaxTextureSize() const;
     void DetermineMipsToSkip(Urho3D::Image* image, Urho3D::Texture2D* texture) const;
 };
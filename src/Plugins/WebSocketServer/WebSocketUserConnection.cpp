@@ -29,6 +29,10 @@ UserConnection::~UserConnection()
 
 void UserConnection::Send(kNet::message_id_t id, const char* data, size_t numBytes, bool reliable, bool inOrder, unsigned long priority, unsigned long contentID)
 {
+    // WebSocket runs over TCP: every message is reliable and in order
+    if (SimulateSend(id, data, numBytes, true, true, priority, contentID))
+        return;
+
     kNet::DataSerializer ds(numBytes + 2);
     ds.Add<u16>(id);
     if (numBytes)
@@ -7,11 +7,12 @@
 
 #include "CoreDefines.h"
 #include "Framework.h"
-#include "FrameAPI.h"
 #include "AssetAPI.h"
 #include "AssetCache.h"
 #include "LoggingFunctions.h"
+#include "Math/MathFunc.h"
 
+#include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
 #include <zzip/zzip.h>
 
@@ -20,11 +21,10 @@ namespace Tundra
 
 ZipAssetBundle::ZipAssetBundle(AssetAPI *owner, const String &type, const String &name) :
     IAssetBundle(owner, type, name),
-    worker_(0),
     archive_(0),
-    fileCount_(-1),
-    done_(false),
-    success_(false)
+    worker_(0),
+    zipLastModified_(0),
+    fileCount_(-1)
 {
 }
 
@@ -35,12 +35,38 @@ ZipAssetBundle::~ZipAssetBundle()
 
 void ZipAssetBundle::DoUnload()
 {
+    StopWorker();
     Close();
-    StopThread();
 
+    files_.Clear();
+    fileIndex_.Clear();
+    zipLastModified_ = 0;
     fileCount_ = -1;
 }
 
+bool ZipAssetBundle::Open()
+{
+    if (archive_)
+        return true;
+
+    const String diskSourceInternal = Urho3D::GetInternalPath(DiskSource());
+
+    zzip_error_t error = ZZIP_NO_ERROR;
+    archive_ = zzip_dir_open(diskSourceInternal.CString(), &error);
+    if (CheckAndLogZzipError(error) || CheckAndLogArchiveError(archive_) || !archive_)
+    {
+        archive_ = 0;
+        return false;
+    }
+    return true;
+}
+
+void ZipAssetBundle::CloseIfAllExtracted()
+{
+    if (archive_ && NumExtracted() == files_.Size())
+        Close();
+}
+
 void ZipAssetBundle::Close()
 {
     if (archive_)
@@ -65,30 +91,20 @@ bool ZipAssetBundle::DeserializeFromDiskSource()
 
     /* We want to detect if the extracted files are already up to date to save time.
        If the last modified date for the sub asset is the same as the parent zip file, 
-       we don't extract it. If the zip is re-downloaded from source everything will get unpacked even
-       if only one file would have changed inside it. We could do uncompressed size comparisons
-       but that is not a absolute guarantee that the file has not changed. We'll be on the safe side
-       to unpack the whole zip file. Zip files are meant for deploying the scene and should be touched
-       rather rarely. Note that local:// refs are unpacked to cache but the zips disk source is not in the
-       cache. Meaning that local:// zip files will always be extracted fully even if the disk source
-       was not changed, we don't have a mechanism to get the last modified date properly except from
-       the asset cache. For local scenes this should be fine as there is no real need to
-       zip the scene up as you already have the disk sources right there in the storage.
+       we don't extract it. If the zip is re-downloaded from source the files will get unpacked again
+       even if only one file would have changed inside it. We could do uncompressed size comparisons
+       but that is not a absolute guarantee that the file has not changed. Note that local:// refs are
+       unpacked to cache but the zips disk source is not in the cache. Meaning that local:// zip files
+       will always extract the requested files even if the disk source was not changed, we don't have
+       a mechanism to get the last modified date properly except from the asset cache.
        The last modified query will fail if the file is open with zziplib, do it first. */
-    uint zipLastModified = assetAPI_->Cache()->LastModified(Name());
+    zipLastModified_ = assetAPI_->Cache()->LastModified(Name());
 
-    const String diskSourceInternal = Urho3D::GetInternalPath(DiskSource());
-
-    zzip_error_t error = ZZIP_NO_ERROR;
-    archive_ = zzip_dir_open(diskSourceInternal.CString(), &error);
-    if (CheckAndLogZzipError(error) || CheckAndLogArchiveError(archive_) || !archive_)
-    {
-        archive_ = 0;
+    if (!Open())
         return false;
-    }
-    
-    int uncompressing = 0;
-    
+
+    // Only the central directory is read here. The archive is reopened for extracting the sub assets on demand.
+    fileCount_ = 0;
     ZZIP_DIRENT archiveEntry;
     while(zzip_dir_read(archive_, &archiveEntry))
     {
@@ -104,52 +120,25 @@ bool ZipAssetBundle::DeserializeFromDiskSource()
             file.compressedSize = archiveEntry.d_csize;
             file.uncompressedSize = archiveEntry.st_size;
             
-            /* Mark this file for extraction. If both cache files have valid dates
-               and they differ extract. If they have the same date stamp skip extraction.
-               Note that file.lastModified will be non-valid for non cached files so we 
-               will cover also missing files. */
-            file.doExtract = (zipLastModified > 0 && file.lastModified > 0) ? (zipLastModified != file.lastModified) : true;
-            if (file.doExtract)
-                uncompressing++;
+            /* If both the zip and the cache file have valid dates and they are the same, the cache file is up to date.
+               Note that file.lastModified will be non-valid for non cached files so we will cover also missing files. */
+            file.extracted = (zipLastModified_ > 0 && file.lastModified > 0 && zipLastModified_ == file.lastModified);
+            file.extracting = false;
 
+            fileIndex_[relativePath.ToLower()] = files_.Size();
             files_.Push(file);
             fileCount_++;
         }
     }
-    
-    // Close the zzip directory ptr
     Close();
-    
-    // If the zip file was empty we don't want IsLoaded to fail on the files_ check.
+
     // The bundle loaded fine but there was no content, log a warning.
     if (files_.Empty())
-    {
         LogWarning("ZipAssetBundle: Bundle loaded but does not contain any files " + Name());
-        files_.Push(ZipArchiveFile());
-        Loaded.Emit(this);
-        return true;
-    }
-    
-    // Don't spin the worker if all sub assets are up to date in cache.
-    if (uncompressing > 0)
-    {   
-        // Now that the file info has been read, continue in a worker thread.
-        LogDebug("ZipAssetBundle: File information read for " + Name() + ". File count: " + String(files_.Size()) + ". Starting worker thread to uncompress " + String(uncompressing) + " files.");
-        
-        // ZipWorker is a QRunnable we can pass to QThreadPool, it will handle scheduling it and deletes it when done.
-        worker_ = new ZipWorker(this, zipLastModified, diskSourceInternal, files_);   
-        if (!worker_->Run())
-        {
-            LogError("ZipAssetBundle: Failed to start worker thread for " + Name());
-            files_.Clear();
-            return false;
-        }
-
-        assetAPI_->GetFramework()->Frame()->Updated.Connect(this, &ZipAssetBundle::CheckDone);
-    }
     else
-        Loaded.Emit(this);
-        
+        LogDebug("ZipAssetBundle: File information read for " + Name() + ". File count: " + String(files_.Size()));
+
+    Loaded.Emit(this);
     return true;
 }
 
@@ -163,66 +152,205 @@ bool ZipAssetBundle::DeserializeFromData(const u8* /*data*/, uint /*numBytes*/)
 Vector<u8> ZipAssetBundle::GetSubAssetData(const String &subAssetName)
 {
     /* Makes no sense to keep the whole zip file contents in memory as only
-       few files could be wanted from a 100mb bundle. Additionally all asset would take 2x the memory.
-       We could make this function also open the zip file and uncompress the data for every sub asset request. 
-       But that would be rather pointless, not to mention slower, as we already have the unpacked individual 
-       assets on disk. If the unpacking to disk changes we might need to rethink this. */
-
-    String filePath = GetSubAssetDiskSource(subAssetName);
-    if (filePath.Empty())
+       few files could be wanted from a 100mb bundle. Uncompress only the requested
+       entry, reading a cache file that is already up to date instead of the archive. */
+    ZipArchiveFile *file = FindFile(subAssetName);
+    if (!file)
         return Vector<u8>();
 
     Vector<u8> data;
-    return LoadFileToVector(filePath, data) ? data : Vector<u8>();
+    if (file->extracted)
+        return LoadFileToVector(file->cachePath, data) ? data : Vector<u8>();
+
+    // Nothing is extracted here, so do not keep the archive open if it was not open already.
+    const bool wasOpen = IsArchiveOpen();
+    if (!Open())
+        return Vector<u8>();
+
+    ZZIP_FILE *zzipFile = zzip_file_open(archive_, file->relativePath.CString(), ZZIP_ONLYZIP | ZZIP_CASELESS);
+    uint total = 0;
+    if (zzipFile && !CheckAndLogArchiveError(archive_))
+    {
+        data.Resize(file->uncompressedSize);
+        zzip_ssize_t chunkRead = 0;
+        while(total < data.Size() && 0 < (chunkRead = zzip_read(zzipFile, &data[total], data.Size() - total)))
+            total += (uint)chunkRead;
+    }
+    if (zzipFile)
+        zzip_file_close(zzipFile);
+    if (!wasOpen)
+        Close();
+
+    if (total != data.Size())
+    {
+        LogError("ZipAssetBundle: Failed to uncompress " + file->relativePath + " from " + Name());
+        return Vector<u8>();
+    }
+    return data;
+}
+
+bool ZipAssetBundle::PrepareSubAsset(const String &subAssetName)
+{
+    ZipArchiveFile *file = FindFile(subAssetName);
+    if (!file || file->extracted)
+        return true;
+
+    if (!file->extracting)
+    {
+        if (!worker_)
+        {
+            worker_ = new ZipWorker(Context(), Urho3D::GetInternalPath(DiskSource()), zipLastModified_);
+            if (!worker_->Run())
+            {
+                // GetSubAssetDiskSource extracts synchronously instead.
+                LogError("ZipAssetBundle: Failed to start worker thread for " + Name());
+                SAFE_DELETE(worker_);
+                return true;
+            }
+        }
+        file->extracting = true;
+        worker_->Extract((uint)(file - &files_[0]), *file);
+    }
+
+    CheckWorker();
+    return !file->extracting;
+}
+
+void ZipAssetBundle::CheckWorker()
+{
+    if (!worker_)
+        return;
+
+    // Failed entries are left unextracted, GetSubAssetDiskSource then tries once more on the calling thread.
+    Vector<Pair<uint, bool> > finished = worker_->TakeFinished();
+    for(uint i = 0; i < finished.Size(); ++i)
+    {
+        ZipArchiveFile &file = files_[finished[i].first_];
+        file.extracting = false;
+        if (finished[i].second_)
+        {
+            file.extracted = true;
+            if (zipLastModified_ > 0)
+                file.lastModified = zipLastModified_;
+        }
+    }
+
+    foreach(const ZipArchiveFile &file, files_)
+        if (file.extracting)
+            return;
+    StopWorker();
+}
+
+void ZipAssetBundle::StopWorker()
+{
+    if (worker_)
+        worker_->Stop();
+    SAFE_DELETE(worker_);
+    foreach(ZipArchiveFile &file, files_)
+        file.extracting = false;
 }
 
 String ZipAssetBundle::GetSubAssetDiskSource(const String &subAssetName)
 {
-    return assetAPI_->Cache()->FindInCache(GetFullAssetReference(subAssetName));
+    ZipArchiveFile *file = FindFile(subAssetName);
+    if (!file)
+        return "";
+    // Do not write the cache file concurrently with the worker thread, GetSubAssetData can read the entry meanwhile.
+    if (file->extracting)
+        CheckWorker();
+    if (file->extracting)
+        return "";
+    if (!file->extracted)
+    {
+        const bool extracted = ExtractToCache(*file);
+        CloseIfAllExtracted();
+        if (!extracted)
+            return "";
+    }
+    return file->cachePath;
 }
 
-String ZipAssetBundle::GetFullAssetReference(const String &subAssetName)
+uint ZipAssetBundle::NumExtracted() const
 {
-    return Name() + "#" + subAssetName;
+    uint num = 0;
+    foreach(const ZipArchiveFile &file, files_)
+        if (file.extracted)
+            ++num;
+    return num;
 }
 
-bool ZipAssetBundle::IsLoaded() const
+ZipArchiveFile *ZipAssetBundle::FindFile(const String &subAssetName)
 {
-    return (archive_ != 0 || !files_.Empty());
+    HashMap<String, uint>::ConstIterator iter = fileIndex_.Find(Urho3D::GetInternalPath(subAssetName).ToLower());
+    return (iter != fileIndex_.End() ? &files_[iter->second_] : 0);
 }
 
-void ZipAssetBundle::CheckDone(float /*frametime*/)
+bool ZipAssetBundle::ExtractToCache(ZipArchiveFile &file)
 {
-    // Invoked in main thread context
+    if (!Open())
+        return false;
+
+    // Open file from zip
+    ZZIP_FILE *zzipFile = zzip_file_open(archive_, file.relativePath.CString(), ZZIP_ONLYZIP | ZZIP_CASELESS);
+    if (!zzipFile || CheckAndLogArchiveError(archive_))
+        return false;
+
+    bool success = true;
     {
-        Urho3D::MutexLock m(mutexDone_);
-        if (!done_)
-            return;
+        // Create cache file
+        Urho3D::File cacheFile(Context(), file.cachePath, Urho3D::FILE_WRITE);
+        if (!cacheFile.IsOpen())
+        {
+            LogError("ZipAssetBundle: Failed to open cache file: " + file.cachePath + ". Cannot unzip " + file.relativePath);
+            zzip_file_close(zzipFile);
+            return false;
+        }
+
+        // Stream the content to the cache file in bounded chunks, large entries are never held in memory as a whole.
+        const zzip_ssize_t chunkLen = (zzip_ssize_t)Min(Max(file.uncompressedSize, 4u * 1024u), 256u * 1024u);
+        Vector<u8> buffer(chunkLen);
+        zzip_ssize_t chunkRead = 0;
+        while (0 < (chunkRead = zzip_read(zzipFile, &buffer[0], chunkLen)))
+        {
+            if (cacheFile.Write((void*)&buffer[0], (uint)chunkRead) != (uint)chunkRead)
+            {
+                LogError("ZipAssetBundle: Failed to write cache file " + file.cachePath);
+                success = false;
+                break;
+            }
+        }
+        if (chunkRead < 0)
+        {
+            LogError("ZipAssetBundle: Failed to uncompress " + file.relativePath + " from " + Name());
+            success = false;
+        }
+    }
+    zzip_file_close(zzipFile);
 
-        if (success_)
-            Loaded.Emit(this);
-        else
-            Failed.Emit(this);
+    if (!success)
+    {
+        FileSystem()->Delete(file.cachePath);
+        return false;
     }
-    StopThread();
 
-    assetAPI_->GetFramework()->Frame()->Updated.Disconnect(this, &ZipAssetBundle::CheckDone);
+    // Update last modified same to the parent zip file.
+    if (zipLastModified_ > 0)
+    {
+        FileSystem()->SetLastModifiedTime(file.cachePath, zipLastModified_);
+        file.lastModified = zipLastModified_;
+    }
+    file.extracted = true;
+    return true;
 }
 
-void ZipAssetBundle::WorkerDone(bool successful)
+String ZipAssetBundle::GetFullAssetReference(const String &subAssetName)
 {
-    // Invoked in worker thread context
-    
-    Urho3D::MutexLock m(mutexDone_);
-    done_ = true;
-    success_ = successful;
+    return Name() + "#" + subAssetName;
 }
 
-void ZipAssetBundle::StopThread()
+bool ZipAssetBundle::IsLoaded() const
 {
-    if (worker_)
-        worker_->Stop();
-    SAFE_DELETE(worker_);
+    return fileCount_ >= 0;
 }
 
 Urho3D::Context *ZipAssetBundle::Context() const
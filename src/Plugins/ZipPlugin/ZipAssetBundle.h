@@ -8,8 +8,6 @@
 #include "AssetAPI.h"
 #include "IAssetBundle.h"
 
-#include <Urho3D/Core/Mutex.h>
-
 namespace Urho3D
 {
     class Context;
@@ -24,6 +22,11 @@ namespace Tundra
 {
 
 /// Provides zip packed asset bundles.
+/** Loading the bundle only reads the central directory of the archive. Each sub asset is extracted to the asset cache
+    when it is first requested, so only the entries a scene actually uses are ever unpacked. AssetAPI requests go through
+    PrepareSubAsset, which extracts in a ZipWorker thread; only direct GetSubAssetDiskSource calls extract on the calling
+    thread. The archive is opened only while there are entries being extracted, it is not kept open for the lifetime
+    of the bundle. */
 class TUNDRA_ZIP_API ZipAssetBundle : public IAssetBundle
 {
     URHO3D_OBJECT(ZipAssetBundle, IAssetBundle);
@@ -42,8 +45,8 @@ public:
     /// IAssetBundle override.
     /** Our current zziplib implementation requires disk source for processing.
         So we fail DeserializeFromData and try our best here to.
-        This function unpacks the archive content to asset cache to normal cache files
-        and provides the sub asset data via GetSubAssetData and GetSubAssetDiskSource. */
+        This function reads the file list of the archive and closes it. The sub assets are provided via
+        GetSubAssetDiskSource and GetSubAssetData, which reopen the archive and extract only the requested entry. */
     bool DeserializeFromDiskSource() override;
 
     /// IAssetBundle override.
@@ -57,13 +60,38 @@ public:
     int SubAssetCount() const override { return fileCount_; }
 
     /// IAssetBundle override.
+    /** Queues the entry to be extracted to its asset cache file by a ZipWorker thread, and returns false until it is done.
+        The worker thread runs only while there are entries being extracted. */
+    bool PrepareSubAsset(const String &subAssetName) override;
+
+    /// IAssetBundle override.
+    /** Decompresses the entry straight from the archive to memory, without a cache file. */
     Vector<u8> GetSubAssetData(const String &subAssetName) override;
 
     /// IAssetBundle override.
+    /** Extracts the entry to its asset cache file unless the cache file is already up to date with the archive.
+        The returned file works as a file backed view of the entry for the asset loaders. Returns an empty string
+        while the entry is being extracted by the worker thread, see PrepareSubAsset. */
     String GetSubAssetDiskSource(const String &subAssetName) override;
+
+    /// Returns the number of sub assets that have been extracted to the asset cache.
+    uint NumExtracted() const;
+
+    /// Returns if the archive is currently open.
+    bool IsArchiveOpen() const { return archive_ != 0; }
     
 private:
-    friend class ZipWorker;
+    /// Returns the archive entry of a sub asset, or null if the archive has no such file.
+    ZipArchiveFile *FindFile(const String &subAssetName);
+
+    /// Extracts @c file to its cache file.
+    bool ExtractToCache(ZipArchiveFile &file);
+
+    /// Applies the extractions the worker thread has finished, and stops the thread if there is nothing left for it.
+    void CheckWorker();
+
+    /// Stops and destroys the worker thread.
+    void StopWorker();
 
     /// Returns full asset reference for a sub asset.
     String GetFullAssetReference(const String &subAssetName);
@@ -71,19 +99,14 @@ private:
     /// IAssetBundle override.
     void DoUnload() override;
 
+    /// Opens the zip file from the disk source, if not already open.
+    bool Open();
+
     /// Closes zip file.
     void Close();
 
-    /// Check if worker has completed.
-    void CheckDone(float frametime);
-
-    /// Handler for asynch loading completion.
-    /** Invoked in worker thread context. */
-    void WorkerDone(bool successful);
-
-    /// Stops and destroys thread.
-    /** @note Only call in main thread context. */
-    void StopThread();
+    /// Closes zip file if all its entries have been extracted, so that it is not needed anymore.
+    void CloseIfAllExtracted();
 
     Urho3D::Context *Context() const;
     Urho3D::FileSystem *FileSystem() const;
@@ -94,16 +117,17 @@ private:
     /// Zip sub assets.
     ZipFileVector files_;
 
-    /// Worker
+    /// Worker thread extracting sub assets, null when there is nothing to extract.
     ZipWorker *worker_;
 
+    /// Index to files_ by lower case relative path.
+    HashMap<String, uint> fileIndex_;
+
+    /// Last modified time of the archive in the asset cache, 0 if unknown.
+    uint zipLastModified_;
+
     /// Count of files inside this zip.
     int fileCount_;
-
-    /// Mutex for polling completion of worker thread.
-    Urho3D::Mutex mutexDone_;
-    bool done_;
-    bool success_;
 };
 typedef SharedPtr<ZipAssetBundle> ZipAssetBundlePtr;
 
@@ -21,7 +21,8 @@ namespace Tundra
         uint compressedSize;
         uint uncompressedSize;
         uint lastModified;
-        bool doExtract;
+        bool extracted; ///< The cache file is up to date with the archive.
+        bool extracting; ///< Queued to or being extracted by the ZipWorker.
     };
     typedef Vector<ZipArchiveFile> ZipFileVector;
     /// @endcond
@@ -4,123 +4,138 @@
 
 #include "ZipWorker.h"
 #include "ZipHelpers.h"
-#include "ZipAssetBundle.h"
 
+#include "CoreDefines.h"
 #include "LoggingFunctions.h"
+#include "Math/MathFunc.h"
 
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
-#include <Urho3D/Container/Sort.h>
 
 #include <zzip/zzip.h>
 
 namespace Tundra
 {
 
-bool ArchiveFileSizeCompare(const ZipArchiveFile &f1, const ZipArchiveFile &f2)
-{
-    return (f1.uncompressedSize < f2.uncompressedSize);
-}
-
-ZipWorker::ZipWorker(ZipAssetBundle *owner, uint zipLastModified, const String &diskSource, const ZipFileVector &files) :
-    owner_(owner),
-    zipLastModified_(zipLastModified),
+ZipWorker::ZipWorker(Urho3D::Context *context, const String &diskSource, uint zipLastModified) :
+    context_(context),
     diskSource_(diskSource),
-    files_(files),
+    zipLastModified_(zipLastModified),
     archive_(0)
 {
 }
 
 ZipWorker::~ZipWorker()
 {
+    Stop();
     Close();
 }
 
+void ZipWorker::Extract(uint index, const ZipArchiveFile &file)
+{
+    Urho3D::MutexLock m(mutex_);
+    queue_.Push(Urho3D::MakePair(index, file));
+}
+
+Vector<Pair<uint, bool> > ZipWorker::TakeFinished()
+{
+    Urho3D::MutexLock m(mutex_);
+    Vector<Pair<uint, bool> > finished = finished_;
+    finished_.Clear();
+    return finished;
+}
+
 void ZipWorker::ThreadFunction()
 {
-    zzip_error_t error = ZZIP_NO_ERROR;
-    archive_ = zzip_dir_open(diskSource_.CString(), &error);
-    if (CheckAndLogZzipError(error) || CheckAndLogArchiveError(archive_) || !archive_)
+    while(shouldRun_)
     {
-        archive_ = 0;
-        owner_->WorkerDone(false);
-        return;
-    }
+        Pair<uint, ZipArchiveFile> next;
+        bool hasNext = false;
+        {
+            Urho3D::MutexLock m(mutex_);
+            if (!queue_.Empty())
+            {
+                next = queue_.Front();
+                queue_.Erase(0);
+                hasNext = true;
+            }
+        }
 
-    Urho3D::FileSystem *fs = owner_->FileSystem();
-    
-    // Sort by size so we can resize the buffer less often.
-    Urho3D::Sort(files_.Begin(), files_.End(), ArchiveFileSizeCompare);
+        if (hasNext)
+        {
+            bool success = ExtractFile(next.second_);
+            Urho3D::MutexLock m(mutex_);
+            finished_.Push(Urho3D::MakePair(next.first_, success));
+        }
+        else
+            Urho3D::Time::Sleep(16);
+    }
 
-    // Read file contents
-    bool success = true;
-    zzip_ssize_t chunkLen = 0;
-    zzip_ssize_t chunkRead = 0;
-    Vector<u8> buffer;
+    Close();
+}
 
-    foreach(const ZipArchiveFile &file, files_)
+bool ZipWorker::ExtractFile(const ZipArchiveFile &file)
+{
+    if (!archive_)
     {
-        if (!file.doExtract)
-            continue;
-
-        // Open file from zip
-        ZZIP_FILE *zzipFile = zzip_file_open(archive_, file.relativePath.CString(), ZZIP_ONLYZIP | ZZIP_CASELESS);
-        if (!zzipFile || CheckAndLogArchiveError(archive_))
+        zzip_error_t error = ZZIP_NO_ERROR;
+        archive_ = zzip_dir_open(diskSource_.CString(), &error);
+        if (CheckAndLogZzipError(error) || CheckAndLogArchiveError(archive_) || !archive_)
         {
-            success = false;
-            break;
+            archive_ = 0;
+            return false;
         }
+    }
 
+    // Open file from zip
+    ZZIP_FILE *zzipFile = zzip_file_open(archive_, file.relativePath.CString(), ZZIP_ONLYZIP | ZZIP_CASELESS);
+    if (!zzipFile || CheckAndLogArchiveError(archive_))
+        return false;
+
+    bool success = true;
+    {
         // Create cache file
-        Urho3D::File cacheFile(owner_->Context(), file.cachePath, Urho3D::FILE_WRITE);
+        Urho3D::File cacheFile(context_, file.cachePath, Urho3D::FILE_WRITE);
         if (!cacheFile.IsOpen())
         {
             LogError("ZipWorker: Failed to open cache file: " + file.cachePath + ". Cannot unzip " + file.relativePath);
-            continue;
+            zzip_file_close(zzipFile);
+            return false;
         }
 
-        // Detect file size and adjust buffer (quite naive atm but is a slight speed improvement)
-        if (file.uncompressedSize > 1000*1024)
-            chunkLen = 500*1024;
-        else if (file.uncompressedSize > 500*1024)
-            chunkLen = 250*1024;
-        else if (file.uncompressedSize > 100*1024)
-            chunkLen = 50*1024;
-        else if (file.uncompressedSize > 20*1024)
-            chunkLen = 10*1024;
-        else
-            chunkLen = 5*1024;
-
-        if (buffer.Size() < (uint)chunkLen)
-            buffer.Resize(chunkLen);
-
-        // Read zip file content to cache file
+        // Stream the content to the cache file in bounded chunks, large entries are never held in memory as a whole.
+        const zzip_ssize_t chunkLen = (zzip_ssize_t)Min(Max(file.uncompressedSize, 4u * 1024u), 256u * 1024u);
+        Vector<u8> buffer(chunkLen);
+        zzip_ssize_t chunkRead = 0;
         while (0 < (chunkRead = zzip_read(zzipFile, &buffer[0], chunkLen)))
         {
             if (cacheFile.Write((void*)&buffer[0], (uint)chunkRead) != (uint)chunkRead)
             {
-                LogError("Failed to write cache file + " + file.cachePath);
+                LogError("ZipWorker: Failed to write cache file " + file.cachePath);
                 success = false;
                 break;
             }
         }
-
-        // Close zip and cache file.
-        zzip_file_close(zzipFile);
-        cacheFile.Close();
-
-        if (!success)
-            break;
-
-        // Update last modified same to the parent zip file.
-        if (success && zipLastModified_ > 0)
-            fs->SetLastModifiedTime(file.cachePath, zipLastModified_);
+        if (chunkRead < 0)
+        {
+            LogError("ZipWorker: Failed to uncompress " + file.relativePath + " from " + diskSource_);
+            success = false;
+        }
     }
+    zzip_file_close(zzipFile);
 
-    // Close the zzip directory ptr
-    Close();
+    Urho3D::FileSystem *fs = context_->GetSubsystem<Urho3D::FileSystem>();
+    if (!success)
+    {
+        fs->Delete(file.cachePath);
+        return false;
+    }
 
-    owner_->WorkerDone(success);
+    // Update last modified same to the parent zip file.
+    if (zipLastModified_ > 0)
+        fs->SetLastModifiedTime(file.cachePath, zipLastModified_);
+    return true;
 }
 
 void ZipWorker::Close()
@@ -5,7 +5,14 @@
 #include "ZipPluginApi.h"
 #include "ZipPluginFwd.h"
 
+#include <Urho3D/Container/Pair.h>
 #include <Urho3D/Core/Thread.h>
+#include <Urho3D/Core/Mutex.h>
+
+namespace Urho3D
+{
+    class Context;
+}
 
 /// @cond PRIVATE
 struct zzip_dir;
@@ -14,25 +21,41 @@ struct zzip_dir;
 namespace Tundra
 {
 
-/// Worker thread that unpacks zip file contents.
+/// Worker thread that extracts requested zip entries to their asset cache files.
+/** The archive is opened by the worker itself, so it does not share the zziplib handle of the bundle. */
 class TUNDRA_ZIP_API ZipWorker : public Urho3D::Thread
 {
 public:
-    ZipWorker(ZipAssetBundle *owner, uint zipLastModified, const String &diskSource, const ZipFileVector &files);
+    ZipWorker(Urho3D::Context *context, const String &diskSource, uint zipLastModified);
     ~ZipWorker();
 
+    /// Queues the entry at @c index of the bundle for extraction.
+    /** Invoked in main thread context. */
+    void Extract(uint index, const ZipArchiveFile &file);
+
+    /// Returns the indices of the entries whose extraction has finished since the previous call, and whether it succeeded.
+    /** Invoked in main thread context. */
+    Vector<Pair<uint, bool> > TakeFinished();
+
     /// Urho3D::Thread override
     void ThreadFunction() override;
-    
+
 private:
+    /// Extracts one entry to its cache file.
+    bool ExtractFile(const ZipArchiveFile &file);
+
     void Close();
 
-    ZipAssetBundle *owner_;
-    
+    Urho3D::Context *context_;
     String diskSource_;
-    ZipFileVector files_;
-    zzip_dir *archive_;
     uint zipLastModified_;
+    zzip_dir *archive_;
+
+    /// Queued entries, protected by mutex_.
+    Vector<Pair<uint, ZipArchiveFile> > queue_;
+    /// Finished entries, protected by mutex_.
+    Vector<Pair<uint, bool> > finished_;
+    Urho3D::Mutex mutex_;
 };
 
 }
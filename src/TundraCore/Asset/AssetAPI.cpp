@@ -20,6 +20,9 @@
 #include "NullAssetFactory.h"
 #include "LocalAssetProvider.h"
 #include "AssetCache.h"
+#include "AssetRefListener.h"
+#include "AssetPrefetchManifest.h"
+#include "AssetLoadTimeline.h"
 
 #include "Framework.h"
 #include "LoggingFunctions.h"
@@ -32,16 +35,36 @@
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileWatcher.h>
 
+#include <cctype>
+
 namespace Tundra
 {
 
+/// Maximum number of memoized ResolveAssetRef results. The memo is cleared when full.
+static const uint cMaxResolvedRefs = 64 * 1024;
+
+/// Returns the key identifying asset content for deduplication: the type, the size and the 64-bit FNV-1a hash of the data.
+static String ContentHashKey(const String &type, const u8 *data, uint numBytes)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for(uint i = 0; i < numBytes; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return Urho3D::ToString("%s:%u:%08x%08x", type.ToLower().CString(), numBytes, (uint)(hash >> 32), (uint)(hash & 0xffffffff));
+}
+
 AssetAPI::AssetAPI(Framework *framework, bool headless) :
     Object(framework->GetContext()),
     fw(framework),
     isHeadless(headless),
-    assetCache(0)
+    assetCache(0),
+    contentDeduplication_(framework->HasCommandLineParameter("--dedupAssets")),
+    numResolvedRefs(0)
 {
     transferPrioritizer_ = new DefaultAssetTransferPrioritizer();
+    loadTimeline_ = new AssetLoadTimeline();
 
     AssetProviderPtr local(new LocalAssetProvider(fw));
     RegisterAssetProvider(local);
@@ -133,7 +156,10 @@ bool AssetAPI::RemoveAssetStorage(const String &name)
     /// not be possible to specify which storage to delete.
     foreach(const AssetProviderPtr &provider, providers)
         if (provider->RemoveAssetStorage(name))
+        {
+            ClearResolvedRefs();
             return true;
+        }
 
     return false;
 }
@@ -146,10 +172,12 @@ AssetStoragePtr AssetAPI::DeserializeAssetStorageFromString(const String &storag
 
     for(uint i = 0; i < providers.Size(); ++i)
     {
-        // TryCreateStorage will call AssetAPI::EmitAssetStorageAdded
+        // Not all providers call AssetAPI::EmitAssetStorageAdded from TryCreateStorage
         AssetStoragePtr assetStorage = providers[i]->TryCreateStorage(storageParams, fromNetwork);
         if (assetStorage)
         {
+            // The new storage may change how refs resolve
+            ClearResolvedRefs();
             // Make this storage the default storage if it was requested so
             if (storageParams.Contains("default") && Urho3D::ToBool(storageParams["default"]))
                 SetDefaultAssetStorage(assetStorage);
@@ -176,6 +204,7 @@ AssetStoragePtr AssetAPI::DefaultAssetStorage() const
 void AssetAPI::SetDefaultAssetStorage(const AssetStoragePtr &storage)
 {
     defaultStorage = storage;
+    ClearResolvedRefs();
     if (storage)
         LogInfo("Set asset storage \"" + storage->Name() + "\" as the default storage (" + storage->SerializeToString() + ").");
     else
@@ -250,14 +279,22 @@ AssetAPI::FileQueryResult AssetAPI::ResolveLocalAssetPath(String ref, String bas
     }
 }
 
-AssetAPI::AssetRefType AssetAPI::ParseAssetRef(String assetRef, String *outProtocolPart, String *outNamedStorage, String *outProtocol_Path, 
+/// Returns whether str[start, start + length) equals the given lowercase literal, ignoring case.
+static bool SubstringEqualsIgnoreCase(const String &str, uint start, uint length, const char *lowercaseLiteral)
+{
+    for(uint i = 0; i < length; ++i)
+        if (!lowercaseLiteral[i] || tolower((unsigned char)str[start + i]) != lowercaseLiteral[i])
+            return false;
+    return !lowercaseLiteral[length];
+}
+
+AssetAPI::AssetRefType AssetAPI::ParseAssetRef(const String &assetRef, String *outProtocolPart, String *outNamedStorage, String *outProtocol_Path, 
                                                String *outPath_Filename_SubAssetName, String *outPath_Filename, String *outPath, 
                                                String *outFilename, String *outSubAssetName, String *outFullRef, String *outFullRefNoSubAssetName)
 {
     if (outProtocolPart) *outProtocolPart = "";
     if (outNamedStorage) *outNamedStorage = "";
     if (outProtocol_Path) *outProtocol_Path = "";
-    String protocol_path = "";
     if (outPath_Filename_SubAssetName) *outPath_Filename_SubAssetName = "";
     if (outPath_Filename) *outPath_Filename = "";
     if (outPath) *outPath = "";
@@ -301,111 +338,77 @@ AssetAPI::AssetRefType AssetAPI::ParseAssetRef(String assetRef, String *outProto
              asset.sfx, "subAssetName as a string with spaces"
              http://server.com/asset.sfx,subAssetName.sfx2
     */
+    // The ref is parsed using offsets into a single normalized copy, and only the parts the caller asked for are constructed.
+    String ref = assetRef.Trimmed();
+    ref.Replace('\\', '/'); // Normalize all path separators to use forward slashes.
 
-    assetRef = assetRef.Trimmed();
-    assetRef.Replace('\\', '/'); // Normalize all path separators to use forward slashes.
-
-    String fullPath; // Contains the url without the "protocolPart://" prefix.
     AssetRefType refType = AssetRefInvalid;
+    uint fullPathStart = 0; // Start of the url without the "protocolPart://" prefix.
+    uint prefixLength = 0; // Length of the "protocolPart://" or "namedStorage:" prefix in the ref.
+    bool httpPrefix = false; // The ref has an implicit "http://" prefix.
     unsigned pos;
-    if ((pos = assetRef.Find("://")) != String::NPOS) // Is ref of type 'a)' above?
+    if ((pos = ref.Find("://")) != String::NPOS) // Is ref of type 'a)' above?
     {
-        String protocol = assetRef.Substring(0, pos);
-        if (protocol.Compare("local", false) == 0 || protocol.Compare("file", false) == 0)
+        if (SubstringEqualsIgnoreCase(ref, 0, pos, "local") || SubstringEqualsIgnoreCase(ref, 0, pos, "file"))
             refType = AssetRefLocalUrl;
         else
             refType = AssetRefExternalUrl;
         if (outProtocolPart)
-            *outProtocolPart = protocol;
-
-        fullPath = assetRef.Substring(pos + 3);
-        protocol_path = protocol + "://";
-        if (outProtocol_Path) // Partially save the beginning of the protocol & path part. This will be completed below with the full path.
-            *outProtocol_Path = protocol_path;
-
-        if (outFullRef)
-            *outFullRef = protocol.ToLower() + "://";
+            *outProtocolPart = ref.Substring(0, pos);
+        fullPathStart = prefixLength = pos + 3;
     }
-    else if (assetRef.StartsWith("www.", false)) // Ref is of type 'b0)'?
+    else if (ref.StartsWith("www.", false)) // Ref is of type 'b0)'?
     {
         refType = AssetRefExternalUrl;
         if (outProtocolPart)
             *outProtocolPart = "http";
-        fullPath = assetRef;
-
-        protocol_path = "http://";
-        if (outProtocol_Path) // Partially save the beginning of the protocol & path part. This will be completed below with the full path.
-            *outProtocol_Path = protocol_path;
-        if (outFullRef)
-            *outFullRef = "http://";
+        httpPrefix = true;
     }
-    else if (assetRef.StartsWith("/")) // Is ref of type 'b1)'?
-    {
+    else if (ref.StartsWith("/")) // Is ref of type 'b1)'?
         refType = AssetRefLocalPath;
-        fullPath = assetRef;
-    }
-    else if ((pos = assetRef.Find(":/")) != String::NPOS)
-    {
+    else if ((pos = ref.Find(":/")) != String::NPOS)
         refType = AssetRefLocalPath;
-        fullPath = assetRef;
-    }
-    else if ((pos = assetRef.Find(':')) != String::NPOS)
+    else if ((pos = ref.Find(':')) != String::NPOS)
     {
         refType = AssetRefNamedStorage;
-        String storage = assetRef.Substring(0, pos);
         if (outNamedStorage)
-            *outNamedStorage = storage;
-        fullPath = assetRef.Substring(pos + 1);
-
-        protocol_path = storage + ":";
-        if (outProtocol_Path)
-            *outProtocol_Path = protocol_path;
-        if (outFullRef)
-            *outFullRef = protocol_path;
+            *outNamedStorage = ref.Substring(0, pos);
+        fullPathStart = prefixLength = pos + 1;
     }
     else // We assume it must be of type b4).
-    {
         refType = AssetRefRelativePath;
-        fullPath = assetRef;
-    }
 
-    // After the above check, we are left with a fullPath reference that can only contain three parts: directory, local name and subAssetName.
-    // The protocol specifier or named storage part has been stripped off.
+    // After the above check, we are left with a full path that can only contain three parts: directory, local name and subAssetName.
+    // The protocol specifier or named storage part is skipped.
     if (outPath_Filename_SubAssetName)
-        *outPath_Filename_SubAssetName = fullPath.Trimmed();
+        *outPath_Filename_SubAssetName = ref.Substring(fullPathStart).Trimmed();
 
-    // Parse subAssetName if it exists.
-    String subAssetName = "";
-
-    pos = fullPath.Find(',');
-    if (pos == String::NPOS)
-        pos = fullPath.Find('#');
-    
-    if (pos != String::NPOS)
+    // Parse subAssetName if it exists. The main part of the ref ends where it starts.
+    String subAssetName;
+    uint mainEnd = ref.Find(',', fullPathStart);
+    if (mainEnd == String::NPOS)
+        mainEnd = ref.Find('#', fullPathStart);
+    if (mainEnd != String::NPOS)
     {
-        assetRef = fullPath.Substring(0, pos);
-        subAssetName = fullPath.Substring(pos + 1).Trimmed();
-        if (subAssetName.StartsWith("\""))
-            subAssetName = subAssetName.Substring(1);
-        if (subAssetName.EndsWith("\""))
-            subAssetName = subAssetName.Substring(0, subAssetName.Length() - 1);
-        if (outSubAssetName)
-            *outSubAssetName = subAssetName;
-        fullPath = assetRef; // Remove the subAssetName from the asset ref so that the parsing can continue without the subAssetName in it.
+        if (outSubAssetName || outFullRef)
+        {
+            subAssetName = ref.Substring(mainEnd + 1).Trimmed();
+            if (subAssetName.StartsWith("\""))
+                subAssetName = subAssetName.Substring(1);
+            if (subAssetName.EndsWith("\""))
+                subAssetName = subAssetName.Substring(0, subAssetName.Length() - 1);
+            if (outSubAssetName)
+                *outSubAssetName = subAssetName;
+        }
     }
+    else
+        mainEnd = ref.Length();
 
-    if (outPath_Filename) 
-        *outPath_Filename = fullPath;
-
-    // Now the only thing that is left is to split the base filename and the path for the asset.
-    unsigned lastPeriodIndex = fullPath.FindLast('.');
-    unsigned directorySeparatorIndex = fullPath.FindLast('/');
-    if (lastPeriodIndex == String::NPOS || lastPeriodIndex < directorySeparatorIndex)
-    {
-        /** Don't do anything, use the last dir separator as is. The old code below
-            breaks refs that do not have a asset extension (eg. .mesh) in the filename part.
+    if (outPath_Filename)
+        *outPath_Filename = ref.Substring(fullPathStart, mainEnd - fullPathStart);
 
-            We want the following to work correctly.
+    // Now the only thing that is left is to split the base filename and the path for the asset at the last directory separator.
+    /** This is done also for refs that do not have a asset extension (eg. .mesh) in the filename part, so that the following work correctly.
             http://myservice.com/list/objects?id=15
                 -> Path     : http://myservice.com/list/
                 -> Filename : objects?id=15
@@ -413,30 +416,44 @@ AssetAPI::AssetRefType AssetAPI::ParseAssetRef(String assetRef, String *outProto
                 -> Path     : http://asset.service.com/some/path/
                 -> Filename : assetWithoutExtension
 
-            @note Not having suffix in the asset filename will only work for "Binary"
-            requests. As the file suffix is the main and only way we detect what IAsset
-            implementation should handle the incoming data. */
-
-        //directorySeparatorIndex = fullPathRef.length()-1;
-    }
-
-    String path = GuaranteeTrailingSlash(fullPath.Substring(0, directorySeparatorIndex+1).Trimmed());
-    if (outPath)
-        *outPath = path;
-    protocol_path += path;
-    if (outProtocol_Path)
-        *outProtocol_Path += path;
+        @note Not having suffix in the asset filename will only work for "Binary"
+        requests. As the file suffix is the main and only way we detect what IAsset
+        implementation should handle the incoming data. */
+    uint filenameStart = mainEnd;
+    while(filenameStart > fullPathStart && ref[filenameStart - 1] != '/')
+        --filenameStart;
 
     /** @todo Handle url query separately? outFilename will have the query (and should as the request should be done with it)
         but if something is interested in the query alone, should be parsed separately to a new out String* param.
         Note however that this will only work for "Binary" type assets, if you have <ref>/mymesh.mesh?something=x the
         file suffix will be read incorrectly and not passed to the correct IAsset implementation. */
-    String assetFilename = fullPath.Substring(directorySeparatorIndex+1);
     if (outFilename)
-        *outFilename = assetFilename;
+        *outFilename = ref.Substring(filenameStart, mainEnd - filenameStart);
+
+    if (outPath || outProtocol_Path || outFullRefNoSubAssetName)
+    {
+        String path = GuaranteeTrailingSlash(ref.Substring(fullPathStart, filenameStart - fullPathStart));
+        String protocol_path = (httpPrefix ? String("http://") : ref.Substring(0, prefixLength)) + path;
+        if (outPath)
+            *outPath = path;
+        if (outProtocol_Path)
+            *outProtocol_Path = protocol_path;
+        if (outFullRefNoSubAssetName)
+        {
+            *outFullRefNoSubAssetName = GuaranteeTrailingSlash(protocol_path);
+            outFullRefNoSubAssetName->Append(ref.CString() + filenameStart, mainEnd - filenameStart);
+        }
+    }
+
     if (outFullRef)
     {
-        *outFullRef += fullPath;
+        if (httpPrefix)
+            *outFullRef = "http://";
+        else if (refType == AssetRefNamedStorage)
+            *outFullRef = ref.Substring(0, prefixLength);
+        else if (prefixLength > 0)
+            *outFullRef = ref.Substring(0, prefixLength).ToLower();
+        outFullRef->Append(ref.CString() + fullPathStart, mainEnd - fullPathStart);
         if (!subAssetName.Empty())
         {
             if (subAssetName.Contains(' '))
@@ -446,8 +463,6 @@ AssetAPI::AssetRefType AssetAPI::ParseAssetRef(String assetRef, String *outProto
         }
     }
 
-    if (outFullRefNoSubAssetName)
-        *outFullRefNoSubAssetName = GuaranteeTrailingSlash(protocol_path) + assetFilename;
     return refType;
 }
 
@@ -491,6 +506,9 @@ AssetPtr AssetAPI::CreateAssetFromFile(String assetType, String assetFile)
 
 bool AssetAPI::ForgetAsset(String assetRef, bool removeDiskSource)
 {
+    // Forgetting an alias only separates it from the asset it aliases.
+    if (contentAliases_.Erase(ResolveAssetRef("", assetRef)))
+        return true;
     return ForgetAsset(FindAsset(assetRef), removeDiskSource);
 }
 
@@ -519,6 +537,8 @@ bool AssetAPI::ForgetAsset(AssetPtr asset, bool removeDiskSource)
     if (transferIter != currentTransfers.end())
         currentTransfers.erase(transferIter);
 
+    RemoveContentHashes(asset->Name());
+
     // Remove the asset from internal state.
     AssetMap::iterator iter = assets.find(asset->Name());
     if (iter == assets.end())
@@ -641,6 +661,21 @@ AssetUploadTransferPtr AssetAPI::UploadAssetFromFile(const String &filename, Ass
         LogError("AssetAPI::UploadAssetFromFile failed! The provider pointer of the passed destination asset storage was null!");
         return AssetUploadTransferPtr();
     }
+
+    // Stream the file in chunks if the provider can, instead of buffering all of it.
+    if (provider->SupportsStreamingUploads())
+    {
+        if (!destination->Writable())
+        {
+            LogError("AssetAPI::UploadAssetFromFile failed! The storage is not writable.");
+            return AssetUploadTransferPtr();
+        }
+        AssetUploadTransferPtr transfer = provider->UploadAssetFromFile(filename, destination, assetName);
+        if (transfer)
+            currentUploadTransfers[destination->GetFullAssetURL(assetName)] = transfer;
+        return transfer;
+    }
+
     Vector<u8> data;
     bool success = LoadFileToVector(filename, data);
     if (!success)
@@ -712,6 +747,8 @@ void AssetAPI::ForgetAllAssets()
     while(!assets.empty())
         ForgetAsset(assets.begin()->second, false);
     assets.clear();
+    contentHashes_.Clear();
+    contentAliases_.Clear();
    
     // Abort all current transfers.
     while(!currentTransfers.empty())
@@ -745,6 +782,16 @@ void AssetAPI::Reset()
     assetTypeFactories.Clear();
     assetBundleTypeFactories.Clear();
     defaultStorage.Reset();
+    ClearResolvedRefs();
+    assetCreatedWaiters.Clear();
+    // Let the listeners queue their Loaded signal again
+    for(uint i = 0; i < pendingLoadedListeners.Size(); ++i)
+    {
+        AssetRefListenerPtr listener = pendingLoadedListeners[i].Lock();
+        if (listener)
+            listener->loadedPending = false;
+    }
+    pendingLoadedListeners.Clear();
     readyTransfers.Clear();
     readySubTransfers.Clear();
     assetDependencies.Clear();
@@ -865,6 +912,18 @@ AssetTransferPtr AssetAPI::RequestAsset(String assetRef, String assetType, bool
     // Note that we are using fullRef here as it has the complete sub asset ref also in it. If this is a sub asset request the assetRef has already been modified.
     AssetPtr existingAsset;
     AssetMap::iterator existingAssetIter = assets.find(fullAssetRef);
+    if (existingAssetIter == assets.end() && !contentAliases_.Empty())
+    {
+        // A deduplicated ref is served by the asset it aliases, unless new data is explicitly requested for it.
+        HashMap<String, String>::ConstIterator aliasIter = contentAliases_.Find(fullAssetRef);
+        if (aliasIter != contentAliases_.End())
+        {
+            if (forceTransfer)
+                contentAliases_.Erase(fullAssetRef);
+            else
+                existingAssetIter = assets.find(aliasIter->second_);
+        }
+    }
     if (existingAssetIter != assets.end())
     {
         existingAsset = existingAssetIter->second;
@@ -987,6 +1046,7 @@ AssetTransferPtr AssetAPI::RequestAsset(String assetRef, String assetType, bool
 
     // Push to pending transfers. These will be sorted by IAssetTransferPrioritizer prior to actual execution.
     pendingTransfers_.Push(transfer);
+    loadTimeline_->Mark(assetRef, AssetLoadTimeline::Queued);
 
     // Request for a direct asset reference.
     if (!isSubAsset)
@@ -1038,6 +1098,32 @@ AssetTransferPtr AssetAPI::RequestAsset(const AssetReference &ref, bool forceTra
     return RequestAsset(ref.ref, ref.type, forceTransfer);
 }
 
+uint AssetAPI::PrefetchAssets(const AssetPrefetchManifest &manifest)
+{
+    URHO3D_PROFILE(AssetAPI_PrefetchAssets);
+
+    Vector<AssetPrefetchManifest::Entry> entries = manifest.PrioritizedEntries();
+    uint numRequested = 0;
+    for(uint i = 0; i < entries.Size(); ++i)
+    {
+        String ref = ResolveAssetRef("", entries[i].ref);
+        if (ref.Empty() || currentTransfers.find(ref) != currentTransfers.end())
+            continue;
+        AssetPtr existing = FindAsset(ref);
+        if (existing && existing->IsLoaded())
+            continue;
+
+        AssetTransferPtr transfer = RequestAsset(ref, entries[i].type);
+        if (transfer)
+        {
+            transfer->priority = (int)(entries.Size() - i);
+            ++numRequested;
+        }
+    }
+    LogDebugF("AssetAPI::PrefetchAssets: Requested %d of %d assets in the manifest", numRequested, entries.Size());
+    return numRequested;
+}
+
 AssetProviderPtr AssetAPI::ProviderForAssetRef(String assetRef, String assetType) const
 {
     URHO3D_PROFILE(AssetAPI_GetProviderForAssetRef);
@@ -1086,6 +1172,34 @@ String AssetAPI::ResolveAssetRef(String context, String assetRef) const
     if (iter != assets.end())
         return assetRef; // Use the ref as-is, there's an existing asset to map this string to.
 
+    // Otherwise the result depends only on the context, the ref and the asset storages, so it can be memoized.
+    HashMap<String, HashMap<String, String> >::Iterator contextIter = resolvedRefs.Find(context);
+    if (contextIter != resolvedRefs.End())
+    {
+        HashMap<String, String>::ConstIterator refIter = contextIter->second_.Find(assetRef);
+        if (refIter != contextIter->second_.End())
+            return refIter->second_;
+    }
+
+    String resolved = ResolveAssetRefUncached(context, assetRef);
+    if (numResolvedRefs >= cMaxResolvedRefs)
+    {
+        resolvedRefs.Clear();
+        numResolvedRefs = 0;
+    }
+    resolvedRefs[context][assetRef] = resolved;
+    ++numResolvedRefs;
+    return resolved;
+}
+
+void AssetAPI::ClearResolvedRefs()
+{
+    resolvedRefs.Clear();
+    numResolvedRefs = 0;
+}
+
+String AssetAPI::ResolveAssetRefUncached(const String &context, String assetRef) const
+{
     // If the assetRef is by local filename without a reference to a provider or storage, use the default asset storage in the system for this assetRef.
     String assetPath;
     String namedStorage;
@@ -1290,6 +1404,22 @@ AssetPtr AssetAPI::CreateNewAsset(String type, String name, AssetStoragePtr stor
         URHO3D_PROFILE(AssetAPI_CreateNewAsset_emit_AssetCreated);
         AssetCreated.Emit(asset);
     }
+
+    // Wake up the listeners waiting for this asset.
+    AssetCreatedWaiterMap::Iterator waiters = assetCreatedWaiters.Find(asset->Name());
+    if (waiters != assetCreatedWaiters.End())
+    {
+        // The handlers may register new waiters, so detach the list first.
+        Vector<AssetRefListenerWeakPtr> listeners;
+        listeners.Swap(waiters->second_);
+        assetCreatedWaiters.Erase(waiters);
+        for(uint i = 0; i < listeners.Size(); ++i)
+        {
+            AssetRefListenerPtr listener = listeners[i].Lock();
+            if (listener)
+                listener->OnAssetCreated(asset);
+        }
+    }
     
     return asset;
 }
@@ -1345,6 +1475,17 @@ bool AssetAPI::LoadSubAssetToTransfer(AssetTransferPtr transfer, const String &b
     }
 }
 
+bool AssetAPI::IsSubAssetReady(const String &bundleRef, const String &fullSubAssetRef)
+{
+    AssetBundleMap::iterator bundleIter = assetBundles.find(bundleRef);
+    if (bundleIter == assetBundles.end())
+        return true; // LoadSubAssetToTransfer reports the error.
+
+    String subAssetRef;
+    ParseAssetRef(fullSubAssetRef, 0, 0, 0, 0, 0, 0, 0, &subAssetRef);
+    return (*bundleIter).second->PrepareSubAsset(subAssetRef);
+}
+
 bool AssetAPI::LoadSubAssetToTransfer(AssetTransferPtr transfer, IAssetBundle *bundle, const String &fullSubAssetRef, String subAssetType)
 {
     if (!transfer)
@@ -1458,6 +1599,14 @@ AssetPtr AssetAPI::FindAsset(String assetRef) const
     iter = assets.find(assetRef);
     if (iter != assets.end())
         return iter->second;
+
+    String aliased = AliasedAssetRef(assetRef);
+    if (!aliased.Empty())
+    {
+        iter = assets.find(aliased);
+        if (iter != assets.end())
+            return iter->second;
+    }
     return AssetPtr();
 }
 
@@ -1497,7 +1646,10 @@ void AssetAPI::Update(float frametime)
         foreach(AssetTransferPtr transfer, pendingTransfers_)
         {
             if (transfer->provider)
+            {
+                loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::Started);
                 transfer->provider->ExecuteTransfer(transfer);
+            }
             else
                 LogErrorF("AssetAPI: Cannot execute asset transfer '%s' as it has no provider", transfer->SourceUrl().CString());
         }
@@ -1508,6 +1660,21 @@ void AssetAPI::Update(float frametime)
     for(uint i = 0, num = providers.Size(); i<num; ++i)
         providers[i]->Update(frametime);
 
+    // Signal the listeners of already loaded assets.
+    if (!pendingLoadedListeners.Empty())
+    {
+        URHO3D_PROFILE(AssetAPI_EmitPendingLoaded);
+
+        Vector<AssetRefListenerWeakPtr> listeners;
+        listeners.Swap(pendingLoadedListeners);
+        for(uint i = 0; i < listeners.Size(); ++i)
+        {
+            AssetRefListenerPtr listener = listeners[i].Lock();
+            if (listener)
+                listener->EmitPendingLoaded();
+        }
+    }
+
     // Proceed with ready transfers.
     if (readyTransfers.Size() > 0)
     {
@@ -1534,13 +1701,23 @@ void AssetAPI::Update(float frametime)
         // readySubTransfers contains sub asset transfers to loaded bundles. The sub asset loading cannot be completed in RequestAsset
         // as it would trigger signals before the calling code can receive and hook to the AssetTransfer. We delay calling LoadSubAssetToTransfer
         // into this function so that all is hooked and loading can be done normally. This is very similar to the above case for readyTransfers.
-        for(uint i = 0, num = readySubTransfers.Size(); i<num; ++i)
+        // Sub assets that the bundle is still unpacking are kept for the following frames.
+        Vector<SubAssetLoader> pendingSubTransfers;
+        uint num = readySubTransfers.Size();
+        for(uint i = 0; i < num; ++i)
         {
             AssetTransferPtr subTransfer = readySubTransfers[i].subAssetTransfer;
+            if (!IsSubAssetReady(readySubTransfers[i].parentBundleRef, subTransfer->source.ref))
+            {
+                pendingSubTransfers.Push(readySubTransfers[i]);
+                continue;
+            }
             LoadSubAssetToTransfer(subTransfer, readySubTransfers[i].parentBundleRef, subTransfer->source.ref);
             subTransfer.Reset();
         }
-        readySubTransfers.Clear();
+        // Loading may have queued new sub transfers after the processed ones.
+        readySubTransfers.Erase(0, num);
+        readySubTransfers.Push(pendingSubTransfers);
     }
 }
 
@@ -1649,6 +1826,13 @@ void AssetAPI::AssetTransferCompleted(IAssetTransfer *transfer_)
     if (iter == currentTransfers.end())
         LogError("AssetAPI: Asset \"" + transfer->assetType + "\", name \"" + transfer->source.ref + "\" transfer finished, but no corresponding AssetTransferPtr was tracked by AssetAPI!");
 
+    loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::Received);
+    {
+        AssetStoragePtr storage = transfer->storage.Lock();
+        loadTimeline_->SetTransferInfo(transfer->source.ref, transfer->assetType, (storage ? storage->Name() : String::EMPTY),
+            transfer->rawAssetData.Size(), transfer->diskSourceType == IAsset::Cached);
+    }
+
     // Transfer is for an asset bundle.
     AssetBundleMonitorMap::iterator bundleIter = bundleMonitors.find(transfer->source.ref);
     if (bundleIter != bundleMonitors.end())
@@ -1674,6 +1858,7 @@ void AssetAPI::AssetTransferCompleted(IAssetTransfer *transfer_)
             // 2) If disk source deserialization fails, try in memory loading if bundle allows it with RequiresDiskSource.
             // Note: Be careful not to use bundleIter after DeserializeFromDiskSource is called, as it can righ away emit
             // Loaded and we end up to AssetBundleLoadCompleted that will remove this bundleIter from bundleMonitors map.
+            loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::DecodeStarted);
             bool success = assetBundle->DeserializeFromDiskSource();
             if (!success && !assetBundle->RequiresDiskSource())
             {
@@ -1705,6 +1890,22 @@ void AssetAPI::AssetTransferCompleted(IAssetTransfer *transfer_)
     // Transfer is for a normal asset.
     else
     {
+        // With content deduplication, a new ref whose data matches an already loaded asset aliases it instead of loading a copy.
+        String contentKey;
+        if (contentDeduplication_ && transfer->rawAssetData.Size() > 0)
+        {
+            contentKey = ContentHashKey(transfer->assetType, &transfer->rawAssetData[0], transfer->rawAssetData.Size());
+            if (!transfer->asset)
+            {
+                AssetPtr original = FindContentDuplicate(contentKey, transfer->source.ref);
+                if (original)
+                {
+                    AliasDuplicateAsset(transfer, original);
+                    return;
+                }
+            }
+        }
+
         // We've finished an asset data download, now create an actual instance of an asset of that type if it did not exist already
         if (!transfer->asset)
             transfer->asset = CreateNewAsset(transfer->assetType, transfer->source.ref);
@@ -1719,6 +1920,12 @@ void AssetAPI::AssetTransferCompleted(IAssetTransfer *transfer_)
         // Connect to Loaded() signal of the asset to be able to notify any dependent assets
         transfer->asset->Loaded.Connect(this, &AssetAPI::OnAssetLoaded);
 
+        // Remember the content of the asset for deduplicating later transfers. A reload replaces the previous content,
+        // so the refs that aliased the old content are separated from the asset and load their own data when requested again.
+        RemoveContentHashes(transfer->asset->Name());
+        if (!contentKey.Empty() && !contentHashes_.Contains(contentKey))
+            contentHashes_[contentKey] = transfer->asset->Name();
+
         // Save this asset to cache, and find out which file will represent a cached version of this asset.
         String assetDiskSource = transfer->DiskSource(); // The asset provider may have specified an explicit filename to use as a disk source.
         if (transfer->CachingAllowed() && transfer->rawAssetData.Size() > 0 && assetCache)
@@ -1737,8 +1944,20 @@ void AssetAPI::AssetTransferCompleted(IAssetTransfer *transfer_)
         // Tell everyone this transfer has now been downloaded. Note that when this signal is fired, the asset dependencies may not yet be loaded.
         transfer->EmitAssetDownloaded();
 
+        loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::DecodeStarted);
         bool success = false;
         const u8 *data = (transfer->rawAssetData.Size() > 0 ? &transfer->rawAssetData[0] : 0);
+
+        // A forced re-transfer of a loaded asset: update the content in place if the asset supports it and nothing depends on it.
+        // The dependencies are unchanged, so the transfer is finished right away.
+        if (data && CanReloadInPlace(transfer->asset) && transfer->asset->ReloadInPlace(data, transfer->rawAssetData.Size()))
+        {
+            loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::DecodeFinished);
+            AssetDependenciesCompleted(transfer);
+            loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::Loaded);
+            return;
+        }
+
         if (data)
             success = transfer->asset->LoadFromFileInMemory(data, transfer->rawAssetData.Size());
         else
@@ -1759,6 +1978,7 @@ void AssetAPI::AssetTransferFailed(IAssetTransfer *transfer, String reason)
         return;
         
     LogError("Transfer of asset \"" + transfer->assetType + "\", name \"" + transfer->source.ref + "\" failed! Reason: \"" + reason + "\"");
+    loadTimeline_->SetFailed(transfer->source.ref);
 
     ///\todo In this function, there is a danger of reaching an infinite recursion. Remember recursion parents and avoid infinite loops. (A -> B -> C -> A)
 
@@ -1794,6 +2014,7 @@ void AssetAPI::AssetTransferAborted(IAssetTransfer *transfer)
     // Don't log any errors for aborted transfers. This is unwanted spam when we disconnect 
     // from a server and have x amount of pending transfers that get aborter.
     AssetTransferMap::iterator iter = currentTransfers.find(transfer->source.ref);
+    loadTimeline_->SetFailed(transfer->source.ref);
     
     transfer->EmitAssetFailed("Transfer aborted.");   
 
@@ -1815,6 +2036,8 @@ void AssetAPI::AssetLoadCompleted(const String assetRef)
 {
     URHO3D_PROFILE(AssetAPI_AssetLoadCompleted);
 
+    loadTimeline_->Mark(assetRef, AssetLoadTimeline::DecodeFinished);
+
     AssetPtr asset;
     AssetTransferMap::const_iterator iter = FindTransferIterator(assetRef);
     AssetMap::iterator iter2 = assets.find(assetRef);
@@ -1877,6 +2100,8 @@ void AssetAPI::AssetLoadFailed(const String assetRef)
 void AssetAPI::AssetBundleLoadCompleted(IAssetBundle *bundle)
 {
     LogDebug("Asset bundle load completed: " + bundle->Name());
+    loadTimeline_->Mark(bundle->Name(), AssetLoadTimeline::DecodeFinished);
+    loadTimeline_->Mark(bundle->Name(), AssetLoadTimeline::Loaded);
     
     // First erase the transfer as the below sub asset loading can trigger new
     // dependency asset requests to the bundle. In this case we want to load them from the
@@ -1896,8 +2121,14 @@ void AssetAPI::AssetBundleLoadCompleted(IAssetBundle *bundle)
         bundleMonitors.erase(monitorIter);
         
         // Start the load process for all sub asset transfers now. From here on out the normal asset request flow should followed.
+        // Sub assets that the bundle needs to unpack first are loaded from Update once ready.
         for (Vector<AssetTransferPtr>::Iterator subIter = subTransfers.Begin(); subIter != subTransfers.End(); ++subIter)
-            LoadSubAssetToTransfer((*subIter), bundle, (*subIter)->source.ref);
+        {
+            if (IsSubAssetReady(bundle->Name(), (*subIter)->source.ref))
+                LoadSubAssetToTransfer((*subIter), bundle, (*subIter)->source.ref);
+            else
+                readySubTransfers.Push(SubAssetLoader(bundle->Name(), (*subIter)));
+        }
     }
     else
         LogWarning("AssetAPI: Asset bundle load completed, but bundle monitor cannot be found: " + bundle->Name());
@@ -1956,6 +2187,8 @@ void AssetAPI::AssetDependenciesCompleted(AssetTransferPtr transfer)
 {    
     URHO3D_PROFILE(AssetAPI_AssetDependenciesCompleted);
 
+    loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::DependenciesResolved);
+
     // Emit success for this transfer
     transfer->EmitTransferSucceeded();
 
@@ -1968,6 +2201,101 @@ void AssetAPI::AssetDependenciesCompleted(AssetTransferPtr transfer)
         pendingDownloadRequests.erase(downloadIter);
 }
 
+void AssetAPI::SaveLoadTimeline(const StringVector &params)
+{
+    String filename = (!params.Empty() ? params[0].Trimmed() : String::EMPTY);
+    if (filename.Empty())
+    {
+        LogError("saveAssetTimeline: No filename given. Usage: saveAssetTimeline(filename)");
+        return;
+    }
+    if (loadTimeline_->SaveToFile(filename))
+        LogInfo(Urho3D::ToString("saveAssetTimeline: Wrote %d asset loads to %s", loadTimeline_->Records().Size(), filename.CString()));
+}
+
+void AssetAPI::PrintLoadStatistics()
+{
+    StringVector lines = loadTimeline_->StatisticsString().Split('\n');
+    foreach(const String &line, lines)
+        LogInfo(line);
+    if (contentDeduplication_)
+        LogInfo(Urho3D::ToString("Content deduplication: %u decodes and %llu bytes saved, %u aliases", deduplicationStats_.decodesSaved,
+            deduplicationStats_.bytesSaved, contentAliases_.Size()));
+}
+
+void AssetAPI::SetContentDeduplicationEnabled(bool enabled)
+{
+    contentDeduplication_ = enabled;
+}
+
+String AssetAPI::AliasedAssetRef(String assetRef) const
+{
+    if (contentAliases_.Empty())
+        return String::EMPTY;
+    HashMap<String, String>::ConstIterator iter = contentAliases_.Find(assetRef);
+    if (iter == contentAliases_.End())
+        iter = contentAliases_.Find(ResolveAssetRef("", assetRef));
+    return (iter != contentAliases_.End() ? iter->second_ : String::EMPTY);
+}
+
+AssetPtr AssetAPI::FindContentDuplicate(const String &contentKey, const String &assetRef) const
+{
+    HashMap<String, String>::ConstIterator iter = contentHashes_.Find(contentKey);
+    if (iter == contentHashes_.End() || iter->second_ == assetRef)
+        return AssetPtr();
+
+    // The asset must be ready to be used as is, and be of the type that was requested.
+    AssetMap::const_iterator assetIter = assets.find(iter->second_);
+    if (assetIter == assets.end())
+        return AssetPtr();
+    AssetPtr original = assetIter->second;
+    if (!original->IsLoaded() || HasPendingDependencies(original) || currentTransfers.find(original->Name()) != currentTransfers.end())
+        return AssetPtr();
+
+    // Relative references in the content are resolved against the name of the asset, so the same data in another location
+    // may refer to different assets. Alias such content only if a relative ref resolves the same from both names.
+    if (!original->FindReferences().Empty() && ResolveAssetRefUncached(original->Name(), "ref") != ResolveAssetRefUncached(assetRef, "ref"))
+        return AssetPtr();
+    return original;
+}
+
+void AssetAPI::AliasDuplicateAsset(AssetTransferPtr transfer, AssetPtr original)
+{
+    URHO3D_PROFILE(AssetAPI_AliasDuplicateAsset);
+
+    LogDebug("AssetAPI: Asset \"" + transfer->source.ref + "\" has the same content as \"" + original->Name() + "\", using it instead of loading a copy.");
+    contentAliases_[transfer->source.ref] = original->Name();
+    deduplicationStats_.decodesSaved++;
+    deduplicationStats_.bytesSaved += transfer->rawAssetData.Size();
+
+    // Cache the data nevertheless, so that the alias is found from the cache on the next run.
+    if (transfer->CachingAllowed() && assetCache)
+        assetCache->StoreAsset(&transfer->rawAssetData[0], transfer->rawAssetData.Size(), transfer->source.ref);
+
+    transfer->asset = original;
+    transfer->EmitAssetDownloaded();
+    AssetDependenciesCompleted(transfer);
+    loadTimeline_->Mark(transfer->source.ref, AssetLoadTimeline::Loaded);
+}
+
+void AssetAPI::RemoveContentHashes(const String &assetRef)
+{
+    for(HashMap<String, String>::Iterator iter = contentHashes_.Begin(); iter != contentHashes_.End();)
+    {
+        if (iter->second_ == assetRef)
+            iter = contentHashes_.Erase(iter);
+        else
+            ++iter;
+    }
+    for(HashMap<String, String>::Iterator iter = contentAliases_.Begin(); iter != contentAliases_.End();)
+    {
+        if (iter->second_ == assetRef)
+            iter = contentAliases_.Erase(iter);
+        else
+            ++iter;
+    }
+}
+
 void AssetAPI::NotifyAssetDependenciesChanged(AssetPtr asset)
 {
     URHO3D_PROFILE(AssetAPI_NotifyAssetDependenciesChanged);
@@ -2021,6 +2349,12 @@ void AssetAPI::RemoveAssetDependencies(String asset)
         }
 }
 
+bool AssetAPI::CanReloadInPlace(const AssetPtr &asset)
+{
+    // An in-place reload only emits ContentReloaded, so the dependents would never see the new content.
+    return asset && asset->IsLoaded() && asset->SupportsInPlaceReload() && FindDependents(asset->Name()).Empty();
+}
+
 Vector<AssetPtr> AssetAPI::FindDependents(String dependee)
 {
     URHO3D_PROFILE(AssetAPI_FindDependents);
@@ -2150,6 +2484,48 @@ void AssetAPI::HandleAssetDeleted(const String &assetRef)
         ForgetAsset(existing, false);
 }
 
+void AssetAPI::AddAssetCreatedWaiter(const String &assetRef, AssetRefListener *listener)
+{
+    if (!listener || assetRef.Empty())
+        return;
+
+    Vector<AssetRefListenerWeakPtr> &waiters = assetCreatedWaiters[assetRef];
+    for(uint i = 0; i < waiters.Size();)
+    {
+        if (waiters[i].Get() == listener)
+            return;
+        if (waiters[i].Expired())
+            waiters.Erase(i);
+        else
+            ++i;
+    }
+    waiters.Push(AssetRefListenerWeakPtr(listener));
+}
+
+void AssetAPI::RemoveAssetCreatedWaiter(const String &assetRef, AssetRefListener *listener)
+{
+    AssetCreatedWaiterMap::Iterator iter = assetCreatedWaiters.Find(assetRef);
+    if (iter == assetCreatedWaiters.End())
+        return;
+
+    Vector<AssetRefListenerWeakPtr> &waiters = iter->second_;
+    for(uint i = 0; i < waiters.Size();)
+    {
+        if (waiters[i].Expired() || waiters[i].Get() == listener)
+            waiters.Erase(i);
+        else
+            ++i;
+    }
+    if (waiters.Empty())
+        assetCreatedWaiters.Erase(iter);
+}
+
+void AssetAPI::QueueAssetRefListenerLoaded(AssetRefListener *listener)
+{
+    if (listener)
+        pendingLoadedListeners.Push(AssetRefListenerWeakPtr(listener));
+}
+
 void AssetAPI::EmitAssetDeletedFromStorage(const String &assetRef)
 {
     AssetDeletedFromStorage.Emit(assetRef);
@@ -2160,6 +2536,7 @@ void AssetAPI::EmitAssetStorageAdded(AssetStoragePtr newStorage)
     // Connect to the asset storage's AssetChanged signal, so that we can create actual empty assets
     // from its refs whenever new assets are added to this storage from external sources.
     newStorage->AssetChanged.Connect(this, &AssetAPI::OnAssetChanged);
+    ClearResolvedRefs();
     AssetStorageAdded.Emit(newStorage);
 }
 
@@ -2202,6 +2579,8 @@ void AssetAPI::OnAssetLoaded(AssetPtr asset)
 {
     URHO3D_PROFILE(AssetAPI_OnAssetLoaded);
 
+    loadTimeline_->Mark(asset->Name(), AssetLoadTimeline::Loaded);
+
     Vector<AssetPtr> dependents = FindDependents(asset->Name());
     for(uint i = 0; i < dependents.Size(); ++i)
     {
@@ -2238,7 +2617,12 @@ void AssetAPI::OnAssetDiskSourceChanged(const String &path)
                 if (storage->HasLiveUpdate())
                 {
                     LogInfo("AssetAPI: Detected file changes in '" + path + "', reloading asset.");
-                    bool success = asset->LoadFromCache();
+                    // Prefer updating the content in place when no other asset depends on it, see CanReloadInPlace.
+                    bool success = (CanReloadInPlace(asset) && asset->ReloadInPlaceFromDiskSource());
+                    if (!success)
+                        success = asset->LoadFromCache();
+                    // The content changed, so it no longer matches the content hash nor the refs that aliased it.
+                    RemoveContentHashes(asset->Name());
                     if (!success)
                         LogError("Failed to reload changed asset \"" + asset->ToString() + "\" from file \"" + path + "\"!");
                     else
@@ -2285,8 +2669,18 @@ void AssetAPI::OnAssetChanged(IAssetStorage* storage, String localName, String d
         if (existing)
         {
             ///\todo Profile performance difference between LoadFromCache and RequestAsset
-            if (existing->IsLoaded()) // Note: exists->LoadFromCache() could be used here as well.
-                RequestAsset(assetRef, assetType, true); // If asset exists and is already loaded, forcibly request updated data
+            if (existing->IsLoaded())
+            {
+                // If the notified file is the asset's own source, its content can be updated in place without a transfer.
+                if (!diskSource.Empty() && existing->DiskSource() == diskSource.Trimmed() && existing->DiskSourceType() == IAsset::Original &&
+                    CanReloadInPlace(existing) && existing->ReloadInPlaceFromDiskSource())
+                {
+                    LogDebug("AssetAPI: Reloaded modified asset " + assetRef + " in place.");
+                    RemoveContentHashes(assetRef);
+                }
+                else
+                    RequestAsset(assetRef, assetType, true); // If asset exists and is already loaded, forcibly request updated data
+            }
             else
                 LogDebug("AssetAPI: Ignoring AssetModify notification for unloaded asset " + assetRef + ".");
         }
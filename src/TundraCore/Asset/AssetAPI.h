@@ -173,7 +173,7 @@ public:
         @param outSubAssetName [out] Returns the sub asset name in the ref. e.g. "local://path/folder/asset.zip#subAsset" -> "subAsset".
         @param outFullRef [out] Returns a cleaned or "canonicalized" version of the asset ref in full.
         @param outFullRefNoSubAssetName [out] Returns a cleaned or "canonicalized" version of the asset ref in full without possible sub asset. */
-    static AssetRefType ParseAssetRef(String assetRef, String *outProtocolPart = 0, String *outNamedStorage = 0, String *outProtocol_Path = 0, 
+    static AssetRefType ParseAssetRef(const String &assetRef, String *outProtocolPart = 0, String *outNamedStorage = 0, String *outProtocol_Path = 0, 
         String *outPath_Filename_SubAssetName = 0, String *outPath_Filename = 0, String *outPath = 0, String *outFilename = 0, String *outSubAssetName = 0,
         String *outFullRef = 0, String *outFullRefNoSubAssetName = 0);
 
@@ -224,6 +224,12 @@ public:
     AssetTransferPtr RequestAsset(String assetRef, String assetType = "", bool forceTransfer = false);
     AssetTransferPtr RequestAsset(const AssetReference &ref, bool forceTransfer = false); /**< @overload */
 
+    /// Requests all the assets listed in @c manifest up front, instead of discovering them level by level as dependencies get loaded.
+    /** The transfers are given descending priorities in AssetPrefetchManifest::PrioritizedEntries order, above the default priority 0.
+        Assets that are already loaded or being transferred are skipped.
+        @return Number of new transfers started. */
+    uint PrefetchAssets(const AssetPrefetchManifest &manifest);
+
     /// Returns the asset provider that is used to fetch assets from the given full URL.
     /** Example: GetProviderForAssetRef("local://my.mesh") will return an instance of LocalAssetProvider.
         @param assetRef The asset reference name to query a provider for.
@@ -274,6 +280,35 @@ public:
     /// Returns the asset cache object that generates a disk source for all assets.
     AssetCache *Cache() const { return assetCache; }
 
+    /// Returns the load timing of the executed asset transfers.
+    /** Tells where the time of slow asset loads goes. Exported with the saveAssetTimeline console command
+        and summarized with printAssetLoadStats and in the debug HUD. */
+    AssetLoadTimeline *LoadTimeline() const { return loadTimeline_; }
+
+    /// Work saved by content deduplication, @see SetContentDeduplicationEnabled.
+    struct DeduplicationStats
+    {
+        DeduplicationStats() : decodesSaved(0), bytesSaved(0) {}
+
+        uint decodesSaved; ///< Number of transfers that aliased a loaded asset instead of loading a new one.
+        unsigned long long bytesSaved; ///< Total size of the asset data that was not loaded again.
+    };
+
+    /// Sets if assets are deduplicated by their content. Disabled by default, enabled with the --dedupAssets command line parameter.
+    /** When a transfer of a new ref completes with data byte-identical to an already loaded asset of the same type, the ref becomes
+        an alias of the loaded asset instead of creating, decoding and keeping a copy in memory. FindAsset and RequestAsset return
+        the loaded asset for the alias, whose Name() is its original ref. Forcing a transfer of an alias or changing the content
+        of the loaded asset separates it again. Content is compared by type, size and a 64-bit hash. Assets with references are
+        aliased only between refs that resolve relative references identically, as the references are resolved against Name(). */
+    void SetContentDeduplicationEnabled(bool enabled);
+    bool IsContentDeduplicationEnabled() const { return contentDeduplication_; }
+
+    /// Returns the work saved by content deduplication so far.
+    const DeduplicationStats &DeduplicationStatistics() const { return deduplicationStats_; }
+
+    /// Returns the name of the asset @c assetRef is an alias of due to content deduplication, or empty if it is not an alias.
+    String AliasedAssetRef(String assetRef) const;
+
     /// Returns the asset storage of the given name.
     /// @param name The name of the storage to get. Remember that Asset Storage names are case-insensitive.
     AssetStoragePtr AssetStorageByName(const String &name) const;
@@ -332,6 +367,11 @@ public:
         If ref is an absolute asset reference, it is returned unmodified (no need for context). */
     String ResolveAssetRef(String context, String ref) const;
 
+    /// Clears the memoized ResolveAssetRef results.
+    /** Done automatically when asset storages are added or removed through AssetAPI or the default storage changes.
+        Needs to be called only if the way a storage maps refs to full asset URLs changes otherwise. */
+    void ClearResolvedRefs();
+
     /// Given an assetRef, turns it into a native OS file path to the asset.
     /** The given ref is resolved in the context of "local://", if it is a relative asset ref.
         If ref contains a subAssetName, it is stripped from outFilePath, and returned in subAssetName.
@@ -444,6 +484,18 @@ public:
     /// Return ready asset transfers (debugging)
     const Vector<AssetTransferPtr>& DebugGetReadyTransfers() const { return readyTransfers; }
 
+    /// Registers @c listener to be notified when the asset @c assetRef is created.
+    /** Unlike with AssetCreated, only the listeners waiting for the created asset are notified.
+        The registration is dropped after the notification, or when the listener is destroyed. */
+    void AddAssetCreatedWaiter(const String &assetRef, AssetRefListener *listener);
+
+    /// Unregisters a listener registered with AddAssetCreatedWaiter.
+    void RemoveAssetCreatedWaiter(const String &assetRef, AssetRefListener *listener);
+
+    /// Makes @c listener emit Loaded for its already loaded asset on the next Update.
+    /** The listeners queued during a frame are signaled in one batch. */
+    void QueueAssetRefListenerLoaded(AssetRefListener *listener);
+
     /// Emitted for each new asset that was created and added to the system.
     /** When this signal is triggered, the dependencies of an asset may not yet have been loaded. */
     Signal1<AssetPtr> AssetCreated;
@@ -494,6 +546,12 @@ private:
     /// Listens to the IAssetBundle Failed signal.
     void AssetBundleLoadFailed(IAssetBundle *bundle);
 
+    /// Handles the saveAssetTimeline console command.
+    void SaveLoadTimeline(const StringVector &params);
+
+    /// Handles the printAssetLoadStats console command.
+    void PrintLoadStatistics();
+
 private:
     AssetTransferMap::iterator FindTransferIterator(String assetRef);
     AssetTransferMap::const_iterator FindTransferIterator(String assetRef) const;
@@ -509,6 +567,15 @@ private:
     /// Removes from AssetDependenciesMap all dependencies the given asset has.
     void RemoveAssetDependencies(String asset);
 
+    /// Returns a loaded asset whose content matches @c contentKey and that can be aliased by @c assetRef, or null.
+    AssetPtr FindContentDuplicate(const String &contentKey, const String &assetRef) const;
+
+    /// Finishes @c transfer by making its ref an alias of the loaded asset @c original.
+    void AliasDuplicateAsset(AssetTransferPtr transfer, AssetPtr original);
+
+    /// Forgets the content hash and the aliases of @c assetRef. Called when the asset is forgotten or its content changes.
+    void RemoveContentHashes(const String &assetRef);
+
     /// Handle discovery of a new asset, when the storage is already known. This is used internally for optimization, so that providers don't need to be queried
     void HandleAssetDiscovery(const String &assetRef, const String &assetType, AssetStoragePtr storage);
     
@@ -521,6 +588,13 @@ private:
     /// Overload that takes in AssetBundlePtr instead of refs.
     bool LoadSubAssetToTransfer(AssetTransferPtr transfer, IAssetBundle *bundle, const String &fullSubAssetRef, String subAssetType = String());
 
+    /// Returns if the sub asset can be loaded from its bundle now, see IAssetBundle::PrepareSubAsset.
+    bool IsSubAssetReady(const String &bundleRef, const String &fullSubAssetRef);
+
+    /// Returns if a changed @c asset can be updated with IAsset::ReloadInPlace instead of a full reload.
+    /** Assets that other assets depend on are always fully reloaded, so that their dependents are reloaded as well. */
+    bool CanReloadInPlace(const AssetPtr &asset);
+
     bool isHeadless;
 
     /// Stores all the currently ongoing asset transfers.
@@ -532,6 +606,17 @@ private:
     /// Asset transfer prioritizer.
     AssetTransferPrioritizerPtr transferPrioritizer_;
 
+    /// Load timing of the executed transfers.
+    SharedPtr<AssetLoadTimeline> loadTimeline_;
+
+    /// If true, new refs with the same content as a loaded asset alias it. @see SetContentDeduplicationEnabled
+    bool contentDeduplication_;
+    /// Loaded asset names by their content key (type, size and hash of the data).
+    HashMap<String, String> contentHashes_;
+    /// Deduplicated refs mapped to the name of the asset they alias.
+    HashMap<String, String> contentAliases_;
+    DeduplicationStats deduplicationStats_;
+
     /// Stores all the currently ongoing asset bundle monitors.
     AssetBundleMonitorMap bundleMonitors;
 
@@ -585,6 +670,21 @@ private:
 
     Framework *fw;
     SharedPtr<AssetCache> assetCache;
+
+    /// Resolves the ref without looking up or storing the result in resolvedRefs.
+    String ResolveAssetRefUncached(const String &context, String assetRef) const;
+
+    typedef HashMap<String, Vector<AssetRefListenerWeakPtr> > AssetCreatedWaiterMap;
+    /// Listeners waiting for an asset to be created, by asset ref. @see AddAssetCreatedWaiter
+    AssetCreatedWaiterMap assetCreatedWaiters;
+
+    /// Listeners that emit Loaded on the next Update. @see QueueAssetRefListenerLoaded
+    Vector<AssetRefListenerWeakPtr> pendingLoadedListeners;
+
+    /// Memoized ResolveAssetRef results, by context and ref.
+    mutable HashMap<String, HashMap<String, String> > resolvedRefs;
+    /// Number of results in resolvedRefs.
+    mutable uint numResolvedRefs;
 };
 
 }
@@ -30,6 +30,8 @@ typedef WeakPtr<IAssetTransfer> AssetTransferWeakPtr;
 typedef Vector<AssetTransferPtr > AssetTransferPtrVector;
 
 class IAssetTransferPrioritizer;
+class AssetPrefetchManifest;
+class AssetLoadTimeline;
 typedef SharedPtr<IAssetTransferPrioritizer> AssetTransferPrioritizerPtr;
 typedef WeakPtr<IAssetTransferPrioritizer> AssetTransferPrioritizerWeakPtr;
 
@@ -60,6 +62,7 @@ typedef SharedPtr<IAssetBundleTypeFactory> AssetBundleTypeFactoryPtr;
 
 class AssetRefListener;
 typedef SharedPtr<AssetRefListener> AssetRefListenerPtr;
+typedef WeakPtr<AssetRefListener> AssetRefListenerWeakPtr;
 
 class AssetRefListListener;
 typedef SharedPtr<AssetRefListListener> AssetRefListListenerPtr;
@@ -0,0 +1,319 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "StableHeaders.h"
+#include "AssetLoadTimeline.h"
+#include "AssetAPI.h"
+#include "JSON/JSON.h"
+#include "LoggingFunctions.h"
+#include "Math/MathFunc.h"
+
+#include <Urho3D/Core/StringUtils.h>
+
+namespace Tundra
+{
+
+static String MSecString(long long usec)
+{
+    return Urho3D::ToString("%.1f ms", usec / 1000.0);
+}
+
+AssetLoadTimeline::Record::Record() :
+    bytes(0),
+    cacheHit(false),
+    failed(false)
+{
+    for(int i = 0; i < NumStages; ++i)
+        stages[i] = -1;
+}
+
+long long AssetLoadTimeline::Record::Duration(Stage from, Stage to) const
+{
+    if (stages[from] < 0 || stages[to] < 0)
+        return -1;
+    return (stages[to] > stages[from] ? stages[to] - stages[from] : 0);
+}
+
+AssetLoadTimeline::AssetLoadTimeline() :
+    enabled_(true)
+{
+}
+
+void AssetLoadTimeline::Clear()
+{
+    records_.Clear();
+    latestRecord_.Clear();
+    clock_.Reset();
+}
+
+AssetLoadTimeline::Record *AssetLoadTimeline::FindRecord(const String &ref)
+{
+    HashMap<String, uint>::ConstIterator iter = latestRecord_.Find(ref);
+    return (iter != latestRecord_.End() ? &records_[iter->second_] : 0);
+}
+
+const AssetLoadTimeline::Record *AssetLoadTimeline::Find(const String &ref) const
+{
+    HashMap<String, uint>::ConstIterator iter = latestRecord_.Find(ref);
+    return (iter != latestRecord_.End() ? &records_[iter->second_] : 0);
+}
+
+void AssetLoadTimeline::Mark(const String &ref, Stage stage)
+{
+    if (!enabled_)
+        return;
+
+    Record *record = 0;
+    if (stage == Queued)
+    {
+        if (records_.Size() >= MaxRecords)
+            DropOldestRecords();
+        latestRecord_[ref] = records_.Size();
+        records_.Push(Record());
+        record = &records_.Back();
+        record->ref = ref;
+    }
+    else
+        record = FindRecord(ref);
+
+    // A reached stage is not overwritten, eg. by a reload that decodes the same asset again without a new transfer.
+    if (record && record->stages[stage] < 0)
+        record->stages[stage] = clock_.GetUSec(false);
+}
+
+void AssetLoadTimeline::DropOldestRecords()
+{
+    // Dropping in bulk keeps the cost of reindexing low. Pending records are kept, unless there is nothing else to drop.
+    bool dropPending = true;
+    foreach(const Record &record, records_)
+        if (record.failed || record.stages[Loaded] >= 0)
+        {
+            dropPending = false;
+            break;
+        }
+
+    Vector<Record> kept;
+    kept.Reserve(records_.Size());
+    uint numDropped = 0;
+    foreach(const Record &record, records_)
+    {
+        if (numDropped < MaxRecords / 4 && (dropPending || record.failed || record.stages[Loaded] >= 0))
+            ++numDropped;
+        else
+            kept.Push(record);
+    }
+    records_.Swap(kept);
+
+    latestRecord_.Clear();
+    for(uint i = 0; i < records_.Size(); ++i)
+        latestRecord_[records_[i].ref] = i;
+}
+
+void AssetLoadTimeline::SetTransferInfo(const String &ref, const String &type, const String &storage, uint bytes, bool cacheHit)
+{
+    Record *record = (enabled_ ? FindRecord(ref) : 0);
+    if (!record)
+        return;
+    record->type = type;
+    record->storage = storage;
+    record->bytes = bytes;
+    record->cacheHit = cacheHit;
+}
+
+void AssetLoadTimeline::SetFailed(const String &ref)
+{
+    Record *record = (enabled_ ? FindRecord(ref) : 0);
+    if (record)
+        record->failed = true;
+}
+
+AssetLoadTimeline::Statistics AssetLoadTimeline::ComputeStatistics(uint numSlowest) const
+{
+    Statistics stats;
+    foreach(const Record &record, records_)
+    {
+        if (record.failed)
+            stats.numFailed++;
+        else if (record.stages[Loaded] >= 0)
+        {
+            stats.numLoaded++;
+
+            // Keep the slowest sorted, there are only a few of them.
+            long long loadTime = record.Duration(Queued, Loaded);
+            uint pos = stats.slowest.Size();
+            while(pos > 0 && stats.slowest[pos - 1].Duration(Queued, Loaded) < loadTime)
+                --pos;
+            if (pos < numSlowest)
+            {
+                stats.slowest.Insert(pos, record);
+                if (stats.slowest.Size() > numSlowest)
+                    stats.slowest.Pop();
+            }
+        }
+        else
+            stats.numPending++;
+
+        long long queue = record.Duration(Queued, Started);
+        long long transfer = record.Duration(Started, Received);
+        long long decode = record.Duration(DecodeStarted, DecodeFinished);
+        long long dependencies = record.Duration(DecodeFinished, Loaded);
+        if (queue > 0)
+            stats.queueUSec += queue;
+        if (transfer > 0)
+            stats.transferUSec += transfer;
+        if (dependencies > 0)
+            stats.dependencyUSec += dependencies;
+        if (decode >= 0)
+        {
+            stats.decodeUSec += decode;
+            TypeStats &type = stats.types[record.type];
+            type.count++;
+            type.decodeUSec += decode;
+        }
+        if (record.stages[Received] >= 0)
+        {
+            StorageStats &storage = stats.storages[record.storage];
+            storage.transfers++;
+            if (record.cacheHit)
+                storage.cacheHits++;
+            storage.bytes += record.bytes;
+            if (transfer > 0)
+                storage.transferUSec += transfer;
+        }
+    }
+
+    return stats;
+}
+
+String AssetLoadTimeline::StatisticsString(uint numSlowest) const
+{
+    Statistics stats = ComputeStatistics(numSlowest);
+
+    String str;
+    str.AppendWithFormat("Asset loads: %u loaded, %u failed, %u pending\n", stats.numLoaded, stats.numFailed, stats.numPending);
+    str.Append("  Queued       " + MSecString(stats.queueUSec) + "\n");
+    str.Append("  Transferring " + MSecString(stats.transferUSec) + "\n");
+    str.Append("  Decoding     " + MSecString(stats.decodeUSec) + "\n");
+    str.Append("  Dependencies " + MSecString(stats.dependencyUSec) + "\n");
+
+    str.Append("Decode time by type:\n");
+    for(HashMap<String, TypeStats>::ConstIterator iter = stats.types.Begin(); iter != stats.types.End(); ++iter)
+        str.AppendWithFormat("  %s: %u assets, %s\n", (iter->first_.Empty() ? "<unknown>" : iter->first_.CString()),
+            iter->second_.count, MSecString(iter->second_.decodeUSec).CString());
+
+    str.Append("Cache hits by storage:\n");
+    for(HashMap<String, StorageStats>::ConstIterator iter = stats.storages.Begin(); iter != stats.storages.End(); ++iter)
+        str.AppendWithFormat("  %s: %u/%u (%.0f%%), %llu bytes, %s transferring\n", (iter->first_.Empty() ? "<unknown>" : iter->first_.CString()),
+            iter->second_.cacheHits, iter->second_.transfers, iter->second_.CacheHitRate() * 100.f, iter->second_.bytes,
+            MSecString(iter->second_.transferUSec).CString());
+
+    str.Append("Slowest assets:\n");
+    foreach(const Record &record, stats.slowest)
+    {
+        str.AppendWithFormat("  %s %s (queue %s, transfer %s, decode %s, dependencies %s)\n", MSecString(record.Duration(Queued, Loaded)).CString(),
+            record.ref.CString(), MSecString(Max(record.Duration(Queued, Started), 0LL)).CString(),
+            MSecString(Max(record.Duration(Started, Received), 0LL)).CString(), MSecString(Max(record.Duration(DecodeStarted, DecodeFinished), 0LL)).CString(),
+            MSecString(Max(record.Duration(DecodeFinished, Loaded), 0LL)).CString());
+    }
+    return str;
+}
+
+String AssetLoadTimeline::ToJSON(int spacing) const
+{
+    // Spans shown for each asset: the stage the span starts at, the stage it ends at, and its name.
+    static const Stage spans[][2] = { { Queued, Started }, { Started, Received }, { DecodeStarted, DecodeFinished }, { DecodeFinished, Loaded } };
+    static const char *spanNames[] = { "queue", "transfer", "decode", "dependencies" };
+
+    JSONValue events;
+    events.SetEmptyArray();
+    JSONValue assets;
+    assets.SetEmptyArray();
+    for(uint i = 0; i < records_.Size(); ++i)
+    {
+        const Record &record = records_[i];
+        for(uint s = 0; s < 4; ++s)
+        {
+            long long duration = record.Duration(spans[s][0], spans[s][1]);
+            if (duration < 0)
+                continue;
+            JSONValue event;
+            event["name"] = spanNames[s];
+            event["cat"] = (record.type.Empty() ? String("asset") : record.type);
+            event["ph"] = "X";
+            event["ts"] = (double)record.stages[spans[s][0]];
+            event["dur"] = (double)duration;
+            event["pid"] = 1;
+            event["tid"] = i;
+            event["args"]["ref"] = record.ref;
+            events.Push(event);
+        }
+
+        JSONValue asset;
+        asset["ref"] = record.ref;
+        asset["type"] = record.type;
+        asset["storage"] = record.storage;
+        asset["bytes"] = record.bytes;
+        asset["cacheHit"] = record.cacheHit;
+        asset["failed"] = record.failed;
+        for(int s = 0; s < NumStages; ++s)
+            if (record.stages[s] >= 0)
+                asset[StageName((Stage)s)] = (double)record.stages[s];
+        assets.Push(asset);
+    }
+
+    Statistics stats = ComputeStatistics();
+    JSONValue summary;
+    summary["loaded"] = stats.numLoaded;
+    summary["failed"] = stats.numFailed;
+    summary["pending"] = stats.numPending;
+    summary["queueUSec"] = (double)stats.queueUSec;
+    summary["transferUSec"] = (double)stats.transferUSec;
+    summary["decodeUSec"] = (double)stats.decodeUSec;
+    summary["dependencyUSec"] = (double)stats.dependencyUSec;
+    JSONValue &types = summary["decodeUSecByType"];
+    types.SetEmptyObject();
+    for(HashMap<String, TypeStats>::ConstIterator iter = stats.types.Begin(); iter != stats.types.End(); ++iter)
+        types[iter->first_] = (double)iter->second_.decodeUSec;
+    JSONValue &storages = summary["cacheHitRateByStorage"];
+    storages.SetEmptyObject();
+    for(HashMap<String, StorageStats>::ConstIterator iter = stats.storages.Begin(); iter != stats.storages.End(); ++iter)
+        storages[iter->first_] = iter->second_.CacheHitRate();
+    JSONValue &slowest = summary["slowest"];
+    slowest.SetEmptyArray();
+    foreach(const Record &record, stats.slowest)
+        slowest.Push(record.ref);
+
+    JSONValue root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    root["assets"] = assets;
+    root["summary"] = summary;
+    return root.ToString(spacing);
+}
+
+bool AssetLoadTimeline::SaveToFile(const String &filename) const
+{
+    String json = ToJSON();
+    if (!SaveAssetFromMemoryToFile(reinterpret_cast<const u8*>(json.CString()), json.Length(), filename))
+    {
+        LogError("AssetLoadTimeline::SaveToFile: Failed to write " + filename);
+        return false;
+    }
+    return true;
+}
+
+const char *AssetLoadTimeline::StageName(Stage stage)
+{
+    switch(stage)
+    {
+    case Queued: return "queued";
+    case Started: return "started";
+    case Received: return "received";
+    case DecodeStarted: return "decodeStarted";
+    case DecodeFinished: return "decodeFinished";
+    case DependenciesResolved: return "dependenciesResolved";
+    case Loaded: return "loaded";
+    default: return "";
+    }
+}
+
+}
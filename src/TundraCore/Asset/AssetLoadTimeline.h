@@ -0,0 +1,150 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#include "TundraCoreApi.h"
+#include "CoreTypes.h"
+
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Container/RefCounted.h>
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Container/Vector.h>
+#include <Urho3D/Core/Timer.h>
+
+namespace Tundra
+{
+
+/// Records when each asset transfer passes through the stages of the asset load pipeline.
+/** Tells whether slow loads are bound by queueing, the network, decoding or waiting for dependencies.
+    AssetAPI records every transfer it executes, @see AssetAPI::LoadTimeline. */
+class TUNDRACORE_API AssetLoadTimeline : public RefCounted
+{
+public:
+    /// Load pipeline stages, in the order they are normally reached.
+    enum Stage
+    {
+        Queued = 0,             ///< Requested and waiting for the prioritizer to execute the transfer.
+        Started,                ///< Handed to the asset provider.
+        Received,               ///< All data has been received from the provider.
+        DecodeStarted,          ///< IAsset::DeserializeFromData called.
+        DecodeFinished,         ///< Deserialization completed, possibly asynchronously.
+        DependenciesResolved,   ///< All dependencies are loaded and the transfer succeeded.
+        Loaded,                 ///< IAsset::Loaded emitted.
+        NumStages
+    };
+
+    /// Timing of a single asset transfer.
+    struct Record
+    {
+        Record();
+
+        /// Returns the microseconds spent between stages @c from and @c to, or -1 if either was not reached.
+        long long Duration(Stage from, Stage to) const;
+
+        String ref;
+        String type;
+        String storage; ///< Name of the storage the asset was transferred from, empty if unknown.
+        uint bytes; ///< Number of bytes received, 0 if the asset was loaded from a file.
+        bool cacheHit; ///< The data came from the asset cache instead of the source.
+        bool failed;
+        long long stages[NumStages]; ///< Microseconds since the timeline was started, -1 if the stage was not reached.
+    };
+
+    /// Decode times of an asset type.
+    struct TypeStats
+    {
+        TypeStats() : count(0), decodeUSec(0) {}
+
+        uint count;
+        long long decodeUSec;
+    };
+
+    /// Transfer counts of a storage.
+    struct StorageStats
+    {
+        StorageStats() : transfers(0), cacheHits(0), bytes(0), transferUSec(0) {}
+
+        /// Returns the share of transfers served from the asset cache, in the range [0, 1].
+        float CacheHitRate() const { return (transfers > 0 ? (float)cacheHits / (float)transfers : 0.f); }
+
+        uint transfers;
+        uint cacheHits;
+        unsigned long long bytes;
+        long long transferUSec;
+    };
+
+    /// Summary of the recorded transfers.
+    struct Statistics
+    {
+        Statistics() : numLoaded(0), numFailed(0), numPending(0), queueUSec(0), transferUSec(0), decodeUSec(0), dependencyUSec(0) {}
+
+        uint numLoaded;
+        uint numFailed;
+        uint numPending;
+        long long queueUSec; ///< Total time spent waiting for execution.
+        long long transferUSec; ///< Total time spent receiving data.
+        long long decodeUSec; ///< Total time spent decoding.
+        long long dependencyUSec; ///< Total time decoded assets were blocked waiting for their dependencies.
+        HashMap<String, TypeStats> types;
+        HashMap<String, StorageStats> storages;
+        Vector<Record> slowest; ///< Loaded assets with the longest time from Queued to Loaded, slowest first.
+    };
+
+    /// Maximum number of recorded transfers. When reached, the oldest finished records are dropped to make room.
+    static const uint MaxRecords = 16 * 1024;
+
+    AssetLoadTimeline();
+
+    /// Sets if transfers are recorded. Enabled by default.
+    void SetEnabled(bool enabled) { enabled_ = enabled; }
+    bool IsEnabled() const { return enabled_; }
+
+    /// Forgets all records and restarts the clock.
+    void Clear();
+
+    /// Records that the transfer of @c ref reached @c stage now.
+    /** Queued starts a new record for the ref, other stages are ignored for refs that have no record. */
+    void Mark(const String &ref, Stage stage);
+
+    /// Sets the information of the transfer of @c ref known when its data has been received.
+    void SetTransferInfo(const String &ref, const String &type, const String &storage, uint bytes, bool cacheHit);
+
+    /// Marks the transfer of @c ref failed.
+    void SetFailed(const String &ref);
+
+    /// Returns the latest record of @c ref, or null if not recorded.
+    const Record *Find(const String &ref) const;
+
+    /// Returns the records in the order they were queued.
+    const Vector<Record> &Records() const { return records_; }
+
+    /// Computes the summary of the recorded transfers.
+    /** @param numSlowest Number of slowest assets to return in Statistics::slowest. */
+    Statistics ComputeStatistics(uint numSlowest = 10) const;
+
+    /// Returns the statistics as human readable text.
+    String StatisticsString(uint numSlowest = 10) const;
+
+    /// Returns the timeline in the Trace Event JSON format, viewable eg. in chrome://tracing.
+    /** Each asset is a row with a span for each of its queue, transfer, decode and dependency waiting times.
+        The raw stage timestamps and the statistics are included under the "assets" and "summary" keys. */
+    String ToJSON(int spacing = 0) const;
+
+    /// Writes ToJSON to @c filename.
+    bool SaveToFile(const String &filename) const;
+
+    /// Returns the name of @c stage.
+    static const char *StageName(Stage stage);
+
+private:
+    Record *FindRecord(const String &ref);
+    /// Drops the oldest quarter of MaxRecords, preferring finished records.
+    void DropOldestRecords();
+
+    Urho3D::HiresTimer clock_;
+    Vector<Record> records_;
+    HashMap<String, uint> latestRecord_; ///< Index of the latest record by ref.
+    bool enabled_;
+};
+
+}
@@ -0,0 +1,177 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "StableHeaders.h"
+#include "AssetPrefetchManifest.h"
+#include "AssetAPI.h"
+#include "IAsset.h"
+#include "Framework.h"
+#include "Scene.h"
+#include "Entity.h"
+#include "IComponent.h"
+#include "IAttribute.h"
+#include "JSON/JSON.h"
+#include "LoggingFunctions.h"
+
+#include <Urho3D/Container/Sort.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+
+namespace Tundra
+{
+
+static bool CmpEntryPriority(const AssetPrefetchManifest::Entry &a, const AssetPrefetchManifest::Entry &b)
+{
+    if (a.depth != b.depth)
+        return a.depth < b.depth;
+    if (a.size != b.size)
+        return a.size < b.size;
+    return a.ref < b.ref;
+}
+
+AssetPrefetchManifest AssetPrefetchManifest::FromScene(Scene *scene)
+{
+    AssetPrefetchManifest manifest;
+    if (!scene)
+        return manifest;
+
+    AssetAPI *assetAPI = scene->GetFramework()->Asset();
+    Urho3D::FileSystem *fileSystem = scene->GetFramework()->GetSubsystem<Urho3D::FileSystem>();
+
+    // Depth 0: refs in the scene's attributes.
+    Vector<AssetReference> level;
+    for(Scene::EntityMap::ConstIterator ei = scene->Entities().Begin(); ei != scene->Entities().End(); ++ei)
+    {
+        const Entity::ComponentMap &components = ei->second_->Components();
+        for(Entity::ComponentMap::ConstIterator ci = components.Begin(); ci != components.End(); ++ci)
+        {
+            foreach(IAttribute *attr, ci->second_->Attributes())
+            {
+                if (!attr)
+                    continue;
+                if (attr->TypeId() == IAttribute::AssetReferenceId)
+                    level.Push(static_cast<Attribute<AssetReference>*>(attr)->Get());
+                else if (attr->TypeId() == IAttribute::AssetReferenceListId)
+                {
+                    const AssetReferenceList &list = static_cast<Attribute<AssetReferenceList>*>(attr)->Get();
+                    foreach(const AssetReference &ref, list.refs)
+                        level.Push(AssetReference(ref.ref, ref.type.Empty() ? list.type : ref.type));
+                }
+            }
+        }
+    }
+
+    // Walk the dependencies breadth first, so that each asset gets the depth it is first needed at.
+    HashSet<String> visited;
+    for(uint depth = 0; !level.Empty(); ++depth)
+    {
+        Vector<AssetReference> nextLevel;
+        foreach(const AssetReference &assetRef, level)
+        {
+            String ref = assetAPI->ResolveAssetRef("", assetRef.ref.Trimmed());
+            if (ref.Empty() || visited.Contains(ref))
+                continue;
+            visited.Insert(ref);
+
+            Entry entry;
+            entry.ref = ref;
+            entry.type = assetRef.type;
+            entry.depth = depth;
+
+            AssetPtr asset = assetAPI->FindAsset(ref);
+            if (asset)
+            {
+                if (entry.type.Empty())
+                    entry.type = asset->Type();
+                String diskSource = asset->DiskSource();
+                if (!diskSource.Empty() && fileSystem->FileExists(diskSource))
+                {
+                    Urho3D::File file(scene->GetFramework()->GetContext(), diskSource);
+                    entry.size = file.GetSize();
+                }
+
+                Vector<AssetReference> refs = asset->FindReferences();
+                foreach(const AssetReference &dependency, refs)
+                {
+                    String dependencyRef = assetAPI->ResolveAssetRef(ref, dependency.ref.Trimmed());
+                    if (dependencyRef.Empty())
+                        continue;
+                    entry.dependencies.Push(dependencyRef);
+                    nextLevel.Push(AssetReference(dependencyRef, dependency.type));
+                }
+            }
+            manifest.entries.Push(entry);
+        }
+        level.Swap(nextLevel);
+    }
+    return manifest;
+}
+
+bool AssetPrefetchManifest::FromJSON(const String &json)
+{
+    JSONValue root;
+    if (!root.FromString(json) || !root["assets"].IsArray())
+    {
+        LogError("AssetPrefetchManifest::FromJSON: Failed to parse manifest.");
+        return false;
+    }
+
+    entries.Clear();
+    foreach(const JSONValue &value, root["assets"].GetArray())
+    {
+        Entry entry;
+        entry.ref = value["ref"].GetString().Trimmed();
+        if (entry.ref.Empty())
+            continue;
+        entry.type = value["type"].GetString();
+        entry.size = (uint)value["size"].GetNumber();
+        entry.depth = (uint)value["depth"].GetNumber();
+        foreach(const JSONValue &dependency, value["dependencies"].GetArray())
+            entry.dependencies.Push(dependency.GetString());
+        entries.Push(entry);
+    }
+    return true;
+}
+
+String AssetPrefetchManifest::ToJSON(int spacing) const
+{
+    JSONValue assets;
+    assets.SetEmptyArray();
+    foreach(const Entry &entry, entries)
+    {
+        JSONValue value;
+        value["ref"] = entry.ref;
+        if (!entry.type.Empty())
+            value["type"] = entry.type;
+        value["size"] = entry.size;
+        value["depth"] = entry.depth;
+        if (!entry.dependencies.Empty())
+        {
+            JSONValue dependencies;
+            foreach(const String &dependency, entry.dependencies)
+                dependencies.Push(dependency);
+            value["dependencies"] = dependencies;
+        }
+        assets.Push(value);
+    }
+
+    JSONValue root;
+    root["assets"] = assets;
+    return root.ToString(spacing);
+}
+
+Vector<AssetPrefetchManifest::Entry> AssetPrefetchManifest::PrioritizedEntries() const
+{
+    Vector<Entry> sorted = entries;
+    Urho3D::Sort(sorted.Begin(), sorted.End(), &CmpEntryPriority);
+    return sorted;
+}
+
+unsigned long long AssetPrefetchManifest::TotalSize() const
+{
+    unsigned long long size = 0;
+    foreach(const Entry &entry, entries)
+        size += entry.size;
+    return size;
+}
+
+}
@@ -0,0 +1,54 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#include "TundraCoreApi.h"
+#include "CoreTypes.h"
+#include "SceneFwd.h"
+
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Container/Vector.h>
+
+namespace Tundra
+{
+
+/// Lists all assets a scene needs, including their transitive dependencies, so that they can be requested up front.
+/** Without a manifest assets are discovered level by level as components and assets process their refs, costing
+    a round trip per dependency level. @see AssetAPI::PrefetchAssets. */
+class TUNDRACORE_API AssetPrefetchManifest
+{
+public:
+    /// A single asset in the manifest.
+    struct Entry
+    {
+        Entry() : size(0), depth(0) {}
+
+        String ref; ///< Full asset ref.
+        String type; ///< Asset type, empty if the type is deduced from the ref.
+        uint size; ///< Size of the asset in bytes, 0 if unknown.
+        uint depth; ///< Dependency depth: 0 for assets referenced by the scene, 1 for their dependencies, etc.
+        StringVector dependencies; ///< Full refs of the assets this asset references directly.
+    };
+
+    /// Generates a manifest from the asset references of @c scene and the assets they (recursively) reference.
+    /** Dependencies and sizes are known only for the assets that are currently loaded, so this should be called after the scene has finished loading. */
+    static AssetPrefetchManifest FromScene(Scene *scene);
+
+    /// Parses the manifest from JSON { "assets": [ { "ref": ..., "type": ..., "size": ..., "depth": ..., "dependencies": [ ... ] }, ... ] }.
+    bool FromJSON(const String &json);
+
+    /// Returns the manifest as JSON.
+    String ToJSON(int spacing = 2) const;
+
+    /// Returns the entries in the order they should be requested: by dependency depth, smallest assets first within the same depth.
+    /** Assets the scene references directly are requested first as nothing can be shown before them, and preferring small assets
+        completes as many assets as possible early instead of letting a few large downloads delay everything. */
+    Vector<Entry> PrioritizedEntries() const;
+
+    /// Returns the total size of the listed assets in bytes.
+    unsigned long long TotalSize() const;
+
+    Vector<Entry> entries;
+};
+
+}
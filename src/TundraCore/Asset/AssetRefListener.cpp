@@ -8,7 +8,6 @@
 #include "IComponent.h"
 #include "Framework.h"
 #include "AssetAPI.h"
-#include "FrameAPI.h"
 #include "IAsset.h"
 #include "IAssetTransfer.h"
 #include "LoggingFunctions.h"
@@ -19,11 +18,19 @@ namespace Tundra
 // AssetRefListener
 
 AssetRefListener::AssetRefListener() : 
-    myAssetAPI(0), 
-    currentWaitingRef("")
+    currentWaitingRef(""),
+    loadedPending(false)
 {
 }
 
+AssetRefListener::~AssetRefListener()
+{
+    StopWaitingForCreation();
+    AssetPtr currentAsset = asset.Lock();
+    if (currentAsset)
+        DisconnectFromAsset(currentAsset.Get());
+}
+
 AssetPtr AssetRefListener::Asset() const
 {
     return asset.Lock();
@@ -51,6 +58,11 @@ void AssetRefListener::HandleAssetRefChange(AssetAPI *assetApi, String assetRef,
         current->Failed.Disconnect(this, &AssetRefListener::OnTransferFailed);
         currentTransfer.Reset();
     }
+
+    // Disconnect from the old asset's load signals
+    AssetPtr previousAsset = asset.Lock();
+    if (previousAsset)
+        DisconnectFromAsset(previousAsset.Get());
     
     assert(assetApi);
 
@@ -62,10 +74,11 @@ void AssetRefListener::HandleAssetRefChange(AssetAPI *assetApi, String assetRef,
     assetRef = assetRef.Trimmed();
     if (assetRef.Empty())
     {
+        StopWaitingForCreation();
         asset = AssetPtr();
         return;
     }
-    currentWaitingRef = "";
+    StopWaitingForCreation();
 
     // Resolve the protocol for generated:// assets. These assets are never meant to be
     // requested from AssetAPI, they cannot be fetched from anywhere. They can only be either
@@ -81,14 +94,19 @@ void AssetRefListener::HandleAssetRefChange(AssetAPI *assetApi, String assetRef,
             // that HandleAssetRefChange won't emit anything itself as before.
             // Otherwise existing connection can break/be too late after calling this function.
             asset = loadedAsset;
-            assetApi->GetFramework()->Frame()->DelayedExecute(0.0f).Connect(this, &AssetRefListener::EmitLoaded);
+            ConnectToAsset(loadedAsset.Get());
+            if (!loadedPending)
+            {
+                loadedPending = true;
+                assetApi->QueueAssetRefListenerLoaded(this);
+            }
             return;
         }
         else
         {
             // Wait for it to be created.
             currentWaitingRef = assetRef;
-            myAssetAPI->AssetCreated.Connect(this, &AssetRefListener::OnAssetCreated);
+            myAssetAPI->AddAssetCreatedWaiter(currentWaitingRef, this);
         }
     }
     else
@@ -108,9 +126,6 @@ void AssetRefListener::HandleAssetRefChange(AssetAPI *assetApi, String assetRef,
         currentTransfer = transfer;
     }
     
-    // Disconnect from the old asset's load signal
-    if (asset)
-        asset->Loaded.Disconnect(this, &AssetRefListener::OnAssetLoaded);
     asset = AssetPtr();
 }
 
@@ -120,8 +135,9 @@ void AssetRefListener::OnTransferSucceeded(AssetPtr assetData)
         return;
     
     // Connect to further reloads of the asset to be able to notify of them.
+    // For a deduplicated ref this is the asset it aliases, so its Name() can differ from the requested ref.
     asset = assetData;
-    assetData->Loaded.Connect(this, &AssetRefListener::OnAssetLoaded);
+    ConnectToAsset(assetData.Get());
     Loaded.Emit(assetData);
 }
 
@@ -131,17 +147,36 @@ void AssetRefListener::OnAssetLoaded(AssetPtr assetData)
         Loaded.Emit(assetData);
 }
 
+void AssetRefListener::OnAssetContentReloaded(AssetPtr assetData)
+{
+    if (assetData == asset.Lock())
+        ContentReloaded.Emit(assetData);
+}
+
+void AssetRefListener::ConnectToAsset(IAsset *assetData)
+{
+    assetData->Loaded.Connect(this, &AssetRefListener::OnAssetLoaded);
+    assetData->ContentReloaded.Connect(this, &AssetRefListener::OnAssetContentReloaded);
+}
+
+void AssetRefListener::DisconnectFromAsset(IAsset *assetData)
+{
+    assetData->Loaded.Disconnect(this, &AssetRefListener::OnAssetLoaded);
+    assetData->ContentReloaded.Disconnect(this, &AssetRefListener::OnAssetContentReloaded);
+}
+
 void AssetRefListener::OnTransferFailed(IAssetTransfer* transfer, String reason)
 {
     /// @todo Remove this logic once a EC_Material + EC_Mesh behaves correctly without failed requests, see generated:// logic in HandleAssetRefChange.
     if (myAssetAPI)
-        myAssetAPI->AssetCreated.Connect(this, &AssetRefListener::OnAssetCreated);
+        myAssetAPI->AddAssetCreatedWaiter(currentWaitingRef, this);
     TransferFailed.Emit(transfer, reason);
 }
 
 void AssetRefListener::OnAssetCreated(AssetPtr assetData)
 {
-    if (assetData.Get() && !currentWaitingRef.Empty() && currentWaitingRef == assetData->Name())
+    if (assetData.Get() && !currentWaitingRef.Empty() && (currentWaitingRef == assetData->Name() ||
+        (myAssetAPI && myAssetAPI->AliasedAssetRef(currentWaitingRef) == assetData->Name())))
     {
         /// @todo Remove this logic once a EC_Material + EC_Mesh behaves correctly without failed requests, see generated:// logic in HandleAssetRefChange.
         /** Log the same message as before for non generated:// refs. This is good to do
@@ -152,14 +187,20 @@ void AssetRefListener::OnAssetCreated(AssetPtr assetData)
         // The asset we are waiting for has been created, hook to the IAsset::Loaded signal.
         currentWaitingRef = "";
         asset = assetData;
-        assetData->Loaded.Connect(this, &AssetRefListener::OnAssetLoaded);
-        if (myAssetAPI)
-            myAssetAPI->AssetCreated.Disconnect(this, &AssetRefListener::OnAssetCreated);
+        ConnectToAsset(assetData.Get());
     }
 }
 
-void AssetRefListener::EmitLoaded(float /*time*/)
+void AssetRefListener::StopWaitingForCreation()
 {
+    if (myAssetAPI && !currentWaitingRef.Empty())
+        myAssetAPI->RemoveAssetCreatedWaiter(currentWaitingRef, this);
+    currentWaitingRef = "";
+}
+
+void AssetRefListener::EmitPendingLoaded()
+{
+    loadedPending = false;
     AssetPtr currentAsset = asset.Lock();
     if (currentAsset.Get())
         Loaded.Emit(currentAsset);
@@ -225,6 +266,7 @@ void AssetRefListListener::HandleChange(const AssetReferenceList &refs)
         AssetRefListenerPtr listener(new AssetRefListener());
         listener->TransferFailed.Connect(this, &AssetRefListListener::OnAssetFailed);
         listener->Loaded.Connect(this, &AssetRefListListener::OnAssetLoaded);
+        listener->ContentReloaded.Connect(this, &AssetRefListListener::OnAssetContentReloaded);
         listeners_.Push(listener);
     }
     for (uint i=0; i<numRefs; ++i)
@@ -286,8 +328,7 @@ void AssetRefListListener::OnAssetLoaded(AssetPtr asset)
     String completedRef = asset->Name();
     for(uint i = 0; i < current_.Size(); ++i)
     {
-        const AssetReference &ref = current_[i];
-        if (ref.ref.Compare(completedRef) == 0)
+        if (IsListenerAsset(i, asset))
         {
             // Don't break/return. Same asset might be in multiple indexes!
             Loaded.Emit(i, asset);
@@ -298,4 +339,25 @@ void AssetRefListListener::OnAssetLoaded(AssetPtr asset)
         LogWarning("AssetRefListListener: Failed to signal completion of " + completedRef + ". The asset ref is unknown to the local state.");
 }
 
+void AssetRefListListener::OnAssetContentReloaded(AssetPtr asset)
+{
+    if (!asset)
+        return;
+
+    for(uint i = 0; i < current_.Size(); ++i)
+    {
+        // Don't break/return. Same asset might be in multiple indexes!
+        if (IsListenerAsset(i, asset))
+            ContentReloaded.Emit(i, asset);
+    }
+}
+
+bool AssetRefListListener::IsListenerAsset(uint index, const AssetPtr &asset) const
+{
+    /* Match by the asset of the listener instead of by name: a ref deduplicated to an alias is
+       served by the asset it aliases, whose Name() is the original ref. Listeners of cleared refs
+       are not updated, so they may still hold their previous asset. */
+    return index < listeners_.Size() && !current_[index].ref.Empty() && listeners_[index]->Asset() == asset;
+}
+
 }
@@ -19,6 +19,7 @@ class TUNDRACORE_API AssetRefListener : public RefCounted
 {
 public:
     AssetRefListener();
+    ~AssetRefListener();
 
     /// Issues a new asset request to the given AssetReference.
     /// @param assetRef A pointer to an attribute of type AssetReference.
@@ -39,22 +40,35 @@ public:
     /// Emitted when this asset is ready to be used in the system.
     Signal1<AssetPtr> Loaded;
 
+    /// Emitted when the content of this asset was replaced in place, see IAsset::ContentReloaded.
+    /** Loaded is not emitted in this case. Users that copy data out of the asset need to handle this to see the new content. */
+    Signal1<AssetPtr> ContentReloaded;
+
     /// Emitted when the transfer failed
     Signal2<IAssetTransfer *, String> TransferFailed;
 
 private:
+    friend class AssetAPI;
+
     void OnTransferSucceeded(AssetPtr assetData);
     void OnAssetLoaded(AssetPtr assetData);
+    void OnAssetContentReloaded(AssetPtr assetData);
+    void ConnectToAsset(IAsset *assetData);
+    void DisconnectFromAsset(IAsset *assetData);
     void OnTransferFailed(IAssetTransfer *transfer, String reason);
+    /// Called by AssetAPI when the asset this listener waits for is created, see AssetAPI::AddAssetCreatedWaiter.
     void OnAssetCreated(AssetPtr assetData);
-    
-    void EmitLoaded(float time);
+    /// Called by AssetAPI on the frame after a loaded asset was set, see AssetAPI::QueueAssetRefListenerLoaded.
+    void EmitPendingLoaded();
+    /// Stops waiting for the creation of currentWaitingRef.
+    void StopWaitingForCreation();
 
 private:
-    AssetAPI *myAssetAPI;
+    WeakPtr<AssetAPI> myAssetAPI;
     AssetWeakPtr asset;
     AssetTransferWeakPtr currentTransfer;
     String currentWaitingRef;
+    bool loadedPending;
 };
 
 /// Tracks and notifies about asset change events.
@@ -86,11 +100,15 @@ public:
     /// Corresponding AssetRefListener signals with additional asset index.
     //Signal2<int, IAssetTransfer*> Downloaded; /// @todo Implement when there is need for this
     Signal2<uint, AssetPtr> Loaded;
+    Signal2<uint, AssetPtr> ContentReloaded;
     Signal3<uint, IAssetTransfer*, String> Failed;
 
 private:
     void OnAssetFailed(IAssetTransfer *transfer, String reason);
     void OnAssetLoaded(AssetPtr asset);
+    void OnAssetContentReloaded(AssetPtr asset);
+    /// Returns if @c asset is the asset loaded for the ref at @c index.
+    bool IsListenerAsset(uint index, const AssetPtr &asset) const;
 
     AssetAPI *assetAPI_;
     AssetReferenceList current_;
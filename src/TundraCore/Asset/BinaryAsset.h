@@ -30,6 +30,12 @@ public:
         data.Clear();
     }
 
+    bool DoReloadInPlace(const u8 *data_, uint numBytes) override
+    {
+        data = Vector<u8>(data_, numBytes);
+        return true;
+    }
+
     bool DeserializeFromData(const u8 *data_, uint numBytes, bool /*allowAsynchronous*/) override
     {
         data.Resize(numBytes);
@@ -39,6 +45,12 @@ public:
         return true;
     }
 
+    /// Binary data can always be replaced in place.
+    bool SupportsInPlaceReload() const override
+    {
+        return true;
+    }
+
     bool SerializeTo(Vector<u8> &dst, const String &/*serializationParameters*/) const override
     {
         dst = data;
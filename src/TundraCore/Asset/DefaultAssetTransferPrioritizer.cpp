@@ -4,6 +4,9 @@
 #include "DefaultAssetTransferPrioritizer.h"
 #include "IAssetTransfer.h"
 
+#include <map>
+#include <functional>
+
 namespace Tundra
 {
 
@@ -25,6 +28,28 @@ DefaultAssetTransferPrioritizer::DefaultAssetTransferPrioritizer()
 }
 
 AssetTransferPtrVector DefaultAssetTransferPrioritizer::Prioritize(const AssetTransferPtrVector &transfers)
+{
+    // Explicit priorities come first, eg. from AssetAPI::PrefetchAssets. Transfers with the same priority are sorted by type.
+    bool samePriority = true;
+    for(uint i = 1; i < transfers.Size() && samePriority; ++i)
+        samePriority = (transfers[i]->priority == transfers[0]->priority);
+    if (samePriority)
+        return SortByType(transfers);
+
+    std::map<int, AssetTransferPtrVector, std::greater<int> > byPriority;
+    for(auto iter = transfers.Begin(); iter != transfers.End(); ++iter)
+        byPriority[(*iter)->priority].Push(*iter);
+
+    AssetTransferPtrVector sorted;
+    for(auto iter = byPriority.begin(); iter != byPriority.end(); ++iter)
+    {
+        AssetTransferPtrVector level = SortByType(iter->second);
+        sorted.Insert(sorted.End(), level.Begin(), level.End());
+    }
+    return sorted;
+}
+
+AssetTransferPtrVector DefaultAssetTransferPrioritizer::SortByType(const AssetTransferPtrVector &transfers)
 {
     /** @todo Add prioritizing with distance to active camera when EntityWeakPtr info is available in transfers.
         @todo Add more types? Should scripts go last or first?
@@ -14,6 +14,10 @@ public:
     
     /// IAssetTransferPrioritizer override
     AssetTransferPtrVector Prioritize(const AssetTransferPtrVector &transfers) override;
+
+private:
+    /// Sorts meshes first, then materials, then everything else, keeping the relative order otherwise.
+    static AssetTransferPtrVector SortByType(const AssetTransferPtrVector &transfers);
 };
 
 }
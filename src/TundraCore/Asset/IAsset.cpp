@@ -50,6 +50,44 @@ bool IAsset::LoadFromCache()
     return success;
 }
 
+bool IAsset::ReloadInPlace(const u8 *data, uint numBytes)
+{
+    URHO3D_PROFILE(IAsset_ReloadInPlace);
+
+    if (!data || numBytes == 0 || !IsLoaded() || !SupportsInPlaceReload())
+        return false;
+
+    profile.Start(AssetProfile::Load);
+    bool success = DoReloadInPlace(data, numBytes);
+    profile.Done(AssetProfile::Load);
+    if (!success)
+    {
+        LogDebug("ReloadInPlace failed for asset \"" + ToString() + "\".");
+        return false;
+    }
+
+    ContentReloaded.Emit(AssetPtr(this));
+    return true;
+}
+
+bool IAsset::ReloadInPlaceFromDiskSource()
+{
+    String filename = DiskSource().Trimmed();
+    if (filename.Empty() || !IsLoaded() || !SupportsInPlaceReload())
+        return false;
+
+    Vector<u8> fileData;
+    profile.Start(AssetProfile::DiskRead);
+    bool success = LoadFileToVector(filename, fileData);
+    profile.Done(AssetProfile::DiskRead);
+    if (!success || fileData.Size() == 0)
+    {
+        LogDebug("ReloadInPlaceFromDiskSource failed for asset \"" + ToString() + "\", could not read file \"" + filename + "\"!");
+        return false;
+    }
+    return ReloadInPlace(&fileData[0], fileData.Size());
+}
+
 void IAsset::Unload()
 {
 //    LogDebug("IAsset::Unload called for asset \"" + name.toStdString() + "\".");
@@ -87,6 +87,24 @@ public:
     /// Forces a reload of this asset from its disk source. Returns true if loading succeeded, false otherwise.
     bool LoadFromCache();
 
+    /// Returns true if this asset can replace its content in place, @see ReloadInPlace.
+    /** The default implementation returns false. */
+    virtual bool SupportsInPlaceReload() const { return false; }
+
+    /// Replaces the content of this loaded asset with the given data without unloading it.
+    /** Unlike LoadFromFileInMemory, the asset keeps its underlying resources (for example the GPU texture object) and only
+        updates their data, so users holding on to them see the new content without reloading themselves.
+        Loaded is not emitted and dependents are not reloaded, only ContentReloaded is emitted. AssetRefListener and
+        AssetRefListListener forward it as their ContentReloaded signal. AssetAPI therefore reloads assets that have
+        dependents fully, and uses this only for assets that nothing depends on.
+        Fails if the asset is not loaded, does not support in-place reload or rejects the data, in which case the caller
+        should fall back to a full reload.
+        @note Only for content changes: the references of the asset are not re-resolved. */
+    bool ReloadInPlace(const u8 *data, uint numBytes);
+
+    /// Replaces the content of this loaded asset with the contents of its disk source, @see ReloadInPlace.
+    bool ReloadInPlaceFromDiskSource();
+
     /// Unloads this asset from memory.
     /** After calling this function, this asset still can be queried for its Type(), Name() and CacheFile(),
         but its dependencies cannot be determined and it cannot be used in any other way. */
@@ -158,6 +176,10 @@ public:
         @param asset A pointer to this will be passed in. The signature of this signal deliberately contains this member to be unified with AssetAPI. */
     Signal1<AssetPtr> Loaded;
 
+    /// This signal is emitted when the content of this asset has been replaced in place by ReloadInPlace.
+    /** The asset stays loaded and its resources remain valid, so only direct users that copy data out of the asset need to react to this. */
+    Signal1<AssetPtr> ContentReloaded;
+
     /// Asset properties have changed. Emitted whenever the modified flag, disk source, or disk source type changes.
     Signal1<IAsset*> PropertyStatusChanged;
     
@@ -212,6 +234,11 @@ protected:
     /// Private-implementation of the unloading of an asset.
     virtual void DoUnload() = 0;
 
+    /// Private-implementation of ReloadInPlace.
+    /** Called only when the asset is loaded and the data is non-empty. Must leave the asset loaded with its old content on failure.
+        The default implementation returns false. */
+    virtual bool DoReloadInPlace(const u8 * /*data*/, uint /*numBytes*/) { return false; }
+
     AssetAPI *assetAPI;
 
     /// Specifies the provider this asset was downloaded from. May be null.
@@ -55,6 +55,13 @@ public:
         @return Absolute disk source path if available, empty string otherwise.*/
     virtual String GetSubAssetDiskSource(const String &subAssetName) = 0;
 
+    /// Prepares a sub asset to be provided by GetSubAssetDiskSource and GetSubAssetData.
+    /** Bundles that unpack their content asynchronously start unpacking the sub asset here and return false until
+        it is done, AssetAPI asks again on the following frames before loading the sub asset.
+        @note Default implementation returns true. Return true also for unknown sub assets.
+        @return True if the sub asset can be loaded now, false otherwise. */
+    virtual bool PrepareSubAsset(const String & /*subAssetName*/) { return true; }
+
     /// Returns the sub asset count in this bundle.
     /** @return Count of the assets or -1 if count is unknown. */
     virtual int SubAssetCount() const { return -1; }
@@ -78,6 +78,19 @@ public:
         return AssetUploadTransferPtr();
     }
 
+    /// Returns if this provider can stream uploads from a file in chunks. @see UploadAssetFromFile.
+    virtual bool SupportsStreamingUploads() const { return false; }
+
+    /// Starts a chunked streaming upload of the given file to the given storage.
+    /** Called by AssetAPI instead of UploadAssetFromFileInMemory if SupportsStreamingUploads returns true. The file is read
+        in IAssetUploadTransfer::chunkSize pieces as the upload progresses, and a failed upload is resumed from the last
+        acknowledged chunk. The default implementation fails all upload attempts and returns 0 immediately. */
+    virtual AssetUploadTransferPtr UploadAssetFromFile(const String & UNUSED_PARAM(filename), AssetStoragePtr UNUSED_PARAM(destination),
+        const String & UNUSED_PARAM(assetName))
+    {
+        return AssetUploadTransferPtr();
+    }
+
 private:
     /// Reads the given storage string and tries to deserialize it to an asset storage in this provider.
     /** Returns a pointer to the newly created storage, or 0 if the storage string is not of the type of this asset provider.
@@ -12,7 +12,8 @@ namespace Tundra
 
 IAssetTransfer::IAssetTransfer() : 
     cachingAllowed(true),
-    diskSourceType(IAsset::Original)
+    diskSourceType(IAsset::Original),
+    priority(0)
 {
 }
 
@@ -36,6 +36,10 @@ public:
 
     /// Specifies the disk source type to set for the asset once this transfer completes.
     IAsset::SourceType diskSourceType;
+
+    /// Execution priority, transfers with a higher priority are executed first. Defaults to 0.
+    /** @see IAssetTransferPrioritizer, AssetAPI::PrefetchAssets. */
+    int priority;
     
     /// Specifies the provider this asset is being downloaded from.
     AssetProviderWeakPtr provider;
@@ -3,14 +3,68 @@
 #include "StableHeaders.h"
 
 #include "IAssetUploadTransfer.h"
+#include "LoggingFunctions.h"
+#include "Math/MathFunc.h"
+
+#include <Urho3D/IO/File.h>
+
+#include <cstring>
 
 namespace Tundra
 {
 
+IAssetUploadTransfer::IAssetUploadTransfer(Urho3D::Context* context) :
+    Object(context),
+    totalBytes(0),
+    bytesUploaded(0),
+    chunkSize(DefaultChunkSize),
+    maxRetries(3),
+    numRetries(0)
+{
+}
+
 IAssetUploadTransfer::~IAssetUploadTransfer()
 {
 }
 
+float IAssetUploadTransfer::Progress() const
+{
+    return (totalBytes > 0 ? (float)bytesUploaded / (float)totalBytes : 0.f);
+}
+
+bool IAssetUploadTransfer::ReadChunk(uint offset, uint numBytes, Vector<u8> &dest)
+{
+    if (offset > totalBytes)
+        return false;
+    numBytes = Min(numBytes, totalBytes - offset);
+    dest.Resize(numBytes);
+    if (numBytes == 0)
+        return true;
+
+    if (!IsStreaming())
+    {
+        if (offset + numBytes > assetData.Size())
+            return false;
+        memcpy(&dest[0], &assetData[offset], numBytes);
+        return true;
+    }
+
+    // Open the file for each chunk so that no handles are held between frames.
+    Urho3D::File file(GetContext(), sourceFilename, Urho3D::FILE_READ);
+    if (!file.IsOpen() || file.GetSize() != totalBytes || !file.Seek(offset) || file.Read(&dest[0], numBytes) != numBytes)
+    {
+        LogError("IAssetUploadTransfer::ReadChunk: Failed to read " + String(numBytes) + " bytes at offset " + String(offset) + " from " + sourceFilename);
+        return false;
+    }
+    return true;
+}
+
+void IAssetUploadTransfer::SetBytesUploaded(uint bytes)
+{
+    bytesUploaded = Min(bytes, totalBytes);
+    ProgressUpdated.Emit(this, bytesUploaded, totalBytes);
+}
+
 void IAssetUploadTransfer::EmitTransferCompleted()
 {
     Completed.Emit(this);
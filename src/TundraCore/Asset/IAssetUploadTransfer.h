@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreTypes.h"
+#include "CoreDefines.h"
 #include "AssetFwd.h"
 #include "IAssetStorage.h"
 #include "Signals.h"
@@ -16,16 +17,36 @@ class TUNDRACORE_API IAssetUploadTransfer : public Object
     URHO3D_OBJECT(IAssetUploadTransfer, Object);
 
 public:
-    IAssetUploadTransfer(Urho3D::Context* context) : Object(context) {}
+    /// Default size of the chunks streaming uploads are read and sent in.
+    static const uint DefaultChunkSize = 256 * 1024;
+
+    IAssetUploadTransfer(Urho3D::Context* context);
 
     virtual ~IAssetUploadTransfer();
 
     /// Returns the current transfer progress in the range [0, 1].
-    virtual float Progress() const { return 0.f; }
+    virtual float Progress() const;
 
     /// Specifies the source file of the upload transfer, or none if this upload does not originate from a file in the system.
+    /** When set, the file is streamed from disk in chunkSize pieces and never read into memory as a whole. */
     String sourceFilename;
 
+    /// Total size of the uploaded data in bytes.
+    uint totalBytes;
+
+    /// Number of bytes the destination has acknowledged. A failed upload is resumed from here.
+    uint bytesUploaded;
+
+    /// Size of the chunks the data is uploaded in, defaults to DefaultChunkSize.
+    /** Bounds the memory used by a streaming upload. Must be set before the upload starts. */
+    uint chunkSize;
+
+    /// Number of times a failed chunk is retried, resuming from bytesUploaded, before the upload fails.
+    uint maxRetries;
+
+    /// Number of retries done so far.
+    uint numRetries;
+
     /// Contains the raw asset data to upload. If sourceFilename=="", the data is taken from this array instead.
     Vector<u8> assetData;
 
@@ -54,8 +75,19 @@ public:
     String AssetRef();
 
     /// Returns a copy of the raw asset data in this upload.
+    /** @note Empty for streaming uploads from sourceFilename. */
     Vector<u8> RawData() const { return assetData; }
 
+    /// Returns if the data is streamed from sourceFilename instead of being held in assetData.
+    bool IsStreaming() const { return !sourceFilename.Empty(); }
+
+    /// Reads @c numBytes of the uploaded data starting at @c offset to @c dest, from sourceFilename or assetData.
+    /** The read is clamped to totalBytes. @return False if the data could not be read. */
+    bool ReadChunk(uint offset, uint numBytes, Vector<u8> &dest);
+
+    /// Sets the number of acknowledged bytes and emits ProgressUpdated.
+    void SetBytesUploaded(uint bytes);
+
     /// Returns the raw reply data returned by this upload.
     Vector<u8> RawReplyData() const { return replyData; }
 
@@ -76,6 +108,9 @@ public:
 
     /// Emitted when upload fails.
     Signal1<IAssetUploadTransfer*> Failed;
+
+    /// Emitted when the destination has acknowledged more of the data.
+    Signal3<IAssetUploadTransfer*, uint ARG(bytesUploaded), uint ARG(totalBytes)> ProgressUpdated;
 };
 
 }
@@ -24,6 +24,14 @@
 namespace Tundra
 {
 
+/// Returns the description of a streaming upload source that is stored next to its .part file: the size,
+/// the modification time and the hash of the path of the source. A .part file is resumed only if this matches.
+static String StreamingUploadSourceInfo(Urho3D::FileSystem *fileSystem, const String &sourceFilename, uint totalBytes)
+{
+    return String(totalBytes) + " " + String(fileSystem->GetLastModifiedTime(sourceFilename)) + " " +
+        String(Urho3D::StringHash(sourceFilename).Value());
+}
+
 LocalAssetProvider::LocalAssetProvider(Framework* framework_) :
     IAssetProvider(framework_->GetContext()),
     framework(framework_)
@@ -176,6 +184,7 @@ void LocalAssetProvider::Update(float /*frametime*/)
     /// asset into the same asset storage. If the download request was processed before the upload request, the download
     /// request would fail on missing file, and the entity would erroneously get an "asset not found" result.
     CompletePendingFileUploads();
+    CompleteStreamingUploads();
     CompletePendingFileDownloads();
     CheckForPendingFileSystemChanges();
 }
@@ -316,12 +325,40 @@ AssetUploadTransferPtr LocalAssetProvider::UploadAssetFromFileInMemory(const u8
     transfer->destinationName = assetName;
     transfer->destinationStorage = destination;
     transfer->assetData.Insert(transfer->assetData.End(), data, data + numBytes);
+    transfer->totalBytes = numBytes;
 
     pendingUploads.Push(transfer);
 
     return transfer;
 }
 
+AssetUploadTransferPtr LocalAssetProvider::UploadAssetFromFile(const String &filename, AssetStoragePtr destination, const String &assetName)
+{
+    LocalAssetStorage *storage = dynamic_cast<LocalAssetStorage*>(destination.Get());
+    if (!storage)
+    {
+        LogError("LocalAssetProvider::UploadAssetFromFile: Invalid destination asset storage type! Was not of type LocalAssetStorage!");
+        return AssetUploadTransferPtr();
+    }
+
+    Urho3D::File file(GetContext(), filename, Urho3D::FILE_READ);
+    if (!file.IsOpen() || file.GetSize() == 0)
+    {
+        LogError("LocalAssetProvider::UploadAssetFromFile: Could not open source file \"" + filename + "\" or it is empty.");
+        return AssetUploadTransferPtr();
+    }
+
+    AssetUploadTransferPtr transfer(new IAssetUploadTransfer(GetContext()));
+    transfer->sourceFilename = filename;
+    transfer->destinationName = assetName;
+    transfer->destinationStorage = destination;
+    transfer->totalBytes = file.GetSize();
+
+    streamingUploads.Push(transfer);
+
+    return transfer;
+}
+
 void LocalAssetProvider::CompletePendingFileDownloads()
 {
     // If we have any uploads running, first wait for each of them to complete, until we download any more.
@@ -514,11 +551,103 @@ void LocalAssetProvider::CompletePendingFileUploads()
         }
         else
         {
+            transfer->SetBytesUploaded(transfer->totalBytes);
             framework->Asset()->AssetUploadTransferCompleted(transfer.Get());
         }
     }
 }
 
+void LocalAssetProvider::CompleteStreamingUploads()
+{
+    const int maxUploadMSecs = 16;
+    Urho3D::HiresTimer uploadTimer;
+    Urho3D::FileSystem *fileSystem = GetSubsystem<Urho3D::FileSystem>();
+
+    while(streamingUploads.Size() > 0 && uploadTimer.GetUSec(false) / 1000 < maxUploadMSecs)
+    {
+        URHO3D_PROFILE(LocalAssetProvider_ProcessStreamingUpload);
+        AssetUploadTransferPtr transfer = streamingUploads.Front();
+
+        LocalAssetStoragePtr storage = Urho3D::DynamicCast<LocalAssetStorage>(transfer->destinationStorage.Lock());
+        if (!storage)
+        {
+            LogError("Invalid IAssetStorage specified for file upload in LocalAssetProvider!");
+            streamingUploads.Erase(0);
+            transfer->EmitTransferFailed();
+            continue;
+        }
+
+        String toFile = GuaranteeTrailingSlash(storage->directory) + transfer->destinationName;
+        String partFile = toFile + ".part";
+        String partInfoFile = partFile + ".info";
+
+        if (transfer->bytesUploaded == 0 && transfer->numRetries == 0)
+        {
+            // Resume from the last complete chunk of an earlier interrupted upload of the same, unmodified source file.
+            const String sourceInfo = StreamingUploadSourceInfo(fileSystem, transfer->sourceFilename, transfer->totalBytes);
+            if (fileSystem->FileExists(partFile) && fileSystem->FileExists(partInfoFile))
+            {
+                Urho3D::File info(GetContext(), partInfoFile, Urho3D::FILE_READ);
+                Urho3D::File part(GetContext(), partFile, Urho3D::FILE_READ);
+                uint partSize = (part.IsOpen() ? part.GetSize() : 0);
+                if (info.IsOpen() && info.ReadLine() == sourceInfo && partSize <= transfer->totalBytes && partSize >= transfer->chunkSize)
+                    transfer->SetBytesUploaded(partSize - partSize % transfer->chunkSize);
+            }
+            if (transfer->bytesUploaded == 0)
+            {
+                Urho3D::File info(GetContext(), partInfoFile, Urho3D::FILE_WRITE);
+                if (!info.IsOpen() || !info.WriteLine(sourceInfo))
+                    LogWarning("LocalAssetProvider: Failed to write \"" + partInfoFile + "\", the upload cannot be resumed if interrupted.");
+            }
+        }
+
+        bool success;
+        {
+            Urho3D::File part(GetContext(), partFile, (transfer->bytesUploaded > 0 ? Urho3D::FILE_READWRITE : Urho3D::FILE_WRITE));
+            success = part.IsOpen() && part.Seek(transfer->bytesUploaded) == transfer->bytesUploaded;
+
+            Vector<u8> chunk;
+            while(success && transfer->bytesUploaded < transfer->totalBytes)
+            {
+                success = transfer->ReadChunk(transfer->bytesUploaded, transfer->chunkSize, chunk) && !chunk.Empty() &&
+                    part.Write(&chunk[0], chunk.Size()) == chunk.Size();
+                if (success)
+                    transfer->SetBytesUploaded(transfer->bytesUploaded + chunk.Size());
+                if (uploadTimer.GetUSec(false) / 1000 >= maxUploadMSecs)
+                    break;
+            }
+        }
+
+        if (!success)
+        {
+            // Retry from the last written chunk on the next frame.
+            if (++transfer->numRetries > transfer->maxRetries)
+            {
+                LogError("Asset upload failed in LocalAssetProvider: Writing \"" + partFile + "\" from \"" + transfer->sourceFilename + "\" failed!");
+                streamingUploads.Erase(0);
+                transfer->EmitTransferFailed();
+                continue;
+            }
+            LogWarning("LocalAssetProvider: Writing \"" + partFile + "\" failed, resuming from byte " + String(transfer->bytesUploaded));
+            break;
+        }
+        if (transfer->bytesUploaded < transfer->totalBytes)
+            break; // Out of time for this frame.
+
+        streamingUploads.Erase(0);
+        fileSystem->Delete(partInfoFile);
+        if (fileSystem->FileExists(toFile))
+            fileSystem->Delete(toFile);
+        if (!fileSystem->Rename(partFile, toFile))
+        {
+            LogError("Asset upload failed in LocalAssetProvider: Renaming \"" + partFile + "\" to \"" + toFile + "\" failed!");
+            transfer->EmitTransferFailed();
+            continue;
+        }
+        framework->Asset()->AssetUploadTransferCompleted(transfer.Get());
+    }
+}
+
 void LocalAssetProvider::CheckForPendingFileSystemChanges()
 {
     URHO3D_PROFILE(LocalAssetProvider_CheckForPendingFileSystemChanges);
@@ -534,6 +663,7 @@ void LocalAssetProvider::CheckForPendingFileSystemChanges()
         {
             file = storage->directory + file;
             LogInfo(file);
+            storage->UpdateCachedFile(file);
             if (!storage->AutoDiscoverable())
             {
                 LogWarning("Received file change notification for storage of which auto-discovery is false.");
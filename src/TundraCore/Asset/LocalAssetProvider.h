@@ -52,6 +52,13 @@ public:
     AssetStoragePtr StorageForAssetRef(const String &assetRef) const override;
     /// IAssetProvider override.
     AssetUploadTransferPtr UploadAssetFromFileInMemory(const u8 *data, uint numBytes, AssetStoragePtr destination, const String &assetName) override;
+    /// IAssetProvider override.
+    bool SupportsStreamingUploads() const override { return true; }
+    /// IAssetProvider override.
+    /** The file is copied chunk by chunk to a .part file next to the destination, which is renamed to the destination once complete.
+        A .part file left behind by an interrupted upload of the same source file to the same destination is resumed from its
+        last complete chunk. The source is identified by the .part.info file next to it, other .part files are overwritten. */
+    AssetUploadTransferPtr UploadAssetFromFile(const String &filename, AssetStoragePtr destination, const String &assetName) override;
 
 private:
     /// IAssetProvider override.
@@ -73,6 +80,9 @@ private:
     /// Takes all the pending file upload transfers and finishes them.
     void CompletePendingFileUploads();
 
+    /// Copies chunks of the streaming uploads for at most a few milliseconds, and finishes the completed ones.
+    void CompleteStreamingUploads();
+
     /// Checks for pending file systems changes and updates 
     void CheckForPendingFileSystemChanges();
 
@@ -83,6 +93,7 @@ private:
     Vector<LocalAssetStoragePtr> storages;          ///< Asset directories to search, may be recursive or not
     Vector<AssetUploadTransferPtr> pendingUploads;  ///< The following asset uploads are pending to be completed by this provider.
     Vector<AssetTransferPtr> pendingDownloads;      ///< The following asset downloads are pending to be completed by this provider.
+    Vector<AssetUploadTransferPtr> streamingUploads; ///< Chunked uploads from files, processed in order.
 
     /// If true, assets outside any known local storages are allowed. Otherwise, requests to them will fail.
     bool enableRequestsOutsideStorages;
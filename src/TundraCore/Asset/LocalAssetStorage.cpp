@@ -7,6 +7,7 @@
 #include "AssetAPI.h"
 #include "LoggingFunctions.h"
 
+#include <Urho3D/Container/HashSet.h>
 #include <Urho3D/Core/Profiler.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
@@ -16,10 +17,23 @@
 namespace Tundra
 {
 
+/// Minimum time in milliseconds between rescans on a miss of a storage that is not watched for changes.
+static const unsigned cIndexRescanInterval = 2000;
+/// Minimum time in milliseconds between rescans on a miss of a watched storage. The watcher does not
+/// see files in subdirectories created after it was started, so known misses expire after this time.
+static const unsigned cWatchedIndexRescanInterval = 10000;
+
+/// Returns whether a path relative to the storage directory points inside version control metadata.
+static bool IsVersionControlPath(const String &path)
+{
+    return path.Contains(".git") || path.Contains(".svn") || path.Contains(".hg");
+}
+
 LocalAssetStorage::LocalAssetStorage(Urho3D::Context* context, bool writable_, bool liveUpdate_, bool autoDiscoverable_) :
     IAssetStorage(context),
     recursive(true),
-    changeWatcher(0)
+    changeWatcher(0),
+    contentsCached(false)
 {
     // Override the parameters for the base class.
     writable = writable_;
@@ -34,56 +48,49 @@ LocalAssetStorage::~LocalAssetStorage()
 
 void LocalAssetStorage::LoadAllAssetsOfType(AssetAPI *assetAPI, const String &suffix, const String &assetType)
 {
-    Urho3D::FileSystem* fileSystem = GetSubsystem<Urho3D::FileSystem>();
-    StringVector filenames;
-    fileSystem->ScanDir(filenames, directory, "*.*", Urho3D::SCAN_FILES, recursive);
-    foreach(String str, filenames)
-    {
-        if ((suffix == "" || str.EndsWith(suffix)) && !(str.Contains(".git") || str.Contains(".svn") || str.Contains(".hg")))
-        {
-            uint lastSlash = str.FindLast('/');
-            if (lastSlash != String::NPOS)
-                str = str.Substring(lastSlash + 1);
-            assetAPI->RequestAsset("local://" + str, assetType);
-        }
-    }
+    EnsureContentsCached();
+    for(std::map<String, String, StringCompareCaseInsensitive>::const_iterator iter = cachedFiles.begin(); iter != cachedFiles.end(); ++iter)
+        if (suffix == "" || iter->first.EndsWith(suffix))
+            assetAPI->RequestAsset("local://" + iter->first, assetType);
 }
 
 void LocalAssetStorage::RefreshAssetRefs()
 {
-    Urho3D::FileSystem* fileSystem = GetSubsystem<Urho3D::FileSystem>();
-    StringVector filenames;
-    fileSystem->ScanDir(filenames, directory, "*.*", Urho3D::SCAN_FILES, recursive);
+    // An explicit refresh always rescans, to pick up changes the watcher may have missed.
+    CacheStorageContents();
 
-    foreach(String str, filenames)
+    HashSet<String> knownRefs;
+    for(uint i = 0; i < assetRefs.Size(); ++i)
+        knownRefs.Insert(assetRefs[i]);
+
+    for(std::map<String, String, StringCompareCaseInsensitive>::const_iterator iter = cachedFiles.begin(); iter != cachedFiles.end(); ++iter)
     {
-        if (!(str.Contains(".git") || str.Contains(".svn") || str.Contains(".hg")))
+        String assetRef = "local://" + iter->first;
+        if (!knownRefs.Contains(assetRef))
         {
-            String diskSource = directory + str;
-            uint lastSlash = str.FindLast('/');
-            if (lastSlash != String::NPOS)
-                str = str.Substring(lastSlash + 1);
-            String localName = str;
-            str = "local://" + str;
-            if (!assetRefs.Contains(str))
-            {
-                assetRefs.Push(str);
-                AssetChanged.Emit(this, localName, diskSource, IAssetStorage::AssetCreate);
-            }
+            knownRefs.Insert(assetRef);
+            assetRefs.Push(assetRef);
+            AssetChanged.Emit(this, iter->first, iter->second, IAssetStorage::AssetCreate);
         }
     }
 }
 
 void LocalAssetStorage::CacheStorageContents()
 {
+    URHO3D_PROFILE(LocalAssetStorage_CacheStorageContents);
+
     cachedFiles.clear();
+    missingFiles.clear();
+    contentsCached = true;
+    cacheAge.Reset();
+
     Urho3D::FileSystem* fileSystem = GetSubsystem<Urho3D::FileSystem>();
     StringVector filenames;
     fileSystem->ScanDir(filenames, directory, "*.*", Urho3D::SCAN_FILES, recursive);
 
     foreach(String str, filenames)
     {
-        if (!(str.Contains(".git") || str.Contains(".svn") || str.Contains(".hg")))
+        if (!IsVersionControlPath(str))
         {
             String diskSource = directory + str;
             uint lastSlash = str.FindLast('/');
@@ -102,28 +109,78 @@ void LocalAssetStorage::CacheStorageContents()
     }
 }
 
+void LocalAssetStorage::EnsureContentsCached()
+{
+    if (!contentsCached)
+        CacheStorageContents();
+}
+
+bool LocalAssetStorage::RescanOnMiss()
+{
+    if (cacheAge.GetMSec(false) < (changeWatcher ? cWatchedIndexRescanInterval : cIndexRescanInterval))
+        return false;
+    CacheStorageContents();
+    return true;
+}
+
+void LocalAssetStorage::UpdateCachedFile(const String &absoluteFilename)
+{
+    if (!contentsCached || !absoluteFilename.StartsWith(directory, false))
+        return;
+    String relativeName = absoluteFilename.Substring(directory.Length());
+    if (IsVersionControlPath(relativeName) || (!recursive && relativeName.Contains('/')))
+        return;
+
+    String localName = Urho3D::GetFileNameAndExtension(absoluteFilename);
+    if (GetSubsystem<Urho3D::FileSystem>()->FileExists(absoluteFilename))
+    {
+        cachedFiles[localName] = absoluteFilename;
+        missingFiles.erase(localName);
+    }
+    else
+    {
+        std::map<String, String, StringCompareCaseInsensitive>::iterator iter = cachedFiles.find(localName);
+        if (iter != cachedFiles.end() && iter->second.Compare(absoluteFilename, false) == 0)
+            cachedFiles.erase(iter);
+    }
+}
+
 String LocalAssetStorage::GetFullPathForAsset(const String &assetname, bool recursiveLookup)
 {
     Urho3D::FileSystem* fileSystem = GetSubsystem<Urho3D::FileSystem>();
     if (fileSystem->FileExists(directory + assetname))
         return directory;
 
-    std::map<String, String, StringCompareCaseInsensitive>::iterator iter = cachedFiles.find(assetname);
-    if (iter == cachedFiles.end())
+    if (!recursive || !recursiveLookup)
     {
-        if (!recursive || !recursiveLookup)
-            return "";
-        else
-            CacheStorageContents();
+        std::map<String, String, StringCompareCaseInsensitive>::iterator iter = cachedFiles.find(assetname);
+        if (iter != cachedFiles.end() && fileSystem->FileExists(iter->second))
+            return Urho3D::GetPath(iter->second);
+        return "";
+    }
+
+    // Hits are answered from the index. Known misses are answered without touching the disk until they expire.
+    EnsureContentsCached();
+    if (missingFiles.find(assetname) == missingFiles.end())
+    {
+        std::map<String, String, StringCompareCaseInsensitive>::iterator iter = cachedFiles.find(assetname);
+        if (iter != cachedFiles.end())
+        {
+            if (fileSystem->FileExists(iter->second))
+                return Urho3D::GetPath(iter->second);
+            // The file was removed without us noticing.
+            cachedFiles.erase(iter);
+        }
     }
 
-    iter = cachedFiles.find(assetname);
-    if (iter != cachedFiles.end())
+    if (RescanOnMiss())
     {
-        if (fileSystem->FileExists(iter->second))
+        std::map<String, String, StringCompareCaseInsensitive>::iterator iter = cachedFiles.find(assetname);
+        if (iter != cachedFiles.end())
             return Urho3D::GetPath(iter->second);
     }
 
+    missingFiles.insert(assetname);
     return "";
 }
 
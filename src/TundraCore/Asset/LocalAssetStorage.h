@@ -6,7 +6,10 @@
 #include "IAssetStorage.h"
 #include "CoreStringUtils.h"
 
+#include <Urho3D/Core/Timer.h>
+
 #include <map>
+#include <set>
 
 namespace Tundra
 {
@@ -54,6 +57,8 @@ public:
     /// Returns the full local filesystem path name of the given asset in this storage, if it exists.
     /// Example: GetFullPathForAsset("my.mesh", true) might return "C:\Projects\Tundra\bin\data\assets".
     /// If the file does not exist, returns "".
+    /** Recursive lookups are answered from the file index, see CacheStorageContents. Misses are remembered, so that
+        missing assets rescan the storage directory at most once in a while. */
     String GetFullPathForAsset(const String &assetname, bool recursive);
 
     /// Returns the URL that should be used in a scene asset reference attribute to refer to the asset with the given localName.
@@ -85,14 +90,39 @@ public:
     void EmitAssetChanged(String absoluteFilename, IAssetStorage::ChangeType change);
 
     /// Walks through this storage on disk and creates a cached index of all the filenames inside this storage.
+    /** The index is built on first need and kept up to date from the file watcher notifications (see UpdateCachedFile),
+        so this needs to be called again only to pick up changes made while not watching. */
     void CacheStorageContents();
 
+    /// Updates the file index for a created, modified or deleted file.
+    /** @param absoluteFilename Full path of the file inside this storage. */
+    void UpdateCachedFile(const String &absoluteFilename);
+
+    /// Returns whether the file index has been built.
+    bool IsContentsCached() const { return contentsCached; }
+
 private:
     friend class LocalAssetProvider;
 
+    /// Builds the file index if it has not been built yet.
+    void EnsureContentsCached();
+
+    /// Rebuilds the file index after a miss, if it has not been rebuilt recently. Returns whether the index was rebuilt.
+    bool RescanOnMiss();
+
     /// Maps a file basename 'asset.mesh' to its full path 'c:\project\assets\asset.mesh'.
     /// Used to quickly lookup known assets by basename instead of having to do an expensive recursive directory search.
     std::map<String, String, StringCompareCaseInsensitive> cachedFiles;
+
+    /// Basenames that were looked up but not found in the index. Cleared when the index is rebuilt.
+    std::set<String, StringCompareCaseInsensitive> missingFiles;
+
+    /// Whether cachedFiles has been built.
+    bool contentsCached;
+
+    /// Time of the latest index build. The index is rebuilt on a miss at most once per cIndexRescanInterval,
+    /// or cWatchedIndexRescanInterval if the storage is watched.
+    Urho3D::Timer cacheAge;
 };
 
 }
@@ -6,6 +6,7 @@
 
 #include "Framework.h"
 #include "AssetAPI.h"
+#include "AssetLoadTimeline.h"
 #include "IAsset.h"
 #include "Scene.h"
 #include "IRenderer.h"
@@ -228,7 +229,8 @@ void SceneHudPanel::UpdatePanel(float frametime, const SharedPtr<Urho3D::UIEleme
 
 AssetHudPanel::AssetHudPanel(Framework *framework) :
     DebugHudPanel(framework),
-    limiter_(1/10.f)
+    limiter_(1/10.f),
+    timingLimiter_(1.f)
 {
 }
 
@@ -275,6 +277,8 @@ struct AssetTypeInfo
 
 void AssetHudPanel::UpdatePanel(float frametime, const SharedPtr<Urho3D::UIElement> &widget)
 {
+    if (timingLimiter_.ShouldUpdate(frametime))
+        timing_ = framework_->Asset()->LoadTimeline()->ComputeStatistics(5);
     if (!limiter_.ShouldUpdate(frametime))
         return;
 
@@ -399,6 +403,25 @@ void AssetHudPanel::UpdatePanel(float frametime, const SharedPtr<Urho3D::UIEleme
     if (!binaryExts.Empty())
         str.AppendWithFormat("Binary Types          %s\n\n", binaryExts.Substring(0, binaryExts.Length()-2).CString());
 
+    // Where the load time went, to tell network, decode and dependency bound loads apart.
+    const AssetLoadTimeline::Statistics &timing = timing_;
+    str.AppendWithFormat("Load Timing (sec)     %u loaded, %u failed, %u pending\n\n", timing.numLoaded, timing.numFailed, timing.numPending);
+    str.AppendWithFormat("%s %s %s %s\n", PadString("Queued", 9).CString(), PadString("Transfer", 9).CString(),
+        PadString("Decode", 9).CString(), PadString("Dependencies", 12).CString());
+    str.AppendWithFormat("%s %s %s %s\n\n", PadDouble(timing.queueUSec / 1e6, 9).CString(), PadDouble(timing.transferUSec / 1e6, 9).CString(),
+        PadDouble(timing.decodeUSec / 1e6, 9).CString(), PadDouble(timing.dependencyUSec / 1e6, 12).CString());
+    for(auto iter = timing.types.Begin(); iter != timing.types.End(); ++iter)
+        str.AppendWithFormat("%s %s decode\n", PadString(iter->first_, 13).CString(), PadDouble(iter->second_.decodeUSec / 1e6, 8).CString());
+    for(auto iter = timing.storages.Begin(); iter != timing.storages.End(); ++iter)
+        str.AppendWithFormat("%s %u/%u cache hits\n", PadString(iter->first_, 13).CString(), iter->second_.cacheHits, iter->second_.transfers);
+    if (!timing.slowest.Empty())
+    {
+        str.Append("\nSlowest\n");
+        foreach(const AssetLoadTimeline::Record &record, timing.slowest)
+            str.AppendWithFormat("%s %s\n", PadDouble(record.Duration(AssetLoadTimeline::Queued, AssetLoadTimeline::Loaded) / 1e6, 8).CString(), record.ref.CString());
+    }
+    str.Append("\n");
+
     // todo Transfers
     auto transfers = framework_->Asset()->PendingTransfers();
     str.AppendWithFormat("Asset Transfers       %u\n\n", transfers.Size());
@@ -5,6 +5,7 @@
 #include "FrameworkFwd.h"
 #include "DebugHudPanel.h"
 #include "CoreTimeUtils.h"
+#include "AssetLoadTimeline.h"
 
 /// @cond PRIVATE
 
@@ -63,6 +64,9 @@ protected:
 
 private:
     FrameLimiter limiter_;
+    /// Load timing statistics go through all the load timeline records, so they are updated less often than the panel.
+    FrameLimiter timingLimiter_;
+    AssetLoadTimeline::Statistics timing_;
 };
 
 }
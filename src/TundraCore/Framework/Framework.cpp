@@ -165,6 +165,9 @@ void Framework::Initialize()
 
     console->RegisterCommand("plugins", "Prints all currently loaded plugins.", plugin.Get(), &PluginAPI::ListPlugins);
     console->RegisterCommand("exit", "Shuts down gracefully.", this, &Framework::Exit);
+    console->RegisterCommand("saveAssetTimeline", "Writes the load timing of the asset transfers to a trace event JSON file, "
+        "viewable eg. in chrome://tracing. Usage: saveAssetTimeline(filename)")->ExecutedWith.Connect(asset.Get(), &AssetAPI::SaveLoadTimeline);
+    console->RegisterCommand("printAssetLoadStats", "Prints where the time of the asset loads was spent.", asset.Get(), &AssetAPI::PrintLoadStatistics);
 
     // Initialize plugins now
     LogInfo("");
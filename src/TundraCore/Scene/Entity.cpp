@@ -10,6 +10,7 @@
 #include "IComponent.h"
 #include "LoggingFunctions.h"
 
+#include <Urho3D/Container/HashSet.h>
 #include <Urho3D/Resource/XMLFile.h>
 #include <Urho3D/Core/Profiler.h>
 
@@ -442,7 +443,8 @@ void Entity::DeserializeFromBinary(kNet::DataDeserializer &src, AttributeChange:
 {
 }*/
 
-void Entity::SerializeToXML(Urho3D::XMLFile &doc, Urho3D::XMLElement &base_element, bool serializeTemporary, bool serializeLocal, bool serializeChildren) const
+void Entity::SerializeToXML(Urho3D::XMLFile &doc, Urho3D::XMLElement &base_element, bool serializeTemporary, bool serializeLocal, bool serializeChildren,
+    bool serializePrefabInstances) const
 {
     Urho3D::XMLElement entity_elem;
 
@@ -456,9 +458,35 @@ void Entity::SerializeToXML(Urho3D::XMLFile &doc, Urho3D::XMLElement &base_eleme
     if (serializeTemporary)
         entity_elem.SetBool("temporary", IsTemporary());
 
+    // A prefab instance is written as differences to its prefab. If a prefab component has been removed
+    // from the instance, loading it would bring the component back, so the entity is written in full instead.
+    bool serializeAsPrefab = serializePrefabInstances && !prefab_.Empty() && scene_ && scene_->HasPrefab(prefab_);
+    if (serializeAsPrefab)
+    {
+        ComponentVector prototypes = scene_->PrefabComponents(prefab_);
+        foreach(const ComponentPtr &prototype, prototypes)
+        {
+            ComponentPtr comp = Component(prototype->TypeId(), prototype->Name());
+            if (!comp || !comp->ShouldBeSerialized(serializeTemporary, serializeLocal))
+            {
+                serializeAsPrefab = false;
+                break;
+            }
+        }
+    }
+    if (serializeAsPrefab)
+        entity_elem.SetAttribute("prefab", prefab_);
+
     for (ComponentMap::ConstIterator i = components_.Begin(); i != components_.End(); ++i)
-        if (i->second_->ShouldBeSerialized(serializeTemporary, serializeLocal))
+    {
+        if (!i->second_->ShouldBeSerialized(serializeTemporary, serializeLocal))
+            continue;
+        IComponent *prototype = (serializeAsPrefab ? scene_->PrefabComponent(prefab_, i->second_->TypeId(), i->second_->Name()) : 0);
+        if (prototype)
+            i->second_->SerializeDeltaTo(doc, entity_elem, prototype, serializeTemporary);
+        else
             i->second_->SerializeTo(doc, entity_elem, serializeTemporary);
+    }
 
     // Serialize child entities
     if (serializeChildren)
@@ -467,11 +495,26 @@ void Entity::SerializeToXML(Urho3D::XMLFile &doc, Urho3D::XMLElement &base_eleme
         {
             const EntityPtr child = i->Lock();
             if (child && child->ShouldBeSerialized(serializeTemporary, serializeLocal, serializeChildren))
-                child->SerializeToXML(doc, entity_elem, serializeTemporary, serializeLocal);
+                child->SerializeToXML(doc, entity_elem, serializeTemporary, serializeLocal, true, serializePrefabInstances);
         }
     }
 }
 
+/// Collects the names of the prefabs that @c entity, and optionally its children, are instances of.
+static void CollectPrefabNames(const Entity *entity, bool children, HashSet<String> &names)
+{
+    if (!entity->PrefabName().Empty())
+        names.Insert(entity->PrefabName());
+    if (!children)
+        return;
+    for(uint i = 0; i < entity->NumChildren(); ++i)
+    {
+        const EntityPtr child = entity->Child(i);
+        if (child)
+            CollectPrefabNames(child.Get(), true, names);
+    }
+}
+
 /* Disabled for now, since have to decide how entityID conflicts are handled.
 void Entity::DeserializeFromXML(Urho3D::XMLElement& element, AttributeChange::Type change)
 {
@@ -483,7 +526,15 @@ String Entity::SerializeToXMLString(bool serializeTemporary, bool serializeLocal
     {
         Urho3D::XMLFile sceneDoc(context_);
         Urho3D::XMLElement sceneElem = sceneDoc.CreateRoot("scene");
-        SerializeToXML(sceneDoc, sceneElem, serializeTemporary, serializeLocal, serializeChildren);
+        // Write the prefab definitions along the instances, so that the XML can be loaded into a scene that lacks them.
+        if (scene_)
+        {
+            HashSet<String> prefabNames;
+            CollectPrefabNames(this, serializeChildren, prefabNames);
+            foreach(const String &prefabName, prefabNames)
+                scene_->SerializePrefabToXml(sceneDoc, sceneElem, prefabName);
+        }
+        SerializeToXML(sceneDoc, sceneElem, serializeTemporary, serializeLocal, serializeChildren, scene_ != 0);
         return sceneDoc.ToString();
     }
     else
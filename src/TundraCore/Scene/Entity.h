@@ -236,8 +236,13 @@ public:
         @param base_element Points to the <scene> element of this XML document. This entity will be serialized as a child to base_element.
         @param serializeTemporary Serialize temporary entities or components for application-specific purposes. The default value is false. 
         @param bool serializeLocal Serialize local entities. Default true.
-        @param serializeChildren Serialize child entities. Default true.*/
-    void SerializeToXML(Urho3D::XMLFile& doc, Urho3D::XMLElement& base_element, bool serializeTemporary = false, bool serializeLocal = true, bool serializeChildren = true) const;
+        @param serializeChildren Serialize child entities. Default true.
+        @param serializePrefabInstances Serialize prefab instances as a reference to their prefab and only the attribute values
+            that differ from it. The caller is responsible for writing the referenced <prefab> definitions to the document.
+            If false, prefab instances are serialized with all their attributes. Default false.
+        @sa Scene::SerializePrefabToXml */
+    void SerializeToXML(Urho3D::XMLFile& doc, Urho3D::XMLElement& base_element, bool serializeTemporary = false, bool serializeLocal = true, bool serializeChildren = true,
+        bool serializePrefabInstances = false) const;
 //        void DeserializeFromXML(Urho3D::XMLElement& element, AttributeChange::Type change);
 
     /// Serializes this entity, and returns the generated XML as a string
@@ -245,6 +250,8 @@ public:
         @param bool serializeLocal Serialize local entities. Default true.
         @param serializeChildren Serialize child entities. Default true.
         @param createSceneElement Whether to wrap the entity XML element in a scene XML element. Default false.
+            If true, the definitions of the prefabs the serialized entities are instances of are written to the scene element,
+            otherwise prefab instances are serialized with all their attributes.
         @sa SerializeToXML */
     String SerializeToXMLString(bool serializeTemporary = false, bool serializeLocal = true, bool serializeChildren = true, bool createSceneElement = false) const;
 //        bool DeserializeFromXMLString(const String &src, AttributeChange::Type change);
@@ -300,6 +307,14 @@ public:
     /** By definition, all components of a temporary entity are temporary as well. */
     bool IsTemporary() const { return temporary_; }
 
+    /// Sets the name of the prefab this entity is an instance of. Set empty to detach the entity from its prefab.
+    /** Only affects serialization: the attributes of a prefab instance are written as differences to the prefab.
+        @sa Scene::RegisterPrefab */
+    void SetPrefabName(const String &prefabName) { prefab_ = prefabName; }
+
+    /// Returns the name of the prefab this entity is an instance of, or an empty string if none.
+    const String &PrefabName() const { return prefab_; }
+
     /// Returns if this entity's changes will NOT be sent over the network.
     /// An Entity is always either local or replicated, but not both.
     bool IsLocal() const { return id_ >= UniqueIdGenerator::FIRST_LOCAL_ID; }
@@ -443,6 +458,7 @@ private:
     Scene* scene_; ///< Pointer to scene
     ActionMap actions_; ///< Map of registered entity actions.
     bool temporary_; ///< Temporary-flag
+    String prefab_; ///< Name of the prefab this entity is an instance of.
 
     ChildEntityVector children_; ///< Child entities. Note that the entities are authoritatively owned by the scene; the child reference is weak intentionally.
     EntityWeakPtr parent_; ///< Parent entity. Note that the entities are authoritatively owned by the scene; the parent reference is weak intentionally.
@@ -0,0 +1,129 @@
+/**
+    For conditions of distribution and use, see copyright notice in LICENSE
+
+    @file   EntityPredictor.cpp
+    @brief  Client-side prediction and server reconciliation of an input-driven entity. */
+
+#include "StableHeaders.h"
+#include "EntityPredictor.h"
+#include "Entity.h"
+#include "IComponent.h"
+#include "LoggingFunctions.h"
+
+namespace Tundra
+{
+
+EntityPredictor::EntityPredictor(Entity *entity) :
+    entity_(entity),
+    nextSequence_(1),
+    lastAcknowledged_(0),
+    corrections_(0)
+{
+}
+
+EntityPredictor::~EntityPredictor()
+{
+    ClearAuthoritativeValues();
+}
+
+void EntityPredictor::AddPredictedAttribute(IAttribute *attr)
+{
+    if (!attr || !attr->Owner() || attr->Owner()->ParentEntity() != entity_.Get())
+    {
+        LogError("EntityPredictor::AddPredictedAttribute: Attribute does not belong to the predicted entity.");
+        return;
+    }
+    if (IsPredicted(attr))
+        return;
+
+    attributes_.Push(AttributeWeakPtr(attr->Owner(), attr));
+    authoritative_.Push(0);
+}
+
+bool EntityPredictor::IsPredicted(IAttribute *attr) const
+{
+    for(uint i = 0; i < attributes_.Size(); ++i)
+        if (attributes_[i].Get() == attr)
+            return attr != 0;
+    return false;
+}
+
+const PredictionInput &EntityPredictor::Predict(const PODVector<u8> &data, float timeStep)
+{
+    PredictionInput input;
+    input.sequence = nextSequence_++;
+    input.timeStep = timeStep;
+    input.data = data;
+    pending_.Push(input);
+
+    ApplyInput(pending_.Back(), AttributeChange::LocalOnly);
+    return pending_.Back();
+}
+
+void EntityPredictor::SetAuthoritativeValue(IAttribute *attr, IAttribute *value)
+{
+    for(uint i = 0; i < attributes_.Size(); ++i)
+    {
+        if (attr && attributes_[i].Get() == attr)
+        {
+            delete authoritative_[i];
+            authoritative_[i] = value;
+            return;
+        }
+    }
+    delete value;
+}
+
+void EntityPredictor::Acknowledge(u32 sequence)
+{
+    if (sequence < lastAcknowledged_)
+        return; // Stale acknowledgement
+    lastAcknowledged_ = sequence;
+    while(!pending_.Empty() && pending_.Front().sequence <= sequence)
+        pending_.PopFront();
+
+    // Remember the predicted values to detect mispredictions
+    StringVector predicted;
+    for(uint i = 0; i < attributes_.Size(); ++i)
+        predicted.Push(attributes_[i].Get() ? attributes_[i].Get()->ToString() : String::EMPTY);
+
+    // Rewind to the authoritative state and replay the inputs the server has not seen yet
+    for(uint i = 0; i < attributes_.Size(); ++i)
+    {
+        IAttribute *attr = attributes_[i].Get();
+        if (attr && authoritative_[i])
+            attr->CopyValue(authoritative_[i], AttributeChange::LocalOnly);
+    }
+    for(List<PredictionInput>::ConstIterator i = pending_.Begin(); i != pending_.End(); ++i)
+        ApplyInput(*i, AttributeChange::LocalOnly);
+
+    for(uint i = 0; i < attributes_.Size(); ++i)
+    {
+        IAttribute *attr = attributes_[i].Get();
+        if (attr && attr->ToString() != predicted[i])
+        {
+            ++corrections_;
+            break;
+        }
+    }
+}
+
+bool EntityPredictor::Process(const PredictionInput &input, AttributeChange::Type change)
+{
+    if (input.sequence <= lastAcknowledged_)
+        return false;
+    lastAcknowledged_ = input.sequence;
+    ApplyInput(input, change);
+    return true;
+}
+
+void EntityPredictor::ClearAuthoritativeValues()
+{
+    for(uint i = 0; i < authoritative_.Size(); ++i)
+    {
+        delete authoritative_[i];
+        authoritative_[i] = 0;
+    }
+}
+
+}
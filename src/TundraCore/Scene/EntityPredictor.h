@@ -0,0 +1,102 @@
+/**
+    For conditions of distribution and use, see copyright notice in LICENSE
+
+    @file   EntityPredictor.h
+    @brief  Client-side prediction and server reconciliation of an input-driven entity. */
+
+#pragma once
+
+#include "TundraCoreApi.h"
+#include "CoreTypes.h"
+#include "SceneFwd.h"
+#include "AttributeChangeType.h"
+#include "IAttribute.h"
+
+#include <Urho3D/Container/RefCounted.h>
+#include <Urho3D/Container/List.h>
+
+namespace Tundra
+{
+
+/// Input applied to a predicted entity.
+struct TUNDRACORE_API PredictionInput
+{
+    PredictionInput() : sequence(0), timeStep(0.f) {}
+
+    u32 sequence; ///< Sequence number, assigned by EntityPredictor::Predict.
+    float timeStep; ///< Time step in seconds the input is applied for.
+    PODVector<u8> data; ///< Application-defined input data.
+};
+
+/// Client-side prediction and server reconciliation of an entity driven by inputs, f.ex. an avatar controller.
+/** Subclass and implement ApplyInput(), which must produce the same result on the client and the server given the same
+    predicted attribute values and input. The same subclass is used on both ends:
+    - The client calls Predict() for each new input. The input is applied immediately and kept until the server acknowledges it.
+    - The server calls Process() for each input received from the client, and sends back the input's sequence number together
+      with the resulting values of the predicted attributes.
+    - The client passes those to SetAuthoritativeValue() and Acknowledge(). The predicted attributes are rewound
+      to the authoritative values and the inputs that the server has not processed yet are re-applied.
+    The network sync of the predicted attributes must not overwrite the predicted values on the client, see IsPredicted(). */
+class TUNDRACORE_API EntityPredictor : public RefCounted
+{
+public:
+    explicit EntityPredictor(Entity *entity);
+    virtual ~EntityPredictor();
+
+    /// Applies @c input to the predicted attributes of the entity.
+    /** @param change Change type to use when setting the attributes: LocalOnly on the client, Default on the server. */
+    virtual void ApplyInput(const PredictionInput &input, AttributeChange::Type change) = 0;
+
+    /// Returns the entity, or null if it has been destroyed.
+    Entity *ParentEntity() const { return entity_.Get(); }
+
+    /// Adds an attribute of the entity that ApplyInput() changes and that is reconciled with the server.
+    void AddPredictedAttribute(IAttribute *attr);
+
+    /// Returns whether @c attr is predicted.
+    bool IsPredicted(IAttribute *attr) const;
+
+    /// Returns the predicted attributes, in the order they were added.
+    const Vector<AttributeWeakPtr> &PredictedAttributes() const { return attributes_; }
+
+    /// Client: applies a new input locally and queues it until acknowledged.
+    /** @return The queued input, with its sequence number assigned, to be sent to the server. */
+    const PredictionInput &Predict(const PODVector<u8> &data, float timeStep);
+
+    /// Client: sets the authoritative value of a predicted attribute, as sent by the server with an acknowledgement.
+    /** @param value Same kind of attribute holding the value. You must dynamically allocate this yourself,
+               but EntityPredictor will always take care of deleting it. */
+    void SetAuthoritativeValue(IAttribute *attr, IAttribute *value);
+
+    /// Client: the server has processed the inputs up to @c sequence. Rewinds to the authoritative values and re-applies the rest.
+    void Acknowledge(u32 sequence);
+
+    /// Server: applies an input received from the client. Inputs older than the last processed one are ignored.
+    /** @return True if the input was applied. */
+    bool Process(const PredictionInput &input, AttributeChange::Type change = AttributeChange::Default);
+
+    /// Client: returns the inputs that have not been acknowledged yet, oldest first.
+    const List<PredictionInput> &PendingInputs() const { return pending_; }
+
+    /// Client: returns the sequence number of the last acknowledged input. Server: the last processed input.
+    u32 LastAcknowledged() const { return lastAcknowledged_; }
+
+    /// Client: returns the number of times reconciliation changed the predicted values, ie. the prediction was wrong.
+    uint Corrections() const { return corrections_; }
+
+private:
+    /// Deletes the authoritative values.
+    void ClearAuthoritativeValues();
+
+    EntityWeakPtr entity_;
+    Vector<AttributeWeakPtr> attributes_; ///< Predicted attributes.
+    Vector<IAttribute*> authoritative_; ///< Latest authoritative value of each predicted attribute, null if not received.
+    List<PredictionInput> pending_; ///< Unacknowledged inputs.
+    u32 nextSequence_;
+    u32 lastAcknowledged_;
+    uint corrections_;
+};
+
+typedef SharedPtr<EntityPredictor> EntityPredictorPtr;
+
+}
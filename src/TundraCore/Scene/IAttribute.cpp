@@ -385,12 +385,12 @@ template<> void TUNDRACORE_API Attribute<Point>::FromString(const String& str, A
 
 template<> void TUNDRACORE_API Attribute<String>::ToBinary(kNet::DataSerializer& dest) const
 {
-    WriteUtf8String(dest, value);
+    WriteUtf8String(dest, Get());
 }
 
 template<> void TUNDRACORE_API Attribute<bool>::ToBinary(kNet::DataSerializer& dest) const
 {
-    if (value)
+    if (Get())
         dest.Add<u8>(1);
     else
         dest.Add<u8>(0);
@@ -398,102 +398,102 @@ template<> void TUNDRACORE_API Attribute<bool>::ToBinary(kNet::DataSerializer& d
 
 template<> void TUNDRACORE_API Attribute<int>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<s32>(value);
+    dest.Add<s32>(Get());
 }
 
 template<> void TUNDRACORE_API Attribute<uint>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<u32>(value);
+    dest.Add<u32>(Get());
 }
 
 template<> void TUNDRACORE_API Attribute<float>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<float>(value);
+    dest.Add<float>(Get());
 }
 
 template<> void TUNDRACORE_API Attribute<Quat>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<float>(value.x);
-    dest.Add<float>(value.y);
-    dest.Add<float>(value.z);
-    dest.Add<float>(value.w);
+    dest.Add<float>(Get().x);
+    dest.Add<float>(Get().y);
+    dest.Add<float>(Get().z);
+    dest.Add<float>(Get().w);
 }
 
 template<> void TUNDRACORE_API Attribute<float2>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<float>(value.x);
-    dest.Add<float>(value.y);
+    dest.Add<float>(Get().x);
+    dest.Add<float>(Get().y);
 }
 
 template<> void TUNDRACORE_API Attribute<float3>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<float>(value.x);
-    dest.Add<float>(value.y);
-    dest.Add<float>(value.z);
+    dest.Add<float>(Get().x);
+    dest.Add<float>(Get().y);
+    dest.Add<float>(Get().z);
 }
 
 template<> void TUNDRACORE_API Attribute<float4>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<float>(value.x);
-    dest.Add<float>(value.y);
-    dest.Add<float>(value.z);
-    dest.Add<float>(value.w);
+    dest.Add<float>(Get().x);
+    dest.Add<float>(Get().y);
+    dest.Add<float>(Get().z);
+    dest.Add<float>(Get().w);
 }
 
 template<> void TUNDRACORE_API Attribute<Color>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<float>(value.r);
-    dest.Add<float>(value.g);
-    dest.Add<float>(value.b);
-    dest.Add<float>(value.a);
+    dest.Add<float>(Get().r);
+    dest.Add<float>(Get().g);
+    dest.Add<float>(Get().b);
+    dest.Add<float>(Get().a);
 }
 
 template<> void TUNDRACORE_API Attribute<AssetReference>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.AddString(value.ref.CString()); /**< @todo Allow longer strings than 255 chars */
+    dest.AddString(Get().ref.CString()); /**< @todo Allow longer strings than 255 chars */
 }
 
 template<> void TUNDRACORE_API Attribute<AssetReferenceList>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<u8>((u8)value.Size()); /**< @todo Use VLE, allow more than 255 refs */
-    for(uint i = 0; i < value.Size(); ++i)
-        dest.AddString(value[i].ref.CString()); /**< @todo Allow longer strings than 255 chars */
+    dest.Add<u8>((u8)Get().Size()); /**< @todo Use VLE, allow more than 255 refs */
+    for(uint i = 0; i < Get().Size(); ++i)
+        dest.AddString(Get()[i].ref.CString()); /**< @todo Allow longer strings than 255 chars */
 }
 
 template<> void TUNDRACORE_API Attribute<EntityReference>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.AddString(value.ref.CString()); /**< @todo Allow longer strings than 255 chars */
+    dest.AddString(Get().ref.CString()); /**< @todo Allow longer strings than 255 chars */
 }
 
 template<> void TUNDRACORE_API Attribute<Variant>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.AddString(value.ToString().CString()); /**< @todo Allow longer strings than 255 chars */
+    dest.AddString(Get().ToString().CString()); /**< @todo Allow longer strings than 255 chars */
 }
 
 template<> void TUNDRACORE_API Attribute<VariantList>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<u8>((u8)value.Size()); /**< @todo Use VLE, allow more than 255 refs */
-    for(u32 i = 0; i < value.Size(); ++i)
-        dest.AddString(value[i].ToString().CString()); /**< @todo Allow longer strings than 255 chars */
+    dest.Add<u8>((u8)Get().Size()); /**< @todo Use VLE, allow more than 255 refs */
+    for(u32 i = 0; i < Get().Size(); ++i)
+        dest.AddString(Get()[i].ToString().CString()); /**< @todo Allow longer strings than 255 chars */
 }
 
 template<> void TUNDRACORE_API Attribute<Transform>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<float>(value.pos.x);
-    dest.Add<float>(value.pos.y);
-    dest.Add<float>(value.pos.z);
-    dest.Add<float>(value.rot.x);
-    dest.Add<float>(value.rot.y);
-    dest.Add<float>(value.rot.z);
-    dest.Add<float>(value.scale.x);
-    dest.Add<float>(value.scale.y);
-    dest.Add<float>(value.scale.z);
+    dest.Add<float>(Get().pos.x);
+    dest.Add<float>(Get().pos.y);
+    dest.Add<float>(Get().pos.z);
+    dest.Add<float>(Get().rot.x);
+    dest.Add<float>(Get().rot.y);
+    dest.Add<float>(Get().rot.z);
+    dest.Add<float>(Get().scale.x);
+    dest.Add<float>(Get().scale.y);
+    dest.Add<float>(Get().scale.z);
 }
 
 template<> void TUNDRACORE_API Attribute<Point>::ToBinary(kNet::DataSerializer& dest) const
 {
-    dest.Add<s32>(value.x);
-    dest.Add<s32>(value.y);
+    dest.Add<s32>(Get().x);
+    dest.Add<s32>(Get().y);
 }
 
 // FROMBINARY TEMPLATE IMPLEMENTATIONS.
@@ -104,6 +104,16 @@ public:
     /// Copies the value from another attribute of the same type.
     virtual void CopyValue(IAttribute* source, AttributeChange::Type change) = 0;
 
+    /// Makes this attribute use the value of another attribute of the same type until a value is set to it (copy-on-write).
+    /** Used by prefab instances so that they do not store copies of the prefab values, see IComponent::SharePrototypeValues.
+        @c source must stay alive and unmodified while it is shared. Setting a value, also with FromString or FromBinary,
+        stores an own copy again. Marks the value changed without emitting a change signal.
+        @return False if @c source is not of the same type. */
+    virtual bool ShareValue(IAttribute* source) = 0;
+
+    /// Returns whether the value is shared from another attribute, i.e. no value has been set since ShareValue.
+    virtual bool IsValueShared() const = 0;
+
     /// Interpolates the value of this attribute based on two values, and a lerp factor between 0 and 1
     /** The attributes given must be of the same type for the result to be defined.
         Is a no-op if the attribute (for example string) does not support interpolation.
@@ -196,7 +206,8 @@ public:
         @param id Attribute ID */
     Attribute(IComponent* owner, const char* id) :
         IAttribute(owner, id),
-        value(DefaultValue())
+        value(DefaultValue()),
+        shared(0)
     {
     }
 
@@ -206,7 +217,8 @@ public:
         @param val Value. */
     Attribute(IComponent* owner, const char* id, const T &val) :
         IAttribute(owner, id),
-        value(val)
+        value(val),
+        shared(0)
     {
     }
 
@@ -217,7 +229,8 @@ public:
         @param name Human-readable name. */
     Attribute(IComponent* owner, const char* id, const char* name) :
         IAttribute(owner, id, name),
-        value(DefaultValue())
+        value(DefaultValue()),
+        shared(0)
     {
     }
 
@@ -228,12 +241,13 @@ public:
         @param val Value. */
     Attribute(IComponent* owner, const char* id, const char* name, const T &val) :
         IAttribute(owner, id, name),
-        value(val)
+        value(val),
+        shared(0)
     {
     }
 
     /// Returns attribute's value.
-    const T &Get() const { return value; }
+    const T &Get() const { return shared ? shared->value : value; }
 
     /** Sets attribute's value.
         @param value New value.
@@ -241,6 +255,7 @@ public:
     void Set(const T &value, AttributeChange::Type change = AttributeChange::Default)
     {
         this->value = value;
+        shared = 0;
         valueChanged = true; // Signal to IComponent owning this attribute that the value of this attribute has changed.
         Changed(change);
     }
@@ -261,6 +276,20 @@ public:
             Set(source_attr->Get(), change);
     }
 
+    bool ShareValue(IAttribute* source) override
+    {
+        Attribute<T>* source_attr = dynamic_cast<Attribute<T>*>(source);
+        if (!source_attr || source_attr == this)
+            return false;
+        // Refer directly to the attribute that stores the value, so that reading it is always a single indirection.
+        shared = (source_attr->shared ? source_attr->shared : source_attr);
+        value = T();
+        valueChanged = true;
+        return true;
+    }
+
+    bool IsValueShared() const override { return shared != 0; }
+
     String ToString() const override;
     void FromString(const String& str, AttributeChange::Type change) override;
     void ToBinary(kNet::DataSerializer& dest) const override;
@@ -274,7 +303,8 @@ public:
     T DefaultValue() const;
 
 private:
-    T value; ///< The value of this Attribute.
+    T value; ///< The value of this Attribute, unless shared.
+    const Attribute<T> *shared; ///< Attribute whose value this attribute uses until it is set, see ShareValue.
 };
 
 /// Represents weak pointer to an attribute.
@@ -447,6 +447,40 @@ void IComponent::SerializeTo(Urho3D::XMLFile& doc, Urho3D::XMLElement& base_elem
             WriteAttribute(doc, comp_element, attributes[i]);
 }
 
+void IComponent::SerializeDeltaTo(Urho3D::XMLFile& doc, Urho3D::XMLElement& base_element, const IComponent *reference, bool serializeTemporary) const
+{
+    if (!reference || reference->TypeId() != TypeId() || SupportsDynamicAttributes())
+    {
+        SerializeTo(doc, base_element, serializeTemporary);
+        return;
+    }
+
+    Urho3D::XMLElement comp_element = BeginSerialization(doc, base_element, serializeTemporary);
+
+    const AttributeVector &referenceAttributes = reference->Attributes();
+    for(uint i = 0; i < attributes.Size(); ++i)
+    {
+        if (!attributes[i])
+            continue;
+        const IAttribute *referenceAttr = (i < referenceAttributes.Size() ? referenceAttributes[i] : 0);
+        const String value = attributes[i]->ToString();
+        if (!referenceAttr || referenceAttr->TypeId() != attributes[i]->TypeId() || referenceAttr->ToString() != value)
+            WriteAttribute(doc, comp_element, attributes[i]->Name(), attributes[i]->Id(), value, attributes[i]->TypeName());
+    }
+}
+
+void IComponent::SharePrototypeValues(const ComponentPtr &prototype)
+{
+    if (!prototype || prototype.Get() == this || prototype->TypeId() != TypeId())
+        return;
+
+    const AttributeVector &prototypeAttributes = prototype->Attributes();
+    for(uint i = 0; i < attributes.Size() && i < prototypeAttributes.Size(); ++i)
+        if (attributes[i] && prototypeAttributes[i] && !attributes[i]->IsDynamic())
+            attributes[i]->ShareValue(prototypeAttributes[i]);
+    prototype_ = prototype;
+}
+
 void IComponent::DeserializeFrom(Urho3D::XMLElement& element, AttributeChange::Type change)
 {
     if (!BeginDeserialization(element))
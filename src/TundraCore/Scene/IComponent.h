@@ -152,6 +152,21 @@ public:
             is only for metadata purposes and doesn't have an actual effect. The default value is false.*/
     virtual void SerializeTo(Urho3D::XMLFile& doc, Urho3D::XMLElement& baseElement, bool serializeTemporary = false) const;
 
+    /// Serializes this component and only those of its Attributes whose value differs from @c reference.
+    /** Used for writing prefab instances. DeserializeFrom applies such a delta on top of the current values.
+        Components that support dynamic attributes are always serialized in full, as their deserialization
+        replaces the whole attribute structure.
+        @param reference Component of the same type to compare against, f.ex. a prefab prototype. */
+    void SerializeDeltaTo(Urho3D::XMLFile& doc, Urho3D::XMLElement& baseElement, const IComponent *reference, bool serializeTemporary = false) const;
+
+    /// Shares the static attribute values of @c prototype copy-on-write, so that this component stores only the values set afterwards.
+    /** Used for prefab instances. The prototype is kept alive by this component and must not be modified afterwards.
+        Dynamic attributes are not shared. @sa IAttribute::ShareValue, Scene::RegisterPrefab */
+    void SharePrototypeValues(const ComponentPtr &prototype);
+
+    /// Returns the prototype whose attribute values this component shares, or null if none, @see SharePrototypeValues.
+    ComponentPtr Prototype() const { return prototype_; }
+
     /// Deserializes this component from the given XML document.
     /** @param element Points to the <component> element that is the root of the serialized form of this Component.
         @param change Specifies the source of this change. This field controls whether the deserialization
@@ -383,6 +398,7 @@ protected:
     AttributeChange::Type updateMode; ///< Default update mode for attribute changes
     Framework* framework; ///< Needed to be able to perform important uninitialization etc. even when not in an entity.
     bool temporary; ///< Temporary-flag
+    ComponentPtr prototype_; ///< Prototype whose attribute values are shared, @see SharePrototypeValues.
 
 private:
     friend class IAttribute;
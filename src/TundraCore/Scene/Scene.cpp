@@ -37,7 +37,20 @@ Scene::Scene(const String &name, Framework *framework, bool viewEnabled, bool au
     name_(name),
     framework_(framework),
     interpolating_(false),
-    authority_(authority)
+    authority_(authority),
+    snapshotLocalTime_(0.0),
+    snapshotRenderTime_(0.0),
+    snapshotClockStarted_(false),
+    snapshotServerOffset_(0.0),
+    snapshotLastServerTime_(0.0),
+    snapshotInterval_(0.0f),
+    snapshotJitter_(0.0f),
+    snapshotDelay_(0.1f),
+    minSnapshotDelay_(0.05f),
+    maxSnapshotDelay_(0.5f),
+    maxSnapshotExtrapolation_(0.25f),
+    snapshotUnderruns_(0),
+    lastPrefabRevision_(0)
 {
     // In headless mode only view disabled-scenes can be created
     viewEnabled_ = framework->IsHeadless() ? false : viewEnabled;
@@ -123,6 +136,331 @@ EntityPtr Scene::CreateLocalTemporaryEntity(const StringVector &components, Attr
     return CreateEntity(0, components, change, false, false, true);
 }
 
+EntityVector Scene::CreateEntities(const EntityDesc &desc, uint count, AttributeChange::Type change)
+{
+    return CreateEntitiesFromDesc(desc, count, nullptr, change);
+}
+
+EntityVector Scene::CreateEntities(const EntityDesc &desc, const Vector<ComponentDescList> &initialValues, AttributeChange::Type change)
+{
+    return CreateEntitiesFromDesc(desc, initialValues.Size(), &initialValues, change);
+}
+
+EntityVector Scene::CreateEntitiesFromDesc(const EntityDesc &desc, uint count, const Vector<ComponentDescList> *initialValues, AttributeChange::Type change)
+{
+    if (count == 0)
+        return EntityVector();
+
+    // Parse the template once into unparented prototype components. The created entities copy their values from these.
+    Entity::ComponentVector prototypes = CreatePrototypes(desc);
+    return CreateEntitiesFromPrototypes(prototypes, !desc.local, desc.temporary, count, initialValues, change, String::EMPTY);
+}
+
+Entity::ComponentVector Scene::CreatePrototypes(const EntityDesc &desc)
+{
+    const bool replicated = !desc.local;
+    SceneAPI* sceneAPI = framework_->Scene();
+
+    Entity::ComponentVector prototypes;
+    foreach(const ComponentDesc &c, desc.components)
+    {
+        if (c.typeName.Empty())
+            continue;
+        if (!sceneAPI->IsComponentTypeRegistered(c.typeName))
+            sceneAPI->RegisterPlaceholderComponentType(c);
+
+        ComponentPtr prototype = sceneAPI->CreateComponentByName(this, c.typeName, c.name);
+        if (!prototype)
+        {
+            LogError("Scene::CreatePrototypes: failed to create component " + c.typeName + " " + c.name);
+            continue;
+        }
+        prototype->SetReplicated(replicated && c.sync);
+        ApplyComponentDesc(prototype.Get(), c);
+        prototypes.Push(prototype);
+    }
+    return prototypes;
+}
+
+EntityVector Scene::CreateEntitiesFromPrototypes(const Entity::ComponentVector &prototypes, bool replicated, bool temporary, uint count,
+    const Vector<ComponentDescList> *initialValues, AttributeChange::Type change, const String &prefabName)
+{
+    URHO3D_PROFILE(Scene_CreateEntities);
+
+    EntityVector ret;
+    if (count == 0)
+        return ret;
+
+    SceneAPI* sceneAPI = framework_->Scene();
+
+    // Allocate the entity IDs as a block
+    PODVector<entity_id_t> ids(count);
+    for(uint i = 0; i < count; ++i)
+    {
+        for(;;)
+        {
+            if (!replicated)
+                ids[i] = idGenerator_.AllocateLocal();
+            else
+                ids[i] = IsAuthority() ? idGenerator_.AllocateReplicated() : idGenerator_.AllocateUnacked();
+            if (entities_.Find(ids[i]) == entities_.End())
+                break;
+        }
+    }
+
+    // Construct all entities without signaling
+    ret.Reserve(count);
+    for(uint i = 0; i < count; ++i)
+    {
+        EntityPtr entity(new Entity(framework_, ids[i], temporary, this));
+        entity->SetPrefabName(prefabName);
+        foreach(const ComponentPtr &prototype, prototypes)
+        {
+            ComponentPtr comp = sceneAPI->CreateComponentById(this, prototype->TypeId(), prototype->Name());
+            if (!comp)
+                continue;
+            comp->SetReplicated(prototype->IsReplicated());
+            InstantiatePrototype(prototype, comp.Get());
+            if (initialValues)
+            {
+                foreach(const ComponentDesc &c, (*initialValues)[i])
+                    if (c.typeName.Compare(comp->TypeName(), false) == 0 && c.name == comp->Name())
+                        ApplyAttributeDescs(comp.Get(), c.attributes);
+            }
+            entity->AddComponent(comp, AttributeChange::Disconnected);
+        }
+        entities_[entity->Id()] = entity;
+        ret.Push(entity);
+    }
+
+    // Signal the whole batch
+    if (change != AttributeChange::Disconnected)
+    {
+        AttributeChange::Type entityChange = (change == AttributeChange::Default ? AttributeChange::Replicate : change);
+        foreach(const EntityPtr &entity, ret)
+        {
+            const Entity::ComponentMap &components = entity->Components();
+            for(Entity::ComponentMap::ConstIterator i = components.Begin(); i != components.End(); ++i)
+            {
+                entity->ComponentAdded.Emit(i->second_.Get(), change == AttributeChange::Default ? i->second_->UpdateMode() : change);
+                EmitComponentAdded(entity.Get(), i->second_.Get(), change);
+            }
+
+            EntityCreated.Emit(entity.Get(), entityChange);
+
+            for(Entity::ComponentMap::ConstIterator i = components.Begin(); i != components.End(); ++i)
+                i->second_->ComponentChanged(change);
+        }
+    }
+
+    return ret;
+}
+
+bool Scene::RegisterPrefab(const String &name, const EntityDesc &desc)
+{
+    if (name.Empty())
+    {
+        LogError("Scene::RegisterPrefab: cannot register a prefab with an empty name.");
+        return false;
+    }
+
+    return RegisterPrefab(name, CreatePrototypes(desc), desc.local, desc.temporary);
+}
+
+bool Scene::RegisterPrefab(const String &name, const Entity::ComponentVector &prototypes, bool local, bool temporary)
+{
+    if (name.Empty())
+    {
+        LogError("Scene::RegisterPrefab: cannot register a prefab with an empty name.");
+        return false;
+    }
+
+    Prefab &prefab = prefabs_[name];
+    prefab.components = prototypes;
+    prefab.local = local;
+    prefab.temporary = temporary;
+    prefab.revision = ++lastPrefabRevision_;
+    return true;
+}
+
+void Scene::UnregisterPrefab(const String &name)
+{
+    prefabs_.Erase(name);
+}
+
+StringVector Scene::PrefabNames() const
+{
+    return prefabs_.Keys();
+}
+
+uint Scene::PrefabRevision(const String &name) const
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(name);
+    return (iter != prefabs_.End() ? iter->second_.revision : 0);
+}
+
+bool Scene::IsPrefabLocal(const String &name) const
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(name);
+    return (iter != prefabs_.End() && iter->second_.local);
+}
+
+Entity::ComponentVector Scene::PrefabComponents(const String &name) const
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(name);
+    return (iter != prefabs_.End() ? iter->second_.components : Entity::ComponentVector());
+}
+
+IComponent *Scene::PrefabComponent(const String &prefabName, u32 typeId, const String &componentName) const
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(prefabName);
+    if (iter == prefabs_.End())
+        return 0;
+    foreach(const ComponentPtr &prototype, iter->second_.components)
+        if (prototype->TypeId() == typeId && prototype->Name() == componentName)
+            return prototype.Get();
+    return 0;
+}
+
+EntityVector Scene::CreateEntitiesFromPrefab(const String &name, uint count, AttributeChange::Type change)
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(name);
+    if (iter == prefabs_.End())
+    {
+        LogError("Scene::CreateEntitiesFromPrefab: no prefab named \"" + name + "\" registered.");
+        return EntityVector();
+    }
+    const Prefab &prefab = iter->second_;
+    return CreateEntitiesFromPrototypes(prefab.components, !prefab.local, prefab.temporary, count, nullptr, change, name);
+}
+
+EntityVector Scene::CreateEntitiesFromPrefab(const String &name, const Vector<ComponentDescList> &initialValues, AttributeChange::Type change)
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(name);
+    if (iter == prefabs_.End())
+    {
+        LogError("Scene::CreateEntitiesFromPrefab: no prefab named \"" + name + "\" registered.");
+        return EntityVector();
+    }
+    const Prefab &prefab = iter->second_;
+    return CreateEntitiesFromPrototypes(prefab.components, !prefab.local, prefab.temporary, initialValues.Size(), &initialValues, change, name);
+}
+
+void Scene::AddPrefabComponents(Entity *entity, const String &prefabName, AttributeChange::Type change)
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(prefabName);
+    if (iter == prefabs_.End())
+    {
+        LogWarning("Scene::AddPrefabComponents: entity " + entity->ToString() + " refers to unknown prefab \"" + prefabName + "\".");
+        return;
+    }
+
+    SceneAPI* sceneAPI = framework_->Scene();
+    foreach(const ComponentPtr &prototype, iter->second_.components)
+    {
+        ComponentPtr comp = sceneAPI->CreateComponentById(this, prototype->TypeId(), prototype->Name());
+        if (!comp)
+            continue;
+        comp->SetReplicated(prototype->IsReplicated());
+        InstantiatePrototype(prototype, comp.Get());
+        entity->AddComponent(comp, change);
+    }
+    entity->SetPrefabName(prefabName);
+}
+
+void Scene::SerializePrefabToXml(Urho3D::XMLFile &doc, Urho3D::XMLElement &sceneElem, const String &name) const
+{
+    PrefabMap::ConstIterator iter = prefabs_.Find(name);
+    if (iter == prefabs_.End())
+        return;
+
+    const Prefab &prefab = iter->second_;
+    Urho3D::XMLElement prefabElem = sceneElem.CreateChild("prefab");
+    prefabElem.SetAttribute("name", name);
+    if (prefab.local)
+        prefabElem.SetBool("local", true);
+    if (prefab.temporary)
+        prefabElem.SetBool("temporary", true);
+    foreach(const ComponentPtr &prototype, prefab.components)
+        prototype->SerializeTo(doc, prefabElem);
+}
+
+Urho3D::XMLElement Scene::FindPrefabElement(const Urho3D::XMLElement &elem, const String &name)
+{
+    Urho3D::XMLElement scene_elem = elem;
+    while(scene_elem && scene_elem.GetName() != "scene")
+        scene_elem = scene_elem.GetParent();
+
+    Urho3D::XMLElement prefab_elem = (scene_elem ? scene_elem.GetChild("prefab") : Urho3D::XMLElement());
+    while(prefab_elem && prefab_elem.GetAttribute("name") != name)
+        prefab_elem = prefab_elem.GetNext("prefab");
+    return prefab_elem;
+}
+
+void Scene::RegisterPrefabFromXml(const Urho3D::XMLElement &prefabElem)
+{
+    const String name = prefabElem.GetAttribute("name");
+    if (name.Empty())
+    {
+        LogWarning("Scene::CreateContentFromXml: ignoring prefab without a name.");
+        return;
+    }
+
+    Prefab prefab;
+    prefab.local = prefabElem.GetBool("local");
+    prefab.temporary = prefabElem.GetBool("temporary");
+
+    SceneAPI* sceneAPI = framework_->Scene();
+    Urho3D::XMLElement compElem = prefabElem.GetChild("component");
+    while(compElem)
+    {
+        const String typeName = compElem.GetAttribute("type");
+        const u32 typeId = compElem.GetUInt("typeId");
+        const String compName = compElem.GetAttribute("name");
+        const bool compReplicated = compElem.HasAttribute("sync") ? compElem.GetBool("sync") : true;
+
+        if (!sceneAPI->IsComponentTypeRegistered(typeName))
+            sceneAPI->RegisterPlaceholderComponentType(compElem);
+
+        ComponentPtr prototype = (!typeName.Empty() ? sceneAPI->CreateComponentByName(this, typeName, compName) :
+            sceneAPI->CreateComponentById(this, typeId, compName));
+        if (prototype)
+        {
+            prototype->SetReplicated(!prefab.local && compReplicated);
+            prototype->DeserializeFrom(compElem, AttributeChange::Disconnected);
+            prefab.components.Push(prototype);
+        }
+        else
+            LogError("Scene::CreateContentFromXml: failed to create component " + typeName + " " + compName + " for prefab " + name);
+
+        compElem = compElem.GetNext("component");
+    }
+
+    RegisterPrefab(name, prefab.components, prefab.local, prefab.temporary);
+}
+
+void Scene::CopyAttributeValues(IComponent *source, IComponent *dest, bool dynamicOnly)
+{
+    const AttributeVector &sourceAttributes = source->Attributes();
+    for(uint i = 0; i < sourceAttributes.Size(); ++i)
+    {
+        IAttribute *sourceAttr = sourceAttributes[i];
+        if (!sourceAttr || (dynamicOnly && !sourceAttr->IsDynamic()))
+            continue;
+        IAttribute *destAttr = (i < dest->Attributes().Size() ? dest->Attributes()[i] : nullptr);
+        if (!destAttr && sourceAttr->IsDynamic())
+            destAttr = dest->CreateAttribute((u8)i, sourceAttr->TypeId(), sourceAttr->Id(), AttributeChange::Disconnected);
+        if (destAttr && destAttr->TypeId() == sourceAttr->TypeId())
+            destAttr->CopyValue(sourceAttr, AttributeChange::Disconnected);
+    }
+}
+
+void Scene::InstantiatePrototype(const ComponentPtr &prototype, IComponent *dest)
+{
+    dest->SharePrototypeValues(prototype);
+    CopyAttributeValues(prototype.Get(), dest, true);
+}
+
 EntityPtr Scene::EntityById(entity_id_t id) const
 {
     EntityMap::ConstIterator it = entities_.Find(id);
@@ -475,10 +813,19 @@ String Scene::SerializeToXmlString(bool serializeTemporary, bool serializeLocal)
 
     const bool serializeChildren = true;
 
+    // Write each prefab once, instances refer to it by name.
+    for(PrefabMap::ConstIterator iter = prefabs_.Begin(); iter != prefabs_.End(); ++iter)
+    {
+        const Prefab &prefab = iter->second_;
+        if ((prefab.local && !serializeLocal) || (prefab.temporary && !serializeTemporary))
+            continue;
+        SerializePrefabToXml(sceneDoc, sceneElem, iter->first_);
+    }
+
     EntityVector list = RootLevelEntities();
     foreach(EntityPtr ent, list)
         if (ent->ShouldBeSerialized(serializeTemporary, serializeLocal, serializeChildren))
-            ent->SerializeToXML(sceneDoc, sceneElem, serializeTemporary, serializeLocal, serializeChildren);
+            ent->SerializeToXML(sceneDoc, sceneElem, serializeTemporary, serializeLocal, serializeChildren, true);
 
     return sceneDoc.ToString(" ");
 }
@@ -605,6 +952,14 @@ Vector<Entity *> Scene::CreateContentFromXml(Urho3D::XMLFile &xml, bool useEntit
         storage_elem = storage_elem.GetNext("storage");
     }
     
+    // Register prefabs before spawning the entities that refer to them.
+    Urho3D::XMLElement prefab_elem = scene_elem.GetChild("prefab");
+    while(prefab_elem)
+    {
+        RegisterPrefabFromXml(prefab_elem);
+        prefab_elem = prefab_elem.GetNext("prefab");
+    }
+
     EntityIdMap oldToNewIds;
 
     // Spawn all entities in the scene storage.
@@ -698,6 +1053,11 @@ void Scene::CreateEntityFromXml(EntityPtr parent, const Urho3D::XMLElement& ent_
     {
         entity->SetTemporary(entityTemporary);
 
+        // Prefab instances only store the attributes that differ from the prefab, so start from the prefab components.
+        const String prefabName = ent_elem.GetAttribute("prefab");
+        if (!prefabName.Empty())
+            AddPrefabComponents(entity.Get(), prefabName, AttributeChange::Default);
+
         Urho3D::XMLElement comp_elem = ent_elem.GetChild("component");
         while (comp_elem)
         {
@@ -1003,41 +1363,7 @@ void Scene::CreateEntityFromDesc(EntityPtr parent, const EntityDesc& e, bool use
                 LogError("Scene::CreateEntityFromDesc: failed to create component " + c.typeName + " " + c.name);
                 continue;
             }
-            if (comp->TypeId() == 25 /*DynamicComponent*/)
-            {
-                Urho3D::XMLFile temp_doc(context_);
-                Urho3D::XMLElement root_elem = temp_doc.CreateRoot("component");
-                root_elem.SetUInt("typeId", c.typeId); // Ambiguous on VC9 as u32
-                root_elem.SetAttribute("type", c.typeName);
-                root_elem.SetAttribute("name", c.name);
-                root_elem.SetBool("sync", c.sync);
-                foreach(const AttributeDesc &a, c.attributes)
-                {
-                    Urho3D::XMLElement child_elem = root_elem.CreateChild("attribute");
-                    child_elem.SetAttribute("id", a.id);
-                    child_elem.SetAttribute("value", a.value);
-                    child_elem.SetAttribute("type", a.typeName);
-                    child_elem.SetAttribute("name", a.name);
-                }
-                comp->DeserializeFrom(root_elem, AttributeChange::Default);
-            }
-            else
-            {
-                foreach(IAttribute *attr, comp->Attributes())
-                {
-                    if (!attr)
-                        continue;
-                    foreach(const AttributeDesc &a, c.attributes)
-                    {
-                        if (attr->TypeName().Compare(a.typeName, false) == 0 &&
-                            (attr->Id().Compare(a.id, false) == 0 ||
-                             attr->Name().Compare(a.name, false) == 0))
-                        {
-                           attr->FromString(a.value, AttributeChange::Disconnected); // Trigger no signal yet when scene is in incoherent state
-                        }
-                    }
-                }
-            }
+            ApplyComponentDesc(comp.Get(), c);
         }
 
         entity->SetTemporary(e.temporary);
@@ -1049,6 +1375,48 @@ void Scene::CreateEntityFromDesc(EntityPtr parent, const EntityDesc& e, bool use
     }
 }
 
+void Scene::ApplyComponentDesc(IComponent *comp, const ComponentDesc &c) const
+{
+    if (comp->TypeId() == 25 /*DynamicComponent*/)
+    {
+        Urho3D::XMLFile temp_doc(context_);
+        Urho3D::XMLElement root_elem = temp_doc.CreateRoot("component");
+        root_elem.SetUInt("typeId", c.typeId); // Ambiguous on VC9 as u32
+        root_elem.SetAttribute("type", c.typeName);
+        root_elem.SetAttribute("name", c.name);
+        root_elem.SetBool("sync", c.sync);
+        foreach(const AttributeDesc &a, c.attributes)
+        {
+            Urho3D::XMLElement child_elem = root_elem.CreateChild("attribute");
+            child_elem.SetAttribute("id", a.id);
+            child_elem.SetAttribute("value", a.value);
+            child_elem.SetAttribute("type", a.typeName);
+            child_elem.SetAttribute("name", a.name);
+        }
+        comp->DeserializeFrom(root_elem, AttributeChange::Default);
+    }
+    else
+        ApplyAttributeDescs(comp, c.attributes);
+}
+
+void Scene::ApplyAttributeDescs(IComponent *comp, const AttributeDescList &attributes)
+{
+    foreach(IAttribute *attr, comp->Attributes())
+    {
+        if (!attr)
+            continue;
+        foreach(const AttributeDesc &a, attributes)
+        {
+            if (attr->TypeName().Compare(a.typeName, false) == 0 &&
+                (attr->Id().Compare(a.id, false) == 0 ||
+                 attr->Name().Compare(a.name, false) == 0))
+            {
+               attr->FromString(a.value, AttributeChange::Disconnected); // Trigger no signal yet when scene is in incoherent state
+            }
+        }
+    }
+}
+
 SceneDesc Scene::CreateSceneDescFromXml(const String &filename) const
 {
     SceneDesc sceneDesc(filename);
@@ -1121,6 +1489,13 @@ void Scene::CreateEntityDescFromXml(SceneDesc& sceneDesc, Vector<EntityDesc>& de
         entityDesc.local = !ent_elem.GetBool("sync"); /**< @todo if no "sync"* attr, deduct from the ID. */
     entityDesc.temporary = ent_elem.GetBool("temporary");
 
+    // Prefab instances only store the attributes that differ from the prefab, so each component starts from the prefab
+    // values: from the <prefab> definition in the same document, or from the prefab registered to this scene.
+    const String prefabName = ent_elem.GetAttribute("prefab");
+    const Urho3D::XMLElement prefab_elem = (!prefabName.Empty() ? FindPrefabElement(ent_elem, prefabName) : Urho3D::XMLElement());
+    if (!prefabName.Empty() && !prefab_elem && !HasPrefab(prefabName))
+        LogWarning("Scene::CreateEntityDescFromXml: entity " + id_str + " refers to unknown prefab \"" + prefabName + "\".");
+
     Urho3D::XMLElement comp_elem = ent_elem.GetChild("component");
     while(comp_elem)
     {
@@ -1136,18 +1511,6 @@ void Scene::CreateEntityDescFromXml(SceneDesc& sceneDesc, Vector<EntityDesc>& de
         compDesc.sync = comp_elem.GetBool("sync");
         const bool hasTypeId = compDesc.typeId != 0xffffffff;
 
-        // A bit of a hack to get the name from Name.
-        if (entityDesc.name.Empty() && (compDesc.typeId == Name::ComponentTypeId ||
-            IComponent::EnsureTypeNameWithoutPrefix(compDesc.typeName) == Name::TypeNameStatic()))
-        {
-            ComponentPtr comp = (hasTypeId ? framework_->Scene()->CreateComponentById(0, compDesc.typeId, compDesc.name) :
-                framework_->Scene()->CreateComponentByName(0, compDesc.typeName, compDesc.name));
-            Tundra::Name *ecName = static_cast<Tundra::Name*>(comp.Get());
-            ecName->DeserializeFrom(comp_elem, AttributeChange::Disconnected);
-            entityDesc.name = ecName->name.Get();
-            entityDesc.group = ecName->group.Get();
-        }
-
         ComponentPtr comp = (hasTypeId ? framework_->Scene()->CreateComponentById(0, compDesc.typeId, compDesc.name) :
             framework_->Scene()->CreateComponentByName(0, compDesc.typeName, compDesc.name));
         if (!comp) // Move to next element if component creation fails.
@@ -1156,8 +1519,32 @@ void Scene::CreateEntityDescFromXml(SceneDesc& sceneDesc, Vector<EntityDesc>& de
             continue;
         }
 
+        if (prefab_elem)
+        {
+            Urho3D::XMLElement prefabComp_elem = prefab_elem.GetChild("component");
+            while(prefabComp_elem && !(prefabComp_elem.GetAttribute("type") == comp_elem.GetAttribute("type") &&
+                prefabComp_elem.GetUInt("typeId") == comp_elem.GetUInt("typeId") && prefabComp_elem.GetAttribute("name") == compDesc.name))
+                prefabComp_elem = prefabComp_elem.GetNext("component");
+            if (prefabComp_elem)
+                comp->DeserializeFrom(prefabComp_elem, AttributeChange::Disconnected);
+        }
+        else if (!prefabName.Empty())
+        {
+            IComponent *prototype = PrefabComponent(prefabName, comp->TypeId(), compDesc.name);
+            if (prototype)
+                CopyAttributeValues(prototype, comp.Get());
+        }
+
         // Find asset references.
         comp->DeserializeFrom(comp_elem, AttributeChange::Disconnected);
+
+        // A bit of a hack to get the name from Name.
+        if (entityDesc.name.Empty() && comp->TypeId() == Name::ComponentTypeId)
+        {
+            Tundra::Name *ecName = static_cast<Tundra::Name*>(comp.Get());
+            entityDesc.name = ecName->name.Get();
+            entityDesc.group = ecName->group.Get();
+        }
         foreach(IAttribute *a,comp->Attributes())
         {
             if (!a)
@@ -1410,6 +1797,13 @@ bool Scene::StartAttributeInterpolation(IAttribute* attr, IAttribute* endvalue,
 
 bool Scene::EndAttributeInterpolation(IAttribute* attr)
 {
+    AttributeSnapshotMap::Iterator snapshot = snapshots_.Find(attr);
+    if (snapshot != snapshots_.End())
+    {
+        ClearAttributeSnapshots(snapshot->second_);
+        snapshots_.Erase(snapshot);
+    }
+
     for(uint i = 0; i < interpolations_.Size(); ++i)
     {
         AttributeInterpolation& interp = interpolations_[i];
@@ -1434,6 +1828,10 @@ void Scene::EndAllAttributeInterpolations()
     }
     
     interpolations_.Clear();
+
+    for(AttributeSnapshotMap::Iterator i = snapshots_.Begin(); i != snapshots_.End(); ++i)
+        ClearAttributeSnapshots(i->second_);
+    snapshots_.Clear();
 }
 
 void Scene::UpdateAttributeInterpolations(float frametime)
@@ -1479,9 +1877,228 @@ void Scene::UpdateAttributeInterpolations(float frametime)
         }
     }
 
+    UpdateAttributeSnapshots(frametime);
+
     interpolating_ = false;
 }
 
+bool Scene::PushAttributeSnapshot(IAttribute* attr, IAttribute* value, double serverTime)
+{
+    if (!value)
+        return false;
+
+    IComponent* comp = attr ? attr->Owner() : 0;
+    Entity* entity = comp ? comp->ParentEntity() : 0;
+    Scene* scene = entity ? entity->ParentScene() : 0;
+
+    if (!attr || !attr->Metadata() || attr->Metadata()->interpolation == AttributeMetadata::None ||
+        !comp || !entity || !scene || scene != this)
+    {
+        delete value;
+        return false;
+    }
+
+    // Snapshot buffering takes over from a possible ongoing interpolation
+    for(uint i = 0; i < interpolations_.Size(); ++i)
+    {
+        AttributeInterpolation& interp = interpolations_[i];
+        if (interp.dest.Get() == attr)
+        {
+            delete interp.start.Get();
+            delete interp.end.Get();
+            interpolations_.Erase(interpolations_.Begin() + i);
+            break;
+        }
+    }
+
+    AttributeSnapshotBuffer &buffer = snapshots_[attr];
+    if (buffer.dest.owner.Expired())
+    {
+        // New buffer, or a stale one left by a deleted component that had an attribute at the same address
+        ClearAttributeSnapshots(buffer);
+        buffer.dest = AttributeWeakPtr(comp, attr);
+    }
+
+    if (!buffer.snapshots.Empty() && serverTime < buffer.snapshots.Back().time)
+    {
+        LogWarning("Scene::PushAttributeSnapshot: Out of order snapshot for attribute " + attr->Name() + ", ignoring.");
+        delete value;
+        return false;
+    }
+    if (!buffer.snapshots.Empty() && serverTime == buffer.snapshots.Back().time)
+    {
+        // Several values within the same server update, the last one wins
+        delete buffer.snapshots.Back().value;
+        buffer.snapshots.Back().value = value;
+        return true;
+    }
+
+    // Start the buffer from the current value, so that the attribute moves smoothly towards the first received value
+    if (buffer.snapshots.Empty() && snapshotClockStarted_ && snapshotRenderTime_ < serverTime)
+    {
+        AttributeSnapshot start;
+        start.time = snapshotRenderTime_;
+        start.value = attr->Clone();
+        buffer.snapshots.Push(start);
+    }
+
+    AttributeSnapshot snapshot;
+    snapshot.time = serverTime;
+    snapshot.value = value;
+    buffer.snapshots.Push(snapshot);
+    buffer.underrun = false;
+    return true;
+}
+
+void Scene::UpdateSnapshotClock(double serverTime)
+{
+    const double offset = serverTime - snapshotLocalTime_;
+    if (!snapshotClockStarted_)
+    {
+        // First update, start the clock
+        snapshotClockStarted_ = true;
+        snapshotServerOffset_ = offset;
+        snapshotLastServerTime_ = serverTime;
+        snapshotRenderTime_ = serverTime - snapshotDelay_;
+        return;
+    }
+
+    // A late update shows up as a smaller offset than estimated. Track the deviations to size the render delay.
+    const float deviation = (float)(offset - snapshotServerOffset_);
+    if (Abs(deviation) > maxSnapshotDelay_ * 2.f)
+    {
+        // Clock discontinuity, eg. a different server after reconnect. Restart the clock, the buffered snapshots
+        // are on the old timeline.
+        interpolating_ = true;
+        for(AttributeSnapshotMap::Iterator i = snapshots_.Begin(); i != snapshots_.End(); ++i)
+        {
+            AttributeSnapshotBuffer &buffer = i->second_;
+            if (!buffer.dest.owner.Expired() && !buffer.snapshots.Empty())
+                buffer.dest.Get()->CopyValue(buffer.snapshots.Back().value, AttributeChange::LocalOnly);
+            ClearAttributeSnapshots(buffer);
+        }
+        snapshots_.Clear();
+        interpolating_ = false;
+        snapshotServerOffset_ = offset;
+        snapshotLastServerTime_ = serverTime;
+        snapshotRenderTime_ = serverTime - snapshotDelay_;
+        snapshotJitter_ = 0.f;
+        return;
+    }
+
+    snapshotServerOffset_ += deviation * 0.05f;
+    snapshotJitter_ += (Abs(deviation) - snapshotJitter_) * 0.1f;
+    if (serverTime > snapshotLastServerTime_)
+    {
+        snapshotInterval_ += ((float)(serverTime - snapshotLastServerTime_) - snapshotInterval_) * 0.1f;
+        snapshotLastServerTime_ = serverTime;
+    }
+
+    snapshotDelay_ = Clamp(snapshotInterval_ + 2.f * snapshotJitter_, minSnapshotDelay_, maxSnapshotDelay_);
+}
+
+void Scene::SetSnapshotDelayLimits(float minDelay, float maxDelay)
+{
+    minSnapshotDelay_ = Max(minDelay, 0.f);
+    maxSnapshotDelay_ = Max(maxDelay, minSnapshotDelay_);
+    snapshotDelay_ = Clamp(snapshotDelay_, minSnapshotDelay_, maxSnapshotDelay_);
+}
+
+void Scene::ClearAttributeSnapshots(AttributeSnapshotBuffer &buffer)
+{
+    for(uint i = 0; i < buffer.snapshots.Size(); ++i)
+        delete buffer.snapshots[i].value;
+    buffer.snapshots.Clear();
+    buffer.underrun = false;
+}
+
+void Scene::UpdateAttributeSnapshots(float frametime)
+{
+    snapshotLocalTime_ += frametime;
+    if (!snapshotClockStarted_)
+        return; // No server updates received yet
+
+    // Advance the render time with the local clock, and let it converge smoothly to the estimated server time minus the delay.
+    // Never go backwards, as already passed snapshots may have been discarded.
+    const double target = snapshotLocalTime_ + snapshotServerOffset_ - snapshotDelay_;
+    double renderTime = snapshotRenderTime_ + frametime;
+    const double error = target - renderTime;
+    if (Abs((float)error) > maxSnapshotDelay_)
+        renderTime = target;
+    else
+        renderTime += error * 0.1;
+    if (renderTime > snapshotRenderTime_)
+        snapshotRenderTime_ = renderTime;
+
+    if (snapshots_.Empty())
+        return;
+
+    URHO3D_PROFILE(Scene_UpdateSnapshots);
+
+    for(AttributeSnapshotMap::Iterator it = snapshots_.Begin(); it != snapshots_.End();)
+    {
+        AttributeSnapshotBuffer &buffer = it->second_;
+        Vector<AttributeSnapshot> &snapshots = buffer.snapshots;
+        if (buffer.dest.owner.Expired() || snapshots.Empty())
+        {
+            ClearAttributeSnapshots(buffer);
+            it = snapshots_.Erase(it);
+            continue;
+        }
+
+        // Discard snapshots that have been passed, but keep the last two for extrapolation
+        while(snapshots.Size() > 2 && snapshots[1].time <= snapshotRenderTime_)
+        {
+            delete snapshots[0].value;
+            snapshots.Erase(0);
+        }
+
+        IAttribute *dest = buffer.dest.Get();
+        const AttributeSnapshot &newest = snapshots.Back();
+        if (snapshotRenderTime_ < snapshots[0].time)
+        {
+            // Render time has not reached the buffer yet
+        }
+        else if (snapshotRenderTime_ < newest.time)
+        {
+            // Interpolate between the two snapshots around the render time
+            uint i = 0;
+            while(snapshots[i + 1].time <= snapshotRenderTime_)
+                ++i;
+            const AttributeSnapshot &a = snapshots[i];
+            const AttributeSnapshot &b = snapshots[i + 1];
+            const float t = (float)((snapshotRenderTime_ - a.time) / (b.time - a.time));
+            dest->Interpolate(a.value, b.value, t, AttributeChange::LocalOnly);
+        }
+        else if (snapshotLastServerTime_ > newest.time || snapshots.Size() < 2)
+        {
+            // The server has sent newer updates without changes to this attribute, so the newest value is final
+            dest->CopyValue(newest.value, AttributeChange::LocalOnly);
+            ClearAttributeSnapshots(buffer);
+            it = snapshots_.Erase(it);
+            continue;
+        }
+        else
+        {
+            // Buffer underrun: the updates are late. Extrapolate from the last two snapshots for a limited time.
+            if (!buffer.underrun)
+            {
+                buffer.underrun = true;
+                ++snapshotUnderruns_;
+                LogDebug("Scene::UpdateAttributeSnapshots: Snapshot buffer underrun for attribute " + dest->Name() + ", extrapolating.");
+            }
+            const AttributeSnapshot &a = snapshots[snapshots.Size() - 2];
+            const double span = newest.time - a.time;
+            const double ahead = Min(snapshotRenderTime_ - newest.time, (double)maxSnapshotExtrapolation_);
+            if (span > 0.0)
+                dest->Interpolate(a.value, newest.value, (float)(1.0 + ahead / span), AttributeChange::LocalOnly);
+            else
+                dest->CopyValue(newest.value, AttributeChange::LocalOnly);
+        }
+        ++it;
+    }
+}
+
 void Scene::OnUpdated(float /*frameTime*/)
 {
     // Signal queued entity creations now
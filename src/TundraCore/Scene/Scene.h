@@ -103,6 +103,37 @@ public:
     /** @param frametime Time step */
     void UpdateAttributeInterpolations(float frametime);
 
+    /// Adds a server-timestamped value to the snapshot interpolation buffer of an attribute.
+    /** Snapshot interpolation is an alternative to StartAttributeInterpolation for network sync managers that know the server time
+        of each update. The attribute is rendered SnapshotDelay() seconds behind the newest server time, interpolating between the two
+        buffered values around the render time. When the buffer runs dry the value is extrapolated for at most MaxSnapshotExtrapolation()
+        seconds and a buffer underrun is recorded. A possible ongoing StartAttributeInterpolation interpolation of the attribute is ended.
+        @param attr Attribute inside a static-structured component.
+        @param value Same kind of attribute holding the value. You must dynamically allocate this yourself, but Scene
+               will always take care of deleting it.
+        @param serverTime Server time of the value in seconds. Must be non-decreasing for an attribute.
+        @return true if successful (same requirements as for StartAttributeInterpolation) */
+    bool PushAttributeSnapshot(IAttribute* attr, IAttribute* value, double serverTime);
+
+    /// Informs the snapshot interpolation clock that an update stamped with @c serverTime (seconds) was received just now.
+    /** Used to estimate the server clock and the jitter of the update arrival times, which in turn define the adaptive render delay. */
+    void UpdateSnapshotClock(double serverTime);
+
+    /// Sets the limits (seconds) of the adaptive snapshot render delay, defaults are 0.05 and 0.5.
+    void SetSnapshotDelayLimits(float minDelay, float maxDelay);
+
+    /// Sets how long (seconds) a value is extrapolated past the newest snapshot, default 0.25.
+    void SetMaxSnapshotExtrapolation(float seconds) { maxSnapshotExtrapolation_ = seconds > 0.f ? seconds : 0.f; }
+
+    /// Returns the current snapshot render delay in seconds.
+    float SnapshotDelay() const { return snapshotDelay_; }
+
+    /// Returns the maximum snapshot extrapolation time in seconds.
+    float MaxSnapshotExtrapolation() const { return maxSnapshotExtrapolation_; }
+
+    /// Returns the number of snapshot buffer underruns, ie. the times an attribute ran out of buffered values and had to be extrapolated.
+    uint SnapshotUnderruns() const { return snapshotUnderruns_; }
+
     /// See if scene is currently performing interpolations, to differentiate between interpolative & non-interpolative attribute changes.
     bool IsInterpolating() const { return interpolating_; }
 
@@ -251,6 +282,81 @@ public:
     EntityPtr CreateLocalTemporaryEntity(const StringVector &components = StringVector(),
         AttributeChange::Type change = AttributeChange::Default);
 
+    /// Creates @c count entities from the template entity description @c desc in a single batch.
+    /** Intended for spawning large numbers of identical entities, f.ex. projectiles or crowds. The template
+        is parsed only once, entity IDs are allocated as a block, and all entities and components are constructed
+        before any signals are emitted. Creation is then signaled for the whole batch at once in the same order as
+        the per-entity path would: ComponentAdded for each component, EntityCreated and AttributeChanged for each entity.
+
+        The entities are replicated unless @c desc is local. IDs in @c desc are ignored and child entities
+        in @c desc are not created.
+        @param desc Template entity description.
+        @param count Number of entities to create.
+        @param change Notification/network replication mode used for the batched signals.
+        @return List of created entities.
+        @sa CreateEntity, CreateContentFromSceneDesc */
+    EntityVector CreateEntities(const EntityDesc &desc, uint count, AttributeChange::Type change = AttributeChange::Default);
+    /// @overload
+    /** @param initialValues Per-entity attribute values that override the template values, one entity is created
+        for each item. The components are matched by type name and name, the attributes by ID or name. */
+    EntityVector CreateEntities(const EntityDesc &desc, const Vector<ComponentDescList> &initialValues, AttributeChange::Type change = AttributeChange::Default);
+
+    /// Registers a prefab, i.e. a named template entity that entities can be instantiated from.
+    /** The template is parsed once into shared prototype components. The components of the entities created with
+        CreateEntitiesFromPrefab share the prototype attribute values copy-on-write, so that an instance stores only
+        the values set to it afterwards, see IComponent::SharePrototypeValues. Instances remember their prefab and are
+        serialized to scene XML as a reference to it plus only the attribute values that differ from the template.
+        The prefab itself is written once per scene file, and sent once to each client that syncs its instances.
+        Registering an existing name replaces the prefab; already existing instances keep sharing the old values.
+        @param name Unique name of the prefab.
+        @param desc Template entity description. IDs and child entities in @c desc are ignored.
+        @return True if successful, false if @c name is empty.
+        @sa UnregisterPrefab, CreateEntitiesFromPrefab */
+    bool RegisterPrefab(const String &name, const EntityDesc &desc);
+    /// @overload
+    /** @param prototypes Unparented prototype components, which must not be modified afterwards.
+        @param local Are the instances local.
+        @param temporary Are the instances temporary. */
+    bool RegisterPrefab(const String &name, const Entity::ComponentVector &prototypes, bool local, bool temporary);
+
+    /// Removes a prefab. Existing instances become ordinary entities when serialized.
+    void UnregisterPrefab(const String &name);
+
+    /// Returns whether a prefab with the given name is registered.
+    bool HasPrefab(const String &name) const { return prefabs_.Contains(name); }
+
+    /// Returns names of all registered prefabs.
+    StringVector PrefabNames() const;
+
+    /// Returns a number that changes whenever the prefab is (re)registered, or 0 if no such prefab exists.
+    /** Used to detect whether a prefab sent earlier, f.ex. to a client, is still the current one. */
+    uint PrefabRevision(const String &name) const;
+
+    /// Returns whether the instances of a prefab are local, false also if no such prefab exists.
+    bool IsPrefabLocal(const String &name) const;
+
+    /// Returns the prototype components of a prefab, or an empty list if no such prefab exists.
+    /** The prototypes are not part of any entity and must not be modified. */
+    Entity::ComponentVector PrefabComponents(const String &name) const;
+
+    /// Returns the prototype component of a prefab with the given type ID and name, or null if not found.
+    IComponent *PrefabComponent(const String &prefabName, u32 typeId, const String &componentName = "") const;
+
+    /// Writes the definition of a prefab as a <prefab> child of @c sceneElem. No-op if no such prefab exists.
+    /** Scene XML that contains prefab instances must contain the definitions of their prefabs.
+        @sa Entity::SerializeToXML */
+    void SerializePrefabToXml(Urho3D::XMLFile &doc, Urho3D::XMLElement &sceneElem, const String &name) const;
+
+    /// Creates @c count instances of a registered prefab in a single batch.
+    /** Behaves like CreateEntities, except that the template is not re-parsed and the created entities
+        remember the prefab they were created from.
+        @sa RegisterPrefab, Entity::PrefabName */
+    EntityVector CreateEntitiesFromPrefab(const String &name, uint count, AttributeChange::Type change = AttributeChange::Default);
+    /// @overload
+    /** @param initialValues Per-entity attribute values that override the prefab values, one entity is created
+        for each item. */
+    EntityVector CreateEntitiesFromPrefab(const String &name, const Vector<ComponentDescList> &initialValues, AttributeChange::Type change = AttributeChange::Default);
+
     /// Returns scene up vector. For now it is a compile-time constant
     /** @sa RightVector,.ForwardVector */
     float3 UpVector() const;
@@ -517,6 +623,40 @@ private:
         AttributeChange::Type change, Vector<Entity *>& entities, EntityIdMap& oldToNewIds);
     /// Create entity desc from an XML element and recurse into child entities. Called internally.
     void CreateEntityDescFromXml(SceneDesc& sceneDesc, Vector<EntityDesc>& dest, const Urho3D::XMLElement& ent_elem) const;
+    /// Creates entities from a template entity desc and signals them as one batch. Called internally.
+    EntityVector CreateEntitiesFromDesc(const EntityDesc &desc, uint count, const Vector<ComponentDescList> *initialValues, AttributeChange::Type change);
+    /// Creates entities by copying the prototype components and signals them as one batch. Called internally.
+    EntityVector CreateEntitiesFromPrototypes(const Entity::ComponentVector &prototypes, bool replicated, bool temporary, uint count,
+        const Vector<ComponentDescList> *initialValues, AttributeChange::Type change, const String &prefabName);
+    /// Parses the components of a template entity desc into unparented prototype components. Called internally.
+    Entity::ComponentVector CreatePrototypes(const EntityDesc &desc);
+    /// Returns the <prefab> element named @c name in the scene XML document of @c elem, or a null element if not found. Called internally.
+    static Urho3D::XMLElement FindPrefabElement(const Urho3D::XMLElement &elem, const String &name);
+    /// Registers a prefab from a <prefab> XML element. Called internally.
+    void RegisterPrefabFromXml(const Urho3D::XMLElement &prefabElem);
+    /// Adds copies of the prefab prototype components to @c entity. Called internally.
+    void AddPrefabComponents(Entity *entity, const String &prefabName, AttributeChange::Type change);
+    /// Applies the attribute values of a component desc to @c comp. Called internally.
+    void ApplyComponentDesc(IComponent *comp, const ComponentDesc &desc) const;
+    /// Applies matching attribute values to @c comp without signaling. Called internally.
+    static void ApplyAttributeDescs(IComponent *comp, const AttributeDescList &attributes);
+    /// Copies attribute values, and dynamic attribute structure, from @c source to a freshly created @c dest without signaling. Called internally.
+    /** @param dynamicOnly Copy only the dynamic attributes. */
+    static void CopyAttributeValues(IComponent *source, IComponent *dest, bool dynamicOnly = false);
+    /// Initializes a freshly created @c dest from a prototype component without signaling: the static attributes share
+    /// the prototype values, the dynamic attributes are copied. Called internally.
+    static void InstantiatePrototype(const ComponentPtr &prototype, IComponent *dest);
+
+    /// Registered prefab
+    struct Prefab
+    {
+        Prefab() : local(false), temporary(false), revision(0) {}
+        Entity::ComponentVector components; ///< Unparented prototype components.
+        bool local; ///< Are instances local.
+        bool temporary; ///< Are instances temporary.
+        uint revision; ///< Unique number of this registration, @see PrefabRevision.
+    };
+    typedef HashMap<String, Prefab> PrefabMap; ///< Maps prefabs by name.
 
     /// Container for an ongoing attribute interpolation
     struct AttributeInterpolation
@@ -527,6 +667,29 @@ private:
         float length;
     };
 
+    /// Server-timestamped value of an attribute
+    struct AttributeSnapshot
+    {
+        AttributeSnapshot() : time(0.0), value(0) {}
+        double time;
+        IAttribute *value;
+    };
+
+    /// Buffered snapshots of an attribute, oldest first
+    struct AttributeSnapshotBuffer
+    {
+        AttributeSnapshotBuffer() : underrun(false) {}
+        AttributeWeakPtr dest;
+        Vector<AttributeSnapshot> snapshots;
+        bool underrun; ///< Whether the buffer is currently extrapolating past its newest snapshot.
+    };
+    typedef HashMap<IAttribute*, AttributeSnapshotBuffer> AttributeSnapshotMap;
+
+    /// Deletes the buffered snapshot values of @c buffer.
+    static void ClearAttributeSnapshots(AttributeSnapshotBuffer &buffer);
+    /// Advances the snapshot render clock and applies the buffered snapshots.
+    void UpdateAttributeSnapshots(float frametime);
+
     /// Resolved parent Entity id that is set to Placeable::parentRef.
     /** @return Returns 0 if parent is not set or the parent ref is not a Entity id (but a entity name). */
     entity_id_t PlaceableParentId(const Entity *ent) const;
@@ -540,9 +703,24 @@ private:
     bool interpolating_; ///< Currently doing interpolation-flag.
     bool authority_; ///< Authority -flag
     Vector<AttributeInterpolation> interpolations_; ///< Running attribute interpolations.
+    AttributeSnapshotMap snapshots_; ///< Buffered attribute snapshots.
+    double snapshotLocalTime_; ///< Local time of the snapshot clock, advanced by UpdateAttributeInterpolations.
+    double snapshotRenderTime_; ///< Server time the buffered snapshots are currently rendered at.
+    bool snapshotClockStarted_; ///< Has a server update been received.
+    double snapshotServerOffset_; ///< Estimated server time minus local time.
+    double snapshotLastServerTime_; ///< Newest server time passed to UpdateSnapshotClock.
+    float snapshotInterval_; ///< Smoothed interval between received server updates.
+    float snapshotJitter_; ///< Smoothed deviation of update arrival times from the estimated server clock.
+    float snapshotDelay_; ///< Current render delay.
+    float minSnapshotDelay_; ///< Lower limit of the render delay.
+    float maxSnapshotDelay_; ///< Upper limit of the render delay.
+    float maxSnapshotExtrapolation_; ///< Max. extrapolation time past the newest snapshot.
+    uint snapshotUnderruns_; ///< Number of buffer underruns.
     Vector<Pair<EntityWeakPtr, AttributeChange::Type> > entitiesCreatedThisFrame_; ///< Entities to signal for creation at frame end.
     ParentingTracker parentTracker_; ///< Tracker for client side mass Entity imports (eg. SceneDesc based).
     SubsystemMap subsystems; ///< Scene subsystems
+    PrefabMap prefabs_; ///< Registered prefabs.
+    uint lastPrefabRevision_; ///< Revision of the latest registered prefab.
 };
 
 }
@@ -0,0 +1,907 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "TestRunner.h"
+#include "TestBenchmark.h"
+
+#include "AssetAPI.h"
+#include "AssetRefListener.h"
+#include "BinaryAsset.h"
+#include "AssetLoadTimeline.h"
+#include "AssetPrefetchManifest.h"
+#include "DefaultAssetTransferPrioritizer.h"
+#include "GenericAssetFactory.h"
+#include "IAsset.h"
+#include "IAssetStorage.h"
+#include "IAssetTransfer.h"
+#include "IAssetUploadTransfer.h"
+#include "JSON/JSON.h"
+#include "LocalAssetProvider.h"
+#include "LocalAssetStorage.h"
+#include "HttpDefines.h"
+#include "HttpAsset/HttpAssetCacheIndex.h"
+#include "HttpAsset/HttpAssetStorage.h"
+#include "ZipAssetBundle.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+
+using namespace Tundra;
+using namespace Tundra::Test;
+
+/// Counts the Loaded signals of AssetRefListeners.
+struct LoadedCounter
+{
+    LoadedCounter() : count(0) {}
+    void OnLoaded(AssetPtr /*asset*/) { ++count; }
+    int count;
+};
+
+/// Records the indices of the Loaded signals of an AssetRefListListener.
+struct ListLoadedCounter
+{
+    void OnLoaded(uint index, AssetPtr /*asset*/) { indices.Push(index); }
+    Vector<uint> indices;
+};
+
+/// Binary asset that references another asset, for creating asset dependencies.
+class DependentBinaryAsset : public BinaryAsset
+{
+    URHO3D_OBJECT(DependentBinaryAsset, BinaryAsset);
+
+public:
+    DependentBinaryAsset(AssetAPI *owner, const String &type_, const String &name_) :
+        BinaryAsset(owner, type_, name_)
+    {
+    }
+
+    Vector<AssetReference> FindReferences() const override
+    {
+        Vector<AssetReference> refs;
+        refs.Push(AssetReference(dependee));
+        return refs;
+    }
+
+    String dependee;
+};
+
+/// Records the ProgressUpdated and Completed signals of an IAssetUploadTransfer.
+struct UploadProgress
+{
+    UploadProgress() : completed(false) {}
+    void OnProgress(IAssetUploadTransfer* /*transfer*/, uint bytesUploaded, uint /*totalBytes*/) { progress.Push(bytesUploaded); }
+    void OnCompleted(IAssetUploadTransfer* /*transfer*/) { completed = true; }
+    Vector<uint> progress;
+    bool completed;
+};
+
+static bool WriteTestFile(Urho3D::Context *context, const String &path, const Vector<u8> &data)
+{
+    Urho3D::File file(context, path, Urho3D::FILE_WRITE);
+    return file.IsOpen() && file.Write(&data[0], data.Size()) == data.Size();
+}
+
+static void WriteLE(Vector<u8> &dest, uint value, uint numBytes)
+{
+    for(uint i = 0; i < numBytes; ++i)
+        dest.Push((u8)(value >> (i * 8)));
+}
+
+static uint Crc32(const Vector<u8> &data)
+{
+    uint crc = 0xffffffff;
+    foreach(u8 byte, data)
+    {
+        crc ^= byte;
+        for(int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+/// Returns a zip archive that stores the @c contents uncompressed under @c names.
+static Vector<u8> CreateStoredZip(const StringVector &names, const Vector<Vector<u8> > &contents)
+{
+    Vector<u8> zip, centralDirectory;
+    for(uint i = 0; i < names.Size(); ++i)
+    {
+        const uint offset = zip.Size();
+        const uint crc = Crc32(contents[i]);
+        const uint size = contents[i].Size();
+
+        WriteLE(zip, 0x04034b50, 4); // Local file header
+        WriteLE(zip, 10, 2); // Version needed
+        WriteLE(zip, 0, 2); // Flags
+        WriteLE(zip, 0, 2); // Stored
+        WriteLE(zip, 0, 2); // Time
+        WriteLE(zip, 0x21, 2); // Date, 1980-01-01
+        WriteLE(zip, crc, 4);
+        WriteLE(zip, size, 4);
+        WriteLE(zip, size, 4);
+        WriteLE(zip, names[i].Length(), 2);
+        WriteLE(zip, 0, 2); // Extra field length
+        zip.Insert(zip.End(), (const u8*)names[i].CString(), (const u8*)names[i].CString() + names[i].Length());
+        zip.Insert(zip.End(), contents[i].Begin(), contents[i].End());
+
+        WriteLE(centralDirectory, 0x02014b50, 4); // Central directory file header
+        WriteLE(centralDirectory, 20, 2); // Version made by
+        WriteLE(centralDirectory, 10, 2); // Version needed
+        WriteLE(centralDirectory, 0, 2); // Flags
+        WriteLE(centralDirectory, 0, 2); // Stored
+        WriteLE(centralDirectory, 0, 2); // Time
+        WriteLE(centralDirectory, 0x21, 2); // Date
+        WriteLE(centralDirectory, crc, 4);
+        WriteLE(centralDirectory, size, 4);
+        WriteLE(centralDirectory, size, 4);
+        WriteLE(centralDirectory, names[i].Length(), 2);
+        WriteLE(centralDirectory, 0, 2); // Extra field length
+        WriteLE(centralDirectory, 0, 2); // Comment length
+        WriteLE(centralDirectory, 0, 2); // Disk number
+        WriteLE(centralDirectory, 0, 2); // Internal attributes
+        WriteLE(centralDirectory, 0, 4); // External attributes
+        WriteLE(centralDirectory, offset, 4);
+        centralDirectory.Insert(centralDirectory.End(), (const u8*)names[i].CString(), (const u8*)names[i].CString() + names[i].Length());
+    }
+
+    const uint centralDirectoryOffset = zip.Size();
+    zip.Insert(zip.End(), centralDirectory.Begin(), centralDirectory.End());
+    WriteLE(zip, 0x06054b50, 4); // End of central directory
+    WriteLE(zip, 0, 2); // Disk number
+    WriteLE(zip, 0, 2); // Disk of the central directory
+    WriteLE(zip, names.Size(), 2);
+    WriteLE(zip, names.Size(), 2);
+    WriteLE(zip, centralDirectory.Size(), 4);
+    WriteLE(zip, centralDirectoryOffset, 4);
+    WriteLE(zip, 0, 2); // Comment length
+    return zip;
+}
+
+static Vector<u8> ReadTestFile(Urho3D::Context *context, const String &path)
+{
+    Vector<u8> data;
+    Urho3D::File file(context, path, Urho3D::FILE_READ);
+    if (file.IsOpen() && file.GetSize() > 0)
+    {
+        data.Resize(file.GetSize());
+        file.Read(&data[0], data.Size());
+    }
+    return data;
+}
+
+TEST_F(Runner, ParseAssetRef)
+{
+    String protocol, namedStorage, protocolPath, pathFilenameSubAsset, pathFilename, path, filename, subAssetName, fullRef, fullRefNoSubAsset;
+
+    AssetAPI::AssetRefType type = AssetAPI::ParseAssetRef("  LOCAL://path\\folder/asset.zip#subAsset  ", &protocol, &namedStorage, &protocolPath,
+        &pathFilenameSubAsset, &pathFilename, &path, &filename, &subAssetName, &fullRef, &fullRefNoSubAsset);
+    ASSERT_EQ(type, AssetAPI::AssetRefLocalUrl);
+    ASSERT_EQ(protocol, "LOCAL");
+    ASSERT_EQ(namedStorage, "");
+    ASSERT_EQ(protocolPath, "LOCAL://path/folder/");
+    ASSERT_EQ(pathFilenameSubAsset, "path/folder/asset.zip#subAsset");
+    ASSERT_EQ(pathFilename, "path/folder/asset.zip");
+    ASSERT_EQ(path, "path/folder/");
+    ASSERT_EQ(filename, "asset.zip");
+    ASSERT_EQ(subAssetName, "subAsset");
+    ASSERT_EQ(fullRef, "local://path/folder/asset.zip#subAsset");
+    ASSERT_EQ(fullRefNoSubAsset, "LOCAL://path/folder/asset.zip");
+
+    type = AssetAPI::ParseAssetRef("http://server.com/list/objects?id=15", &protocol, 0, &protocolPath, 0, 0, &path, &filename, 0, &fullRef);
+    ASSERT_EQ(type, AssetAPI::AssetRefExternalUrl);
+    ASSERT_EQ(protocol, "http");
+    ASSERT_EQ(protocolPath, "http://server.com/list/");
+    ASSERT_EQ(path, "server.com/list/");
+    ASSERT_EQ(filename, "objects?id=15");
+    ASSERT_EQ(fullRef, "http://server.com/list/objects?id=15");
+
+    type = AssetAPI::ParseAssetRef("www.server.com/asset.png", &protocol, 0, &protocolPath, 0, 0, 0, &filename, 0, &fullRef);
+    ASSERT_EQ(type, AssetAPI::AssetRefExternalUrl);
+    ASSERT_EQ(protocol, "http");
+    ASSERT_EQ(protocolPath, "http://www.server.com/");
+    ASSERT_EQ(filename, "asset.png");
+    ASSERT_EQ(fullRef, "http://www.server.com/asset.png");
+
+    ASSERT_EQ(AssetAPI::ParseAssetRef("/unix/absolute/path/asset.sfx", 0, 0, 0, 0, 0, &path, &filename), AssetAPI::AssetRefLocalPath);
+    ASSERT_EQ(path, "/unix/absolute/path/");
+    ASSERT_EQ(filename, "asset.sfx");
+    ASSERT_EQ(AssetAPI::ParseAssetRef("X:\\windows/mixedupslash\\path/asset.sfx", 0, 0, 0, 0, 0, &path), AssetAPI::AssetRefLocalPath);
+    ASSERT_EQ(path, "X:/windows/mixedupslash/path/");
+
+    type = AssetAPI::ParseAssetRef("myStorage:asset.sfx, \"sub asset\"", 0, &namedStorage, &protocolPath, 0, &pathFilename, &path, &filename,
+        &subAssetName, &fullRef, &fullRefNoSubAsset);
+    ASSERT_EQ(type, AssetAPI::AssetRefNamedStorage);
+    ASSERT_EQ(namedStorage, "myStorage");
+    ASSERT_EQ(protocolPath, "myStorage:");
+    ASSERT_EQ(pathFilename, "asset.sfx");
+    ASSERT_EQ(path, "");
+    ASSERT_EQ(filename, "asset.sfx");
+    ASSERT_EQ(subAssetName, "sub asset");
+    ASSERT_EQ(fullRef, "myStorage:asset.sfx#\"sub asset\"");
+    ASSERT_EQ(fullRefNoSubAsset, "myStorage:/asset.sfx");
+
+    type = AssetAPI::ParseAssetRef("../relative/path/asset.sfx", &protocol, 0, 0, 0, 0, &path, &filename, &subAssetName, &fullRef);
+    ASSERT_EQ(type, AssetAPI::AssetRefRelativePath);
+    ASSERT_EQ(protocol, "");
+    ASSERT_EQ(path, "../relative/path/");
+    ASSERT_EQ(filename, "asset.sfx");
+    ASSERT_EQ(subAssetName, "");
+    ASSERT_EQ(fullRef, "../relative/path/asset.sfx");
+}
+
+TEST_F(Runner, ResolveAssetRef)
+{
+    AssetAPI *asset = framework->Asset();
+
+    // Named storage refs resolve as-is until the storage exists, after which the memoized results must not be used.
+    ASSERT_EQ(asset->ResolveAssetRef("", "TestResolveStorage:texture.png"), "TestResolveStorage:texture.png");
+    AssetStoragePtr storage = asset->DeserializeAssetStorageFromString("src=" + framework->InstallationDirectory() +
+        ";name=TestResolveStorage;recursive=false;liveupdate=false;autodiscoverable=false", false);
+    ASSERT_TRUE(storage != nullptr);
+    ASSERT_EQ(asset->ResolveAssetRef("", "TestResolveStorage:texture.png"), "local://texture.png");
+
+    ASSERT_EQ(asset->ResolveAssetRef("http://server.com/path/my.material", "texture.png"), "http://server.com/path/texture.png");
+    ASSERT_EQ(asset->ResolveAssetRef("local://bundle.zip#folder/my.material", "texture.png"), "local://bundle.zip#folder/texture.png");
+
+    const uint numRefs = 1000;
+    StringVector contexts, refs, expected;
+    for(uint i = 0; i < numRefs; ++i)
+    {
+        String name = "asset" + String(i) + ".png";
+        switch(i % 4)
+        {
+        case 0: contexts.Push(""); refs.Push("local://" + name); break;
+        case 1: contexts.Push(""); refs.Push("TestResolveStorage:" + name); break;
+        case 2: contexts.Push("http://server.com/path/scene.txml"); refs.Push(name); break;
+        default: contexts.Push(""); refs.Push("http://server.com/" + name); break;
+        }
+        expected.Push(asset->ResolveAssetRef(contexts.Back(), refs.Back()));
+    }
+
+    Tundra::Benchmark::Iterations = 1000000;
+
+    BENCHMARK("ResolveAssetRef", 25)
+    {
+        const uint index = (uint)i % numRefs;
+        String resolved = asset->ResolveAssetRef(contexts[index], refs[index]);
+
+        BENCHMARK_STEP_END;
+
+        ASSERT_EQ(resolved, expected[index]);
+    }
+    BENCHMARK_END;
+
+    ASSERT_TRUE(asset->RemoveAssetStorage("TestResolveStorage"));
+    ASSERT_EQ(asset->ResolveAssetRef("", "TestResolveStorage:texture.png"), "TestResolveStorage:texture.png");
+}
+
+TEST_F(Runner, AssetRefListenerWaiters)
+{
+    AssetAPI *asset = framework->Asset();
+    LoadedCounter counter;
+
+    const uint numListeners = 1000;
+    Vector<AssetRefListenerPtr> listeners;
+    for(uint i = 0; i < numListeners; ++i)
+    {
+        AssetRefListenerPtr listener(new AssetRefListener());
+        listener->Loaded.Connect(&counter, &LoadedCounter::OnLoaded);
+        listener->HandleAssetRefChange(asset, "generated://waiter" + String(i) + ".bin", "Binary");
+        listeners.Push(listener);
+    }
+
+    // Only the listener waiting for the created asset picks it up.
+    AssetPtr created = asset->CreateNewAsset("Binary", "generated://waiter500.bin");
+    ASSERT_TRUE(created != nullptr);
+    for(uint i = 0; i < numListeners; ++i)
+        ASSERT_EQ(listeners[i]->Asset() == created, i == 500);
+
+    const u8 data[] = { 1, 2, 3 };
+    ASSERT_TRUE(created->LoadFromFileInMemory(data, sizeof(data), false));
+    ASSERT_EQ(counter.count, 1);
+
+    // Listeners set to an already loaded asset signal Loaded on the next frame, not during HandleAssetRefChange.
+    counter.count = 0;
+    for(uint i = 0; i < numListeners; ++i)
+        listeners[i]->HandleAssetRefChange(asset, "generated://waiter500.bin", "Binary");
+    ASSERT_EQ(counter.count, 0);
+    ProcessEvents();
+    ASSERT_EQ(counter.count, (int)numListeners);
+    for(uint i = 0; i < numListeners; ++i)
+        ASSERT_TRUE(listeners[i]->Asset() == created);
+}
+
+TEST_F(Runner, AssetPrefetchManifest)
+{
+    AssetPrefetchManifest manifest;
+    const char *refs[] = { "http://server/texture.png", "http://server/scene.mesh", "http://server/scene.material", "http://server/small.mesh" };
+    const uint sizes[] = { 4096, 2048, 256, 128 };
+    const uint depths[] = { 2, 0, 1, 0 };
+    for(uint i = 0; i < 4; ++i)
+    {
+        AssetPrefetchManifest::Entry entry;
+        entry.ref = refs[i];
+        entry.size = sizes[i];
+        entry.depth = depths[i];
+        manifest.entries.Push(entry);
+    }
+    manifest.entries[1].dependencies.Push("http://server/scene.material");
+    manifest.entries[2].type = "OgreMaterial";
+    manifest.entries[2].dependencies.Push("http://server/texture.png");
+
+    AssetPrefetchManifest parsed;
+    ASSERT_TRUE(parsed.FromJSON(manifest.ToJSON()));
+    ASSERT_EQ(parsed.entries.Size(), 4u);
+    ASSERT_EQ(parsed.TotalSize(), 4096u + 2048u + 256u + 128u);
+    ASSERT_EQ(parsed.entries[2].type, "OgreMaterial");
+    ASSERT_EQ(parsed.entries[2].dependencies.Size(), 1u);
+    ASSERT_EQ(parsed.entries[2].dependencies[0], "http://server/texture.png");
+
+    // Shallowest dependencies first, smallest first within the same depth.
+    Vector<AssetPrefetchManifest::Entry> prioritized = parsed.PrioritizedEntries();
+    ASSERT_EQ(prioritized[0].ref, "http://server/small.mesh");
+    ASSERT_EQ(prioritized[1].ref, "http://server/scene.mesh");
+    ASSERT_EQ(prioritized[2].ref, "http://server/scene.material");
+    ASSERT_EQ(prioritized[3].ref, "http://server/texture.png");
+
+    ASSERT_FALSE(parsed.FromJSON("{ \"assets\": 5 }"));
+}
+
+TEST_F(Runner, AssetTransferPriority)
+{
+    AssetTransferPtrVector transfers;
+    const char *types[] = { "Texture", "OgreMesh", "OgreMaterial", "Texture", "OgreMesh" };
+    const int priorities[] = { 0, 0, 0, 2, 1 };
+    for(uint i = 0; i < 5; ++i)
+    {
+        AssetTransferPtr transfer(new IAssetTransfer());
+        transfer->source.ref = "transfer" + String(i);
+        transfer->assetType = types[i];
+        transfer->priority = priorities[i];
+        transfers.Push(transfer);
+    }
+
+    // Explicit priorities first, then meshes, materials and the rest.
+    DefaultAssetTransferPrioritizer prioritizer;
+    AssetTransferPtrVector sorted = prioritizer.Prioritize(transfers);
+    ASSERT_EQ(sorted.Size(), transfers.Size());
+    const char *expected[] = { "transfer3", "transfer4", "transfer1", "transfer2", "transfer0" };
+    for(uint i = 0; i < 5; ++i)
+        ASSERT_EQ(sorted[i]->source.ref, expected[i]);
+}
+
+TEST_F(Runner, AssetLoadTimeline)
+{
+    AssetLoadTimeline timeline;
+    const char *refs[] = { "http://server/a.mesh", "http://server/b.png", "local://c.material" };
+    for(uint i = 0; i < 3; ++i)
+        timeline.Mark(refs[i], AssetLoadTimeline::Queued);
+    timeline.Mark("local://unqueued.mesh", AssetLoadTimeline::Started);
+    ASSERT_EQ(timeline.Records().Size(), 3u);
+    ASSERT_TRUE(timeline.Find("local://unqueued.mesh") == 0);
+
+    timeline.Mark(refs[0], AssetLoadTimeline::Started);
+    timeline.Mark(refs[1], AssetLoadTimeline::Started);
+    timeline.SetTransferInfo(refs[0], "OgreMesh", "Web", 100, false);
+    timeline.Mark(refs[0], AssetLoadTimeline::Received);
+    timeline.SetTransferInfo(refs[1], "Texture", "Web", 200, true);
+    timeline.Mark(refs[1], AssetLoadTimeline::Received);
+    for(uint i = 0; i < 2; ++i)
+    {
+        timeline.Mark(refs[i], AssetLoadTimeline::DecodeStarted);
+        timeline.Mark(refs[i], AssetLoadTimeline::DecodeFinished);
+        timeline.Mark(refs[i], AssetLoadTimeline::DependenciesResolved);
+        timeline.Mark(refs[i], AssetLoadTimeline::Loaded);
+    }
+    timeline.SetFailed(refs[2]);
+
+    const AssetLoadTimeline::Record *record = timeline.Find(refs[0]);
+    ASSERT_TRUE(record != 0);
+    for(int s = 1; s < AssetLoadTimeline::NumStages; ++s)
+        ASSERT_GE(record->stages[s], record->stages[s - 1]);
+    ASSERT_GE(record->Duration(AssetLoadTimeline::Queued, AssetLoadTimeline::Loaded), 0);
+    ASSERT_EQ(timeline.Find(refs[2])->Duration(AssetLoadTimeline::Queued, AssetLoadTimeline::Loaded), -1);
+
+    AssetLoadTimeline::Statistics stats = timeline.ComputeStatistics(1);
+    ASSERT_EQ(stats.numLoaded, 2u);
+    ASSERT_EQ(stats.numFailed, 1u);
+    ASSERT_EQ(stats.numPending, 0u);
+    ASSERT_EQ(stats.slowest.Size(), 1u);
+    ASSERT_EQ(stats.types.Size(), 2u);
+    ASSERT_EQ(stats.types["Texture"].count, 1u);
+    ASSERT_EQ(stats.storages.Size(), 1u);
+    ASSERT_EQ(stats.storages["Web"].transfers, 2u);
+    ASSERT_EQ(stats.storages["Web"].cacheHits, 1u);
+    ASSERT_EQ(stats.storages["Web"].bytes, 300u);
+    ASSERT_FLOAT_EQ(stats.storages["Web"].CacheHitRate(), 0.5f);
+
+    JSONValue json;
+    ASSERT_TRUE(json.FromString(timeline.ToJSON()));
+    ASSERT_TRUE(json["traceEvents"].IsArray());
+    ASSERT_EQ(json["assets"].Size(), 3u);
+    ASSERT_EQ((uint)json["summary"]["loaded"].GetNumber(), 2u);
+
+    // A new request for the same ref starts a new record.
+    timeline.Mark(refs[0], AssetLoadTimeline::Queued);
+    ASSERT_EQ(timeline.Records().Size(), 4u);
+    ASSERT_EQ(timeline.Find(refs[0])->stages[AssetLoadTimeline::Loaded], -1);
+
+    timeline.Clear();
+    ASSERT_TRUE(timeline.Records().Empty());
+
+    // When full, the oldest finished records make room for new ones. Pending records are kept.
+    timeline.Mark("local://pending.mesh", AssetLoadTimeline::Queued);
+    for(uint i = 1; i < AssetLoadTimeline::MaxRecords; ++i)
+    {
+        const String ref = "local://" + String(i) + ".mesh";
+        timeline.Mark(ref, AssetLoadTimeline::Queued);
+        timeline.Mark(ref, AssetLoadTimeline::Loaded);
+    }
+    ASSERT_EQ(timeline.Records().Size(), AssetLoadTimeline::MaxRecords);
+    timeline.Mark("local://new.mesh", AssetLoadTimeline::Queued);
+    ASSERT_EQ(timeline.Records().Size(), AssetLoadTimeline::MaxRecords - AssetLoadTimeline::MaxRecords / 4 + 1);
+    ASSERT_TRUE(timeline.Find("local://new.mesh") != 0);
+    ASSERT_TRUE(timeline.Find("local://pending.mesh") != 0);
+    ASSERT_TRUE(timeline.Find("local://1.mesh") == 0);
+    ASSERT_TRUE(timeline.Find(String("local://") + String(AssetLoadTimeline::MaxRecords - 1) + ".mesh") != 0);
+    timeline.Mark("local://pending.mesh", AssetLoadTimeline::Loaded);
+    ASSERT_GE(timeline.Find("local://pending.mesh")->stages[AssetLoadTimeline::Loaded], 0);
+}
+
+TEST_F(Runner, StreamingAssetUpload)
+{
+    Urho3D::FileSystem *fileSystem = framework->GetSubsystem<Urho3D::FileSystem>();
+    const String directory = framework->UserDataDirectory() + "TestStreamingUpload/";
+    ASSERT_TRUE(fileSystem->CreateDir(directory));
+
+    LocalAssetStoragePtr storage = framework->Asset()->AssetProvider<LocalAssetProvider>()->AddStorageDirectory(
+        directory, "TestStreamingUpload", false, true, false, false);
+    ASSERT_TRUE(storage.Get() != 0);
+
+    const uint chunkSize = 1000;
+    Vector<u8> source(chunkSize * 3 + chunkSize / 2);
+    for(uint i = 0; i < source.Size(); ++i)
+        source[i] = (u8)(i * 7 + i / 256);
+    const String sourceFile = directory + "source.bin";
+    ASSERT_TRUE(WriteTestFile(context, sourceFile, source));
+
+    // Fresh upload: progress is reported per chunk and ends at the full size.
+    {
+        UploadProgress progress;
+        AssetUploadTransferPtr transfer = framework->Asset()->UploadAssetFromFile(sourceFile, storage, "uploaded.bin");
+        ASSERT_TRUE(transfer.Get() != 0);
+        ASSERT_TRUE(transfer->IsStreaming());
+        ASSERT_EQ(transfer->totalBytes, source.Size());
+        transfer->chunkSize = chunkSize;
+        transfer->ProgressUpdated.Connect(&progress, &UploadProgress::OnProgress);
+        transfer->Completed.Connect(&progress, &UploadProgress::OnCompleted);
+
+        for(int i = 0; i < 100 && !progress.completed; ++i)
+            ProcessEvents();
+        ASSERT_TRUE(progress.completed);
+        ASSERT_EQ(progress.progress.Size(), 4u);
+        for(uint i = 1; i < progress.progress.Size(); ++i)
+            ASSERT_GT(progress.progress[i], progress.progress[i - 1]);
+        ASSERT_EQ(progress.progress.Back(), source.Size());
+        ASSERT_FLOAT_EQ(transfer->Progress(), 1.f);
+        ASSERT_TRUE(ReadTestFile(context, directory + "uploaded.bin") == source);
+        ASSERT_FALSE(fileSystem->FileExists(directory + "uploaded.bin.part"));
+    }
+
+    // Resumed upload: an interrupted .part file of the same source continues from its last complete chunk.
+    {
+        Vector<u8> partial(&source[0], chunkSize * 2 + chunkSize / 2);
+        ASSERT_TRUE(WriteTestFile(context, directory + "resumed.bin.part", partial));
+        {
+            Urho3D::File info(context, directory + "resumed.bin.part.info", Urho3D::FILE_WRITE);
+            ASSERT_TRUE(info.WriteLine(String(source.Size()) + " " + String(fileSystem->GetLastModifiedTime(sourceFile)) + " " +
+                String(Urho3D::StringHash(sourceFile).Value())));
+        }
+
+        UploadProgress progress;
+        AssetUploadTransferPtr transfer = framework->Asset()->UploadAssetFromFile(sourceFile, storage, "resumed.bin");
+        ASSERT_TRUE(transfer.Get() != 0);
+        transfer->chunkSize = chunkSize;
+        transfer->ProgressUpdated.Connect(&progress, &UploadProgress::OnProgress);
+        transfer->Completed.Connect(&progress, &UploadProgress::OnCompleted);
+
+        for(int i = 0; i < 100 && !progress.completed; ++i)
+            ProcessEvents();
+        ASSERT_TRUE(progress.completed);
+        ASSERT_FALSE(progress.progress.Empty());
+        ASSERT_EQ(progress.progress.Front(), chunkSize * 2);
+        ASSERT_EQ(progress.progress.Back(), source.Size());
+        ASSERT_TRUE(ReadTestFile(context, directory + "resumed.bin") == source);
+        ASSERT_FALSE(fileSystem->FileExists(directory + "resumed.bin.part.info"));
+    }
+
+    // A .part file of some other source is not resumed.
+    {
+        Vector<u8> other(chunkSize * 2, 0xff);
+        ASSERT_TRUE(WriteTestFile(context, directory + "restarted.bin.part", other));
+        {
+            Urho3D::File info(context, directory + "restarted.bin.part.info", Urho3D::FILE_WRITE);
+            ASSERT_TRUE(info.WriteLine(String(other.Size()) + " 0 0"));
+        }
+
+        UploadProgress progress;
+        AssetUploadTransferPtr transfer = framework->Asset()->UploadAssetFromFile(sourceFile, storage, "restarted.bin");
+        ASSERT_TRUE(transfer.Get() != 0);
+        transfer->chunkSize = chunkSize;
+        transfer->ProgressUpdated.Connect(&progress, &UploadProgress::OnProgress);
+        transfer->Completed.Connect(&progress, &UploadProgress::OnCompleted);
+
+        for(int i = 0; i < 100 && !progress.completed; ++i)
+            ProcessEvents();
+        ASSERT_TRUE(progress.completed);
+        ASSERT_EQ(progress.progress.Front(), chunkSize);
+        ASSERT_TRUE(ReadTestFile(context, directory + "restarted.bin") == source);
+    }
+
+    fileSystem->Delete(directory + "uploaded.bin");
+    fileSystem->Delete(directory + "resumed.bin");
+    fileSystem->Delete(directory + "restarted.bin");
+    fileSystem->Delete(sourceFile);
+    framework->Asset()->RemoveAssetStorage("TestStreamingUpload");
+}
+
+TEST_F(Runner, AssetReloadInPlace)
+{
+    const String diskSource = framework->UserDataDirectory() + "TestReloadInPlace.bin";
+    const u8 original[] = { 1, 2, 3 };
+    const u8 modified[] = { 4, 5, 6, 7 };
+
+    SharedPtr<BinaryAsset> binary = DynamicCast<BinaryAsset>(framework->Asset()->CreateNewAsset("Binary", "generated://reloadinplace.bin"));
+    ASSERT_TRUE(binary != nullptr);
+    ASSERT_TRUE(binary->SupportsInPlaceReload());
+    // Only loaded assets can be updated in place.
+    ASSERT_FALSE(binary->ReloadInPlace(modified, sizeof(modified)));
+    ASSERT_TRUE(binary->LoadFromFileInMemory(original, sizeof(original), false));
+
+    LoadedCounter loaded, reloaded;
+    binary->Loaded.Connect(&loaded, &LoadedCounter::OnLoaded);
+    binary->ContentReloaded.Connect(&reloaded, &LoadedCounter::OnLoaded);
+
+    ASSERT_TRUE(WriteTestFile(context, diskSource, Vector<u8>(modified, sizeof(modified))));
+    binary->SetDiskSource(diskSource);
+    ASSERT_TRUE(binary->ReloadInPlaceFromDiskSource());
+    ASSERT_TRUE(binary->data == Vector<u8>(modified, sizeof(modified)));
+    ASSERT_EQ(reloaded.count, 1);
+    ASSERT_EQ(loaded.count, 0);
+
+    // Empty data is rejected and the content is kept.
+    ASSERT_FALSE(binary->ReloadInPlace(0, 0));
+    ASSERT_TRUE(binary->data == Vector<u8>(modified, sizeof(modified)));
+    ASSERT_EQ(reloaded.count, 1);
+
+    framework->GetSubsystem<Urho3D::FileSystem>()->Delete(diskSource);
+    framework->Asset()->ForgetAsset(binary, false);
+}
+
+TEST_F(Runner, AssetReloadInPlaceListeners)
+{
+    AssetAPI *asset = framework->Asset();
+    Urho3D::FileSystem *fileSystem = framework->GetSubsystem<Urho3D::FileSystem>();
+    const String directory = framework->UserDataDirectory() + "TestReloadInPlaceListeners/";
+    const String ref = "TestReloadInPlaceListeners:data.bin";
+    ASSERT_TRUE(fileSystem->CreateDir(directory));
+    const u8 original[] = { 1, 2, 3 };
+    const u8 modified[] = { 4, 5, 6, 7 };
+    ASSERT_TRUE(WriteTestFile(context, directory + "data.bin", Vector<u8>(original, sizeof(original))));
+    ASSERT_TRUE(asset->AssetProvider<LocalAssetProvider>()->AddStorageDirectory(directory, "TestReloadInPlaceListeners", false, false, false, false).Get() != 0);
+
+    AssetRefListenerPtr listener(new AssetRefListener());
+    LoadedCounter loaded, reloaded;
+    listener->Loaded.Connect(&loaded, &LoadedCounter::OnLoaded);
+    listener->ContentReloaded.Connect(&reloaded, &LoadedCounter::OnLoaded);
+    listener->HandleAssetRefChange(asset, ref, "Binary");
+    for(int f = 0; f < 100 && loaded.count == 0; ++f)
+        ProcessEvents();
+    ASSERT_EQ(loaded.count, 1);
+    SharedPtr<BinaryAsset> binary = DynamicCast<BinaryAsset>(listener->Asset());
+    ASSERT_TRUE(binary != nullptr);
+
+    // A forced re-transfer updates the loaded asset in place and reaches the listener as ContentReloaded.
+    ASSERT_TRUE(WriteTestFile(context, directory + "data.bin", Vector<u8>(modified, sizeof(modified))));
+    AssetTransferPtr transfer = asset->RequestAsset(ref, "Binary", true);
+    ASSERT_TRUE(transfer.Get() != 0);
+    for(int f = 0; f < 100 && reloaded.count == 0; ++f)
+        ProcessEvents();
+    ASSERT_EQ(reloaded.count, 1);
+    ASSERT_TRUE(listener->Asset() == binary);
+    ASSERT_TRUE(binary->data == Vector<u8>(modified, sizeof(modified)));
+
+    // An asset that another asset depends on is fully reloaded instead, so that its dependents are reloaded too.
+    asset->RegisterAssetTypeFactory(AssetTypeFactoryPtr(new GenericAssetFactory<DependentBinaryAsset>("TestDependent", ".testdep")));
+    SharedPtr<DependentBinaryAsset> dependent = DynamicCast<DependentBinaryAsset>(asset->CreateNewAsset("TestDependent", "dependent.testdep"));
+    ASSERT_TRUE(dependent != nullptr);
+    dependent->dependee = binary->Name();
+    asset->NotifyAssetDependenciesChanged(dependent);
+    ASSERT_EQ(asset->FindDependents(binary->Name()).Size(), 1u);
+    ASSERT_TRUE(WriteTestFile(context, directory + "data.bin", Vector<u8>(original, sizeof(original))));
+    transfer = asset->RequestAsset(ref, "Binary", true);
+    ASSERT_TRUE(transfer.Get() != 0);
+    for(int f = 0; f < 100 && loaded.count == 1; ++f)
+        ProcessEvents();
+    ASSERT_EQ(loaded.count, 2);
+    ASSERT_EQ(reloaded.count, 1);
+    ASSERT_TRUE(binary->data == Vector<u8>(original, sizeof(original)));
+    asset->ForgetAsset(dependent, false);
+    dependent.Reset();
+
+    // Once the listener moves to another ref, reloads of the old asset are no longer forwarded.
+    listener->HandleAssetRefChange(asset, "", "Binary");
+    ASSERT_TRUE(binary->ReloadInPlace(original, sizeof(original)));
+    ASSERT_EQ(reloaded.count, 1);
+
+    listener.Reset();
+    asset->ForgetAsset(binary, false);
+    asset->RemoveAssetStorage("TestReloadInPlaceListeners");
+    fileSystem->Delete(directory + "data.bin");
+}
+
+TEST_F(Runner, AssetContentDeduplication)
+{
+    AssetAPI *asset = framework->Asset();
+    Urho3D::FileSystem *fileSystem = framework->GetSubsystem<Urho3D::FileSystem>();
+    const String directory = framework->UserDataDirectory() + "TestDeduplication/";
+    ASSERT_TRUE(fileSystem->CreateDir(directory));
+
+    Vector<u8> content(4096), different(4096);
+    for(uint i = 0; i < content.Size(); ++i)
+    {
+        content[i] = (u8)(i * 13);
+        different[i] = (u8)(i * 17);
+    }
+    ASSERT_TRUE(WriteTestFile(context, directory + "original.bin", content));
+    ASSERT_TRUE(WriteTestFile(context, directory + "copy.bin", content));
+    ASSERT_TRUE(WriteTestFile(context, directory + "different.bin", different));
+    ASSERT_TRUE(asset->AssetProvider<LocalAssetProvider>()->AddStorageDirectory(directory, "TestDeduplication", false, false, false, false).Get() != 0);
+
+    asset->SetContentDeduplicationEnabled(true);
+    const char *refs[] = { "TestDeduplication:original.bin", "TestDeduplication:copy.bin", "TestDeduplication:different.bin" };
+    for(uint i = 0; i < 3; ++i)
+    {
+        AssetTransferPtr transfer = asset->RequestAsset(refs[i], "Binary");
+        ASSERT_TRUE(transfer.Get() != 0);
+        for(int f = 0; f < 100 && asset->PendingTransfer(transfer->source.ref); ++f)
+            ProcessEvents();
+        ASSERT_TRUE(transfer->asset != nullptr);
+    }
+
+    // The copy aliases the original, the different content is loaded separately.
+    AssetPtr original = asset->FindAsset(refs[0]);
+    ASSERT_TRUE(original != nullptr);
+    ASSERT_TRUE(asset->FindAsset(refs[1]) == original);
+    ASSERT_EQ(asset->AliasedAssetRef(refs[1]), original->Name());
+    ASSERT_TRUE(asset->FindAsset(refs[2]) != original);
+    ASSERT_TRUE(asset->AliasedAssetRef(refs[2]).Empty());
+    ASSERT_EQ(asset->DeduplicationStatistics().decodesSaved, 1u);
+    ASSERT_EQ(asset->DeduplicationStatistics().bytesSaved, (unsigned long long)content.Size());
+
+    // Reloading the original with new content separates its aliases.
+    const Vector<u8> modified(content.Size(), 7);
+    ASSERT_TRUE(WriteTestFile(context, directory + "original.bin", modified));
+    AssetTransferPtr reload = asset->RequestAsset(refs[0], "Binary", true);
+    ASSERT_TRUE(reload.Get() != 0);
+    for(int f = 0; f < 100 && asset->PendingTransfer(reload->source.ref); ++f)
+        ProcessEvents();
+    ASSERT_TRUE(asset->FindAsset(refs[0]) == original);
+    ASSERT_TRUE(asset->AliasedAssetRef(refs[1]).Empty());
+    ASSERT_TRUE(asset->FindAsset(refs[1]) == nullptr);
+
+    // Once separated, the copy matches the new content of the original again.
+    ASSERT_TRUE(WriteTestFile(context, directory + "copy.bin", modified));
+    AssetTransferPtr copy = asset->RequestAsset(refs[1], "Binary");
+    ASSERT_TRUE(copy.Get() != 0);
+    for(int f = 0; f < 100 && asset->PendingTransfer(copy->source.ref); ++f)
+        ProcessEvents();
+    ASSERT_TRUE(asset->FindAsset(refs[1]) == original);
+
+    // Forgetting the original forgets its aliases.
+    ASSERT_TRUE(asset->ForgetAsset(original, false));
+    ASSERT_TRUE(asset->FindAsset(refs[1]) == nullptr);
+
+    asset->SetContentDeduplicationEnabled(false);
+    asset->ForgetAsset(refs[2], false);
+    asset->RemoveAssetStorage("TestDeduplication");
+    fileSystem->Delete(directory + "original.bin");
+    fileSystem->Delete(directory + "copy.bin");
+    fileSystem->Delete(directory + "different.bin");
+}
+
+TEST_F(Runner, AssetRefListAlias)
+{
+    AssetAPI *asset = framework->Asset();
+    Urho3D::FileSystem *fileSystem = framework->GetSubsystem<Urho3D::FileSystem>();
+    const String directory = framework->UserDataDirectory() + "TestRefListAlias/";
+    ASSERT_TRUE(fileSystem->CreateDir(directory));
+    const Vector<u8> content(1024, 42);
+    ASSERT_TRUE(WriteTestFile(context, directory + "original.bin", content));
+    ASSERT_TRUE(WriteTestFile(context, directory + "copy.bin", content));
+    ASSERT_TRUE(asset->AssetProvider<LocalAssetProvider>()->AddStorageDirectory(directory, "TestRefListAlias", false, false, false, false).Get() != 0);
+    asset->SetContentDeduplicationEnabled(true);
+
+    const String originalRef = "TestRefListAlias:original.bin";
+    const String copyRef = "TestRefListAlias:copy.bin";
+    AssetTransferPtr transfer = asset->RequestAsset(originalRef, "Binary");
+    ASSERT_TRUE(transfer.Get() != 0);
+    for(int f = 0; f < 100 && asset->PendingTransfer(transfer->source.ref); ++f)
+        ProcessEvents();
+    AssetPtr original = asset->FindAsset(originalRef);
+    ASSERT_TRUE(original != nullptr);
+
+    // The copy is loaded as an alias of the original, its index still receives the asset.
+    AssetRefListListenerPtr list(new AssetRefListListener(asset));
+    ListLoadedCounter loaded, reloaded;
+    list->Loaded.Connect(&loaded, &ListLoadedCounter::OnLoaded);
+    list->ContentReloaded.Connect(&reloaded, &ListLoadedCounter::OnLoaded);
+    AssetReferenceList refs("Binary");
+    refs.Append(AssetReference(originalRef, "Binary"));
+    refs.Append(AssetReference(copyRef, "Binary"));
+    list->HandleChange(refs);
+    for(int f = 0; f < 100 && loaded.indices.Size() < 2; ++f)
+        ProcessEvents();
+    ASSERT_EQ(asset->AliasedAssetRef(copyRef), original->Name());
+    ASSERT_EQ(loaded.indices.Size(), 2u);
+    ASSERT_TRUE(loaded.indices.Contains(0) && loaded.indices.Contains(1));
+    ASSERT_TRUE(list->Asset(1) == original);
+
+    // Content reloads of the aliased asset reach both indices.
+    const u8 modified[] = { 1, 2, 3 };
+    ASSERT_TRUE(original->ReloadInPlace(modified, sizeof(modified)));
+    ASSERT_EQ(reloaded.indices.Size(), 2u);
+    ASSERT_TRUE(reloaded.indices.Contains(0) && reloaded.indices.Contains(1));
+
+    list.Reset();
+    asset->SetContentDeduplicationEnabled(false);
+    asset->ForgetAsset(original, false);
+    asset->RemoveAssetStorage("TestRefListAlias");
+    fileSystem->Delete(directory + "original.bin");
+    fileSystem->Delete(directory + "copy.bin");
+}
+
+TEST_F(Runner, ZipAssetBundleExtraction)
+{
+    AssetAPI *asset = framework->Asset();
+    ASSERT_TRUE(asset->Cache() != 0);
+    Urho3D::FileSystem *fileSystem = framework->GetSubsystem<Urho3D::FileSystem>();
+
+    StringVector names;
+    names.Push("a.txt");
+    names.Push("dir/b.txt");
+    Vector<Vector<u8> > contents(2);
+    for(uint i = 0; i < 100; ++i)
+    {
+        contents[0].Push((u8)i);
+        contents[1].Push((u8)(255 - i));
+    }
+    const String zipFile = framework->UserDataDirectory() + "TestZipBundle.zip";
+    ASSERT_TRUE(WriteTestFile(context, zipFile, CreateStoredZip(names, contents)));
+
+    ZipAssetBundlePtr bundle(new ZipAssetBundle(asset, "Zip", "local://TestZipBundle.zip"));
+    bundle->SetDiskSource(zipFile);
+    ASSERT_TRUE(bundle->DeserializeFromDiskSource());
+    ASSERT_TRUE(bundle->IsLoaded());
+    ASSERT_EQ(bundle->SubAssetCount(), 2);
+    ASSERT_EQ(bundle->NumExtracted(), 0u);
+    // Only the central directory is read on load, the archive is not kept open.
+    ASSERT_FALSE(bundle->IsArchiveOpen());
+
+    // Reading the data of an entry does not extract it.
+    ASSERT_TRUE(bundle->GetSubAssetData("a.txt") == contents[0]);
+    ASSERT_EQ(bundle->NumExtracted(), 0u);
+    ASSERT_FALSE(bundle->IsArchiveOpen());
+
+    // Entries are extracted when first requested, the archive is closed once all of them are.
+    String diskSource = bundle->GetSubAssetDiskSource("a.txt");
+    ASSERT_FALSE(diskSource.Empty());
+    ASSERT_TRUE(ReadTestFile(context, diskSource) == contents[0]);
+    ASSERT_EQ(bundle->NumExtracted(), 1u);
+    ASSERT_TRUE(bundle->GetSubAssetDiskSource("unknown.txt").Empty());
+    ASSERT_EQ(bundle->NumExtracted(), 1u);
+
+    String diskSourceB = bundle->GetSubAssetDiskSource("dir/b.txt");
+    ASSERT_TRUE(ReadTestFile(context, diskSourceB) == contents[1]);
+    ASSERT_EQ(bundle->NumExtracted(), 2u);
+    ASSERT_FALSE(bundle->IsArchiveOpen());
+    ASSERT_EQ(bundle->GetSubAssetDiskSource("a.txt"), diskSource);
+    ASSERT_TRUE(bundle->GetSubAssetData("dir/b.txt") == contents[1]);
+
+    bundle->Unload();
+    ASSERT_FALSE(bundle->IsLoaded());
+    fileSystem->Delete(diskSource);
+    fileSystem->Delete(diskSourceB);
+
+    // AssetAPI prepares sub assets first, which extracts them in a worker thread.
+    bundle = new ZipAssetBundle(asset, "Zip", "local://TestZipBundle.zip");
+    bundle->SetDiskSource(zipFile);
+    ASSERT_TRUE(bundle->DeserializeFromDiskSource());
+    ASSERT_EQ(bundle->NumExtracted(), 0u);
+    ASSERT_TRUE(bundle->PrepareSubAsset("unknown.txt"));
+    uint waited = 0;
+    while(!bundle->PrepareSubAsset("a.txt"))
+    {
+        // Data can be read while the extraction is in progress.
+        ASSERT_TRUE(bundle->GetSubAssetData("a.txt") == contents[0]);
+        ASSERT_LT(waited, 5000u);
+        Urho3D::Time::Sleep(10);
+        waited += 10;
+    }
+    ASSERT_EQ(bundle->NumExtracted(), 1u);
+    ASSERT_EQ(bundle->GetSubAssetDiskSource("a.txt"), diskSource);
+    ASSERT_TRUE(ReadTestFile(context, diskSource) == contents[0]);
+
+    bundle->Unload();
+    fileSystem->Delete(diskSource);
+    fileSystem->Delete(zipFile);
+}
+
+TEST_F(Runner, HttpAssetCacheExpiry)
+{
+    const time_t now = 1000000;
+    HttpHeaderMap headers;
+
+    // No freshness information
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), 0);
+
+    // max-age, reduced by the time spent in intermediate caches
+    headers[Http::Header::CacheControl] = "public, max-age=600";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), now + 600);
+    headers[Http::Header::Age] = "100";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), now + 500);
+    headers[Http::Header::Age] = "600";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), 0);
+    headers.erase(Http::Header::Age);
+
+    // max-age takes precedence over Expires
+    headers[Http::Header::Date] = "Sun, 06 Nov 1994 08:49:37 GMT";
+    headers[Http::Header::Expires] = "Sun, 06 Nov 1994 09:49:37 GMT";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), now + 600);
+
+    // Expires is relative to the server Date, not the local clock
+    headers.erase(Http::Header::CacheControl);
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), now + 3600);
+    headers[Http::Header::Expires] = "0";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), 0);
+    headers[Http::Header::Expires] = "Sun, 06 Nov 1994 07:49:37 GMT";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), 0);
+
+    // no-cache and no-store always revalidate
+    headers[Http::Header::Expires] = "Sun, 06 Nov 1994 09:49:37 GMT";
+    headers[Http::Header::CacheControl] = "max-age=600, no-cache";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), 0);
+    headers[Http::Header::CacheControl] = "No-Store";
+    ASSERT_EQ(HttpAssetCacheIndex::ExpiryTime(headers, now), 0);
+}
+
+TEST_F(Runner, HttpAssetCacheIndex)
+{
+    // 64-bit FNV-1a
+    ASSERT_EQ(HttpAssetCacheIndex::ContentHash(0, 0), "cbf29ce484222325");
+    const u8 a = 'a';
+    ASSERT_EQ(HttpAssetCacheIndex::ContentHash(&a, 1), "af63dc4c8601ec8c");
+    const u8 data[] = { 1, 2, 3, 4 };
+    const String hash = HttpAssetCacheIndex::ContentHash(data, sizeof(data));
+    ASSERT_EQ(hash.Length(), 16u);
+    ASSERT_EQ(HttpAssetCacheIndex::ContentHash(data, sizeof(data)), hash);
+    ASSERT_NE(HttpAssetCacheIndex::ContentHash(data, sizeof(data) - 1), hash);
+
+    // The manifest lists content hashes by names relative to the storage base URL
+    SharedPtr<HttpAssetStorage> storage(new HttpAssetStorage(context, "TestHttp", "http://localhost/assets/", ""));
+    ASSERT_FALSE(storage->HasManifest());
+    ASSERT_TRUE(storage->ManifestHash("http://localhost/assets/data.bin").Empty());
+    ASSERT_FALSE(storage->LoadManifest("{ \"files\": [] }"));
+    ASSERT_FALSE(storage->HasManifest());
+    ASSERT_TRUE(storage->LoadManifest("{ \"assets\": { \"data.bin\": { \"hash\": \"" + hash + "\" }, \"models/box.mesh\": { \"hash\": \"0123456789abcdef\" }, \"nohash.bin\": {} } }"));
+    ASSERT_TRUE(storage->HasManifest());
+    ASSERT_EQ(storage->ManifestHash("http://localhost/assets/data.bin"), hash);
+    ASSERT_EQ(storage->ManifestHash("http://localhost/assets/models/box.mesh"), "0123456789abcdef");
+    ASSERT_TRUE(storage->ManifestHash("http://localhost/assets/nohash.bin").Empty());
+    ASSERT_TRUE(storage->ManifestHash("http://localhost/assets/unknown.bin").Empty());
+    ASSERT_TRUE(storage->ManifestHash("http://otherhost/assets/data.bin").Empty());
+    storage->SetManifestUrl("http://localhost/assets/manifest.json");
+    ASSERT_FALSE(storage->HasManifest());
+    ASSERT_TRUE(storage->ManifestHash("http://localhost/assets/data.bin").Empty());
+}
+
+TUNDRA_TEST_MAIN();
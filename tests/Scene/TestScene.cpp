@@ -5,12 +5,19 @@
 
 #include "Scene.h"
 #include "Entity.h"
+#include "Name.h"
+#include "DynamicComponent.h"
+#include "SceneDesc.h"
+#include "AttributeMetadata.h"
+#include "EntityPredictor.h"
 #include "LoggingFunctions.h"
 
 #include <Urho3D/IO/FileSystem.h>
 
 #include <kNet/DataSerializer.h>
 
+#include <cstring>
+
 using namespace Tundra;
 using namespace Tundra::Test;
 
@@ -194,6 +201,404 @@ TEST_F(Runner, CreateComponentsParented)
     }
 }
 
+// Returns the description of an entity named @c name with a dynamic "health" attribute in its "State" component.
+static EntityDesc HealthEntityDesc(const String &name)
+{
+    AttributeDesc nameAttr;
+    nameAttr.typeName = "String";
+    nameAttr.id = "name";
+    nameAttr.name = "Name";
+    nameAttr.value = name;
+    ComponentDesc nameDesc;
+    nameDesc.typeName = Name::TypeNameStatic();
+    nameDesc.attributes.Push(nameAttr);
+
+    AttributeDesc healthAttr;
+    healthAttr.typeName = "real";
+    healthAttr.id = "health";
+    healthAttr.name = "health";
+    healthAttr.value = "100";
+    ComponentDesc stateDesc;
+    stateDesc.typeName = DynamicComponent::TypeNameStatic();
+    stateDesc.name = "State";
+    stateDesc.attributes.Push(healthAttr);
+
+    EntityDesc desc;
+    desc.components.Push(nameDesc);
+    desc.components.Push(stateDesc);
+    return desc;
+}
+
+TEST_F(Runner, CreateEntitiesBatch)
+{
+    const uint numEntities = 1000;
+
+    EntityDesc desc = HealthEntityDesc("Projectile");
+
+    Tundra::Benchmark::Iterations = 10;
+
+    BENCHMARK(String("Per-entity x ") + String(numEntities), 25)
+    {
+        for(uint i = 0; i < numEntities; ++i)
+        {
+            EntityPtr ent = scene->CreateEntity();
+            ent->CreateComponent<Name>()->name.Set("Projectile", AttributeChange::Default);
+            ent->CreateComponent<DynamicComponent>("State")->CreateAttribute("real", "health")->FromString("100", AttributeChange::Default);
+        }
+
+        BENCHMARK_STEP_END;
+
+        scene->RemoveAllEntities();
+    }
+    BENCHMARK_END;
+
+    BENCHMARK(String("Batch x ") + String(numEntities), 25)
+    {
+        EntityVector ents = scene->CreateEntities(desc, numEntities);
+        ASSERT_EQ(ents.Size(), numEntities);
+
+        BENCHMARK_STEP_END;
+
+        scene->RemoveAllEntities();
+    }
+    BENCHMARK_END;
+
+    // Verify batch created content and per-entity initial values
+    Vector<ComponentDescList> initialValues;
+    for(uint i = 0; i < 10; ++i)
+    {
+        ComponentDesc stateOverride = desc.components[1];
+        stateOverride.attributes[0].value = String(i);
+        ComponentDescList overrides;
+        overrides.Push(stateOverride);
+        initialValues.Push(overrides);
+    }
+
+    EntityVector ents = scene->CreateEntities(desc, initialValues);
+    ASSERT_EQ(ents.Size(), initialValues.Size());
+    for(uint i = 0; i < ents.Size(); ++i)
+    {
+        EntityPtr ent = ents[i];
+        ASSERT_TRUE(ent->IsReplicated());
+        ASSERT_TRUE(scene->EntityById(ent->Id()) == ent);
+        ASSERT_EQ(ent->NumComponents(), 2U);
+        ASSERT_EQ(ent->Name(), "Projectile");
+
+        ComponentPtr state = ent->Component(DynamicComponent::TypeNameStatic(), "State");
+        ASSERT_TRUE(state != nullptr);
+        IAttribute *health = state->AttributeById("health");
+        ASSERT_TRUE(health != nullptr);
+        ASSERT_EQ(health->ToString(), String(i));
+    }
+
+    scene->RemoveAllEntities();
+}
+
+TEST_F(Runner, PrefabSerialization)
+{
+    scene->RemoveAllEntities();
+
+    const uint numEntities = 100;
+
+    EntityDesc desc = HealthEntityDesc("Tree");
+
+    ASSERT_TRUE(scene->RegisterPrefab("Tree", desc));
+    EntityVector ents = scene->CreateEntitiesFromPrefab("Tree", numEntities);
+    ASSERT_EQ(ents.Size(), numEntities);
+    ASSERT_EQ(ents[0]->PrefabName(), "Tree");
+    ents[0]->SetName("Oak");
+    const entity_id_t oakId = ents[0]->Id();
+
+    const String prefabXml = scene->SerializeToXmlString(false, false);
+    foreach(const EntityPtr &ent, ents)
+        ent->SetPrefabName("");
+    const String fullXml = scene->SerializeToXmlString(false, false);
+    Log(String("Scene XML size with prefab ") + String(prefabXml.Length()) + " bytes, without " + String(fullXml.Length()) + " bytes", 2);
+    ASSERT_LT(prefabXml.Length(), fullXml.Length());
+
+    // A single entity brings the definition of its prefab along, or is written in full without a scene element.
+    foreach(const EntityPtr &ent, ents)
+        ent->SetPrefabName("Tree");
+    const String entitySceneXml = ents[1]->SerializeToXMLString(false, false, true, true);
+    ASSERT_TRUE(entitySceneXml.Contains("<prefab"));
+    ASSERT_TRUE(entitySceneXml.Contains("prefab=\"Tree\""));
+    ASSERT_FALSE(ents[1]->SerializeToXMLString(false, false, true, false).Contains("prefab="));
+
+    // Scene descriptions of prefab instances contain the inherited attribute values.
+    SceneDesc sceneDesc;
+    scene->CreateSceneDescFromXml(prefabXml, sceneDesc);
+    ASSERT_EQ(sceneDesc.entities.Size(), numEntities);
+    foreach(const EntityDesc &entityDesc, sceneDesc.entities)
+    {
+        ASSERT_EQ(entityDesc.name, entityDesc.id == String(oakId) ? "Oak" : "Tree");
+        ASSERT_EQ(entityDesc.components.Size(), 2U);
+        foreach(const ComponentDesc &compDesc, entityDesc.components)
+        {
+            if (compDesc.name != "State")
+                continue;
+            ASSERT_EQ(compDesc.attributes.Size(), 1U);
+            ASSERT_EQ(compDesc.attributes[0].value, "100");
+        }
+    }
+
+    scene->RemoveAllEntities();
+    scene->UnregisterPrefab("Tree");
+    ASSERT_FALSE(scene->HasPrefab("Tree"));
+
+    Vector<Entity*> copied = scene->CreateContentFromXml(entitySceneXml, false, AttributeChange::Default);
+    ASSERT_EQ(copied.Size(), 1U);
+    ASSERT_TRUE(scene->HasPrefab("Tree"));
+    ASSERT_EQ(copied[0]->Name(), "Tree");
+    ComponentPtr copiedState = copied[0]->Component(DynamicComponent::TypeNameStatic(), "State");
+    ASSERT_TRUE(copiedState != nullptr);
+    ASSERT_TRUE(copiedState->AttributeById("health") != nullptr);
+    ASSERT_EQ(copiedState->AttributeById("health")->ToString(), "100");
+
+    scene->RemoveAllEntities();
+    scene->UnregisterPrefab("Tree");
+
+    Vector<Entity*> loaded = scene->CreateContentFromXml(prefabXml, true, AttributeChange::Default);
+    ASSERT_EQ(loaded.Size(), numEntities);
+    ASSERT_TRUE(scene->HasPrefab("Tree"));
+
+    foreach(Entity *ent, loaded)
+    {
+        ASSERT_EQ(ent->PrefabName(), "Tree");
+        ASSERT_EQ(ent->NumComponents(), 2U);
+        ASSERT_EQ(ent->Name(), ent->Id() == oakId ? "Oak" : "Tree");
+
+        ComponentPtr state = ent->Component(DynamicComponent::TypeNameStatic(), "State");
+        ASSERT_TRUE(state != nullptr);
+        IAttribute *health = state->AttributeById("health");
+        ASSERT_TRUE(health != nullptr);
+        ASSERT_EQ(health->ToString(), "100");
+    }
+
+    scene->RemoveAllEntities();
+    scene->UnregisterPrefab("Tree");
+}
+
+TEST_F(Runner, PrefabSharedValues)
+{
+    scene->RemoveAllEntities();
+
+    const uint numEntities = 10;
+
+    ASSERT_TRUE(scene->RegisterPrefab("Tree", HealthEntityDesc("Tree")));
+    const uint revision = scene->PrefabRevision("Tree");
+    ASSERT_GT(revision, 0U);
+    IComponent *prototype = scene->PrefabComponent("Tree", Name::ComponentTypeId);
+    ASSERT_TRUE(prototype != nullptr);
+
+    // Instances use the prefab values until they set their own, dynamic attributes are copied.
+    EntityVector ents = scene->CreateEntitiesFromPrefab("Tree", numEntities);
+    ASSERT_EQ(ents.Size(), numEntities);
+    foreach(const EntityPtr &ent, ents)
+    {
+        ComponentPtr name = ent->Component(Name::ComponentTypeId);
+        ASSERT_TRUE(name != nullptr);
+        ASSERT_TRUE(name->Prototype().Get() == prototype);
+        ASSERT_TRUE(name->AttributeById("name")->IsValueShared());
+        ASSERT_EQ(ent->Name(), "Tree");
+        ComponentPtr state = ent->Component(DynamicComponent::TypeNameStatic(), "State");
+        ASSERT_TRUE(state != nullptr);
+        ASSERT_FALSE(state->AttributeById("health")->IsValueShared());
+        ASSERT_EQ(state->AttributeById("health")->ToString(), "100");
+    }
+
+    // Setting a value stores an own copy without touching the prefab or the other instances.
+    ents[0]->SetName("Oak");
+    IAttribute *oakName = ents[0]->Component(Name::ComponentTypeId)->AttributeById("name");
+    IAttribute *treeName = ents[1]->Component(Name::ComponentTypeId)->AttributeById("name");
+    ASSERT_FALSE(oakName->IsValueShared());
+    ASSERT_TRUE(treeName->IsValueShared());
+    ASSERT_EQ(ents[0]->Name(), "Oak");
+    ASSERT_EQ(ents[1]->Name(), "Tree");
+    ASSERT_EQ(prototype->AttributeById("name")->ToString(), "Tree");
+
+    // Shared values serialize like own values.
+    kNet::DataSerializer dsShared(1024);
+    kNet::DataSerializer dsCopy(1024);
+    treeName->ToBinary(dsShared);
+    prototype->AttributeById("name")->ToBinary(dsCopy);
+    ASSERT_EQ(dsShared.BytesFilled(), dsCopy.BytesFilled());
+    ASSERT_EQ(memcmp(dsShared.GetData(), dsCopy.GetData(), dsShared.BytesFilled()), 0);
+
+    // Re-registering the prefab gives it a new revision, existing instances keep the old prototype alive.
+    ASSERT_TRUE(scene->RegisterPrefab("Tree", HealthEntityDesc("Pine")));
+    ASSERT_GT(scene->PrefabRevision("Tree"), revision);
+    ASSERT_EQ(ents[1]->Name(), "Tree");
+    ASSERT_EQ(scene->CreateEntitiesFromPrefab("Tree", 1)[0]->Name(), "Pine");
+
+    scene->RemoveAllEntities();
+    scene->UnregisterPrefab("Tree");
+    ASSERT_EQ(scene->PrefabRevision("Tree"), 0U);
+}
+
+// Simulates a server sync update at @c serverTime, optionally with a new value for @c attr.
+static void PushSnapshot(Scene *scene, IAttribute *attr, double serverTime, bool withValue)
+{
+    scene->UpdateSnapshotClock(serverTime);
+    if (withValue)
+    {
+        IAttribute *value = attr->Clone();
+        static_cast<Attribute<float>*>(value)->Set((float)(serverTime * 10.0), AttributeChange::Disconnected);
+        ASSERT_TRUE(scene->PushAttributeSnapshot(attr, value, serverTime));
+    }
+}
+
+TEST_F(Runner, SnapshotInterpolation)
+{
+    scene->RemoveAllEntities();
+
+    static AttributeMetadata interpolated;
+    interpolated.interpolation = AttributeMetadata::Interpolate;
+
+    EntityPtr ent = scene->CreateEntity();
+    IAttribute *attr = ent->CreateComponent<DynamicComponent>("State")->CreateAttribute("real", "value");
+    ASSERT_TRUE(attr != nullptr);
+    attr->SetMetadata(&interpolated);
+    Attribute<float> *value = static_cast<Attribute<float>*>(attr);
+
+    // Fixed render delay of 0.1 s. Server updates every 0.05 s, rendered at 0.01 s frames.
+    scene->SetSnapshotDelayLimits(0.1f, 0.1f);
+    const float frameTime = 0.01f;
+    const uint underrunsBefore = scene->SnapshotUnderruns();
+    uint frame = 0;
+
+    // Steadily changing value is rendered 0.1 s behind the server
+    for(; frame <= 50; ++frame)
+    {
+        if (frame % 5 == 0)
+            PushSnapshot(scene.Get(), attr, frame * frameTime, true);
+        scene->UpdateAttributeInterpolations(frameTime);
+    }
+    ASSERT_NEAR(value->Get(), 10.f * ((frame * frameTime) - 0.1f), 0.01f);
+
+    // Server keeps updating without changes to the value: the last value is final, no extrapolation
+    for(; frame <= 80; ++frame)
+    {
+        if (frame % 5 == 0)
+            PushSnapshot(scene.Get(), attr, frame * frameTime, false);
+        scene->UpdateAttributeInterpolations(frameTime);
+    }
+    ASSERT_NEAR(value->Get(), 5.f, 0.01f);
+    ASSERT_EQ(scene->SnapshotUnderruns(), underrunsBefore);
+
+    // Updates stop arriving: the value is extrapolated for at most MaxSnapshotExtrapolation seconds
+    for(; frame <= 100; ++frame)
+    {
+        if (frame % 5 == 0)
+            PushSnapshot(scene.Get(), attr, frame * frameTime, true);
+        scene->UpdateAttributeInterpolations(frameTime);
+    }
+    for(; frame <= 140; ++frame)
+        scene->UpdateAttributeInterpolations(frameTime);
+    ASSERT_EQ(scene->SnapshotUnderruns(), underrunsBefore + 1);
+    ASSERT_NEAR(value->Get(), 10.f + 10.f * scene->MaxSnapshotExtrapolation(), 0.01f);
+
+    scene->RemoveAllEntities();
+}
+
+// Moves the "position" attribute of the entity's State component along one axis by the input direction, optionally blocked by a wall.
+class TestMovePredictor : public EntityPredictor
+{
+public:
+    TestMovePredictor(Entity *entity, float wall) : EntityPredictor(entity), wall_(wall)
+    {
+        AddPredictedAttribute(Position());
+    }
+
+    Attribute<float> *Position() const
+    {
+        return static_cast<Attribute<float>*>(ParentEntity()->Component<DynamicComponent>()->AttributeById("position"));
+    }
+
+    void ApplyInput(const PredictionInput &input, AttributeChange::Type change) override
+    {
+        float direction = input.data.Size() && input.data[0] ? 1.f : -1.f;
+        float pos = Position()->Get() + direction * 2.f * input.timeStep;
+        Position()->Set(pos < wall_ ? pos : wall_, change);
+    }
+
+private:
+    float wall_;
+};
+
+// Runs a client and a server predictor of separate entities against each other over a loopback with the given latency in frames.
+static void RunPredictionLoopback(Scene *scene, float serverWall, uint latency, SharedPtr<TestMovePredictor> &client, SharedPtr<TestMovePredictor> &server)
+{
+    EntityPtr clientEnt = scene->CreateEntity();
+    clientEnt->CreateComponent<DynamicComponent>("State")->CreateAttribute("real", "position");
+    EntityPtr serverEnt = scene->CreateEntity();
+    serverEnt->CreateComponent<DynamicComponent>("State")->CreateAttribute("real", "position");
+    client = new TestMovePredictor(clientEnt.Get(), 1000.f);
+    server = new TestMovePredictor(serverEnt.Get(), serverWall);
+
+    struct Ack { uint frame; u32 sequence; float position; };
+    List<Pair<uint, PredictionInput> > inputs;
+    List<Ack> acks;
+    PODVector<u8> forward(1, 1);
+    PODVector<u8> backward(1, 0);
+
+    for(uint frame = 0; frame < 100; ++frame)
+    {
+        // Client samples input for the first 60 frames, turning back halfway
+        if (frame < 60)
+            inputs.Push(MakePair(frame + latency, client->Predict(frame < 40 ? forward : backward, 0.1f)));
+
+        while(!inputs.Empty() && inputs.Front().first_ <= frame)
+        {
+            if (server->Process(inputs.Front().second_))
+            {
+                Ack ack = { frame + latency, server->LastAcknowledged(), server->Position()->Get() };
+                acks.Push(ack);
+            }
+            inputs.PopFront();
+        }
+
+        while(!acks.Empty() && acks.Front().frame <= frame)
+        {
+            IAttribute *value = client->Position()->Clone();
+            static_cast<Attribute<float>*>(value)->Set(acks.Front().position, AttributeChange::Disconnected);
+            client->SetAuthoritativeValue(client->Position(), value);
+            client->Acknowledge(acks.Front().sequence);
+            acks.PopFront();
+        }
+    }
+}
+
+TEST_F(Runner, EntityPrediction)
+{
+    scene->RemoveAllEntities();
+
+    SharedPtr<TestMovePredictor> client, server;
+
+    // Deterministic simulation: prediction is never corrected and ends up in the server state
+    RunPredictionLoopback(scene.Get(), 1000.f, 5, client, server);
+    ASSERT_TRUE(client->PendingInputs().Empty());
+    ASSERT_EQ(client->LastAcknowledged(), 60u);
+    ASSERT_EQ(client->Corrections(), 0u);
+    ASSERT_FLOAT_EQ(client->Position()->Get(), server->Position()->Get());
+    ASSERT_NEAR(server->Position()->Get(), 4.f, 0.001f);
+
+    // Old and duplicate inputs are ignored by the server
+    PredictionInput old;
+    old.sequence = 30;
+    old.timeStep = 0.1f;
+    ASSERT_FALSE(server->Process(old));
+
+    // Server blocks the movement the client did not know of: the client is corrected and converges to the server
+    RunPredictionLoopback(scene.Get(), 1.f, 5, client, server);
+    ASSERT_TRUE(client->PendingInputs().Empty());
+    ASSERT_GT(client->Corrections(), 0u);
+    ASSERT_FLOAT_EQ(client->Position()->Get(), server->Position()->Get());
+
+    client.Reset();
+    server.Reset();
+    scene->RemoveAllEntities();
+}
+
 TEST_F(Runner, SceneSerialization)
 {
     // Remove tundra.json hardcoded scene ents
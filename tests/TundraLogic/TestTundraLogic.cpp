@@ -0,0 +1,380 @@
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include "TestRunner.h"
+#include "TestBenchmark.h"
+
+#include "TundraLogic.h"
+#include "Server.h"
+#include "Client.h"
+#include "SyncManager.h"
+#include "SyncState.h"
+#include "TundraMessages.h"
+#include "UserConnection.h"
+#include "TundraLogicUtils.h"
+#include "LinkSimulator.h"
+#include "MsgClientLeft.h"
+#include "Placeable.h"
+#include "Scene.h"
+#include "Entity.h"
+#include "Name.h"
+#include "SceneDesc.h"
+#include "SceneAPI.h"
+#include "IComponentFactory.h"
+
+#include <algorithm>
+
+using namespace Tundra;
+using namespace Tundra::Test;
+
+/// User connection that counts the messages sent to it instead of sending them.
+class TestUserConnection : public UserConnection
+{
+public:
+    TestUserConnection() : numSent(0), lastMessageId(0) {}
+
+    /// Returns the number of messages with @c id sent to the connection.
+    uint NumSent(kNet::message_id_t id) const
+    {
+        HashMap<kNet::message_id_t, uint>::ConstIterator it = numSentById.Find(id);
+        return it != numSentById.End() ? it->second_ : 0;
+    }
+
+    String ConnectionType() const override { return "test"; }
+
+    void Send(kNet::message_id_t id, const char* /*data*/, size_t /*numBytes*/, bool /*reliable*/, bool /*inOrder*/, unsigned long /*priority*/, unsigned long /*contentID*/) override
+    {
+        ++numSent;
+        ++numSentById[id];
+        lastMessageId = id;
+    }
+
+    void Disconnect() override {}
+    void Close() override {}
+
+    uint numSent;
+    kNet::message_id_t lastMessageId;
+    HashMap<kNet::message_id_t, uint> numSentById;
+};
+
+/// Runner with the TundraLogic module loaded.
+class TundraLogicRunner : public Runner
+{
+protected:
+    TundraLogic *logic;
+
+    void SetUp() override
+    {
+        Runner::SetUp();
+
+        logic = new TundraLogic(framework.Get());
+        framework->RegisterModule(logic);
+        static_cast<IModule*>(logic)->Initialize();
+    }
+};
+
+TEST_F(TundraLogicRunner, AuthenticatedUserBroadcast)
+{
+    ServerPtr server = logic->Server();
+    ASSERT_TRUE(server.Get() != 0);
+
+    const uint numUsers = 1000;
+    Vector<SharedPtr<TestUserConnection> > users;
+    for(uint i = 0; i < numUsers; ++i)
+    {
+        SharedPtr<TestUserConnection> user(new TestUserConnection());
+        ASSERT_TRUE(server->AddExternalUser(user));
+        users.Push(user);
+    }
+    ASSERT_EQ(server->AuthenticatedUsers().Size(), numUsers);
+    ASSERT_TRUE(server->UserConnectionById(users.Back()->userID) == users.Back());
+
+    MsgClientLeft left;
+    left.userID = users.Back()->userID;
+
+    Tundra::Benchmark::Iterations = 100;
+
+    // Reference: what the broadcast used to do, filter all connections and serialize per user
+    BENCHMARK("Filtered per-user broadcast", 30)
+    {
+        UserConnectionList authenticated;
+        foreach(const UserConnectionPtr &u, server->UserConnections())
+            if (u->properties["authenticated"].GetBool() == true)
+                authenticated.Push(u);
+        foreach(const UserConnectionPtr &u, authenticated)
+            if (u->userID != left.userID)
+                u->Send(left);
+
+        BENCHMARK_STEP_END;
+    }
+    BENCHMARK_END;
+
+    BENCHMARK("Authenticated user broadcast", 30)
+    {
+        SharedPtr<TestUserConnection> user = users.Back();
+        const uint sentBefore = users.Front()->numSent;
+
+        server->RemoveExternalUser(user);
+
+        BENCHMARK_STEP_END;
+
+        ASSERT_EQ(users.Front()->numSent, sentBefore + 1);
+        ASSERT_EQ(users.Front()->lastMessageId, MsgClientLeft::messageID);
+        ASSERT_EQ(server->AuthenticatedUsers().Size(), numUsers - 1);
+        ASSERT_TRUE(server->UserConnectionById(user->userID).Get() == 0);
+
+        ASSERT_TRUE(server->AddExternalUser(user));
+    }
+    BENCHMARK_END;
+
+    BENCHMARK("UserConnectionById", 30)
+    {
+        UserConnectionPtr found = server->UserConnectionById(users[(uint)i % numUsers]->userID);
+
+        BENCHMARK_STEP_END;
+
+        ASSERT_TRUE(found == users[(uint)i % numUsers]);
+    }
+    BENCHMARK_END;
+
+    foreach(const SharedPtr<TestUserConnection> &user, users)
+        server->RemoveExternalUser(user);
+    ASSERT_EQ(server->AuthenticatedUsers().Size(), 0u);
+}
+
+TEST_F(TundraLogicRunner, LoginData)
+{
+    ClientPtr client = logic->Client();
+    ASSERT_TRUE(client.Get() != 0);
+    client->ClearLoginProperties();
+    client->SetLoginProperty("username", "Tester");
+    client->SetLoginProperty("password", "");
+    client->SetLoginProperty("port", 2345);
+
+    // First-time login: the client does not yet know the server version and sends XML,
+    // even though it requests a protocol version that supports the binary format.
+    std::vector<s8> xmlData = StringToBuffer(client->LoginPropertiesAsXml());
+    ASSERT_FALSE(IsBinaryLoginData(&xmlData[0], xmlData.size()));
+
+    LoginPropertyMap properties;
+    String loginXml;
+    ASSERT_TRUE(DeserializeLoginData(context.Get(), xmlData, properties, loginXml));
+    ASSERT_EQ(properties.Size(), 3u);
+    ASSERT_EQ(properties["username"].GetString(), "Tester");
+    ASSERT_EQ(properties["password"].GetString(), "");
+    ASSERT_EQ(properties["port"].GetString(), "2345");
+    ASSERT_EQ(loginXml, BufferToString(xmlData));
+
+    // Reconnect: binary format
+    std::vector<s8> binaryData = SerializeLoginProperties(client->LoginProperties());
+    ASSERT_TRUE(IsBinaryLoginData(&binaryData[0], binaryData.size()));
+
+    properties.Clear();
+    ASSERT_TRUE(DeserializeLoginData(context.Get(), binaryData, properties, loginXml));
+    ASSERT_EQ(properties.Size(), 3u);
+    ASSERT_EQ(properties["username"].GetString(), "Tester");
+    ASSERT_EQ(properties["port"].GetString(), "2345");
+    ASSERT_TRUE(loginXml.Empty());
+
+    // Truncated binary data is rejected
+    binaryData.resize(binaryData.size() - 1);
+    properties.Clear();
+    ASSERT_FALSE(DeserializeLoginData(context.Get(), binaryData, properties, loginXml));
+}
+
+TEST_F(TundraLogicRunner, AssignUserToScene)
+{
+    ServerPtr server = logic->Server();
+    SharedPtr<SyncManager> sync = logic->SyncManager();
+    ASSERT_TRUE(server->Start(2399, "udp"));
+    ScenePtr defaultScene = sync->RegisteredScene(0);
+    ASSERT_TRUE(defaultScene.Get() != 0);
+
+    SharedPtr<TestUserConnection> user(new TestUserConnection());
+    user->protocolVersion = cHighestSupportedProtocolVersion;
+    ASSERT_TRUE(server->AddExternalUser(user));
+    SharedPtr<TestUserConnection> oldUser(new TestUserConnection());
+    oldUser->protocolVersion = ProtocolHierarchicScene;
+    ASSERT_TRUE(server->AddExternalUser(oldUser));
+    ASSERT_TRUE(user->syncState.Get() != 0);
+    ASSERT_EQ(user->syncState->sceneId, 0u);
+    ASSERT_TRUE(user->syncState->ParentScene().Get() == defaultScene.Get());
+
+    ScenePtr other = framework->Scene()->CreateScene("TestAdditionalScene", true, true);
+    const u32 otherId = sync->RegisterAdditionalScene(other);
+    ASSERT_NE(otherId, 0u);
+    ASSERT_EQ(sync->RegisterAdditionalScene(other), otherId);
+    ASSERT_TRUE(sync->RegisteredScene(otherId) == other);
+
+    // Unknown scene, and a client that does not support changing scenes
+    ASSERT_FALSE(sync->AssignUserToScene(user, otherId + 1));
+    ASSERT_FALSE(sync->AssignUserToScene(oldUser, otherId));
+    ASSERT_EQ(oldUser->syncState->sceneId, 0u);
+    // Assigning to the current scene is a no-op
+    const uint sentBefore = user->numSent;
+    ASSERT_TRUE(sync->AssignUserToScene(user, 0));
+    ASSERT_EQ(user->numSent, sentBefore);
+
+    ASSERT_TRUE(sync->AssignUserToScene(user, otherId));
+    ASSERT_EQ(user->lastMessageId, cSceneChangedMessage);
+    ASSERT_EQ(user->syncState->sceneId, otherId);
+    ASSERT_TRUE(user->syncState->ParentScene().Get() == other.Get());
+
+    // Unregistering the scene moves its users back to the default scene
+    sync->UnregisterAdditionalScene(otherId);
+    ASSERT_TRUE(sync->RegisteredScene(otherId).Get() == 0);
+    ASSERT_EQ(user->lastMessageId, cSceneChangedMessage);
+    ASSERT_EQ(user->syncState->sceneId, 0u);
+    ASSERT_TRUE(user->syncState->ParentScene().Get() == defaultScene.Get());
+
+    // Registering a new default scene moves the users of the additional scenes to it
+    const u32 otherId2 = sync->RegisterAdditionalScene(other);
+    ASSERT_TRUE(sync->AssignUserToScene(user, otherId2));
+    ScenePtr newDefault = framework->Scene()->CreateScene("TestNewDefaultScene", true, true);
+    sync->RegisterToScene(newDefault);
+    ASSERT_TRUE(sync->RegisteredScene(otherId2).Get() == 0);
+    ASSERT_EQ(user->syncState->sceneId, 0u);
+    ASSERT_TRUE(user->syncState->ParentScene().Get() == newDefault.Get());
+
+    server->RemoveExternalUser(user);
+    server->RemoveExternalUser(oldUser);
+    server->Stop();
+}
+
+TEST_F(TundraLogicRunner, RigidBodyChangeBelowThreshold)
+{
+    framework->Scene()->RegisterComponentFactory(ComponentFactoryPtr(new GenericComponentFactory<Placeable>()));
+
+    ServerPtr server = logic->Server();
+    SharedPtr<SyncManager> sync = logic->SyncManager();
+    ASSERT_TRUE(server->Start(2400, "udp"));
+    ScenePtr scene = sync->RegisteredScene(0);
+    ASSERT_TRUE(scene.Get() != 0);
+
+    SharedPtr<TestUserConnection> user(new TestUserConnection());
+    user->protocolVersion = cHighestSupportedProtocolVersion;
+    ASSERT_TRUE(server->AddExternalUser(user));
+
+    EntityPtr entity = scene->CreateEntity(0, StringVector(), AttributeChange::Replicate, true);
+    SharedPtr<Placeable> placeable = entity->CreateComponent<Placeable>();
+    ASSERT_TRUE(placeable.Get() != 0);
+    sync->Update(1.f);
+    ASSERT_EQ(user->NumSent(cRigidBodyUpdateMessage), 0u);
+
+    // A move over the error threshold is sent right away
+    placeable->SetPosition(float3(0.5f, 0.f, 0.f));
+    sync->Update(1.f);
+    ASSERT_EQ(user->NumSent(cRigidBodyUpdateMessage), 1u);
+
+    // The final move stays below the threshold: it is not sent yet, but the entity is kept queued
+    placeable->SetPosition(float3(0.51f, 0.f, 0.f));
+    sync->Update(1.f);
+    ASSERT_EQ(user->NumSent(cRigidBodyUpdateMessage), 1u);
+    SceneSyncState *state = user->syncState.Get();
+    std::map<entity_id_t, EntitySyncState>::iterator ess = state->entities.find(entity->Id());
+    ASSERT_TRUE(ess != state->entities.end());
+    ASSERT_TRUE(std::find(state->dirtyQueue.begin(), state->dirtyQueue.end(), &ess->second) != state->dirtyQueue.end());
+    ASSERT_NE(ess->second.components[placeable->Id()].dirtyAttributes[0] & 1, 0);
+
+    // Once the tolerated error is reached, the pending move is sent without the entity moving again
+    sync->SetRigidBodyErrorThresholds(0.001f, 2.f);
+    sync->Update(1.f);
+    ASSERT_EQ(user->NumSent(cRigidBodyUpdateMessage), 2u);
+    ASSERT_TRUE(std::find(state->dirtyQueue.begin(), state->dirtyQueue.end(), &ess->second) == state->dirtyQueue.end());
+
+    server->RemoveExternalUser(user);
+    server->Stop();
+}
+
+TEST_F(TundraLogicRunner, PrefabSentOncePerUser)
+{
+    ServerPtr server = logic->Server();
+    SharedPtr<SyncManager> sync = logic->SyncManager();
+    ASSERT_TRUE(server->Start(2401, "udp"));
+    ScenePtr scene = sync->RegisteredScene(0);
+    ASSERT_TRUE(scene.Get() != 0);
+
+    SharedPtr<TestUserConnection> user(new TestUserConnection());
+    user->protocolVersion = cHighestSupportedProtocolVersion;
+    ASSERT_TRUE(server->AddExternalUser(user));
+    SharedPtr<TestUserConnection> oldUser(new TestUserConnection());
+    oldUser->protocolVersion = ProtocolMultiScene;
+    ASSERT_TRUE(server->AddExternalUser(oldUser));
+
+    ComponentDesc nameDesc;
+    nameDesc.typeName = Name::TypeNameStatic();
+    EntityDesc desc;
+    desc.components.Push(nameDesc);
+    ASSERT_TRUE(scene->RegisterPrefab("Tree", desc));
+
+    // The prefab is sent once before its first instance, clients without prefab support get the instances in full
+    scene->CreateEntitiesFromPrefab("Tree", 10, AttributeChange::Replicate);
+    sync->Update(1.f);
+    ASSERT_EQ(user->NumSent(cRegisterPrefabMessage), 1u);
+    ASSERT_EQ(user->NumSent(cCreateEntityMessage), 10u);
+    ASSERT_EQ(oldUser->NumSent(cRegisterPrefabMessage), 0u);
+    ASSERT_EQ(oldUser->NumSent(cCreateEntityMessage), 10u);
+
+    scene->CreateEntitiesFromPrefab("Tree", 5, AttributeChange::Replicate);
+    sync->Update(1.f);
+    ASSERT_EQ(user->NumSent(cRegisterPrefabMessage), 1u);
+    ASSERT_EQ(user->NumSent(cCreateEntityMessage), 15u);
+
+    // Registering the prefab again sends the new definition with the next instance
+    ASSERT_TRUE(scene->RegisterPrefab("Tree", desc));
+    scene->CreateEntitiesFromPrefab("Tree", 1, AttributeChange::Replicate);
+    sync->Update(1.f);
+    ASSERT_EQ(user->NumSent(cRegisterPrefabMessage), 2u);
+
+    scene->UnregisterPrefab("Tree");
+    server->RemoveExternalUser(user);
+    server->RemoveExternalUser(oldUser);
+    server->Stop();
+}
+
+TEST_F(Runner, LinkSimulatorDeterministic)
+{
+    LinkSimulationParams params = LinkSimulationParams::FromString("latency=100,loss=0.5,seed=1234");
+    ASSERT_EQ(params.seed, 1234u);
+    ASSERT_TRUE(params.IsEnabled());
+
+    // The same seed and sequence of messages loses the same messages
+    LinkSimulatorPtr first(new LinkSimulator(params));
+    LinkSimulatorPtr second(new LinkSimulator(params));
+    const char data[16] = { 0 };
+    uint delivered = 0;
+    for(uint i = 0; i < 100; ++i)
+    {
+        const bool queued = first->Queue(1, data, sizeof(data), false, false, 100, 0);
+        ASSERT_EQ(second->Queue(1, data, sizeof(data), false, false, 100, 0), queued);
+        if (queued)
+            ++delivered;
+    }
+    ASSERT_EQ(first->NumLost(), second->NumLost());
+    ASSERT_EQ(first->NumLost() + delivered, 100u);
+    ASSERT_GT(first->NumLost(), 0u);
+    ASSERT_GT(delivered, 0u);
+
+    // Messages are due only after the simulated time has advanced by the latency
+    Vector<LinkSimulator::Message> due;
+    first->Advance(0.099);
+    first->PopDue(due);
+    ASSERT_EQ(due.Size(), 0u);
+    first->Advance(0.002);
+    first->PopDue(due);
+    ASSERT_EQ(due.Size(), delivered);
+    ASSERT_EQ(first->NumQueued(), 0u);
+
+    // Lost reliable messages are delivered after the maximum number of simulated retransmissions, a round trip + 100 ms each
+    LinkSimulatorPtr reliable(new LinkSimulator(LinkSimulationParams::FromString("latency=100,loss=1,seed=1")));
+    ASSERT_TRUE(reliable->Queue(1, data, sizeof(data), true, true, 100, 0));
+    ASSERT_EQ(reliable->NumRetransmitted(), 8u);
+    due.Clear();
+    reliable->Advance(2.49);
+    reliable->PopDue(due);
+    ASSERT_EQ(due.Size(), 0u);
+    reliable->Advance(0.02);
+    reliable->PopDue(due);
+    ASSERT_EQ(due.Size(), 1u);
+}
+
+TUNDRA_TEST_MAIN();